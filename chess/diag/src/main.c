@@ -1,8 +1,9 @@
 /*
- * Chess Engine Diagnostic — Root Move Analysis
+ * Chess Engine Diagnostic — Startup Timing + Root Move Analysis
  *
- * Sets up a specific FEN position, searches for 30s,
- * then dumps all root move candidates and their scores.
+ * Times the AppVar work the game does between launch and its first
+ * board, then sets up a specific FEN position, searches for 30s,
+ * and dumps all root move candidates and their scores.
  */
 
 #undef NDEBUG
@@ -12,6 +13,7 @@
 #include <stdint.h>
 #include <sys/timers.h>
 #include <graphx.h>
+#include <fileioc.h>
 
 #include "board.h"
 #include "movegen.h"
@@ -19,6 +21,7 @@
 #include "search.h"
 #include "zobrist.h"
 #include "tt.h"
+#include "chdata.h"
 
 /* ========== Timer (48 MHz) ========== */
 
@@ -41,6 +44,12 @@ static void bench_time_reset(void)
     bench_last_raw = 0;
 }
 
+/* Microseconds since bench_time_reset(), for spans under 89 s */
+static uint32_t bench_time_us(void)
+{
+    return timer_GetSafe(1, TIMER_UP) / 48UL;
+}
+
 /* ========== FEN Parser ========== */
 
 static void parse_fen_board(const char *fen, board_t *b)
@@ -153,6 +162,61 @@ static void out(const char *s)
     gfx_Blit(gfx_screen);
 }
 
+/* ========== Startup Timing ========== */
+
+/* The game opens CHDATA before its first menu frame, decodes a piece's
+   sprite on first draw, probes one book tier per menu frame and loads
+   the book on the first engine move.  Time each piece of that. */
+static void startup_timing(void)
+{
+    static const char tier_appvars[5][7] = {
+        "CHBY01", "CHBX01", "CHBL01", "CHBM01", "CHBS01"
+    };
+    static uint8_t pixels[CHDATA_SPR_PIXELS];
+    const uint8_t *data = NULL;
+    uint32_t us, one_us, worst_us, total_us;
+    uint8_t h, t, found = 0;
+    char buf[48];
+
+    bench_time_reset();
+    h = ti_Open(CHDATA_APPVAR, "r");
+    if (h) {
+        data = (const uint8_t *)ti_GetDataPtr(h);
+        ti_Close(h);
+    }
+    us = bench_time_us();
+    sprintf(buf, "CHDATA open: %luus %s", us,
+            !data ? "(missing)" : CHDATA_IS_PACKED(data) ? "(v2)" : "(v1)");
+    out(buf);
+
+    if (data) {
+        bench_time_reset();
+        chdata_sprite(data, 0, pixels);
+        one_us = bench_time_us();
+        for (t = 1; t < CHDATA_SPR_COUNT; t++)
+            chdata_sprite(data, t, pixels);
+        us = bench_time_us();
+        sprintf(buf, "Sprites: first %luus, all 6 %luus", one_us, us);
+        out(buf);
+    }
+
+    worst_us = total_us = 0;
+    for (t = 0; t < 5 && !found; t++) {
+        bench_time_reset();
+        h = ti_Open(tier_appvars[t], "r");
+        if (h) {
+            ti_Close(h);
+            found = 1;
+        }
+        us = bench_time_us();
+        total_us += us;
+        if (us > worst_us) worst_us = us;
+    }
+    sprintf(buf, "Book tiers: %u probes %luus, frame %luus",
+            t, total_us, worst_us);
+    out(buf);
+}
+
 /* ========== Main ========== */
 
 int main(void)
@@ -175,7 +239,9 @@ int main(void)
     gfx_SetDrawBuffer();
     gfx_ZeroScreen();
 
-    timer_Enable(1, TIMER_32K, TIMER_NOINT, TIMER_UP);
+    timer_Enable(1, TIMER_CPU, TIMER_NOINT, TIMER_UP);
+
+    startup_timing();
 
     out("=== ROOT MOVE DIAGNOSTIC ===");
     out("FEN: ...3q4/3P2b1/2N1BN2...");
@@ -234,8 +300,8 @@ int main(void)
         dbg_printf("| %2u | %5s | %5d | %5d | %12s |\n",
                    i, mbuf, cand_scores[i], delta, mark);
 
-        /* Also show on screen (first 15 that fit) */
-        if (i < 15) {
+        /* Also show on screen (first 10 that fit under the timings) */
+        if (i < 10) {
             sprintf(buf, "%2u: %s %5d %s%s",
                     i, mbuf, cand_scores[i],
                     (delta <= 15) ? "<=" : "  ",
@@ -6,9 +6,16 @@ The eZ80 engine runs inside a cycle-accurate TI-84 Plus CE emulator.
 Each move is computed by patching a command into the binary, running the
 emulator as a subprocess, and parsing the "MOVE xxxx" output.
 
+Moves are sent as a batch session (see emu_uci/src/main.c): the game's
+move list, so the engine sees the history for repetition detection, and
+with --replay-turns N the engine's previous N searches are re-run first
+so the TT, history and killers are warm as in a real game.  --epd runs a
+position suite, many positions per emulator run.
+
 Usage:
     python3 emu_tournament.py --games 30 --sf-elo 1500 --time-ms 4500 \\
         --max-nodes 30000 --variance 5 --book-ply 0 --concurrency 5
+    python3 emu_tournament.py --epd suite.epd --time-ms 4500 --max-nodes 30000
 """
 
 import argparse
@@ -34,7 +41,8 @@ EMU_DIR = Path.home() / "Documents" / "GitHub" / "calc" / "core"
 EMU_BIN = EMU_DIR / "target" / "release" / "examples" / "debug"
 
 SENTINEL = b"@@CMDSLOT@@"
-CMD_SLOT_SIZE = 512
+CMD_SLOT_SIZE = 4096
+STARTPOS_FEN = chess.STARTING_FEN
 
 
 def find_sentinel(data: bytes) -> int:
@@ -73,6 +81,39 @@ def build_command(time_ms: int, max_nodes: int, variance: int, book_ply: int,
     return f"{time_ms} {max_nodes} {variance} {book_ply} {fen}"
 
 
+def build_batch(time_ms: int, max_nodes: int, variance: int, book_ply: int,
+                commands: list[str]) -> str:
+    """Build a batch command: limits line, then one command per line."""
+    return "\n".join([f"{time_ms} {max_nodes} {variance} {book_ply}"] +
+                      commands) + "\n"
+
+
+def game_commands(board: chess.Board, replay_turns: int) -> list[str]:
+    """Session commands that bring the engine to the current position.
+
+    The side to move's last replay_turns positions get a "go" first, so
+    the final search starts from the TT/history/killers state the engine
+    would have had playing the game.  Each "go" prints a MOVE line; only
+    the last one is the answer.
+    """
+    root = board.root()
+    moves = [m.uci() for m in board.move_stack]
+    cmds = ["ucinewgame"]
+    if root.fen() == STARTPOS_FEN:
+        cmds.append("position startpos")
+    else:
+        cmds.append(f"position fen {root.fen()}")
+
+    turns = list(range(len(moves), -1, -2))[:replay_turns + 1][::-1]
+    played = 0
+    for ply in turns:
+        if ply > played:
+            cmds.append("moves " + " ".join(moves[played:ply]))
+            played = ply
+        cmds.append("go")
+    return cmds
+
+
 def get_appvar_args(book_ply: int) -> list[str]:
     """Get the list of appvar files to pass to the emulator."""
     args = []
@@ -83,6 +124,10 @@ def get_appvar_args(book_ply: int) -> list[str]:
     chdata = SCRIPT_DIR / "assets" / "CHDATA.8xv"
     if chdata.exists():
         args.append(str(chdata))
+    # CHEGTB (endgame bitbases) — probed by the search when present
+    chegtb = SCRIPT_DIR / "assets" / "CHEGTB.8xv"
+    if chegtb.exists():
+        args.append(str(chegtb))
     # Book files only if book is used
     if book_ply > 0:
         # Use Small tier (CHBS) for tournament
@@ -92,8 +137,9 @@ def get_appvar_args(book_ply: int) -> list[str]:
 
 
 def run_emulator(patched_8xp: str, appvar_args: list[str],
-                 timeout_s: int) -> str | None:
-    """Run the emulator and return the engine's move (UCI string) or None."""
+                 timeout_s: int) -> list[str] | None:
+    """Run the emulator and return the engine's moves (UCI strings), one
+    per "go", or None."""
     cmd = [
         str(EMU_BIN), "run", patched_8xp
     ] + appvar_args + ["--timeout", str(timeout_s)]
@@ -106,9 +152,11 @@ def run_emulator(patched_8xp: str, appvar_args: list[str],
         )
         output = result.stdout + result.stderr
         # Look for "MOVE xxxx"
-        match = re.search(r"MOVE\s+(\S+)", output)
-        if match:
-            return match.group(1)
+        for err in re.findall(r"ERROR\s+(\S+)", output):
+            print(f"  [EMU] Rejected move: {err}")
+        found = re.findall(r"MOVE\s+(\S+)", output)
+        if found:
+            return found
         else:
             print(f"  [EMU] No MOVE found in output. stdout={result.stdout[:200]}")
             print(f"  [EMU] stderr={result.stderr[:200]}")
@@ -126,7 +174,8 @@ class EmuEngine:
 
     def __init__(self, original_binary: bytes, sentinel_offset: int,
                  time_ms: int, max_nodes: int, variance: int, book_ply: int,
-                 appvar_args: list[str], timeout_s: int, tmp_dir: str):
+                 appvar_args: list[str], timeout_s: int, tmp_dir: str,
+                 replay_turns: int = 0):
         self.original = original_binary
         self.offset = sentinel_offset
         self.time_ms = time_ms
@@ -136,11 +185,10 @@ class EmuEngine:
         self.appvar_args = appvar_args
         self.timeout_s = timeout_s
         self.tmp_dir = tmp_dir
+        self.replay_turns = replay_turns
 
-    def get_move(self, fen: str) -> str | None:
-        """Get the engine's move for the given position (FEN string)."""
-        cmd = build_command(self.time_ms, self.max_nodes, self.variance,
-                            self.book_ply, fen)
+    def run(self, cmd: str, searches: int) -> list[str] | None:
+        """Run one patched binary; the timeout scales with the searches."""
         patched = patch_binary(self.original, self.offset, cmd)
 
         # Write patched binary to temp file (filename must be EMUUCI.8xp
@@ -149,8 +197,49 @@ class EmuEngine:
         with open(tmp_path, "wb") as f:
             f.write(patched)
 
-        move = run_emulator(tmp_path, self.appvar_args, self.timeout_s)
-        return move
+        return run_emulator(tmp_path, self.appvar_args,
+                            self.timeout_s * max(1, searches))
+
+    def get_move(self, board: chess.Board) -> str | None:
+        """Get the engine's move for the given game position."""
+        cmds = game_commands(board, self.replay_turns)
+        # Long games can outgrow the slot: drop replays, then fall back
+        # to a single FEN without history
+        while cmds.count("go") > 1 and len(build_batch(
+                self.time_ms, self.max_nodes, self.variance, self.book_ply,
+                cmds)) >= CMD_SLOT_SIZE:
+            cmds = game_commands(board, cmds.count("go") - 2)
+        cmd = build_batch(self.time_ms, self.max_nodes, self.variance,
+                          self.book_ply, cmds)
+        if len(cmd) >= CMD_SLOT_SIZE:
+            cmd = build_command(self.time_ms, self.max_nodes, self.variance,
+                                self.book_ply, board.fen())
+        moves = self.run(cmd, cmds.count("go"))
+        return moves[-1] if moves else None
+
+    def get_moves(self, fens: list[str]) -> list[str | None]:
+        """Search several unrelated positions, packing as many as fit
+        into each emulator run."""
+        results = []
+        i = 0
+        while i < len(fens):
+            cmds = []
+            j = i
+            while j < len(fens):
+                extra = ["ucinewgame", f"position fen {fens[j]}", "go"]
+                if cmds and len(build_batch(
+                        self.time_ms, self.max_nodes, self.variance,
+                        self.book_ply, cmds + extra)) >= CMD_SLOT_SIZE:
+                    break
+                cmds += extra
+                j += 1
+            moves = self.run(build_batch(self.time_ms, self.max_nodes,
+                                         self.variance, self.book_ply, cmds),
+                             j - i) or []
+            moves += [None] * (j - i - len(moves))
+            results += moves[:j - i]
+            i = j
+        return results
 
 
 def play_game(game_id: int, emu_engine: EmuEngine, sf_path: str,
@@ -180,7 +269,7 @@ def play_game(game_id: int, emu_engine: EmuEngine, sf_path: str,
             emu_turn = (board.turn == chess.WHITE) == emu_plays_white
 
             if emu_turn:
-                move_str = emu_engine.get_move(board.fen())
+                move_str = emu_engine.get_move(board)
                 if move_str is None or move_str == "none":
                     # Engine failed to produce a move — forfeit
                     result_info["result"] = "0-1" if emu_plays_white else "1-0"
@@ -238,9 +327,8 @@ def result_to_emu_score(result: str, emu_white: bool) -> float:
     return 0.0
 
 
-def run_tournament(args):
-    """Run a tournament of N games."""
-    # Read original binary
+def load_binary():
+    """Read EMUUCI.8xp and locate its command slot."""
     if not EMU_UCI_8XP.exists():
         print(f"Error: {EMU_UCI_8XP} not found. Build with: make -C chess/emu_uci")
         sys.exit(1)
@@ -248,15 +336,60 @@ def run_tournament(args):
     original = EMU_UCI_8XP.read_bytes()
     offset = find_sentinel(original)
     print(f"Sentinel found at offset {offset}")
+    return original, offset
 
-    appvar_args = get_appvar_args(args.book_ply)
+
+def search_timeout(args) -> int:
+    """Emulator timeout for one search."""
     # Timeout must cover both time-based and node-based search stopping.
     # If the emulator's hardware timer glitches, the search falls back to
     # the node limit.  At ~154K cycles/node and 48 MHz, worst case is:
     #   max_nodes * 200 / 48000  seconds  (with safety margin on cy/node)
     time_timeout = (args.time_ms // 1000) * 3 + 30
     node_timeout = (args.max_nodes * 200 // 48000 + 30) if args.max_nodes else 0
-    timeout_s = max(60, time_timeout, node_timeout)
+    return max(60, time_timeout, node_timeout)
+
+
+def run_suite(args):
+    """Search every position of an EPD file and score "bm" matches."""
+    original, offset = load_binary()
+    appvar_args = get_appvar_args(args.book_ply)
+    timeout_s = search_timeout(args)
+
+    boards = []
+    with open(args.epd) as f:
+        for line in f:
+            if line.strip():
+                boards.append(chess.Board.from_epd(line.strip()))
+
+    print(f"\n=== Suite: {len(boards)} positions from {args.epd} ===")
+    start_time = time.time()
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        engine = EmuEngine(original, offset, args.time_ms, args.max_nodes,
+                           args.variance, args.book_ply, appvar_args,
+                           timeout_s, tmp_dir)
+        moves = engine.get_moves([b.fen() for b, _ in boards])
+
+    solved = scored = 0
+    for (board, ops), move in zip(boards, moves):
+        best = ops.get("bm")
+        ok = ""
+        if best:
+            scored += 1
+            hit = move is not None and chess.Move.from_uci(move) in best
+            solved += hit
+            ok = "ok" if hit else "miss"
+        print(f"  {ops.get('id', board.fen())}: {move} {ok}")
+
+    elapsed = time.time() - start_time
+    print(f"\nSolved {solved}/{scored}  Elapsed: {elapsed:.0f}s")
+
+
+def run_tournament(args):
+    """Run a tournament of N games."""
+    original, offset = load_binary()
+    appvar_args = get_appvar_args(args.book_ply)
+    timeout_s = search_timeout(args)
 
     sf_path = shutil.which("stockfish")
     if not sf_path:
@@ -266,7 +399,8 @@ def run_tournament(args):
     print(f"\n=== Tournament: {args.games} games, SF Elo {args.sf_elo} ===")
     print(f"    time={args.time_ms}ms nodes={args.max_nodes} var={args.variance} "
           f"book_ply={args.book_ply}")
-    print(f"    timeout={timeout_s}s concurrency={args.concurrency}")
+    print(f"    timeout={timeout_s}s concurrency={args.concurrency} "
+          f"replay_turns={args.replay_turns}")
     print(f"    appvars: {len(appvar_args)} files")
     print()
 
@@ -285,7 +419,8 @@ def run_tournament(args):
         with tempfile.TemporaryDirectory() as tmp_dir:
             engine = EmuEngine(
                 original, offset, args.time_ms, args.max_nodes,
-                args.variance, args.book_ply, appvar_args, timeout_s, tmp_dir
+                args.variance, args.book_ply, appvar_args, timeout_s, tmp_dir,
+                args.replay_turns
             )
             emu_white = (game_id % 2 == 0)  # alternate colors
             return play_game(game_id, engine, sf_path, args.sf_elo, emu_white)
@@ -366,9 +501,17 @@ def main():
     parser.add_argument("--variance", type=int, default=0, help="Move variance (cp)")
     parser.add_argument("--book-ply", type=int, default=0, help="Book max ply (0=disabled)")
     parser.add_argument("--concurrency", type=int, default=5, help="Concurrent games")
+    parser.add_argument("--replay-turns", type=int, default=0,
+                        help="Re-run the engine's last N searches before each "
+                             "move to warm the TT (costs N extra searches)")
+    parser.add_argument("--epd", default=None,
+                        help="Run an EPD position suite instead of games")
     args = parser.parse_args()
 
-    run_tournament(args)
+    if args.epd:
+        run_suite(args)
+    else:
+        run_tournament(args)
 
 
 if __name__ == "__main__":
@@ -5,9 +5,23 @@
  *   "<time_ms> <max_nodes> <variance> <book_ply> <fen>"
  *
  * FEN is standard Forsyth-Edwards Notation (always <90 bytes).
- * Output: "MOVE <uci>\n" via dbg_printf, then terminates.
+ * Output: "MOVE <uci>\n" via dbg_printf, then terminates.  Each
+ * completed search iteration first prints a UCI-style line,
+ * "info depth .. seldepth .. score .. nodes .. nps .. hashfull .. time .. pv ..",
+ * for triage; the controller only picks up the MOVE lines.
  *
- * The 512-byte cmd_slot is initialized with "@@CMDSLOT@@" sentinel
+ * Batch format: the four numbers alone on the first line, then one
+ * command per line, all run in one session so the TT, history and
+ * killers carry over between searches as they do in CHESS.8xp:
+ *   ucinewgame              clear TT, history and killers
+ *   position startpos       set the start position (TT kept)
+ *   position fen <fen>      set a FEN position (TT kept)
+ *   moves <uci> <uci> ...   play moves on the current position
+ *   go                      print "MOVE <uci>"; the move is not played
+ * A move that is not legal prints "ERROR <uci>" and ends its line.
+ * "DONE" is printed after the last command.
+ *
+ * The 4096-byte cmd_slot is initialized with "@@CMDSLOT@@" sentinel
  * so the controller can locate and patch it in the binary.
  */
 
@@ -21,7 +35,7 @@
 
 /* ========== Command Slot (patched by controller) ========== */
 
-static char cmd_slot[512] = "@@CMDSLOT@@";
+static char cmd_slot[4096] = "@@CMDSLOT@@";
 
 /* ========== Hardware Timer (48 MHz) ========== */
 
@@ -163,25 +177,173 @@ static void format_uci_move(engine_move_t m, char *out)
     }
 }
 
+/* Parse a UCI move ("e2e4", "e7e8q").  Returns the text after it, or
+   NULL if p does not start with a move. */
+static const char *parse_uci_move(const char *p, engine_move_t *m)
+{
+    if (p[0] < 'a' || p[0] > 'h' || p[1] < '1' || p[1] > '8' ||
+        p[2] < 'a' || p[2] > 'h' || p[3] < '1' || p[3] > '8')
+        return NULL;
+
+    m->from_col = p[0] - 'a';
+    m->from_row = '8' - p[1];
+    m->to_col = p[2] - 'a';
+    m->to_row = '8' - p[3];
+    m->flags = 0;
+    p += 4;
+
+    switch (*p) {
+        case 'q': m->flags = ENGINE_FLAG_PROMOTION | ENGINE_FLAG_PROMO_Q; p++; break;
+        case 'r': m->flags = ENGINE_FLAG_PROMOTION | ENGINE_FLAG_PROMO_R; p++; break;
+        case 'b': m->flags = ENGINE_FLAG_PROMOTION | ENGINE_FLAG_PROMO_B; p++; break;
+        case 'n': m->flags = ENGINE_FLAG_PROMOTION | ENGINE_FLAG_PROMO_N; p++; break;
+    }
+    return p;
+}
+
+/* ========== Search Info ========== */
+
+static void print_info(const engine_info_t *info)
+{
+    char mbuf[6];
+    uint8_t i;
+    uint32_t nps = 0;
+
+    /* nodes * 1000 / time without overflowing 32 bits */
+    if (info->time_ms)
+        nps = info->nodes / info->time_ms * 1000 +
+              info->nodes % info->time_ms * 1000 / info->time_ms;
+
+    dbg_printf("info depth %u seldepth %u", (unsigned)info->depth,
+               (unsigned)info->seldepth);
+    if (info->mate)
+        dbg_printf(" score mate %d", info->mate);
+    else
+        dbg_printf(" score cp %d", info->score);
+    dbg_printf(" nodes %lu nps %lu hashfull %u time %lu",
+               (unsigned long)info->nodes, (unsigned long)nps,
+               (unsigned)info->hashfull, (unsigned long)info->time_ms);
+    if (info->pv_len) {
+        dbg_printf(" pv");
+        for (i = 0; i < info->pv_len; i++) {
+            format_uci_move(info->pv[i], mbuf);
+            dbg_printf(" %s", mbuf);
+        }
+    }
+    dbg_printf("\n");
+}
+
+/* ========== Commands ========== */
+
+static uint32_t max_time_ms;
+
+/* Search the current position and print the result */
+static void cmd_go(void)
+{
+    engine_move_t move;
+    char mbuf[6];
+
+    /* Reset timer for search timing */
+    time_reset();
+
+    move = engine_think(0, max_time_ms);
+
+    if (move.from_row == ENGINE_SQ_NONE) {
+        dbg_printf("MOVE none\n");
+    } else {
+        format_uci_move(move, mbuf);
+        dbg_printf("MOVE %s\n", mbuf);
+    }
+}
+
+/* Play the UCI moves on the rest of the line */
+static const char *cmd_moves(const char *p)
+{
+    engine_move_t m;
+    const char *next;
+
+    for (;;) {
+        p = skip_ws(p);
+        if (!*p || *p == '\n')
+            return p;
+        next = parse_uci_move(p, &m);
+        if (!next || (*next && *next != ' ' && *next != '\n') ||
+            !engine_is_legal_move(m)) {
+            char tok[8];
+            uint8_t n = 0;
+            while (*p && *p != ' ' && *p != '\n') {
+                if (n < sizeof(tok) - 1) tok[n++] = *p;
+                p++;
+            }
+            tok[n] = '\0';
+            dbg_printf("ERROR %s\n", tok);
+            return p;
+        }
+        engine_make_move(m);
+        p = next;
+    }
+}
+
+/* "position startpos" or "position fen <fen>" */
+static const char *cmd_position(const char *p)
+{
+    static const char startpos[] =
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    engine_position_t pos;
+
+    p = skip_ws(p);
+    if (strncmp(p, "startpos", 8) == 0) {
+        parse_fen(startpos, &pos);
+        p += 8;
+    } else if (strncmp(p, "fen ", 4) == 0) {
+        p = parse_fen(skip_ws(p + 4), &pos);
+    } else {
+        return p;
+    }
+    engine_set_position(&pos);
+    return p;
+}
+
+/* Run the batch commands after the limits line */
+static void run_batch(const char *p)
+{
+    while (*p) {
+        p = skip_ws(p);
+        if (strncmp(p, "ucinewgame", 10) == 0) {
+            engine_new_game();
+            p += 10;
+        } else if (strncmp(p, "position", 8) == 0) {
+            p = cmd_position(p + 8);
+        } else if (strncmp(p, "moves", 5) == 0) {
+            p = cmd_moves(p + 5);
+        } else if (strncmp(p, "go", 2) == 0) {
+            cmd_go();
+            p += 2;
+        }
+        /* Skip the rest of the line, including unknown commands */
+        while (*p && *p != '\n') p++;
+        if (*p) p++;
+    }
+    dbg_printf("DONE\n");
+}
+
 /* ========== Main ========== */
 
 int main(void)
 {
     const char *p;
-    uint32_t max_time_ms, max_nodes;
+    uint32_t max_nodes;
     int variance;
     uint32_t book_ply;
     engine_hooks_t hooks;
     engine_position_t pos;
-    engine_move_t move;
-    char mbuf[6];
 
     /* Start hardware timer */
     timer_Enable(1, TIMER_CPU, TIMER_NOINT, TIMER_UP);
     time_reset();
 
-    /* Parse command from cmd_slot:
-       "<time_ms> <max_nodes> <variance> <book_ply> <fen>" */
+    /* Parse limits from cmd_slot:
+       "<time_ms> <max_nodes> <variance> <book_ply>" */
     p = cmd_slot;
     p = skip_ws(p);
     max_time_ms = parse_uint(&p);
@@ -193,14 +355,11 @@ int main(void)
     book_ply = parse_uint(&p);
     p = skip_ws(p);
 
-    /* Parse FEN and set position */
-    parse_fen(p, &pos);
-
     /* Initialize engine with timer hook */
     hooks.time_ms = time_ms;
     engine_init(&hooks);
+    engine_set_info(print_info);
     engine_new_game();
-    engine_set_position(&pos);
 
     /* Configure engine settings */
     engine_set_max_nodes(max_nodes);
@@ -212,18 +371,13 @@ int main(void)
         engine_set_use_book(0);
     }
 
-    /* Reset timer for search timing */
-    time_reset();
-
-    /* Search */
-    move = engine_think(0, max_time_ms);
-
-    /* Output result */
-    if (move.from_row == ENGINE_SQ_NONE) {
-        dbg_printf("MOVE none\n");
+    if (*p == '\n') {
+        run_batch(p + 1);
     } else {
-        format_uci_move(move, mbuf);
-        dbg_printf("MOVE %s\n", mbuf);
+        /* Single position: the FEN follows the limits */
+        parse_fen(p, &pos);
+        engine_set_position(&pos);
+        cmd_go();
     }
 
     /* Signal emulator to terminate */
@@ -2,6 +2,9 @@
 """
 Ablation tournament: each variant (with one eval feature removed) plays 20 games
 against the full engine (all features enabled). Both sides use 2000-node limit.
+
+Every arm is the same build/uci binary; a variant switches its feature off
+with "setoption name EvalFeatures value <mask>".
 """
 
 import os
@@ -15,15 +18,17 @@ import chess.pgn
 
 BASE_DIR = os.path.dirname(os.path.abspath(__file__))
 BUILD_DIR = os.path.join(BASE_DIR, "build")
-FULL_ENGINE = os.path.join(BUILD_DIR, "uci_full")
+ENGINE = os.path.join(BUILD_DIR, "uci")
 
+# EvalFeatures bits (ENGINE_EVAL_* in src/engine.h)
+EVAL_ALL = 0x3F
 VARIANTS = [
-    ("no_tempo",      "NO_TEMPO",      "Tempo bonus S(24,11)"),
-    ("no_pawns",      "NO_PAWNS",      "Pawn structure (doubled/isolated/connected)"),
-    ("no_passed",     "NO_PASSED",     "Passed pawn bonus"),
-    ("no_rook_files", "NO_ROOK_FILES", "Rook on open/semi-open files"),
-    ("no_mobility",   "NO_MOBILITY",   "Knight & bishop mobility"),
-    ("no_shield",     "NO_SHIELD",     "Pawn shield (king safety)"),
+    ("no_tempo",      0x01, "Tempo bonus S(24,11)"),
+    ("no_pawns",      0x02, "Pawn structure (doubled/isolated/connected)"),
+    ("no_passed",     0x04, "Passed pawn bonus"),
+    ("no_rook_files", 0x08, "Rook on open/semi-open files"),
+    ("no_mobility",   0x10, "Knight & bishop mobility"),
+    ("no_shield",     0x20, "Pawn shield (king safety)"),
 ]
 
 GAMES_PER_MATCH = 20  # 10 as white, 10 as black
@@ -39,7 +44,13 @@ def log(msg):
         print(msg, flush=True)
 
 
-def play_game(white_path, black_path, white_name, black_name, event):
+def open_engine(features):
+    eng = chess.engine.SimpleEngine.popen_uci(ENGINE)
+    eng.configure({"EvalFeatures": features})
+    return eng
+
+
+def play_game(white_features, black_features, white_name, black_name, event):
     """Play one game. Returns chess.pgn.Game."""
     board = chess.Board()
     game = chess.pgn.Game()
@@ -48,8 +59,8 @@ def play_game(white_path, black_path, white_name, black_name, event):
     game.headers["White"] = white_name
     game.headers["Black"] = black_name
 
-    w_eng = chess.engine.SimpleEngine.popen_uci(white_path)
-    b_eng = chess.engine.SimpleEngine.popen_uci(black_path)
+    w_eng = open_engine(white_features)
+    b_eng = open_engine(black_features)
 
     limit = chess.engine.Limit(time=MOVETIME)
     node = game
@@ -96,19 +107,8 @@ def result_score(result_str, for_white):
 
 
 def main():
-    # Check all binaries exist
-    if not os.path.isfile(FULL_ENGINE):
-        print(f"Full engine not found: {FULL_ENGINE}")
-        print("Build: cd chess/engine && make ablation")
-        sys.exit(1)
-
-    missing = []
-    for suffix, _, desc in VARIANTS:
-        path = os.path.join(BUILD_DIR, f"uci_{suffix}")
-        if not os.path.isfile(path):
-            missing.append(f"uci_{suffix}")
-    if missing:
-        print(f"Missing ablation binaries: {', '.join(missing)}")
+    if not os.path.isfile(ENGINE):
+        print(f"Engine not found: {ENGINE}")
         print("Build: cd chess/engine && make ablation")
         sys.exit(1)
 
@@ -131,8 +131,8 @@ def main():
                 print(game, file=f)
                 print(file=f)
 
-    def run_match(suffix, flag, desc):
-        variant_path = os.path.join(BUILD_DIR, f"uci_{suffix}")
+    def run_match(suffix, bit, desc):
+        variant = EVAL_ALL & ~bit
         variant_name = f"Full-{suffix}"
         full_name = "Full"
         half = GAMES_PER_MATCH // 2
@@ -144,11 +144,11 @@ def main():
         for i in range(GAMES_PER_MATCH):
             if i < half:
                 # Full as white vs variant as black
-                g = play_game(FULL_ENGINE, variant_path, full_name, variant_name, event)
+                g = play_game(EVAL_ALL, variant, full_name, variant_name, event)
                 full_sc = result_score(g.headers["Result"], True)
             else:
                 # Variant as white vs full as black
-                g = play_game(variant_path, FULL_ENGINE, variant_name, full_name, event)
+                g = play_game(variant, EVAL_ALL, variant_name, full_name, event)
                 full_sc = result_score(g.headers["Result"], False)
             games.append((g, full_sc))
 
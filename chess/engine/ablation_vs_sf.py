@@ -2,6 +2,9 @@
 """
 Ablation vs Stockfish: each engine variant plays 20 games against SF at
 1400, 1500, 1600, 1700. Measures absolute strength of each variant.
+
+Every variant is the same build/uci binary with some eval terms switched
+off through "setoption name EvalFeatures value <mask>".
 """
 
 import os
@@ -16,17 +19,20 @@ import chess.pgn
 
 BASE_DIR = os.path.dirname(os.path.abspath(__file__))
 BUILD_DIR = os.path.join(BASE_DIR, "build")
+ENGINE = os.path.join(BUILD_DIR, "uci")
 STOCKFISH = "/opt/homebrew/bin/stockfish"
 
+# (EvalFeatures mask, name); bits are ENGINE_EVAL_* in src/engine.h
+EVAL_ALL = 0x3F
 ENGINES = [
-    ("uci_full",          "Full"),
-    ("uci_baseline",      "Baseline"),
-    ("uci_no_tempo",      "-Tempo"),
-    ("uci_no_pawns",      "-Pawns"),
-    ("uci_no_passed",     "-Passed"),
-    ("uci_no_rook_files", "-RookFiles"),
-    ("uci_no_mobility",   "-Mobility"),
-    ("uci_no_shield",     "-Shield"),
+    (EVAL_ALL,         "Full"),
+    (0x00,             "PST-only"),
+    (EVAL_ALL & ~0x01, "-Tempo"),
+    (EVAL_ALL & ~0x02, "-Pawns"),
+    (EVAL_ALL & ~0x04, "-Passed"),
+    (EVAL_ALL & ~0x08, "-RookFiles"),
+    (EVAL_ALL & ~0x10, "-Mobility"),
+    (EVAL_ALL & ~0x20, "-Shield"),
 ]
 
 SF_ELOS = [1700]
@@ -43,13 +49,14 @@ def log(msg):
         print(msg, flush=True)
 
 
-def play_game(our_path, sf_path, sf_elo, our_name, our_is_white):
+def play_game(our_features, sf_path, sf_elo, our_name, our_is_white):
     board = chess.Board()
     game = chess.pgn.Game()
     game.headers["Event"] = f"Ablation vs SF-{sf_elo}"
     game.headers["Date"] = datetime.date.today().strftime("%Y.%m.%d")
 
-    our_eng = chess.engine.SimpleEngine.popen_uci(our_path)
+    our_eng = chess.engine.SimpleEngine.popen_uci(ENGINE)
+    our_eng.configure({"EvalFeatures": our_features})
     sf_eng = chess.engine.SimpleEngine.popen_uci(sf_path)
     sf_eng.configure({"Threads": 1, "UCI_LimitStrength": True, "UCI_Elo": sf_elo})
 
@@ -109,12 +116,10 @@ def elo_diff(pct):
 
 
 def main():
-    # Verify all engines exist
-    for binary, name in ENGINES:
-        path = os.path.join(BUILD_DIR, binary)
-        if not os.path.isfile(path):
-            print(f"Missing: {path}")
-            sys.exit(1)
+    if not os.path.isfile(ENGINE):
+        print(f"Missing: {ENGINE}")
+        print("Build: cd chess/engine && make ablation")
+        sys.exit(1)
 
     total = len(ENGINES) * len(SF_ELOS) * GAMES_PER_MATCH
     print(f"Ablation vs Stockfish: {len(ENGINES)} engines x {len(SF_ELOS)} SF levels x {GAMES_PER_MATCH} games = {total} total")
@@ -136,14 +141,13 @@ def main():
                 print(game, file=f)
                 print(file=f)
 
-    def run_match(binary, name, sf_elo):
-        our_path = os.path.join(BUILD_DIR, binary)
+    def run_match(features, name, sf_elo):
         half = GAMES_PER_MATCH // 2
         wins = draws = losses = 0
 
         for i in range(GAMES_PER_MATCH):
             our_is_white = i < half
-            g = play_game(our_path, STOCKFISH, sf_elo, name, our_is_white)
+            g = play_game(features, STOCKFISH, sf_elo, name, our_is_white)
             sc = score_for_our(g.headers["Result"], our_is_white)
             if sc == 1.0:
                 wins += 1
@@ -164,10 +168,10 @@ def main():
             }
 
     # Build all (engine, sf_elo) pairs
-    tasks = [(b, n, elo) for b, n in ENGINES for elo in SF_ELOS]
+    tasks = [(f, n, elo) for f, n in ENGINES for elo in SF_ELOS]
 
     with ThreadPoolExecutor(max_workers=MAX_WORKERS) as pool:
-        futures = {pool.submit(run_match, b, n, e): (n, e) for b, n, e in tasks}
+        futures = {pool.submit(run_match, f, n, e): (n, e) for f, n, e in tasks}
         done = 0
         for fut in as_completed(futures):
             done += 1
@@ -0,0 +1,133 @@
+#include "bitbase.h"
+#ifdef __ez80__
+#include <fileioc.h>
+#endif
+
+/* ========== Payload Layout ==========
+ *
+ * Multi-byte fields little-endian:
+ *   [4]      magic "CBB\x01"
+ *   [1]      table count N
+ *   [N * 9]  directory: table id (1), offset from payload start (4),
+ *            size in bytes (4)
+ *   tables
+ *
+ * KPK (BITBASE_KPK, 24,576 bytes): pawn side as white, pawn on files
+ * a-d (the others mirror onto them), squares a1=0 .. h8=63.
+ *   index = ((stm * 24 + pawn) * 64 + white_king) * 64 + black_king
+ *   pawn  = (pawn_rank - 1) * 4 + pawn_file     (ranks 2..7 -> 1..6)
+ *   stm   = 0 white to move, 1 black to move
+ *   bit   = table[index >> 3] >> (index & 7) & 1, 1 = white wins
+ */
+
+#define BITBASE_MAGIC   0x01424243UL  /* "CBB\x01" read little-endian */
+#define BITBASE_HEADER  5
+#define BITBASE_DIR     9
+
+#define KPK_PAWNS 24
+#define KPK_BYTES (2UL * KPK_PAWNS * 64 * 64 / 8)
+
+static const uint8_t *kpk_table;
+
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint8_t bitbase_load(const uint8_t *data, uint32_t size)
+{
+    uint8_t count, i, used = 0;
+
+    kpk_table = 0;
+    if (!data || size < BITBASE_HEADER || read_le32(data) != BITBASE_MAGIC)
+        return 0;
+    count = data[4];
+    if (size < BITBASE_HEADER + (uint32_t)count * BITBASE_DIR)
+        return 0;
+
+    for (i = 0; i < count; i++) {
+        const uint8_t *e = data + BITBASE_HEADER + (uint32_t)i * BITBASE_DIR;
+        uint32_t offset = read_le32(e + 1);
+        uint32_t len = read_le32(e + 5);
+
+        if (offset > size || len > size - offset)
+            continue;
+        if (e[0] == BITBASE_KPK && len == KPK_BYTES && !kpk_table) {
+            kpk_table = data + offset;
+            used++;
+        }
+    }
+    return used;
+}
+
+#ifdef __ez80__
+
+uint8_t bitbase_init(void)
+{
+    uint8_t handle;
+    const uint8_t *data;
+    uint32_t size;
+
+    /* Archived AppVars stay put in flash, so the pointer outlives the handle */
+    handle = ti_Open(BITBASE_APPVAR, "r");
+    if (!handle) {
+        kpk_table = 0;
+        return 0;
+    }
+    data = (const uint8_t *)ti_GetDataPtr(handle);
+    size = ti_GetSize(handle);
+    ti_Close(handle);
+    return bitbase_load(data, size);
+}
+
+#else
+
+uint8_t bitbase_init(void)
+{
+    return kpk_table ? 1 : 0;
+}
+
+#endif /* __ez80__ */
+
+/* 0x88 square to the tables' a1=0 numbering */
+#define BB_SQ(sq) ((uint8_t)((7 - SQ_TO_ROW(sq)) * 8 + SQ_TO_COL(sq)))
+
+uint8_t bitbase_probe(const board_t *b, int *score)
+{
+    uint8_t strong, i, sq = SQ_NONE;
+    uint8_t p, wk, bk, stm;
+    uint32_t idx;
+    int v;
+
+    if (!kpk_table ||
+        b->piece_count[WHITE] + b->piece_count[BLACK] != 3)
+        return 0;
+
+    /* KPK: the side with two men has the pawn */
+    strong = (b->piece_count[WHITE] == 2) ? WHITE : BLACK;
+    for (i = 0; i < 2; i++) {
+        sq = b->piece_list[strong][i];
+        if (PIECE_TYPE(b->squares[sq]) != PIECE_KING) break;
+    }
+    if (PIECE_TYPE(b->squares[sq]) != PIECE_PAWN)
+        return 0;
+
+    p = BB_SQ(sq);
+    wk = BB_SQ(b->king_sq[strong]);
+    bk = BB_SQ(b->king_sq[strong ^ 1]);
+    stm = (b->side == strong) ? 0 : 1;
+    if (strong == BLACK) { p ^= 56; wk ^= 56; bk ^= 56; }
+    if ((p & 7) > 3)     { p ^= 7;  wk ^= 7;  bk ^= 7; }
+
+    idx = (((uint32_t)stm * KPK_PAWNS + ((p >> 3) - 1) * 4 + (p & 7)) * 64
+           + wk) * 64 + bk;
+    if (!((kpk_table[idx >> 3] >> (idx & 7)) & 1)) {
+        *score = SCORE_DRAW;
+        return 1;
+    }
+
+    v = BITBASE_WIN + (p >> 3) * BITBASE_WIN_RANK;
+    *score = stm ? -v : v;
+    return 1;
+}
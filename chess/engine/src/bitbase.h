@@ -0,0 +1,41 @@
+#ifndef BITBASE_H
+#define BITBASE_H
+
+#include "board.h"
+
+/* Endgame bitbases: exact win/draw results for tiny endgames, one bit
+   per position, generated offline by tools/gen_bitbase_appvar.py.
+   The payload (layout in bitbase.c) is a small directory of tables so
+   more 3/4-man endgames can join KPK later. */
+
+#define BITBASE_APPVAR  "CHEGTB"
+
+/* Table ids in the payload directory */
+#define BITBASE_KPK     1
+
+/* Most men (kings included) of any table: positions with more are
+   never probed */
+#define BITBASE_MAX_MEN 3
+
+/* Score of a won position for the winning side, plus a bonus per rank
+   the pawn has advanced so the search makes progress.  Stays below
+   the eval of a fresh queen, so promoting still looks better. */
+#define BITBASE_WIN      600
+#define BITBASE_WIN_RANK 10
+
+/* Find the bitbase AppVar on the calculator.  Desktop builds have no
+   AppVar and get their tables from bitbase_load().  Returns the number
+   of tables in use. */
+uint8_t bitbase_init(void);
+
+/* Use the payload at data (kept in place, must stay valid).  Unknown
+   or malformed tables are skipped.  Returns the number of tables in
+   use; 0 turns probing off. */
+uint8_t bitbase_load(const uint8_t *data, uint32_t size);
+
+/* Exact score of b from the side to move, if a table covers it:
+   SCORE_DRAW or +-(BITBASE_WIN + pawn rank bonus).  Returns 0 when no
+   table applies. */
+uint8_t bitbase_probe(const board_t *b, int *score);
+
+#endif /* BITBASE_H */
@@ -0,0 +1,161 @@
+#include "bitboard.h"
+
+#ifdef BITBOARDS
+
+/* ========== Tables ========== */
+
+bb_t bb_knight[64];
+bb_t bb_king[64];
+bb_t bb_pawn_atk[2][64];
+bb_magic_t bb_bishop_magic[64];
+bb_magic_t bb_rook_magic[64];
+
+/* Sum of 2^popcount(mask) over all squares */
+static bb_t bishop_table[5248];
+static bb_t rook_table[102400];
+
+static uint8_t bb_ready = 0;
+
+static const int8_t bishop_dr[4] = { -1, -1,  1,  1 };
+static const int8_t bishop_dc[4] = { -1,  1, -1,  1 };
+static const int8_t rook_dr[4]   = { -1,  1,  0,  0 };
+static const int8_t rook_dc[4]   = {  0,  0, -1,  1 };
+
+static inline uint8_t on_grid(int r, int c)
+{
+    return r >= 0 && r < 8 && c >= 0 && c < 8;
+}
+
+/* ========== Reference Slider Attacks ========== */
+
+/* Walk the four rays from s64, stopping on (and including) blockers.
+   With mask_only set, returns the relevant-occupancy mask
+   instead: ray squares that still have a square beyond them. */
+static bb_t slider_rays(uint8_t s64, bb_t occ, const int8_t *dr,
+                        const int8_t *dc, uint8_t mask_only)
+{
+    bb_t a = 0;
+    int d;
+
+    for (d = 0; d < 4; d++) {
+        int r = (s64 >> 3) + dr[d];
+        int c = (s64 & 7) + dc[d];
+        while (on_grid(r, c)) {
+            if (mask_only && !on_grid(r + dr[d], c + dc[d])) break;
+            a |= BB_SQ(r * 8 + c);
+            if (occ & BB_SQ(r * 8 + c)) break;
+            r += dr[d];
+            c += dc[d];
+        }
+    }
+    return a;
+}
+
+/* ========== Magic Search ========== */
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+/* xorshift64*: fixed seed, so the tables are identical every run */
+static uint64_t rng_next(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ULL;
+}
+
+/* Find a collision-free magic for every square and fill its slice of
+   storage.  Subsets of the mask are enumerated with the carry-rippler;
+   epoch[] marks which slots the current candidate has written. */
+static void init_magics(bb_magic_t *tab, bb_t *storage,
+                        const int8_t *dr, const int8_t *dc)
+{
+    static bb_t occ[4096], ref[4096];
+    static uint32_t epoch[4096];
+    static uint32_t attempt = 0;
+    uint32_t offset = 0;
+    uint8_t s;
+
+    for (s = 0; s < 64; s++) {
+        bb_magic_t *m = &tab[s];
+        bb_t mask = slider_rays(s, 0, dr, dc, 1);
+        uint8_t bits = (uint8_t)__builtin_popcountll(mask);
+        bb_t sub = 0;
+        uint32_t n = 0, i;
+
+        do {
+            occ[n] = sub;
+            ref[n] = slider_rays(s, sub, dr, dc, 0);
+            n++;
+            sub = (sub - mask) & mask;
+        } while (sub);
+
+        m->mask = mask;
+        m->shift = (uint8_t)(64 - bits);
+        m->attacks = storage + offset;
+
+        for (;;) {
+            bb_t magic = rng_next() & rng_next() & rng_next();
+            if (__builtin_popcountll((mask * magic) >> 56) < 6) continue;
+
+            attempt++;
+            for (i = 0; i < n; i++) {
+                uint32_t idx = (uint32_t)((occ[i] * magic) >> m->shift);
+                if (epoch[idx] != attempt) {
+                    epoch[idx] = attempt;
+                    storage[offset + idx] = ref[i];
+                } else if (storage[offset + idx] != ref[i]) {
+                    break;
+                }
+            }
+            if (i == n) { m->magic = magic; break; }
+        }
+
+        offset += (uint32_t)1 << bits;
+    }
+}
+
+/* ========== Step Tables ========== */
+
+static bb_t step_targets(uint8_t s64, const int8_t *dr, const int8_t *dc,
+                         uint8_t n)
+{
+    bb_t a = 0;
+    uint8_t i;
+
+    for (i = 0; i < n; i++) {
+        int r = (s64 >> 3) + dr[i];
+        int c = (s64 & 7) + dc[i];
+        if (on_grid(r, c)) a |= BB_SQ(r * 8 + c);
+    }
+    return a;
+}
+
+void bitboard_init(void)
+{
+    static const int8_t knight_dr[8] = { -2, -2, -1, -1,  1,  1,  2,  2 };
+    static const int8_t knight_dc[8] = { -1,  1, -2,  2, -2,  2, -1,  1 };
+    static const int8_t king_dr[8]   = { -1, -1, -1,  0,  0,  1,  1,  1 };
+    static const int8_t king_dc[8]   = { -1,  0,  1, -1,  1, -1,  0,  1 };
+    /* White pawns move toward row 0 (rank 8), black toward row 7 */
+    static const int8_t wpawn_dr[2]  = { -1, -1 };
+    static const int8_t bpawn_dr[2]  = {  1,  1 };
+    static const int8_t pawn_dc[2]   = { -1,  1 };
+    uint8_t s;
+
+    if (bb_ready) return;
+
+    for (s = 0; s < 64; s++) {
+        bb_knight[s] = step_targets(s, knight_dr, knight_dc, 8);
+        bb_king[s] = step_targets(s, king_dr, king_dc, 8);
+        bb_pawn_atk[WHITE][s] = step_targets(s, wpawn_dr, pawn_dc, 2);
+        bb_pawn_atk[BLACK][s] = step_targets(s, bpawn_dr, pawn_dc, 2);
+    }
+
+    init_magics(bb_bishop_magic, bishop_table, bishop_dr, bishop_dc);
+    init_magics(bb_rook_magic, rook_table, rook_dr, rook_dc);
+
+    bb_ready = 1;
+}
+
+#endif /* BITBOARDS */
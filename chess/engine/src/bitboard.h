@@ -0,0 +1,57 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+/* Bitboard attack tables for 64-bit desktop builds (-DBITBOARDS).
+   The 0x88 board stays the source of truth; board_make/unmake keep
+   per-side and per-type occupancy sets in step with it, and movegen
+   uses these tables for non-pawn targets and is_square_attacked().
+   Bit index is sq64 (0 = a8 .. 63 = h1), same as SQ_TO_SQ64(). */
+
+#include "types.h"
+
+#ifdef BITBOARDS
+
+typedef uint64_t bb_t;
+
+#define BB_SQ(s64) ((bb_t)1 << (s64))
+
+typedef struct {
+    bb_t        mask;     /* relevant occupancy (board edges dropped) */
+    bb_t        magic;
+    const bb_t *attacks;  /* this square's slice of the shared table */
+    uint8_t     shift;    /* 64 - popcount(mask) */
+} bb_magic_t;
+
+extern bb_t bb_knight[64];
+extern bb_t bb_king[64];
+extern bb_t bb_pawn_atk[2][64];  /* [side][sq]: squares a pawn on sq attacks */
+extern bb_magic_t bb_bishop_magic[64];
+extern bb_magic_t bb_rook_magic[64];
+
+/* Build the step and magic tables.  Safe to call repeatedly;
+   board_init() calls it on first use. */
+void bitboard_init(void);
+
+static inline bb_t bb_bishop_attacks(uint8_t s64, bb_t occ)
+{
+    const bb_magic_t *m = &bb_bishop_magic[s64];
+    return m->attacks[((occ & m->mask) * m->magic) >> m->shift];
+}
+
+static inline bb_t bb_rook_attacks(uint8_t s64, bb_t occ)
+{
+    const bb_magic_t *m = &bb_rook_magic[s64];
+    return m->attacks[((occ & m->mask) * m->magic) >> m->shift];
+}
+
+/* Index of the lowest set bit, which is then cleared */
+static inline uint8_t bb_pop_lsb(bb_t *b)
+{
+    uint8_t s = (uint8_t)__builtin_ctzll(*b);
+    *b &= *b - 1;
+    return s;
+}
+
+#endif /* BITBOARDS */
+
+#endif /* BITBOARD_H */
@@ -2,6 +2,12 @@
 #include "eval.h"
 #include "zobrist.h"
 #include <string.h>
+#ifdef ATTACK_MAPS
+#include "directions.h"
+#endif
+#ifdef BITBOARDS
+#include "bitboard.h"
+#endif
 
 /* Sentinel for piece_index[] entries when no piece occupies a square. */
 #define PLIST_INVALID 0xFF
@@ -114,6 +120,9 @@ void board_init(board_t *b)
     uint8_t i;
     if (!zobrist_is_initialized())
         zobrist_init(0);
+#ifdef BITBOARDS
+    bitboard_init();
+#endif
 
     memset(b, 0, sizeof(board_t));
     /* Fill all off-board squares with sentinel so sliding loops
@@ -140,6 +149,10 @@ static void board_add_piece(board_t *b, uint8_t sq, uint8_t piece)
     uint8_t list_idx = b->piece_count[side];
 
     b->squares[sq] = piece;
+#ifdef BITBOARDS
+    b->bb_side[side] |= BB_SQ(sq64);
+    b->bb_type[type] |= BB_SQ(sq64);
+#endif
     if (type == PIECE_KING) {
         b->king_sq[side] = sq;
     }
@@ -188,6 +201,265 @@ static inline void plist_move(board_t *b, uint8_t side, uint8_t old_sq, uint8_t
     b->piece_index[old_sq] = PLIST_INVALID;
 }
 
+/* ========== Incremental Attack Maps ========== */
+
+#ifdef ATTACK_MAPS
+
+/* Add (delta = 1) or remove (delta = -1) the attacks of `piece` standing
+   on sq, given the current occupancy. */
+static void atk_piece(board_t *b, uint8_t sq, uint8_t piece, uint8_t delta)
+{
+    uint8_t *a = b->attacks[IS_BLACK(piece) ? BLACK : WHITE];
+    uint8_t type = PIECE_TYPE(piece);
+    uint8_t t;
+    uint8_t i;
+
+    switch (type) {
+    case PIECE_PAWN:
+        t = sq + (IS_BLACK(piece) ? 16 : -16);
+        if (SQ_VALID(t - 1)) a[t - 1] += delta;
+        if (SQ_VALID(t + 1)) a[t + 1] += delta;
+        return;
+    case PIECE_KNIGHT:
+        for (i = 0; i < 8; i++) {
+            t = sq + knight_offsets[i];
+            if (SQ_VALID(t)) a[t] += delta;
+        }
+        return;
+    case PIECE_KING:
+        for (i = 0; i < 8; i++) {
+            t = sq + king_offsets[i];
+            if (SQ_VALID(t)) a[t] += delta;
+        }
+        return;
+    default:
+        /* king_offsets[] alternates diagonal/orthogonal pairs, so walk
+           it and skip the directions this slider can't use */
+        for (i = 0; i < 8; i++) {
+            int8_t dir = king_offsets[i];
+            uint8_t orth = (dir == -16 || dir == -1 || dir == 1 || dir == 16);
+            if (type == PIECE_BISHOP && orth) continue;
+            if (type == PIECE_ROOK && !orth) continue;
+            t = sq + dir;
+            while (b->squares[t] == PIECE_NONE) { a[t] += delta; t += dir; }
+            if (SQ_VALID(t)) a[t] += delta;
+        }
+        return;
+    }
+}
+
+/* sq just became empty (delta = 1) or occupied (delta = -1): extend or
+   cut every slider ray that runs through it. */
+static void atk_through(board_t *b, uint8_t sq, uint8_t delta)
+{
+    uint8_t i;
+
+    for (i = 0; i < 8; i++) {
+        int8_t dir = king_offsets[i];
+        uint8_t orth = (dir == -16 || dir == -1 || dir == 1 || dir == 16);
+        uint8_t t = sq + dir;
+        uint8_t p, type;
+        uint8_t *a;
+
+        while (b->squares[t] == PIECE_NONE) t += dir;
+        if (!SQ_VALID(t)) continue;
+        p = b->squares[t];
+        type = PIECE_TYPE(p);
+        if (orth ? (type != PIECE_ROOK && type != PIECE_QUEEN)
+                 : (type != PIECE_BISHOP && type != PIECE_QUEEN))
+            continue;
+
+        /* The slider at t looks back through sq */
+        a = b->attacks[IS_BLACK(p) ? BLACK : WHITE];
+        t = sq - dir;
+        while (b->squares[t] == PIECE_NONE) { a[t] += delta; t -= dir; }
+        if (SQ_VALID(t)) a[t] += delta;
+    }
+}
+
+/* Take the piece off sq, keeping the maps in step */
+static void atk_lift(board_t *b, uint8_t sq)
+{
+    atk_piece(b, sq, b->squares[sq], (uint8_t)-1);
+    b->squares[sq] = PIECE_NONE;
+    atk_through(b, sq, 1);
+}
+
+/* Put piece on the empty square sq, keeping the maps in step */
+static void atk_drop(board_t *b, uint8_t sq, uint8_t piece)
+{
+    atk_through(b, sq, (uint8_t)-1);
+    b->squares[sq] = piece;
+    atk_piece(b, sq, piece, 1);
+}
+
+void board_compute_attacks(board_t *b)
+{
+    uint8_t s, i;
+
+    memset(b->attacks, 0, sizeof(b->attacks));
+    for (s = 0; s < 2; s++)
+        for (i = 0; i < b->piece_count[s]; i++) {
+            uint8_t sq = b->piece_list[s][i];
+            atk_piece(b, sq, b->squares[sq], 1);
+        }
+}
+
+static inline void castle_rook_squares(uint8_t from, uint8_t to,
+                                       uint8_t *rook_from, uint8_t *rook_to)
+{
+    if (to > from) { *rook_from = from + 3; *rook_to = from + 1; }
+    else           { *rook_from = from - 4; *rook_to = from - 1; }
+}
+
+/* Update the maps for m, called before board_make() touches squares[].
+   Replays the move one square at a time, then puts squares[] back so
+   the rest of board_make() runs unchanged. */
+static void attacks_make(board_t *b, move_t m)
+{
+    uint8_t from = m.from, to = m.to;
+    uint8_t piece = b->squares[from];
+    uint8_t victim = b->squares[to];
+    uint8_t placed = piece;
+    uint8_t cap_sq = SQ_NONE, cap_piece = PIECE_NONE;
+    uint8_t rook_from = SQ_NONE, rook_to = SQ_NONE;
+
+    if (m.flags & FLAG_PROMOTION) {
+        uint8_t pt;
+        switch (m.flags & FLAG_PROMO_MASK) {
+            case FLAG_PROMO_R: pt = PIECE_ROOK;   break;
+            case FLAG_PROMO_B: pt = PIECE_BISHOP; break;
+            case FLAG_PROMO_N: pt = PIECE_KNIGHT; break;
+            default:           pt = PIECE_QUEEN;  break;
+        }
+        placed = MAKE_PIECE(PIECE_COLOR(piece), pt);
+    }
+
+    atk_lift(b, from);
+    if (m.flags & FLAG_EN_PASSANT) {
+        cap_sq = IS_BLACK(piece) ? (to - 16) : (to + 16);
+        cap_piece = b->squares[cap_sq];
+        if (cap_piece != PIECE_NONE) atk_lift(b, cap_sq);
+    } else if (victim != PIECE_NONE) {
+        atk_lift(b, to);
+    }
+    atk_drop(b, to, placed);
+    if (m.flags & FLAG_CASTLE) {
+        uint8_t rook;
+        castle_rook_squares(from, to, &rook_from, &rook_to);
+        rook = b->squares[rook_from];
+        atk_lift(b, rook_from);
+        atk_drop(b, rook_to, rook);
+        b->squares[rook_from] = rook;
+        b->squares[rook_to] = PIECE_NONE;
+    }
+
+    b->squares[from] = piece;
+    b->squares[to] = victim;
+    if (cap_sq != SQ_NONE) b->squares[cap_sq] = cap_piece;
+}
+
+/* Reverse of attacks_make(), called before board_unmake() touches
+   squares[] (which still hold the post-move position). */
+static void attacks_unmake(board_t *b, move_t m, const undo_t *u)
+{
+    uint8_t from = m.from, to = m.to;
+    uint8_t placed = b->squares[to];
+    uint8_t cap_sq = SQ_NONE;
+    uint8_t rook_from = SQ_NONE, rook_to = SQ_NONE;
+
+    if (u->flags & FLAG_CASTLE) {
+        uint8_t rook;
+        castle_rook_squares(from, to, &rook_from, &rook_to);
+        rook = b->squares[rook_to];
+        atk_lift(b, rook_to);
+        atk_drop(b, rook_from, rook);
+    }
+    atk_lift(b, to);
+    if (u->flags & FLAG_EN_PASSANT) {
+        cap_sq = IS_BLACK(u->moved_piece) ? (to - 16) : (to + 16);
+        if (u->captured != PIECE_NONE) atk_drop(b, cap_sq, u->captured);
+    } else if (u->captured != PIECE_NONE) {
+        atk_drop(b, to, u->captured);
+    }
+    atk_drop(b, from, u->moved_piece);
+
+    /* Back to the post-move squares for board_unmake() */
+    if (cap_sq != SQ_NONE) b->squares[cap_sq] = PIECE_NONE;
+    if (u->flags & FLAG_CASTLE) {
+        b->squares[rook_to] = b->squares[rook_from];
+        b->squares[rook_from] = PIECE_NONE;
+    }
+    b->squares[from] = PIECE_NONE;
+    b->squares[to] = placed;
+}
+
+#endif /* ATTACK_MAPS */
+
+#ifdef BITBOARDS
+
+/* ========== Bitboard Occupancy ========== */
+
+static inline void bb_toggle(board_t *b, uint8_t sq, uint8_t piece)
+{
+    bb_t bit = BB_SQ(SQ_TO_SQ64(sq));
+    b->bb_side[IS_BLACK(piece) ? BLACK : WHITE] ^= bit;
+    b->bb_type[PIECE_TYPE(piece)] ^= bit;
+}
+
+void board_compute_bitboards(board_t *b)
+{
+    uint8_t s, i;
+
+    memset(b->bb_side, 0, sizeof(b->bb_side));
+    memset(b->bb_type, 0, sizeof(b->bb_type));
+    for (s = 0; s < 2; s++)
+        for (i = 0; i < b->piece_count[s]; i++) {
+            uint8_t sq = b->piece_list[s][i];
+            bb_toggle(b, sq, b->squares[sq]);
+        }
+}
+
+/* Flip every occupancy bit m changes.  XOR is its own inverse, so
+   board_unmake() replays the same toggles from the undo record. */
+static void bb_toggle_move(board_t *b, move_t m, uint8_t piece,
+                           uint8_t captured)
+{
+    uint8_t placed = piece;
+
+    if (m.flags & FLAG_PROMOTION) {
+        uint8_t pt;
+        switch (m.flags & FLAG_PROMO_MASK) {
+            case FLAG_PROMO_R: pt = PIECE_ROOK;   break;
+            case FLAG_PROMO_B: pt = PIECE_BISHOP; break;
+            case FLAG_PROMO_N: pt = PIECE_KNIGHT; break;
+            default:           pt = PIECE_QUEEN;  break;
+        }
+        placed = MAKE_PIECE(PIECE_COLOR(piece), pt);
+    }
+
+    bb_toggle(b, m.from, piece);
+    bb_toggle(b, m.to, placed);
+    if (captured != PIECE_NONE) {
+        if (m.flags & FLAG_EN_PASSANT)
+            bb_toggle(b, IS_BLACK(piece) ? (m.to - 16) : (m.to + 16), captured);
+        else
+            bb_toggle(b, m.to, captured);
+    }
+    if (m.flags & FLAG_CASTLE) {
+        uint8_t rook = MAKE_PIECE(PIECE_COLOR(piece), PIECE_ROOK);
+        if (m.to > m.from) {
+            bb_toggle(b, m.from + 3, rook);
+            bb_toggle(b, m.from + 1, rook);
+        } else {
+            bb_toggle(b, m.from - 4, rook);
+            bb_toggle(b, m.from - 1, rook);
+        }
+    }
+}
+
+#endif /* BITBOARDS */
+
 /* ========== Position Setup ========== */
 
 void board_set_from_ui(board_t *b,
@@ -222,6 +494,9 @@ void board_set_from_ui(board_t *b,
     }
 
     board_compute_hash(b);
+#ifdef ATTACK_MAPS
+    board_compute_attacks(b);
+#endif
 }
 
 void board_startpos(board_t *b)
@@ -259,6 +534,15 @@ void board_make(board_t *b, move_t m, undo_t *u)
     uint8_t pst_from = (side == WHITE) ? from64 : PST_FLIP(from64);
     uint8_t pst_to   = (side == WHITE) ? to64 : PST_FLIP(to64);
 
+#ifdef ATTACK_MAPS
+    attacks_make(b, m);
+#endif
+#ifdef BITBOARDS
+    bb_toggle_move(b, m, piece, (flags & FLAG_EN_PASSANT)
+                   ? b->squares[IS_BLACK(piece) ? (to - 16) : (to + 16)]
+                   : captured);
+#endif
+
     /* Save undo state */
     u->captured = captured;
     u->castling = b->castling;
@@ -484,6 +768,13 @@ void board_unmake(board_t *b, move_t m, const undo_t *u)
     uint8_t type, eidx;
     uint8_t from64, to64, pst_from, pst_to;
 
+#ifdef ATTACK_MAPS
+    attacks_unmake(b, m, u);
+#endif
+#ifdef BITBOARDS
+    bb_toggle_move(b, m, u->moved_piece, u->captured);
+#endif
+
     /* Flip side back */
     b->side ^= 1;
     side = b->side;
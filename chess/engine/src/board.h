@@ -24,6 +24,16 @@ typedef struct {
     int16_t  mg[2];              /* middlegame score per side */
     int16_t  eg[2];              /* endgame score per side */
     uint8_t  phase;              /* game phase (24=opening, 0=endgame) */
+#ifdef ATTACK_MAPS
+    /* incremental attack maps: number of pieces of each side attacking
+       each 0x88 square (x-rays not counted) */
+    uint8_t  attacks[2][128];
+#endif
+#ifdef BITBOARDS
+    /* occupancy sets mirroring squares[], bit = sq64 (see bitboard.h) */
+    uint64_t bb_side[2];         /* all pieces per side */
+    uint64_t bb_type[7];         /* per piece type (1..6), both sides */
+#endif
 } board_t;
 
 /* ========== Undo State ========== */
@@ -78,6 +88,18 @@ void board_startpos(board_t *b);
 void board_make(board_t *b, move_t m, undo_t *u);
 void board_unmake(board_t *b, move_t m, const undo_t *u);
 
+#ifdef ATTACK_MAPS
+/* Rebuild attacks[][] from scratch.  board_set_from_ui() calls this;
+   code that fills squares[] by hand must call it before searching. */
+void board_compute_attacks(board_t *b);
+#endif
+
+#ifdef BITBOARDS
+/* Rebuild bb_side/bb_type from squares[].  Same contract as
+   board_compute_attacks(): needed after filling squares[] by hand. */
+void board_compute_bitboards(board_t *b);
+#endif
+
 /* Translate a UI piece (signed int8) to engine piece encoding */
 uint8_t ui_to_engine_piece(int8_t ui_piece);
 
@@ -14,7 +14,7 @@
  * TI-OS limits AppVars to ~65KB, so books are split across files:
  *
  * CHDATA (shared data, see chdata.h):
- *   Polyglot random uint64s at CHDATA_RND_OFFSET (6,248 bytes, LE)
+ *   Polyglot random uint64s at CHDATA_RANDOMS() (6,248 bytes, LE)
  *
  * Book data AppVars (tier-specific, CHxBnn where x=tier, nn=01..99):
  *   [4 bytes]      uint32_t entry_count (little-endian)
@@ -25,6 +25,22 @@
  *   uint16 move    (encoded move)
  *   uint16 weight  (move quality)
  *   uint32 learn   (unused)
+ *
+ * Compact book AppVars (gen_book_appvar.py --compact, same names):
+ *   [4 bytes]      magic "CBK\x01" in place of the entry count
+ *   [4 bytes]      uint32_t entry_count (little-endian)
+ *   [2 bytes]      uint16_t block_count (little-endian)
+ *   [1 byte]       key shift: records store key >> shift (<= 40 bits)
+ *   [5 bytes]      prefix of the last record (big-endian)
+ *   [B * 5 bytes]  prefix of each block's first record (big-endian)
+ *   [B * 256]      blocks; the last one is not padded
+ *
+ * A block is a record count byte followed by records: a LEB128 prefix
+ * delta (from the block's index prefix for the first record), then
+ * uint16 LE move codes with bit 15 set when another move follows.
+ * Keys with several moves give each code a weight byte; single-move
+ * keys have none.  A key never straddles a block or an AppVar, and a
+ * block spans less than 2^32 prefixes.
  */
 
 /* Tier IDs for detected_tier */
@@ -35,22 +51,33 @@
 #define TIER_S   4
 #define TIER_NONE 5
 
-/* Randoms now loaded from CHDATA appvar at CHDATA_RND_OFFSET */
+/* Randoms now loaded from CHDATA appvar at CHDATA_RANDOMS() */
 #define POLY_RANDOM_COUNT   781
 #define POLY_RANDOM_BYTES   (POLY_RANDOM_COUNT * 8)  /* 6,248 */
 #define POLY_ENTRY_SIZE     16
 #define MAX_BOOK_SEGMENTS   40
 
+#define COMPACT_MAGIC       0x014B4243UL  /* "CBK\x01" read little-endian */
+#define COMPACT_HEADER      16
+#define COMPACT_BLOCK       256
+#define COMPACT_PREFIX_SIZE 5
+
 /* ========== Internal State ========== */
 
 typedef struct {
-    const uint8_t *data;     /* flash pointer to entries */
+    const uint8_t *data;     /* flash pointer to entries (or blocks) */
     uint32_t       count;    /* number of entries in this segment */
+    uint64_t       first_key; /* key of the first entry */
+    uint64_t       last_key;  /* key of the last entry */
+    const uint8_t *index;    /* compact only: block prefixes */
+    uint16_t       blocks;   /* compact block count, 0 for raw entries */
+    uint8_t        shift;    /* compact key shift */
 } book_segment_t;
 
 static const uint64_t *poly_randoms;        /* 781 random values in flash */
 static book_segment_t  segments[MAX_BOOK_SEGMENTS];
 static uint8_t         num_segments;
+static uint8_t         last_hit_seg;         /* segment of the previous hit */
 static uint32_t        total_entries;        /* sum of all segment counts */
 static uint8_t         book_ready;
 static uint8_t         detected_tier;        /* TIER_XXL..TIER_S, or TIER_NONE */
@@ -90,6 +117,17 @@ static uint16_t read_be16(const uint8_t *p)
     return ((uint16_t)p[0] << 8) | p[1];
 }
 
+static uint32_t read_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8)  | p[3];
+}
+
+static uint16_t read_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
 static uint32_t read_le32(const uint8_t *p)
 {
     return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
@@ -161,6 +199,11 @@ static uint64_t compute_polyglot_hash(const board_t *b)
 
 /* ========== Segmented Binary Search ========== */
 
+typedef struct {
+    uint16_t move;
+    uint16_t weight;
+} book_entry_t;
+
 /* Binary search within a single segment for the first entry matching key.
  * Returns the local index, or seg->count if not found. */
 static uint32_t segment_find_first(const book_segment_t *seg, uint64_t key)
@@ -184,21 +227,91 @@ static uint32_t segment_find_first(const book_segment_t *seg, uint64_t key)
     return seg->count;  /* not found */
 }
 
-/* Find all entries matching key across segments.
- * The book is globally sorted, so matching entries can only be in
- * one or two adjacent segments (if the key falls on a boundary).
- * Returns the segment index and local offset, or -1 if not found. */
-static uint8_t find_key_segment(uint64_t key, uint8_t *out_seg, uint32_t *out_idx)
+/* 1 if segment s holds the first entry for key (if there is one).
+ * The book is globally sorted, so that is the first segment whose last
+ * key is >= key. */
+static uint8_t segment_owns_key(uint8_t s, uint64_t key)
 {
-    uint8_t s;
+    if (key > segments[s].last_key)
+        return 0;
+    return s == 0 || key > segments[s - 1].last_key;
+}
 
-    for (s = 0; s < num_segments; s++) {
-        uint32_t idx = segment_find_first(&segments[s], key);
-        if (idx < segments[s].count) {
-            *out_seg = s;
-            *out_idx = idx;
-            return 1;
-        }
+/* Collect the moves stored for key in a compact segment.  A binary
+ * search over the block index picks the last block starting at or
+ * before the key's prefix; the walk through that block then runs on
+ * 32-bit offsets from the block's prefix, so the only 64-bit work per
+ * probe is forming the prefix. */
+static uint8_t compact_key_entries(const book_segment_t *seg, uint64_t key,
+                                   book_entry_t *entries, uint8_t max_entries)
+{
+    uint64_t prefix = key >> seg->shift;
+    uint8_t want_hi = (uint8_t)(prefix >> 32);
+    uint32_t want_lo = (uint32_t)prefix;
+    uint8_t want[COMPACT_PREFIX_SIZE];
+    uint16_t lo = 0, hi = seg->blocks, mid;
+    const uint8_t *p;
+    uint32_t base, off, cur = 0;
+    uint8_t records, count = 0;
+
+    want[0] = want_hi;
+    want[1] = (uint8_t)(want_lo >> 24);
+    want[2] = (uint8_t)(want_lo >> 16);
+    want[3] = (uint8_t)(want_lo >> 8);
+    want[4] = (uint8_t)want_lo;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (memcmp(seg->index + (uint32_t)mid * COMPACT_PREFIX_SIZE,
+                   want, COMPACT_PREFIX_SIZE) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return 0;
+
+    /* Offset from the block prefix; blocks span less than 2^32 */
+    p = seg->index + (uint32_t)(lo - 1) * COMPACT_PREFIX_SIZE;
+    base = read_be32(p + 1);
+    off = want_lo - base;
+    if ((uint8_t)(want_hi - p[0] - (want_lo < base)) != 0)
+        return 0;
+
+    p = seg->data + (uint32_t)(lo - 1) * COMPACT_BLOCK;
+    records = *p++;
+
+    while (records--) {
+        uint32_t delta = 0;
+        uint8_t bit = 0, byte, multi, hit;
+        uint16_t code;
+
+        do {
+            byte = *p++;
+            delta |= (uint32_t)(byte & 0x7F) << bit;
+            bit += 7;
+        } while (byte & 0x80);
+
+        cur += delta;
+        if (cur > off)
+            return 0;
+
+        hit = (cur == off);
+        multi = p[1] & 0x80;
+        do {
+            code = read_le16(p);
+            p += 2;
+            if (hit && count < max_entries) {
+                entries[count].move = code & 0x7FFF;
+                entries[count].weight = multi ? *p : 1;
+                count++;
+            }
+            if (multi)
+                p++;
+        } while (code & 0x8000);
+
+        if (hit)
+            return count;
     }
 
     return 0;
@@ -270,11 +383,6 @@ static move_t poly_move_to_engine(const board_t *b, uint16_t poly_move)
 /* Iterate entries with the given key starting at segment seg_idx, local
  * offset local_idx. Calls the callback for each entry's (move, weight).
  * This handles the case where matching entries span a segment boundary. */
-typedef struct {
-    uint16_t move;
-    uint16_t weight;
-} book_entry_t;
-
 static uint8_t iterate_key_entries(uint64_t key, uint8_t seg_idx,
                                    uint32_t local_idx,
                                    book_entry_t *entries, uint8_t max_entries)
@@ -305,6 +413,47 @@ static uint8_t iterate_key_entries(uint64_t key, uint8_t seg_idx,
     return count;
 }
 
+/* Collect the entries matching key.  The segment key ranges recorded
+ * at load act as a directory: the segment of the previous hit is tried
+ * first, otherwise one binary search over the ranges picks the segment,
+ * and keys that fall between ranges are rejected without touching the
+ * entries.  Entries for a key that straddles a boundary start in the
+ * chosen segment; iterate_key_entries() follows them into the next. */
+static uint8_t find_key_entries(uint64_t key, book_entry_t *entries,
+                                uint8_t max_entries)
+{
+    uint8_t s = last_hit_seg;
+    uint8_t count;
+
+    if (s >= num_segments || !segment_owns_key(s, key)) {
+        uint8_t lo = 0, hi = num_segments, mid;
+        while (lo < hi) {
+            mid = (uint8_t)((lo + hi) / 2);
+            if (segments[mid].last_key < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        s = lo;
+    }
+
+    if (s >= num_segments || key < segments[s].first_key)
+        return 0;
+
+    if (segments[s].blocks) {
+        count = compact_key_entries(&segments[s], key, entries, max_entries);
+    } else {
+        uint32_t idx = segment_find_first(&segments[s], key);
+        if (idx >= segments[s].count)
+            return 0;
+        count = iterate_key_entries(key, s, idx, entries, max_entries);
+    }
+
+    if (count)
+        last_hit_seg = s;
+    return count;
+}
+
 /* ========== Public API ========== */
 
 /* Try to load all segments for a given 4-char prefix (e.g. "CHBX").
@@ -337,11 +486,39 @@ static void load_segments(const char *prefix)
         count = read_le32(data_ptr);
         ti_Close(handle);
 
+        if (count == COMPACT_MAGIC) {
+            book_segment_t *sg = &segments[num_segments];
+            uint16_t blocks = read_le16(data_ptr + 8);
+            uint8_t shift = data_ptr[10];
+
+            if (blocks == 0)
+                continue;
+            count = read_le32(data_ptr + 4);
+            sg->index = data_ptr + COMPACT_HEADER;
+            sg->data = sg->index + (uint32_t)blocks * COMPACT_PREFIX_SIZE;
+            sg->count = count;
+            sg->blocks = blocks;
+            sg->shift = shift;
+            /* Prefix ranges widened to cover every key they stand for */
+            sg->first_key = ((uint64_t)data_ptr[COMPACT_HEADER] << 32 |
+                             read_be32(data_ptr + COMPACT_HEADER + 1)) << shift;
+            sg->last_key = ((uint64_t)data_ptr[11] << 32 |
+                            read_be32(data_ptr + 12)) << shift |
+                           (((uint64_t)1 << shift) - 1);
+            total_entries += count;
+            num_segments++;
+            continue;
+        }
+
         if (count == 0)
             continue;
 
         segments[num_segments].data = data_ptr + 4;
         segments[num_segments].count = count;
+        segments[num_segments].first_key = read_be64(data_ptr + 4);
+        segments[num_segments].last_key =
+            read_be64(data_ptr + 4 + (count - 1) * POLY_ENTRY_SIZE);
+        segments[num_segments].blocks = 0;
         total_entries += count;
         num_segments++;
     }
@@ -364,6 +541,7 @@ uint8_t book_init(void)
     uint8_t *data_ptr;
 
     num_segments = 0;
+    last_hit_seg = 0;
     total_entries = 0;
     book_ready = 0;
     detected_tier = TIER_NONE;
@@ -373,7 +551,7 @@ uint8_t book_init(void)
     if (!handle)
         return 0;
     data_ptr = (uint8_t *)ti_GetDataPtr(handle);
-    poly_randoms = (const uint64_t *)(data_ptr + CHDATA_RND_OFFSET);
+    poly_randoms = (const uint64_t *)CHDATA_RANDOMS(data_ptr);
     ti_Close(handle);
 
     /* Try each tier from largest to smallest.
@@ -405,8 +583,6 @@ uint8_t book_init(void)
 uint8_t book_probe(board_t *b, move_t *out)
 {
     uint64_t key;
-    uint8_t seg_idx;
-    uint32_t local_idx;
     book_entry_t entries[32];  /* max alternatives per position */
     uint8_t n_entries, i;
     uint32_t total_weight, pick, cumulative;
@@ -417,11 +593,8 @@ uint8_t book_probe(board_t *b, move_t *out)
 
     key = compute_polyglot_hash(b);
 
-    if (!find_key_segment(key, &seg_idx, &local_idx))
-        return 0;
-
     /* Collect all entries for this key */
-    n_entries = iterate_key_entries(key, seg_idx, local_idx, entries, 32);
+    n_entries = find_key_entries(key, entries, 32);
     if (n_entries == 0)
         return 0;
 
@@ -466,6 +639,26 @@ uint8_t book_probe(board_t *b, move_t *out)
     return 0;
 }
 
+#ifdef BENCH_BOOK
+
+uint64_t book_key(const board_t *b)
+{
+    return compute_polyglot_hash(b);
+}
+
+uint8_t book_lookup(uint64_t key)
+{
+    book_entry_t entries[32];
+    return book_ready ? find_key_entries(key, entries, 32) : 0;
+}
+
+uint8_t book_is_compact(void)
+{
+    return num_segments && segments[0].blocks;
+}
+
+#endif /* BENCH_BOOK */
+
 void book_get_info(uint8_t *ready, uint8_t *n_seg, uint32_t *n_entries)
 {
     *ready = book_ready;
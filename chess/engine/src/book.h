@@ -28,6 +28,16 @@ void book_get_info(uint8_t *ready, uint8_t *n_seg, uint32_t *n_entries);
    or "" if no book loaded. */
 const char *book_get_tier_name(void);
 
+#ifdef BENCH_BOOK
+/* chess/bench hooks (make BOOK_PROBE=1) for timing raw against compact
+   lookups: the Polyglot key of b, the number of book moves stored for
+   key (the lookup alone, no hashing or move validation), and whether
+   the loaded AppVars are in the compact format. */
+uint64_t book_key(const board_t *b);
+uint8_t book_lookup(uint64_t key);
+uint8_t book_is_compact(void);
+#endif
+
 #else
 
 /* No-op stubs when book is disabled */
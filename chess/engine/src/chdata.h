@@ -1,18 +1,69 @@
 #ifndef CHDATA_H
 #define CHDATA_H
 
+#include <stdint.h>
+#include <string.h>
+
 /*
- * CHDATA.8xv layout — shared chess data appvar
+ * CHDATA.8xv layout — shared chess data appvar (version 2)
+ *
+ * Offset 0:     magic "CHD\x02"
+ * Offset 4:     Polyglot random numbers (781 × 8-byte uint64, LE)
+ * Offset 6252:  sprite index: 6 × uint16 LE stream offsets from offset 0
+ * Offset 6264:  run-length coded piece sprites (6 pieces × 20 × 20)
+ *
+ * A sprite stream is a sequence of bytes value << 6 | (length - 1) that
+ * expands to exactly 400 pixels; runs never cross into the next sprite.
+ * The randoms don't compress, so they stay raw.
  *
- * Offset 0:     piece sprite data (6 pieces × 20 × 20 bytes)
- * Offset 2400:  Polyglot random numbers (781 × 8-byte uint64, LE)
+ * Version 1 files have no magic: raw sprites at offset 0 and the randoms
+ * at offset 2400 (8,648 bytes).  A raw sprite starts with a pixel value
+ * (0-2), never 'C', so both layouts are still read.
  */
 
-#define CHDATA_APPVAR     "CHDATA"
-#define CHDATA_SPR_OFFSET 0
-#define CHDATA_SPR_SIZE   2400   /* 6 × 20 × 20 */
-#define CHDATA_RND_OFFSET 2400
-#define CHDATA_RND_SIZE   6248   /* 781 × 8 */
-#define CHDATA_TOTAL_SIZE 8648
+#define CHDATA_APPVAR       "CHDATA"
+#define CHDATA_RND_OFFSET   4
+#define CHDATA_RND_SIZE     6248   /* 781 × 8 */
+#define CHDATA_SPR_INDEX    6252
+#define CHDATA_SPR_COUNT    6
+#define CHDATA_SPR_PIXELS   400    /* 20 × 20 */
+
+#define CHDATA_V1_SPR_OFFSET 0
+#define CHDATA_V1_RND_OFFSET 2400
+#define CHDATA_V1_SIZE       8648
+
+#define CHDATA_IS_PACKED(d) \
+    ((d)[0] == 'C' && (d)[1] == 'H' && (d)[2] == 'D' && (d)[3] == 2)
+
+/* Polyglot randoms of either layout */
+#define CHDATA_RANDOMS(d) \
+    ((d) + (CHDATA_IS_PACKED(d) ? CHDATA_RND_OFFSET : CHDATA_V1_RND_OFFSET))
+
+/* Pixels (0-2) of piece sprite type (0-5).  Version 1 sprites are
+   returned in place; packed ones are decoded into buf
+   (CHDATA_SPR_PIXELS bytes). */
+static inline const uint8_t *chdata_sprite(const uint8_t *d, uint8_t type,
+                                           uint8_t *buf)
+{
+    const uint8_t *src, *idx;
+    uint8_t *dst, *end;
+    uint8_t run;
+
+    if (!CHDATA_IS_PACKED(d))
+        return d + CHDATA_V1_SPR_OFFSET + type * CHDATA_SPR_PIXELS;
+
+    idx = d + CHDATA_SPR_INDEX + type * 2;
+    src = d + (idx[0] | (uint16_t)idx[1] << 8);
+    dst = buf;
+    end = buf + CHDATA_SPR_PIXELS;
+    while (dst < end) {
+        run = (*src & 0x3F) + 1;
+        if (run > end - dst)
+            run = (uint8_t)(end - dst);
+        memset(dst, *src++ >> 6, run);
+        dst += run;
+    }
+    return buf;
+}
 
 #endif /* CHDATA_H */
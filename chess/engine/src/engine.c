@@ -5,12 +5,30 @@
 #include "eval.h"
 #include "zobrist.h"
 #include "book.h"
+#include "tt.h"
+#include "timeman.h"
+#include "bitbase.h"
 
 /* ========== Internal State ========== */
 
 board_t engine_board;
 static engine_hooks_t engine_hooks;
 static uint8_t last_was_book;
+static uint8_t ponder_pending;  /* engine_ponder() ran since the last think */
+static uint8_t book_checked;    /* book_init() ran since engine_init() */
+
+/* Legal moves and status of engine_board, rebuilt whenever the API
+   changes the position so UI queries never generate moves.  Moves are
+   grouped by from-square (sq64): first[s] .. first[s + 1] - 1.
+   Sized like the generator's list: 218 is only the most for reachable
+   positions, and setups with extra promoted pieces can exceed it. */
+static struct {
+    move_t  moves[MAX_MOVES];
+    uint8_t first[65];
+    uint8_t count;
+    uint8_t status;
+    uint8_t in_check;
+} legal_cache;
 
 /* ========== Translation Helpers ========== */
 
@@ -45,6 +63,41 @@ static uint8_t is_legal_internal(board_t *b, move_t m)
     return legal;
 }
 
+/* Find the legal generated move with target's from/to (and promotion
+   piece), which carries the full flags.  Returns 0 if there is none. */
+static uint8_t find_legal_move(board_t *b, move_t target, move_t *out)
+{
+    move_t moves[MAX_MOVES];
+    uint8_t count, i;
+
+    count = generate_moves_from(b, target.from, moves);
+
+    for (i = 0; i < count; i++) {
+        if (moves[i].to != target.to) continue;
+        /* Match promotion type if applicable */
+        if ((moves[i].flags & FLAG_PROMOTION) &&
+            (moves[i].flags & FLAG_PROMO_MASK) !=
+            (target.flags & FLAG_PROMO_MASK))
+            continue;
+        if (is_legal_internal(b, moves[i])) {
+            *out = moves[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static engine_move_t no_engine_move(void)
+{
+    engine_move_t em;
+    em.from_row = ENGINE_SQ_NONE;
+    em.from_col = 0;
+    em.to_row = 0;
+    em.to_col = 0;
+    em.flags = 0;
+    return em;
+}
+
 /* ========== Game Status Detection ========== */
 
 /* Check for insufficient material (K vs K, KN vs K, KB vs K, KB vs KB same color) */
@@ -74,14 +127,11 @@ static uint8_t is_insufficient_material(const board_t *b)
     return 0;
 }
 
-static uint8_t compute_status(board_t *b)
+/* Status of b, given whether the side to move is in check and has a
+   legal move */
+static uint8_t compute_status(const board_t *b, uint8_t in_check,
+                              uint8_t has_legal)
 {
-    uint8_t in_check;
-    uint8_t has_legal;
-    move_t moves[MAX_MOVES];
-    uint8_t count, i;
-    undo_t undo;
-
     /* 50-move rule */
     if (b->halfmove >= 100)
         return ENGINE_STATUS_DRAW_50;
@@ -94,21 +144,6 @@ static uint8_t compute_status(board_t *b)
     if (is_insufficient_material(b))
         return ENGINE_STATUS_DRAW_MAT;
 
-    in_check = is_square_attacked(b, b->king_sq[b->side], b->side ^ 1);
-
-    /* Check for any legal move */
-    count = generate_moves(b, moves, GEN_ALL);
-    has_legal = 0;
-    for (i = 0; i < count; i++) {
-        board_make(b, moves[i], &undo);
-        if (board_is_legal(b)) {
-            has_legal = 1;
-            board_unmake(b, moves[i], &undo);
-            break;
-        }
-        board_unmake(b, moves[i], &undo);
-    }
-
     if (!has_legal) {
         if (in_check)
             return ENGINE_STATUS_CHECKMATE;
@@ -122,6 +157,69 @@ static uint8_t compute_status(board_t *b)
     return ENGINE_STATUS_NORMAL;
 }
 
+/* ========== Legal Move Cache ========== */
+
+/* Generate, legality-check and bucket engine_board's moves by
+   from-square (stable, so each square keeps generation order), then
+   derive the status from them.  Call after every position change. */
+static void legal_cache_build(void)
+{
+    move_t moves[MAX_MOVES];
+    uint8_t legal[MAX_MOVES];
+    uint8_t pos[64];
+    uint8_t count, i, s, total;
+    undo_t undo;
+
+    count = generate_moves(&engine_board, moves, GEN_ALL);
+    for (s = 0; s < 64; s++)
+        pos[s] = 0;
+    for (i = 0; i < count; i++) {
+        board_make(&engine_board, moves[i], &undo);
+        legal[i] = board_is_legal(&engine_board);
+        board_unmake(&engine_board, moves[i], &undo);
+        if (legal[i])
+            pos[SQ_TO_SQ64(moves[i].from)]++;
+    }
+
+    /* pos[] turns from per-square counts into insert positions */
+    total = 0;
+    for (s = 0; s < 64; s++) {
+        uint8_t n = pos[s];
+        legal_cache.first[s] = total;
+        pos[s] = total;
+        total += n;
+    }
+    legal_cache.first[64] = total;
+    legal_cache.count = total;
+
+    for (i = 0; i < count; i++)
+        if (legal[i])
+            legal_cache.moves[pos[SQ_TO_SQ64(moves[i].from)]++] = moves[i];
+
+    legal_cache.in_check = is_square_attacked(&engine_board,
+        engine_board.king_sq[engine_board.side], engine_board.side ^ 1);
+    legal_cache.status = compute_status(&engine_board, legal_cache.in_check,
+                                        total > 0);
+}
+
+/* The cached legal move with target's from/to and, for promotions, its
+   promotion piece.  Returns 0 if there is none. */
+static const move_t *legal_cache_find(move_t target)
+{
+    uint8_t s = SQ_TO_SQ64(target.from);
+    uint8_t i;
+
+    for (i = legal_cache.first[s]; i < legal_cache.first[s + 1]; i++) {
+        const move_t *m = &legal_cache.moves[i];
+        if (m->to != target.to) continue;
+        if ((m->flags & FLAG_PROMOTION) &&
+            (m->flags & FLAG_PROMO_MASK) != (target.flags & FLAG_PROMO_MASK))
+            continue;
+        return m;
+    }
+    return 0;
+}
+
 /* ========== Lifecycle ========== */
 
 void engine_init(const engine_hooks_t *hooks)
@@ -133,7 +231,9 @@ void engine_init(const engine_hooks_t *hooks)
 
     search_init();
     board_init(&engine_board);
-    book_init();
+    book_checked = 0;
+    bitbase_init();
+    legal_cache_build();
 }
 
 void engine_new_game(void)
@@ -141,6 +241,7 @@ void engine_new_game(void)
     search_init();
     board_startpos(&engine_board);
     search_history_push(engine_board.hash);
+    legal_cache_build();
 }
 
 /* ========== Position ========== */
@@ -155,6 +256,7 @@ void engine_set_position(const engine_position_t *pos)
                       pos->fullmove_number);
     search_history_clear();
     search_history_push(engine_board.hash);
+    legal_cache_build();
 }
 
 void engine_get_position(engine_position_t *out)
@@ -184,59 +286,39 @@ void engine_get_position(engine_position_t *out)
 uint8_t engine_get_moves_from(uint8_t row, uint8_t col,
                               engine_move_t *out, uint8_t max)
 {
-    uint8_t sq = RC_TO_SQ(row, col);
-    move_t moves[MAX_MOVES];
-    uint8_t count, result, i;
-    undo_t undo;
+    uint8_t s, i, result;
 
-    count = generate_moves_from(&engine_board, sq, moves);
+    if (row > 7 || col > 7) return 0;
+    s = (uint8_t)(row * 8 + col);
     result = 0;
-
-    for (i = 0; i < count && result < max; i++) {
-        board_make(&engine_board, moves[i], &undo);
-        if (board_is_legal(&engine_board)) {
-            out[result++] = internal_to_engine_move(moves[i]);
-        }
-        board_unmake(&engine_board, moves[i], &undo);
-    }
-
+    for (i = legal_cache.first[s]; i < legal_cache.first[s + 1] && result < max; i++)
+        out[result++] = internal_to_engine_move(legal_cache.moves[i]);
     return result;
 }
 
 uint8_t engine_get_all_moves(engine_move_t *out, uint8_t max)
 {
-    move_t moves[MAX_MOVES];
-    uint8_t count, result, i;
-    undo_t undo;
-
-    count = generate_moves(&engine_board, moves, GEN_ALL);
-    result = 0;
+    uint8_t i;
 
-    for (i = 0; i < count && result < max; i++) {
-        board_make(&engine_board, moves[i], &undo);
-        if (board_is_legal(&engine_board)) {
-            out[result++] = internal_to_engine_move(moves[i]);
-        }
-        board_unmake(&engine_board, moves[i], &undo);
-    }
-
-    return result;
+    for (i = 0; i < legal_cache.count && i < max; i++)
+        out[i] = internal_to_engine_move(legal_cache.moves[i]);
+    return i;
 }
 
 uint8_t engine_is_legal_move(engine_move_t em)
 {
     move_t target = engine_to_internal_move(em);
-    move_t moves[MAX_MOVES];
-    uint8_t count, i;
-
-    count = generate_moves_from(&engine_board, target.from, moves);
-
-    for (i = 0; i < count; i++) {
-        if (moves[i].to == target.to &&
-            (moves[i].flags & (FLAG_PROMOTION | FLAG_PROMO_MASK)) ==
-            (target.flags & (FLAG_PROMOTION | FLAG_PROMO_MASK))) {
-            return is_legal_internal(&engine_board, moves[i]);
-        }
+    uint8_t s = SQ_TO_SQ64(target.from);
+    uint8_t i;
+
+    if (em.from_row > 7 || em.from_col > 7 || em.to_row > 7 || em.to_col > 7)
+        return 0;
+    for (i = legal_cache.first[s]; i < legal_cache.first[s + 1]; i++) {
+        const move_t *m = &legal_cache.moves[i];
+        if (m->to == target.to &&
+            (m->flags & (FLAG_PROMOTION | FLAG_PROMO_MASK)) ==
+            (target.flags & (FLAG_PROMOTION | FLAG_PROMO_MASK)))
+            return 1;
     }
     return 0;
 }
@@ -274,41 +356,30 @@ void engine_get_move_effects(engine_move_t em, engine_move_effects_t *fx)
 
 uint8_t engine_make_move(engine_move_t em)
 {
-    move_t target = engine_to_internal_move(em);
-    move_t moves[MAX_MOVES];
-    uint8_t count, i;
+    const move_t *found;
+    move_t m;
     undo_t undo;
 
-    /* Find the matching generated move (to get correct flags) */
-    count = generate_moves_from(&engine_board, target.from, moves);
-
-    for (i = 0; i < count; i++) {
-        if (moves[i].to != target.to) continue;
-        /* Match promotion type if applicable */
-        if ((moves[i].flags & FLAG_PROMOTION) &&
-            (moves[i].flags & FLAG_PROMO_MASK) !=
-            (target.flags & FLAG_PROMO_MASK))
-            continue;
-
-        /* Verify legality */
-        board_make(&engine_board, moves[i], &undo);
-        if (!board_is_legal(&engine_board)) {
-            board_unmake(&engine_board, moves[i], &undo);
-            continue;
-        }
-
-        /* Move is legal and applied. Update history. */
-        if (PIECE_TYPE(undo.moved_piece) == PIECE_PAWN ||
-            (undo.flags & FLAG_CAPTURE)) {
-            search_history_set_irreversible();
-        }
-        search_history_push(engine_board.hash);
-
-        return compute_status(&engine_board);
+    /* Find the matching generated move (to get correct flags).
+       No legal move found — return normal (shouldn't happen with valid input) */
+    if (em.from_row > 7 || em.from_col > 7 || em.to_row > 7 || em.to_col > 7)
+        return ENGINE_STATUS_NORMAL;
+    found = legal_cache_find(engine_to_internal_move(em));
+    if (!found)
+        return ENGINE_STATUS_NORMAL;
+    m = *found;
+
+    board_make(&engine_board, m, &undo);
+
+    /* Move is legal and applied. Update history. */
+    if (PIECE_TYPE(undo.moved_piece) == PIECE_PAWN ||
+        (undo.flags & FLAG_CAPTURE)) {
+        search_history_set_irreversible();
     }
+    search_history_push(engine_board.hash);
 
-    /* No legal move found — return normal (shouldn't happen with valid input) */
-    return ENGINE_STATUS_NORMAL;
+    legal_cache_build();
+    return legal_cache.status;
 }
 
 /* ========== AI ========== */
@@ -344,43 +415,230 @@ void engine_set_move_variance(int cp)
     engine_move_variance = cp;
 }
 
-engine_move_t engine_think(uint8_t max_depth, uint32_t max_time_ms)
+uint32_t engine_set_hash_kb(uint32_t kb)
+{
+    if (kb > 0x3FFFFFUL) kb = 0x3FFFFFUL;  /* keep kb * 1024 within 32 bits */
+    return tt_resize(kb * 1024UL) / 1024UL;
+}
+
+#if defined(SEARCH_THREADS) && ENGINE_MAX_THREADS != SEARCH_MAX_THREADS
+#error "ENGINE_MAX_THREADS must match SEARCH_MAX_THREADS"
+#endif
+
+uint8_t engine_set_threads(uint8_t n)
+{
+    return search_set_threads(n);
+}
+
+/* ENGINE_EVAL_* is the public spelling of EVAL_F_* */
+typedef char engine_eval_bits_match[(ENGINE_EVAL_TEMPO == EVAL_F_TEMPO &&
+    ENGINE_EVAL_PAWNS == EVAL_F_PAWNS && ENGINE_EVAL_PASSED == EVAL_F_PASSED &&
+    ENGINE_EVAL_ROOK_FILES == EVAL_F_ROOK_FILES &&
+    ENGINE_EVAL_MOBILITY == EVAL_F_MOBILITY &&
+    ENGINE_EVAL_SHIELD == EVAL_F_SHIELD && ENGINE_EVAL_ALL == EVAL_F_ALL) ? 1 : -1];
+
+uint8_t engine_set_eval_features(uint8_t mask)
+{
+    return eval_set_features(mask);
+}
+
+uint8_t engine_set_bitbase(const void *data, uint32_t size)
+{
+    return bitbase_load((const uint8_t *)data, size);
+}
+
+void engine_set_think_poll(engine_poll_fn fn, uint16_t interval_ms)
+{
+    search_set_poll(fn, interval_ms);
+}
+
+typedef char engine_pv_fits[(ENGINE_MAX_PV == SEARCH_PV_MAX) ? 1 : -1];
+
+static engine_info_fn engine_info_cb;
+static engine_info_t engine_info;   /* static: keeps it off the CE stack */
+
+static void report_info(const search_info_t *si)
+{
+    uint8_t i;
+
+    engine_info.depth = si->depth;
+    engine_info.seldepth = si->seldepth;
+    engine_info.score = si->score;
+    engine_info.mate = 0;
+    if (si->score > SCORE_MATE - MAX_PLY)
+        engine_info.mate = (SCORE_MATE - si->score + 1) / 2;
+    else if (si->score < -SCORE_MATE + MAX_PLY)
+        engine_info.mate = -((SCORE_MATE + si->score) / 2);
+    engine_info.nodes = si->nodes;
+    engine_info.time_ms = si->time_ms;
+    engine_info.hashfull = si->hashfull;
+    engine_info.pv_len = si->pv_len;
+    for (i = 0; i < si->pv_len; i++)
+        engine_info.pv[i] = internal_to_engine_move(si->pv[i]);
+    engine_info_cb(&engine_info);
+}
+
+void engine_set_info(engine_info_fn fn)
+{
+    engine_info_cb = fn;
+    search_set_info(fn ? report_info : 0);
+}
+
+/* The book AppVars are looked up when the book is first needed rather
+   than in engine_init(), so starting a game doesn't wait on them */
+static void book_ensure(void)
+{
+    if (!book_checked) {
+        book_checked = 1;
+        book_init();
+    }
+}
+
+static uint8_t probe_book(board_t *b, move_t *out)
+{
+    (void)out;  /* unused when NO_BOOK stubs out book_probe() */
+    if (!engine_use_book
+        || (engine_book_max_ply && b->fullmove > engine_book_max_ply))
+        return 0;
+    book_ensure();
+    return book_probe(b, out);
+}
+
+static void think_limits(search_limits_t *limits, uint8_t max_depth,
+                         uint32_t max_time_ms)
+{
+    limits->max_depth = max_depth;
+    limits->max_time_ms = max_time_ms;
+    limits->soft_time_ms = 0;
+    limits->max_nodes = engine_max_nodes;
+    limits->time_fn = engine_hooks.time_ms;
+    limits->eval_noise = engine_eval_noise;
+    limits->move_variance = engine_move_variance;
+}
+
+static void clock_budget(const engine_clock_t *clock, tm_t *tm)
+{
+    if (clock)
+        tm_allocate(tm, clock->time_left, clock->increment,
+                    clock->moves_to_go, clock->move_time, clock->target_time);
+    else
+        tm_allocate(tm, 0, 0, 0, 0, 0);
+}
+
+static engine_move_t think(uint8_t max_depth, uint32_t soft_time_ms,
+                           uint32_t max_time_ms)
 {
     search_limits_t limits;
     search_result_t result;
-    engine_move_t em;
     move_t book_move;
+    uint8_t resume = ponder_pending;
+
+    ponder_pending = 0;
 
     /* Try the opening book first — instant response */
-    if (engine_use_book
-        && (!engine_book_max_ply || engine_board.fullmove <= engine_book_max_ply)
-        && book_probe(&engine_board, &book_move)) {
+    if (probe_book(&engine_board, &book_move)) {
         last_was_book = 1;
         return internal_to_engine_move(book_move);
     }
     last_was_book = 0;
 
-    limits.max_depth = max_depth;
-    limits.max_time_ms = max_time_ms;
-    limits.max_nodes = engine_max_nodes;
-    limits.time_fn = engine_hooks.time_ms;
-    limits.eval_noise = engine_eval_noise;
-    limits.move_variance = engine_move_variance;
+    think_limits(&limits, max_depth, max_time_ms);
+    limits.soft_time_ms = soft_time_ms;
+
+    /* A ponder search of this exact position carries on where it stopped */
+    if (resume)
+        search_continue_next();
 
     result = search_go(&engine_board, &limits);
 
-    if (result.best_move.from == SQ_NONE) {
-        em.from_row = ENGINE_SQ_NONE;
-        em.from_col = 0;
-        em.to_row = 0;
-        em.to_col = 0;
-        em.flags = 0;
-        return em;
-    }
+    if (result.best_move.from == SQ_NONE)
+        return no_engine_move();
 
     return internal_to_engine_move(result.best_move);
 }
 
+engine_move_t engine_think(uint8_t max_depth, uint32_t max_time_ms)
+{
+    return think(max_depth, 0, max_time_ms);
+}
+
+engine_move_t engine_think_clock(uint8_t max_depth, const engine_clock_t *clock)
+{
+    tm_t tm;
+    clock_budget(clock, &tm);
+    return think(max_depth, tm.soft_ms, tm.hard_ms);
+}
+
+/* ========== Pondering ========== */
+
+/* Scratch board: the position being pondered, so engine_board stays
+   free for the UI while the search runs */
+static board_t ponder_board;
+
+engine_move_t engine_get_ponder_move(const engine_move_t *after)
+{
+    move_t m;
+    move_t pv[2];
+    undo_t undo;
+    int score;
+    tt_move16_t packed;
+    int8_t depth;
+    uint8_t flag;
+
+    ponder_board = engine_board;
+    if (after) {
+        if (!find_legal_move(&ponder_board, engine_to_internal_move(*after), &m))
+            return no_engine_move();
+        board_make(&ponder_board, m, &undo);
+        /* The PV holds the reply even when its TT entry was replaced */
+        if (search_get_pv(&engine_board, pv, 2) == 2 && MOVE_EQ(pv[0], m) &&
+            find_legal_move(&ponder_board, pv[1], &m))
+            return internal_to_engine_move(m);
+    }
+
+    if (tt_probe(ponder_board.hash, ponder_board.lock,
+                 &score, &packed, &depth, &flag) &&
+        packed != TT_MOVE_NONE &&
+        find_legal_move(&ponder_board, tt_unpack_move(packed), &m))
+        return internal_to_engine_move(m);
+
+    return no_engine_move();
+}
+
+uint8_t engine_ponder(engine_move_t predicted, uint32_t max_time_ms)
+{
+    search_limits_t limits;
+    move_t m;
+    undo_t undo;
+
+    ponder_board = engine_board;
+    if (!find_legal_move(&ponder_board, engine_to_internal_move(predicted), &m))
+        return 0;
+    board_make(&ponder_board, m, &undo);
+
+    /* Our reply would come straight from the book */
+    if (probe_book(&ponder_board, &m))
+        return 0;
+
+    think_limits(&limits, 0, max_time_ms);
+
+    /* An interrupted ponder of the same move resumes, too */
+    search_history_push(ponder_board.hash);
+    search_continue_next();
+    search_go(&ponder_board, &limits);
+    search_history_pop();
+
+    ponder_pending = 1;
+    return 1;
+}
+
+void engine_ponderhit(const engine_clock_t *clock)
+{
+    tm_t tm;
+    clock_budget(clock, &tm);
+    search_set_time_limit(tm.soft_ms, tm.hard_ms);
+}
+
 engine_bench_result_t engine_bench(uint8_t max_depth, uint32_t max_time_ms)
 {
     search_limits_t limits;
@@ -389,6 +647,7 @@ engine_bench_result_t engine_bench(uint8_t max_depth, uint32_t max_time_ms)
 
     limits.max_depth = max_depth;
     limits.max_time_ms = max_time_ms;
+    limits.soft_time_ms = 0;
     limits.max_nodes = 0; /* no node limit for benchmarking */
     limits.time_fn = engine_hooks.time_ms;
     limits.eval_noise = 0;
@@ -404,20 +663,19 @@ engine_bench_result_t engine_bench(uint8_t max_depth, uint32_t max_time_ms)
 
 uint8_t engine_get_status(void)
 {
-    return compute_status(&engine_board);
+    return legal_cache.status;
 }
 
 uint8_t engine_in_check(void)
 {
-    return is_square_attacked(&engine_board,
-                              engine_board.king_sq[engine_board.side],
-                              engine_board.side ^ 1);
+    return legal_cache.in_check;
 }
 
 /* ========== Book Diagnostics ========== */
 
 void engine_get_book_info(engine_book_info_t *out)
 {
+    book_ensure();
     book_get_info(&out->ready, &out->num_segments, &out->total_entries);
 }
 
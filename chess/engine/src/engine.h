@@ -6,6 +6,7 @@
 /* ---- Types ---- */
 
 typedef uint32_t (*engine_time_ms_fn)(void);
+typedef uint8_t (*engine_poll_fn)(void);
 
 typedef struct {
     engine_time_ms_fn time_ms;   /* required for time-limited search */
@@ -99,8 +100,109 @@ void engine_set_use_book(uint8_t enabled);
 void engine_set_book_max_ply(uint8_t ply); /* 0 = unlimited */
 void engine_set_eval_noise(int noise);
 void engine_set_move_variance(int cp); /* pick randomly among moves within N cp of best */
+/* Resize the transposition table (0 = built-in size). Clears it.
+   Returns the size actually allocated, in KB. */
+uint32_t engine_set_hash_kb(uint32_t kb);
+/* Search threads (Lazy SMP, desktop builds only).  Returns the count
+   in effect, clamped to 1..ENGINE_MAX_THREADS. */
+#ifdef SEARCH_THREADS
+#define ENGINE_MAX_THREADS 64   /* = SEARCH_MAX_THREADS */
+#else
+#define ENGINE_MAX_THREADS 1
+#endif
+uint8_t engine_set_threads(uint8_t n);
+/* Eval terms in use, ENGINE_EVAL_* bits (for ablation runs; default
+   ENGINE_EVAL_ALL).  Returns the mask in effect: terms compiled out
+   stay off, and the calculator build always reports its fixed set. */
+#define ENGINE_EVAL_TEMPO       0x01
+#define ENGINE_EVAL_PAWNS       0x02
+#define ENGINE_EVAL_PASSED      0x04
+#define ENGINE_EVAL_ROOK_FILES  0x08
+#define ENGINE_EVAL_MOBILITY    0x10
+#define ENGINE_EVAL_SHIELD      0x20
+#define ENGINE_EVAL_ALL         0x3F
+uint8_t engine_set_eval_features(uint8_t mask);
+/* Endgame bitbases (tools/gen_bitbase_appvar.py payload, e.g. read
+   from a file) probed by the search; data must stay valid while in
+   use.  The calculator finds its CHEGTB AppVar in engine_init().
+   Returns the number of tables in use, 0 = none (probing off). */
+uint8_t engine_set_bitbase(const void *data, uint32_t size);
+/* Have engine_think() call fn about every interval_ms (NULL = off) so
+   the UI can keep drawing frames and reading keys while it thinks.
+   Return nonzero to stop and play the best move found so far.  The
+   callback must not call back into the engine, except for
+   engine_ponderhit(). */
+void engine_set_think_poll(engine_poll_fn fn, uint16_t interval_ms);
 engine_move_t engine_think(uint8_t max_depth, uint32_t max_time_ms);
 
+/* Search progress, reported after each completed iteration */
+#ifdef __ez80__
+#define ENGINE_MAX_PV 16        /* = SEARCH_PV_MAX */
+#else
+#define ENGINE_MAX_PV 64
+#endif
+
+typedef struct {
+    uint8_t  depth;
+    uint8_t  seldepth;      /* deepest ply reached */
+    int      score;         /* centipawns, side to move */
+    int      mate;          /* mate in N moves (negative: getting mated),
+                               0 = score is in centipawns */
+    uint32_t nodes;
+    uint32_t time_ms;
+    uint16_t hashfull;      /* permille of the hash table in use */
+    uint8_t  pv_len;
+    engine_move_t pv[ENGINE_MAX_PV];
+} engine_info_t;
+
+typedef void (*engine_info_fn)(const engine_info_t *info);
+
+/* Have engine_think() and engine_ponder() call fn after every search
+   iteration (NULL = off), e.g. to print UCI "info" lines.  The
+   callback must not call back into the engine. */
+void engine_set_info(engine_info_fn fn);
+
+/* Time control for one move, in ms (0 = not given).  The first of
+   move_time, time_left and target_time that is set decides:
+     move_time    think exactly this long at most (UCI movetime)
+     time_left    our clock, with increment and moves_to_go
+                  (0 = rest of the game); soft and hard budgets are
+                  derived from it
+     target_time  no clock: nominal think time.  The search may stop
+                  sooner once its best move has settled, and skips an
+                  iteration it can't finish in time. */
+typedef struct {
+    uint32_t move_time;
+    uint32_t time_left;
+    uint32_t increment;
+    uint16_t moves_to_go;
+    uint32_t target_time;
+} engine_clock_t;
+
+/* engine_think() with the time manager's budget for clock */
+engine_move_t engine_think_clock(uint8_t max_depth, const engine_clock_t *clock);
+
+/* ---- Pondering ---- */
+
+/* Expected reply: to *after if given, else by the side to move now.
+   Taken from the last search's PV when that began with *after, else
+   from the transposition table.  from_row = ENGINE_SQ_NONE if unknown. */
+engine_move_t engine_get_ponder_move(const engine_move_t *after);
+
+/* Think on the opponent's time: search the position after predicted
+   on a private board, within the node limit and max_time_ms.  Blocks
+   like engine_think(); have the think poll stop it once the opponent
+   moves.  If predicted is then played, the next engine_think()
+   continues from this search instead of starting at depth 1.
+   Returns 0 without searching if predicted is illegal or the reply
+   would be a book move. */
+uint8_t engine_ponder(engine_move_t predicted, uint32_t max_time_ms);
+
+/* From the think poll: the running search (a UCI "go ponder") goes
+   on as a normal think with the budget for clock, counted from now
+   (NULL = no time limit). */
+void engine_ponderhit(const engine_clock_t *clock);
+
 /* ---- Benchmark ---- */
 
 typedef struct {
@@ -31,6 +31,29 @@ const eval_profile_t *eval_profile_get(void) {
 
 #endif /* SEARCH_PROFILE */
 
+/* ========== Eval Trace ========== */
+
+#ifdef EVAL_TRACE
+
+static THREAD_LOCAL eval_trace_t _et;
+
+const eval_trace_t *eval_trace_get(void) {
+    return &_et;
+}
+
+#define TRACE(term, m, e) (_et.mg[term] += (m), _et.eg[term] += (e))
+
+/* Traced evals must run every term, so the score cache is compiled out
+   (the pawn cache is bypassed in evaluate_bounded) */
+#undef EVAL_CACHE_SIZE
+#define EVAL_CACHE_SIZE 0
+
+#else
+
+#define TRACE(term, m, e)
+
+#endif /* EVAL_TRACE */
+
 /* ========== Phase Weights ========== */
 
 /* Pawn=0, Knight=1, Bishop=1, Rook=2, Queen=4, King=0 */
@@ -222,6 +245,17 @@ static const int16_t knight_mob_eg[] = { -61, -43, -24, -2, 13, 26, 41, 45, 50 }
 static const int16_t bishop_mob_mg[] = { -12, -6, 2, 9, 11, 16, 18, 21, 25, 27, 29, 30, 32, 37 };
 static const int16_t bishop_mob_eg[] = { -17, -9, -1, 7, 12, 17, 23, 27, 32, 35, 37, 39, 41, 40 };
 
+#ifdef EVAL_TRACE
+/* The trace layout in eval.h must cover every table entry */
+#define TRACE_RUN(arr, first, next) \
+    typedef char arr##_fits_trace[(sizeof(arr) / sizeof(arr[0]) == (next) - (first)) ? 1 : -1]
+TRACE_RUN(connected_bonus, ET_CONNECTED, ET_PASSED);
+TRACE_RUN(passed_mg, ET_PASSED, ET_ROOK_OPEN);
+TRACE_RUN(knight_mob_mg, ET_KNIGHT_MOB, ET_BISHOP_MOB);
+TRACE_RUN(bishop_mob_mg, ET_BISHOP_MOB, ET_SHIELD);
+#undef TRACE_RUN
+#endif
+
 /* ========== Evaluation Helpers ========== */
 
 #ifndef PAWN_CACHE_SIZE
@@ -253,8 +287,79 @@ typedef struct {
     uint8_t pawn_atk[128];  /* bit0 white attacks, bit1 black attacks */
 } pawn_cache_entry_t;
 
-static pawn_cache_entry_t pawn_cache[PAWN_CACHE_SIZE];
-static uint8_t pawn_cache_victim[PAWN_CACHE_SETS];
+/* ASM_KERNELS CE builds scan a set with pawn_probe.asm, which hardcodes
+   the way count and the entry layout. */
+#if defined(__ez80__) && defined(ASM_KERNELS)
+#define PAWN_PROBE_ASM
+#if PAWN_CACHE_WAYS != 4
+#error "pawn_probe.asm scans 4 ways"
+#endif
+typedef char pawn_entry_fits_asm[(sizeof(pawn_cache_entry_t) == 151) ? 1 : -1];
+extern pawn_cache_entry_t *pawn_cache_probe(pawn_cache_entry_t *set_slots, zhash_t key);
+#endif
+
+static THREAD_LOCAL pawn_cache_entry_t pawn_cache[PAWN_CACHE_SIZE];
+static THREAD_LOCAL uint8_t pawn_cache_victim[PAWN_CACHE_SETS];
+
+/* Direct-mapped cache of final static scores, keyed on the full
+   position hash + lock.  Scores are side-to-move relative (the hash
+   includes the side).  EVAL_CACHE_SIZE 0 compiles it out. */
+#ifndef EVAL_CACHE_SIZE
+#define EVAL_CACHE_SIZE 256
+#endif
+
+#if EVAL_CACHE_SIZE > 0
+#if (EVAL_CACHE_SIZE & (EVAL_CACHE_SIZE - 1)) != 0
+#error "EVAL_CACHE_SIZE must be a power of two"
+#endif
+
+typedef struct {
+    zhash_t  key;           /* board hash */
+    uint16_t lock;          /* board lock */
+    int16_t  score;         /* full evaluate() result */
+} eval_cache_entry_t;
+
+static THREAD_LOCAL eval_cache_entry_t eval_cache[EVAL_CACHE_SIZE];
+#endif
+
+/* ========== Eval Features ========== */
+
+#ifdef __ez80__
+
+/* No run-time mask on the calculator: FEATURE() is a constant */
+#define FEATURE(f) (EVAL_F_BUILT & (f))
+
+uint8_t eval_set_features(uint8_t mask)
+{
+    (void)mask;
+    return EVAL_F_BUILT;
+}
+
+#else
+
+static uint8_t eval_features = EVAL_F_BUILT;
+
+/* Terms left out of the build still fold to 0 */
+#define FEATURE(f) (EVAL_F_BUILT & eval_features & (f))
+
+uint8_t eval_set_features(uint8_t mask)
+{
+    eval_features = (uint8_t)(mask & EVAL_F_BUILT);
+    /* Cached pawn terms and scores were computed under the old mask */
+    memset(pawn_cache, 0, sizeof(pawn_cache));
+    memset(pawn_cache_victim, 0, sizeof(pawn_cache_victim));
+#if EVAL_CACHE_SIZE > 0
+    memset(eval_cache, 0, sizeof(eval_cache));
+#endif
+    return eval_features;
+}
+
+#endif /* __ez80__ */
+
+uint8_t eval_get_features(void)
+{
+    return FEATURE(EVAL_F_ALL);
+}
 
 /* Build pawn-only derived data and scores once per pawn structure. */
 static void build_pawn_cache(const board_t *b, pawn_cache_entry_t *e)
@@ -306,44 +411,48 @@ static void build_pawn_cache(const board_t *b, pawn_cache_entry_t *e)
         rel_rank = 7 - row;
         ri = rel_rank - 2;
 
-#ifndef NO_PAWNS
-        if (e->w_pawns[col] & (uint8_t)~(1u << row)) {
-            mg -= DOUBLED_MG;
-            eg -= DOUBLED_EG;
-        }
-        {
-            uint8_t adj = 0;
-            if (col > 0) adj |= e->w_pawns[col - 1];
-            if (col < 7) adj |= e->w_pawns[col + 1];
-            if (!adj) {
-                mg -= ISOLATED_MG;
-                eg -= ISOLATED_EG;
+        if (FEATURE(EVAL_F_PAWNS)) {
+            if (e->w_pawns[col] & (uint8_t)~(1u << row)) {
+                mg -= DOUBLED_MG;
+                eg -= DOUBLED_EG;
+                TRACE(ET_DOUBLED, -DOUBLED_MG, -DOUBLED_EG);
             }
-        }
-        {
-            uint8_t supported = 0;
-            uint8_t s1 = sq + 17;
-            uint8_t s2 = sq + 15;
-            if (SQ_VALID(s1) && b->squares[s1] == white_pawn) supported = 1;
-            if (SQ_VALID(s2) && b->squares[s2] == white_pawn) supported = 1;
-            if (supported && rel_rank >= 2) {
-                mg += connected_bonus[ri];
-                eg += connected_bonus[ri];
+            {
+                uint8_t adj = 0;
+                if (col > 0) adj |= e->w_pawns[col - 1];
+                if (col < 7) adj |= e->w_pawns[col + 1];
+                if (!adj) {
+                    mg -= ISOLATED_MG;
+                    eg -= ISOLATED_EG;
+                    TRACE(ET_ISOLATED, -ISOLATED_MG, -ISOLATED_EG);
+                }
+            }
+            {
+                uint8_t supported = 0;
+                uint8_t s1 = sq + 17;
+                uint8_t s2 = sq + 15;
+                if (SQ_VALID(s1) && b->squares[s1] == white_pawn) supported = 1;
+                if (SQ_VALID(s2) && b->squares[s2] == white_pawn) supported = 1;
+                if (supported && rel_rank >= 2) {
+                    mg += connected_bonus[ri];
+                    eg += connected_bonus[ri];
+                    TRACE(ET_CONNECTED + ri, connected_bonus[ri], connected_bonus[ri]);
+                }
             }
         }
-#endif /* NO_PAWNS */
-
-#ifndef NO_PASSED
-        ahead = (uint8_t)((1u << row) - 1);
-        if (rel_rank >= 2) {
-            if (!(e->b_pawns[col] & ahead) &&
-                (col == 0 || !(e->b_pawns[col - 1] & ahead)) &&
-                (col == 7 || !(e->b_pawns[col + 1] & ahead))) {
-                mg += passed_mg[ri];
-                eg += passed_eg[ri];
+
+        if (FEATURE(EVAL_F_PASSED)) {
+            ahead = (uint8_t)((1u << row) - 1);
+            if (rel_rank >= 2) {
+                if (!(e->b_pawns[col] & ahead) &&
+                    (col == 0 || !(e->b_pawns[col - 1] & ahead)) &&
+                    (col == 7 || !(e->b_pawns[col + 1] & ahead))) {
+                    mg += passed_mg[ri];
+                    eg += passed_eg[ri];
+                    TRACE(ET_PASSED + ri, passed_mg[ri], passed_eg[ri]);
+                }
             }
         }
-#endif /* NO_PASSED */
     }
 
     /* Black pawn structure terms */
@@ -356,44 +465,48 @@ static void build_pawn_cache(const board_t *b, pawn_cache_entry_t *e)
         rel_rank = row;
         ri = rel_rank - 2;
 
-#ifndef NO_PAWNS
-        if (e->b_pawns[col] & (uint8_t)~(1u << row)) {
-            mg += DOUBLED_MG;
-            eg += DOUBLED_EG;
-        }
-        {
-            uint8_t adj = 0;
-            if (col > 0) adj |= e->b_pawns[col - 1];
-            if (col < 7) adj |= e->b_pawns[col + 1];
-            if (!adj) {
-                mg += ISOLATED_MG;
-                eg += ISOLATED_EG;
+        if (FEATURE(EVAL_F_PAWNS)) {
+            if (e->b_pawns[col] & (uint8_t)~(1u << row)) {
+                mg += DOUBLED_MG;
+                eg += DOUBLED_EG;
+                TRACE(ET_DOUBLED, DOUBLED_MG, DOUBLED_EG);
             }
-        }
-        {
-            uint8_t supported = 0;
-            uint8_t s1 = sq - 17;
-            uint8_t s2 = sq - 15;
-            if (SQ_VALID(s1) && b->squares[s1] == black_pawn) supported = 1;
-            if (SQ_VALID(s2) && b->squares[s2] == black_pawn) supported = 1;
-            if (supported && rel_rank >= 2) {
-                mg -= connected_bonus[ri];
-                eg -= connected_bonus[ri];
+            {
+                uint8_t adj = 0;
+                if (col > 0) adj |= e->b_pawns[col - 1];
+                if (col < 7) adj |= e->b_pawns[col + 1];
+                if (!adj) {
+                    mg += ISOLATED_MG;
+                    eg += ISOLATED_EG;
+                    TRACE(ET_ISOLATED, ISOLATED_MG, ISOLATED_EG);
+                }
+            }
+            {
+                uint8_t supported = 0;
+                uint8_t s1 = sq - 17;
+                uint8_t s2 = sq - 15;
+                if (SQ_VALID(s1) && b->squares[s1] == black_pawn) supported = 1;
+                if (SQ_VALID(s2) && b->squares[s2] == black_pawn) supported = 1;
+                if (supported && rel_rank >= 2) {
+                    mg -= connected_bonus[ri];
+                    eg -= connected_bonus[ri];
+                    TRACE(ET_CONNECTED + ri, -connected_bonus[ri], -connected_bonus[ri]);
+                }
             }
         }
-#endif /* NO_PAWNS */
-
-#ifndef NO_PASSED
-        ahead = (uint8_t)(~((1u << (row + 1)) - 1));
-        if (rel_rank >= 2) {
-            if (!(e->w_pawns[col] & ahead) &&
-                (col == 0 || !(e->w_pawns[col - 1] & ahead)) &&
-                (col == 7 || !(e->w_pawns[col + 1] & ahead))) {
-                mg -= passed_mg[ri];
-                eg -= passed_eg[ri];
+
+        if (FEATURE(EVAL_F_PASSED)) {
+            ahead = (uint8_t)(~((1u << (row + 1)) - 1));
+            if (rel_rank >= 2) {
+                if (!(e->w_pawns[col] & ahead) &&
+                    (col == 0 || !(e->w_pawns[col - 1] & ahead)) &&
+                    (col == 7 || !(e->w_pawns[col + 1] & ahead))) {
+                    mg -= passed_mg[ri];
+                    eg -= passed_eg[ri];
+                    TRACE(ET_PASSED + ri, -passed_mg[ri], -passed_eg[ri]);
+                }
             }
         }
-#endif /* NO_PASSED */
     }
 
     e->pawn_mg = mg;
@@ -403,7 +516,18 @@ static void build_pawn_cache(const board_t *b, pawn_cache_entry_t *e)
 
 /* ========== Main Evaluation ========== */
 
+/* Largest swing the pawn, rook-file, mobility and shield terms give on
+   top of material+PST.  Measured over bench searches, fewer than 1 in
+   100k evals move further than this. */
+#define LAZY_MARGIN 350
+#define LAZY_INF    32000
+
 int evaluate(const board_t *b)
+{
+    return evaluate_bounded(b, -LAZY_INF, LAZY_INF);
+}
+
+int evaluate_bounded(const board_t *b, int alpha, int beta)
 {
     const pawn_cache_entry_t *pc;
     const uint8_t *w_pawns;
@@ -413,31 +537,95 @@ int evaluate(const board_t *b)
     int mg, eg, phase;
     int score;
     uint8_t i, sq, col, type;
+#if EVAL_CACHE_SIZE > 0
+    eval_cache_entry_t *ec;
+#endif
     EP_VARS;
 
 #ifdef SEARCH_PROFILE
     _ep.eval_count++;
 #endif
 
+#if EVAL_CACHE_SIZE > 0
+    ec = &eval_cache[b->hash & (EVAL_CACHE_SIZE - 1)];
+    if (ec->key == b->hash && ec->lock == b->lock) {
+#ifdef SEARCH_PROFILE
+        _ep.cache_hits++;
+#endif
+        return ec->score;
+    }
+#endif
+
     /* Material + PST from white's perspective (maintained incrementally) */
     mg = b->mg[WHITE] - b->mg[BLACK];
     eg = b->eg[WHITE] - b->eg[BLACK];
 
+#ifdef EVAL_TRACE
+    /* Split the incremental material+PST score by piece type */
+    memset(&_et, 0, sizeof(_et));
+    {
+        uint8_t s;
+        for (s = 0; s < 2; s++) {
+            for (i = 0; i < b->piece_count[s]; i++) {
+                uint8_t idx, pst_sq;
+                sq = b->piece_list[s][i];
+                idx = EVAL_INDEX(PIECE_TYPE(b->squares[sq]));
+                pst_sq = (s == WHITE) ? SQ_TO_SQ64(sq) : PST_FLIP(SQ_TO_SQ64(sq));
+                if (s == WHITE)
+                    TRACE(ET_TABLE + idx, mg_table[idx][pst_sq], eg_table[idx][pst_sq]);
+                else
+                    TRACE(ET_TABLE + idx, -mg_table[idx][pst_sq], -eg_table[idx][pst_sq]);
+            }
+        }
+    }
+#endif
+
     /* Bishop pair bonus */
-    if (b->bishop_count[WHITE] >= 2) { mg += BISHOP_PAIR_MG; eg += BISHOP_PAIR_EG; }
-    if (b->bishop_count[BLACK] >= 2) { mg -= BISHOP_PAIR_MG; eg -= BISHOP_PAIR_EG; }
+    if (b->bishop_count[WHITE] >= 2) {
+        mg += BISHOP_PAIR_MG; eg += BISHOP_PAIR_EG;
+        TRACE(ET_BISHOP_PAIR, BISHOP_PAIR_MG, BISHOP_PAIR_EG);
+    }
+    if (b->bishop_count[BLACK] >= 2) {
+        mg -= BISHOP_PAIR_MG; eg -= BISHOP_PAIR_EG;
+        TRACE(ET_BISHOP_PAIR, -BISHOP_PAIR_MG, -BISHOP_PAIR_EG);
+    }
 
     /* ---- Tempo ---- */
-#ifndef NO_TEMPO
-    if (b->side == WHITE) { mg += TEMPO_MG; eg += TEMPO_EG; }
-    else                   { mg -= TEMPO_MG; eg -= TEMPO_EG; }
+    if (FEATURE(EVAL_F_TEMPO)) {
+        if (b->side == WHITE) { mg += TEMPO_MG; eg += TEMPO_EG; TRACE(ET_TEMPO, TEMPO_MG, TEMPO_EG); }
+        else                  { mg -= TEMPO_MG; eg -= TEMPO_EG; TRACE(ET_TEMPO, -TEMPO_MG, -TEMPO_EG); }
+    }
+
+    /* ---- Lazy exit: remaining terms can't bring the score into the window ---- */
+    if (alpha > -LAZY_INF || beta < LAZY_INF) {
+        phase = b->phase;
+        if (phase > PHASE_MAX) phase = PHASE_MAX;
+        score = (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
+        if (b->side != WHITE) score = -score;
+        if (score - LAZY_MARGIN >= beta || score + LAZY_MARGIN <= alpha) {
+#ifdef SEARCH_PROFILE
+            _ep.lazy_count++;
 #endif
+            return (score - LAZY_MARGIN >= beta) ? score - LAZY_MARGIN
+                                                 : score + LAZY_MARGIN;
+        }
+    }
 
     /* ---- Probe/build pawn cache ---- */
     EP_B();
     {
         uint8_t set = (uint8_t)(b->pawn_hash & PAWN_CACHE_SET_MASK);
         pawn_cache_entry_t *set_slots = &pawn_cache[(uint8_t)(set * PAWN_CACHE_WAYS)];
+#ifdef EVAL_TRACE
+        /* Pawn terms are traced while an entry is built */
+        slot = &set_slots[0];
+        build_pawn_cache(b, slot);
+        (void)pawn_cache_victim;
+#else
+#ifdef PAWN_PROBE_ASM
+        slot = pawn_cache_probe(set_slots, b->pawn_hash);
+        if (!slot) {
+#else
         if (set_slots[0].key == b->pawn_hash) {
             slot = &set_slots[0];
         } else if (set_slots[1].key == b->pawn_hash) {
@@ -447,11 +635,13 @@ int evaluate(const board_t *b)
         } else if (set_slots[3].key == b->pawn_hash) {
             slot = &set_slots[3];
         } else {
+#endif
             uint8_t victim = pawn_cache_victim[set];
             slot = &set_slots[victim];
             pawn_cache_victim[set] = (uint8_t)((victim + 1u) & (PAWN_CACHE_WAYS - 1u));
             build_pawn_cache(b, slot);
         }
+#endif
     }
     pc = slot;
     w_pawns = pc->w_pawns;
@@ -469,18 +659,18 @@ int evaluate(const board_t *b)
             sq = b->piece_list[WHITE][i];
             type = PIECE_TYPE(b->squares[sq]);
             col = SQ_TO_COL(sq);
-#ifndef NO_ROOK_FILES
-            if (type == PIECE_ROOK) {
+            if (FEATURE(EVAL_F_ROOK_FILES) && type == PIECE_ROOK) {
                 /* Open file: no pawns of either color */
                 if (!w_pawns[col] && !b_pawns[col]) {
                     mg += ROOK_OPEN_MG; eg += ROOK_OPEN_EG;
+                    TRACE(ET_ROOK_OPEN, ROOK_OPEN_MG, ROOK_OPEN_EG);
                 }
                 /* Semi-open: no friendly pawns but enemy pawns present */
                 else if (!w_pawns[col] && b_pawns[col]) {
                     mg += ROOK_SEMIOPEN_MG; eg += ROOK_SEMIOPEN_EG;
+                    TRACE(ET_ROOK_SEMIOPEN, ROOK_SEMIOPEN_MG, ROOK_SEMIOPEN_EG);
                 }
             }
-#endif /* NO_ROOK_FILES */
         }
 
         /* Iterate black pieces */
@@ -488,16 +678,16 @@ int evaluate(const board_t *b)
             sq = b->piece_list[BLACK][i];
             type = PIECE_TYPE(b->squares[sq]);
             col = SQ_TO_COL(sq);
-#ifndef NO_ROOK_FILES
-            if (type == PIECE_ROOK) {
+            if (FEATURE(EVAL_F_ROOK_FILES) && type == PIECE_ROOK) {
                 if (!b_pawns[col] && !w_pawns[col]) {
                     mg -= ROOK_OPEN_MG; eg -= ROOK_OPEN_EG;
+                    TRACE(ET_ROOK_OPEN, -ROOK_OPEN_MG, -ROOK_OPEN_EG);
                 }
                 else if (!b_pawns[col] && w_pawns[col]) {
                     mg -= ROOK_SEMIOPEN_MG; eg -= ROOK_SEMIOPEN_EG;
+                    TRACE(ET_ROOK_SEMIOPEN, -ROOK_SEMIOPEN_MG, -ROOK_SEMIOPEN_EG);
                 }
             }
-#endif /* NO_ROOK_FILES */
         }
     }
     EP_E(pieces_cy);
@@ -506,8 +696,7 @@ int evaluate(const board_t *b)
     /* Use pawn_atk bitmap: bit 0 = attacked by white, bit 1 = attacked by black.
        enemy_pawn_bit = 1 << enemy_side: BLACK(1)->2, WHITE(0)->1. */
     EP_B();
-#ifndef NO_MOBILITY
-    {
+    if (FEATURE(EVAL_F_MOBILITY)) {
         /* White pieces (enemy = BLACK, check bit 1 = value 2) */
         for (i = 0; i < b->piece_count[WHITE]; i++) {
             sq = b->piece_list[WHITE][i];
@@ -526,6 +715,7 @@ int evaluate(const board_t *b)
                 if (mob > 8) mob = 8;
                 mg += knight_mob_mg[mob];
                 eg += knight_mob_eg[mob];
+                TRACE(ET_KNIGHT_MOB + mob, knight_mob_mg[mob], knight_mob_eg[mob]);
             }
             else if (type == PIECE_BISHOP) {
                 uint8_t mob = 0, j;
@@ -544,6 +734,7 @@ int evaluate(const board_t *b)
                 if (mob > 13) mob = 13;
                 mg += bishop_mob_mg[mob];
                 eg += bishop_mob_eg[mob];
+                TRACE(ET_BISHOP_MOB + mob, bishop_mob_mg[mob], bishop_mob_eg[mob]);
             }
         }
 
@@ -565,6 +756,7 @@ int evaluate(const board_t *b)
                 if (mob > 8) mob = 8;
                 mg -= knight_mob_mg[mob];
                 eg -= knight_mob_eg[mob];
+                TRACE(ET_KNIGHT_MOB + mob, -knight_mob_mg[mob], -knight_mob_eg[mob]);
             }
             else if (type == PIECE_BISHOP) {
                 uint8_t mob = 0, j;
@@ -583,16 +775,15 @@ int evaluate(const board_t *b)
                 if (mob > 13) mob = 13;
                 mg -= bishop_mob_mg[mob];
                 eg -= bishop_mob_eg[mob];
+                TRACE(ET_BISHOP_MOB + mob, -bishop_mob_mg[mob], -bishop_mob_eg[mob]);
             }
         }
     }
-#endif /* NO_MOBILITY */
     EP_E(mobility_cy);
 
     /* ---- Pawn shield (simplified king safety) ---- */
     EP_B();
-#ifndef NO_SHIELD
-    {
+    if (FEATURE(EVAL_F_SHIELD)) {
         uint8_t ksq, krow, kcol;
         uint8_t shield;
 
@@ -613,6 +804,7 @@ int evaluate(const board_t *b)
         }
         mg += shield * SHIELD_MG;
         eg += shield * SHIELD_EG;
+        TRACE(ET_SHIELD, shield * SHIELD_MG, shield * SHIELD_EG);
 
         /* Black king */
         ksq = b->king_sq[BLACK];
@@ -630,8 +822,8 @@ int evaluate(const board_t *b)
         }
         mg -= shield * SHIELD_MG;
         eg -= shield * SHIELD_EG;
+        TRACE(ET_SHIELD, -shield * SHIELD_MG, -shield * SHIELD_EG);
     }
-#endif /* NO_SHIELD */
     EP_E(shield_cy);
 
     /* Tapered eval */
@@ -640,6 +832,23 @@ int evaluate(const board_t *b)
 
     score = (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
 
+#ifdef EVAL_TRACE
+    /* Whatever no term claimed stays fixed under tuning */
+    _et.mg_base = mg;
+    _et.eg_base = eg;
+    for (i = 0; i < ET_COUNT; i++) {
+        _et.mg_base -= _et.mg[i];
+        _et.eg_base -= _et.eg[i];
+    }
+    _et.phase = (uint8_t)phase;
+#endif
+
     /* Return from side-to-move perspective */
-    return (b->side == WHITE) ? score : -score;
+    if (b->side != WHITE) score = -score;
+#if EVAL_CACHE_SIZE > 0
+    ec->key = b->hash;
+    ec->lock = b->lock;
+    ec->score = (int16_t)score;
+#endif
+    return score;
 }
@@ -28,6 +28,104 @@ extern const uint8_t phase_weight[6];
    Returns score in centipawns. Positive = good for side to move. */
 int evaluate(const board_t *b);
 
+/* Same as evaluate(), but returns early when the incremental
+   material+PST score is more than the lazy margin outside
+   (alpha, beta).  The early result is the near edge of that margin,
+   so it is still a valid bound for the window test that asked. */
+int evaluate_bounded(const board_t *b, int alpha, int beta);
+
+/* ========== Eval Features ========== */
+
+/* Switchable eval terms, for ablation runs.  Material, PST and the
+   bishop pair are always on. */
+#define EVAL_F_TEMPO      0x01
+#define EVAL_F_PAWNS      0x02   /* doubled / isolated / connected */
+#define EVAL_F_PASSED     0x04
+#define EVAL_F_ROOK_FILES 0x08
+#define EVAL_F_MOBILITY   0x10
+#define EVAL_F_SHIELD     0x20
+#define EVAL_F_ALL        0x3F
+
+/* Terms compiled in.  A NO_<feature> build drops one for good. */
+#ifdef NO_TEMPO
+#define EVAL_F_NO_TEMPO_ EVAL_F_TEMPO
+#else
+#define EVAL_F_NO_TEMPO_ 0
+#endif
+#ifdef NO_PAWNS
+#define EVAL_F_NO_PAWNS_ EVAL_F_PAWNS
+#else
+#define EVAL_F_NO_PAWNS_ 0
+#endif
+#ifdef NO_PASSED
+#define EVAL_F_NO_PASSED_ EVAL_F_PASSED
+#else
+#define EVAL_F_NO_PASSED_ 0
+#endif
+#ifdef NO_ROOK_FILES
+#define EVAL_F_NO_ROOK_FILES_ EVAL_F_ROOK_FILES
+#else
+#define EVAL_F_NO_ROOK_FILES_ 0
+#endif
+#ifdef NO_MOBILITY
+#define EVAL_F_NO_MOBILITY_ EVAL_F_MOBILITY
+#else
+#define EVAL_F_NO_MOBILITY_ 0
+#endif
+#ifdef NO_SHIELD
+#define EVAL_F_NO_SHIELD_ EVAL_F_SHIELD
+#else
+#define EVAL_F_NO_SHIELD_ 0
+#endif
+#define EVAL_F_BUILT (EVAL_F_ALL & ~(EVAL_F_NO_TEMPO_ | EVAL_F_NO_PAWNS_ | \
+    EVAL_F_NO_PASSED_ | EVAL_F_NO_ROOK_FILES_ | EVAL_F_NO_MOBILITY_ | \
+    EVAL_F_NO_SHIELD_))
+
+/* Turn compiled-in terms on or off at run time and clear this thread's
+   eval and pawn caches.  Returns the mask in effect (mask & EVAL_F_BUILT).
+   The calculator build has no run-time mask: the terms are constants
+   there and this is a no-op returning EVAL_F_BUILT. */
+uint8_t eval_set_features(uint8_t mask);
+uint8_t eval_get_features(void);
+
+/* ========== Eval Trace ========== */
+
+#ifdef EVAL_TRACE
+
+/* Tunable eval terms.  Each records its white-minus-black contribution
+   at the current weights, so scaling a term's weight scales its entry.
+   Runs of terms are indexed by piece type, relative rank (2nd..7th) or
+   mobility count. */
+enum {
+    ET_TABLE         = 0,                          /* material+PST, 6 types */
+    ET_BISHOP_PAIR   = ET_TABLE + 6,
+    ET_TEMPO,
+    ET_DOUBLED,
+    ET_ISOLATED,
+    ET_CONNECTED,                                  /* 6 ranks */
+    ET_PASSED        = ET_CONNECTED + 6,           /* 6 ranks */
+    ET_ROOK_OPEN     = ET_PASSED + 6,
+    ET_ROOK_SEMIOPEN,
+    ET_KNIGHT_MOB,                                 /* 0..8 squares */
+    ET_BISHOP_MOB    = ET_KNIGHT_MOB + 9,          /* 0..13 squares */
+    ET_SHIELD        = ET_BISHOP_MOB + 14,
+    ET_COUNT
+};
+
+typedef struct {
+    int32_t mg[ET_COUNT];
+    int32_t eg[ET_COUNT];
+    int32_t mg_base;        /* untraced remainder of the mg total */
+    int32_t eg_base;        /* untraced remainder of the eg total */
+    uint8_t phase;          /* clamped game phase, 0..PHASE_MAX */
+} eval_trace_t;
+
+/* Terms of the last evaluate() on this thread.  Trace builds bypass
+   the eval and pawn caches so every call fills the whole trace. */
+const eval_trace_t *eval_trace_get(void);
+
+#endif /* EVAL_TRACE */
+
 /* ========== Eval Sub-Profiling ========== */
 
 #ifdef SEARCH_PROFILE
@@ -38,6 +136,8 @@ typedef struct {
     uint32_t mobility_cy;   /* knight + bishop mobility (both sides) */
     uint32_t shield_cy;     /* pawn shield */
     uint32_t eval_count;    /* number of evaluate() calls */
+    uint32_t cache_hits;    /* ...of which were answered by the eval cache */
+    uint32_t lazy_count;    /* ...of which evaluate_bounded() exited early */
 } eval_profile_t;
 
 void eval_profile_reset(void);
@@ -0,0 +1,337 @@
+	assume	adl=1
+	section	.text
+	public	_is_square_attacked_0x88
+	public	_gen_sliding_0x88
+
+; 0x88 move generation kernels for the CE build, selected by MOVEGEN_ASM
+; in movegen.h (make ASM_KERNELS=1 only).  The C versions in movegen.c are
+; the reference and are what desktop and default CE builds run.
+;
+; Both index b->squares[] (offset 0 of board_t, 256 bytes) with an 8-bit
+; square, so target wraps exactly like the C uint8_t arithmetic and every
+; off-board index reads the OFFBOARD sentinel (0FFh).
+;
+; Piece codes are XORed with a color byte (00h white, 80h black, from
+; side rrca) so one side's pieces read as plain types 1-6.  Pieces of the
+; other color then read 81h-86h, empty 00h/80h and OFFBOARD 7Fh/0FFh, so
+; no separate SQ_VALID test is needed.
+
+; uint8_t is_square_attacked_0x88(const board_t *b, uint8_t sq, uint8_t by_side)
+;
+;   Stack: [ret_addr(3)] [b(3)] [sq(3)] [by_side(3)]
+;   Return: A = 1 if a by_side piece attacks sq, else 0
+;
+; Registers:
+;   DE = b->squares
+;   C  = sq
+;   B  = attacker color (00h/80h)
+;   IYL/IYH = ray direction / current ray square
+
+_is_square_attacked_0x88:
+	push	ix
+	ld	ix, 0
+	add	ix, sp
+	ld	de, (ix + 6)		; DE = b->squares
+	ld	c, (ix + 9)		; C = sq
+	ld	a, (ix + 12)
+	rrca				; by_side 0/1 -> 00h/80h
+	ld	b, a			; B = attacker color
+	pop	ix
+	push	iy
+
+	; Knights: sq + {-33, -31, -18, -14, 14, 18, 31, 33}
+	ld	a, c
+	add	a, 0DFh
+	call	.piece
+	cp	a, 2			; PIECE_KNIGHT
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0E1h
+	call	.piece
+	cp	a, 2
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0EEh
+	call	.piece
+	cp	a, 2
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0F2h
+	call	.piece
+	cp	a, 2
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0Eh
+	call	.piece
+	cp	a, 2
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 12h
+	call	.piece
+	cp	a, 2
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 1Fh
+	call	.piece
+	cp	a, 2
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 21h
+	call	.piece
+	cp	a, 2
+	jr	z, .yes_near
+
+	; Pawns: white attackers stand below sq (+15, +17), black above
+	ld	a, b
+	or	a, a
+	jr	nz, .black_pawns
+	ld	a, c
+	add	a, 0Fh
+	call	.piece
+	dec	a			; PIECE_PAWN
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 11h
+	jr	.last_pawn
+.black_pawns:
+	ld	a, c
+	add	a, 0EFh
+	call	.piece
+	dec	a
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0F1h
+.last_pawn:
+	call	.piece
+	dec	a
+	jr	nz, .kings
+.yes_near:				; within jr range of the checks above and below
+	ld	a, 1
+	pop	iy
+	ret
+
+	; King: sq + {-17, -16, -15, -1, 1, 15, 16, 17}
+.kings:
+	ld	a, c
+	add	a, 0EFh
+	call	.piece
+	cp	a, 6			; PIECE_KING
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0F0h
+	call	.piece
+	cp	a, 6
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0F1h
+	call	.piece
+	cp	a, 6
+	jr	z, .yes_near
+	ld	a, c
+	dec	a
+	call	.piece
+	cp	a, 6
+	jr	z, .yes_near
+	ld	a, c
+	inc	a
+	call	.piece
+	cp	a, 6
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 0Fh
+	call	.piece
+	cp	a, 6
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 10h
+	call	.piece
+	cp	a, 6
+	jr	z, .yes_near
+	ld	a, c
+	add	a, 11h
+	call	.piece
+	cp	a, 6
+	jr	z, .yes_near
+
+	; Diagonals: bishop or queen
+	ld	a, 0EFh
+	call	.ray
+	cp	a, 3			; PIECE_BISHOP
+	jr	z, .yes
+	cp	a, 5			; PIECE_QUEEN
+	jr	z, .yes
+	ld	a, 0F1h
+	call	.ray
+	cp	a, 3
+	jr	z, .yes
+	cp	a, 5
+	jr	z, .yes
+	ld	a, 0Fh
+	call	.ray
+	cp	a, 3
+	jr	z, .yes
+	cp	a, 5
+	jr	z, .yes
+	ld	a, 11h
+	call	.ray
+	cp	a, 3
+	jr	z, .yes
+	cp	a, 5
+	jr	z, .yes
+
+	; Orthogonals: rook or queen
+	ld	a, 0F0h
+	call	.ray
+	cp	a, 4			; PIECE_ROOK
+	jr	z, .yes
+	cp	a, 5
+	jr	z, .yes
+	ld	a, 0FFh
+	call	.ray
+	cp	a, 4
+	jr	z, .yes
+	cp	a, 5
+	jr	z, .yes
+	ld	a, 1
+	call	.ray
+	cp	a, 4
+	jr	z, .yes
+	cp	a, 5
+	jr	z, .yes
+	ld	a, 10h
+	call	.ray
+	cp	a, 4
+	jr	z, .yes
+	cp	a, 5
+	jr	z, .yes
+
+	xor	a, a
+	pop	iy
+	ret
+.yes:
+	ld	a, 1
+	pop	iy
+	ret
+
+; A = square -> A = squares[A] ^ B (clobbers HL)
+.piece:
+	or	a, a
+	sbc	hl, hl
+	ld	l, a
+	add	hl, de
+	ld	a, (hl)
+	xor	a, b
+	ret
+
+; A = direction -> A = first non-empty square along it from C, ^ B
+; (clobbers HL, IY)
+.ray:
+	ld	iyl, a
+	ld	a, c
+.ray_step:
+	add	a, iyl
+	ld	iyh, a
+	or	a, a
+	sbc	hl, hl
+	ld	l, a
+	add	hl, de
+	ld	a, (hl)
+	or	a, a
+	jr	nz, .ray_hit
+	ld	a, iyh
+	jr	.ray_step
+.ray_hit:
+	xor	a, b
+	ret
+
+
+; uint8_t gen_sliding_0x88(const board_t *b, uint8_t sq, uint8_t side,
+;                          const int8_t *offsets, uint8_t num_dirs,
+;                          move_t *list, uint8_t mode)
+;
+;   Stack: [ret_addr(3)] [b(3)] [sq(3)] [side(3)] [offsets(3)]
+;          [num_dirs(3)] [list(3)] [mode(3)]
+;   Return: A = number of moves written to list
+;
+; Same output order as the C gen_sliding_moves(): per direction, the
+; quiet moves outward, then the capture.  mode is GEN_ALL (0),
+; GEN_CAPTURES (1) or GEN_QUIETS (2), so bit 0 set means no quiets and
+; bit 1 set means no captures.  The side, offsets and num_dirs slots
+; are reused as the own color, offsets cursor and directions left.
+;
+; Registers:
+;   DE = b->squares
+;   IY = list cursor (3 bytes per move_t)
+;   C  = direction
+;   B  = current target square
+;   (ix - 6) = count
+
+_gen_sliding_0x88:
+	push	ix
+	ld	ix, 0
+	add	ix, sp
+	push	iy
+	or	a, a
+	sbc	hl, hl
+	push	hl			; (ix - 6) = count = 0
+	ld	iy, (ix + 21)		; IY = list
+	ld	de, (ix + 6)		; DE = b->squares
+	ld	a, (ix + 12)
+	rrca				; side 0/1 -> own color 00h/80h
+	ld	(ix + 12), a
+	ld	a, (ix + 18)
+	or	a, a
+	jr	z, .done
+
+.dir:
+	ld	hl, (ix + 15)
+	ld	c, (hl)			; C = *offsets++
+	inc	hl
+	ld	(ix + 15), hl
+	ld	b, (ix + 9)		; B = sq
+
+.walk:
+	ld	a, b
+	add	a, c
+	ld	b, a			; target += dir
+	or	a, a
+	sbc	hl, hl
+	ld	l, a
+	add	hl, de
+	ld	a, (hl)
+	or	a, a
+	jr	nz, .stop		; piece or OFFBOARD
+	bit	0, (ix + 24)
+	jr	nz, .walk		; GEN_CAPTURES: walk without emitting
+	ld	a, (ix + 9)
+	ld	(iy + 0), a		; from
+	ld	(iy + 1), b		; to
+	ld	(iy + 2), 0		; flags
+	lea	iy, iy + 3
+	inc	(ix - 6)
+	jr	.walk
+
+.stop:
+	xor	a, (ix + 12)
+	sub	a, 81h
+	cp	a, 6
+	jr	nc, .next		; own piece or OFFBOARD
+	bit	1, (ix + 24)
+	jr	nz, .next		; GEN_QUIETS
+	ld	a, (ix + 9)
+	ld	(iy + 0), a
+	ld	(iy + 1), b
+	ld	(iy + 2), 1		; FLAG_CAPTURE
+	lea	iy, iy + 3
+	inc	(ix - 6)
+
+.next:
+	dec	(ix + 18)
+	jr	nz, .dir
+
+.done:
+	ld	a, (ix - 6)
+	pop	hl
+	pop	iy
+	pop	ix
+	ret
@@ -1,5 +1,8 @@
 #include "movegen.h"
 #include "directions.h"
+#ifdef BITBOARDS
+#include "bitboard.h"
+#endif
 
 /* ========== Helpers ========== */
 
@@ -85,6 +88,36 @@ static uint8_t gen_pawn_moves(const board_t *b, uint8_t sq, uint8_t side,
     return count;
 }
 
+/* ========== Bitboard Targets ========== */
+
+#ifdef BITBOARDS
+/* Emit sq -> each square of targets: captures onto enemy pieces,
+   quiets onto empty squares (own pieces are masked off). */
+static uint8_t gen_bb_moves(const board_t *b, uint8_t sq, uint8_t side,
+                            bb_t targets, move_t *list, uint8_t mode)
+{
+    uint8_t count = 0;
+    bb_t t;
+
+    targets &= ~b->bb_side[side];
+    if (mode != GEN_QUIETS) {
+        t = targets & b->bb_side[side ^ 1];
+        while (t) {
+            uint8_t s64 = bb_pop_lsb(&t);
+            list[count++] = make_move(sq, SQ64_TO_SQ(s64), FLAG_CAPTURE);
+        }
+    }
+    if (mode != GEN_CAPTURES) {
+        t = targets & ~b->bb_side[side ^ 1];
+        while (t) {
+            uint8_t s64 = bb_pop_lsb(&t);
+            list[count++] = make_move(sq, SQ64_TO_SQ(s64), 0);
+        }
+    }
+    return count;
+}
+#else
+
 /* ========== Knight Moves ========== */
 
 static uint8_t gen_knight_moves(const board_t *b, uint8_t sq, uint8_t side,
@@ -112,6 +145,12 @@ static uint8_t gen_knight_moves(const board_t *b, uint8_t sq, uint8_t side,
 
 /* ========== Sliding Moves (Bishop, Rook, Queen) ========== */
 
+#ifdef MOVEGEN_ASM
+extern uint8_t gen_sliding_0x88(const board_t *b, uint8_t sq, uint8_t side,
+                                const int8_t *offsets, uint8_t num_dirs,
+                                move_t *list, uint8_t mode);
+#define gen_sliding_moves gen_sliding_0x88
+#else
 static uint8_t gen_sliding_moves(const board_t *b, uint8_t sq, uint8_t side,
                                  const int8_t *offsets, uint8_t num_dirs,
                                  move_t *list, uint8_t mode)
@@ -138,6 +177,8 @@ static uint8_t gen_sliding_moves(const board_t *b, uint8_t sq, uint8_t side,
     }
     return count;
 }
+#endif /* MOVEGEN_ASM */
+#endif /* BITBOARDS */
 
 /* ========== King Moves ========== */
 
@@ -145,6 +186,9 @@ static uint8_t gen_king_moves(const board_t *b, uint8_t sq, uint8_t side,
                               move_t *list, uint8_t mode)
 {
     uint8_t count = 0;
+#ifdef BITBOARDS
+    count = gen_bb_moves(b, sq, side, bb_king[SQ_TO_SQ64(sq)], list, mode);
+#else
     int i;
 
     /* Normal king moves */
@@ -162,6 +206,7 @@ static uint8_t gen_king_moves(const board_t *b, uint8_t sq, uint8_t side,
                 list[count++] = make_move(sq, target, FLAG_CAPTURE);
         }
     }
+#endif
 
     /* Castling (quiet moves only, king must be on starting square) */
     if (mode != GEN_CAPTURES) {
@@ -228,6 +273,28 @@ static uint8_t gen_piece_moves(const board_t *b, uint8_t sq, uint8_t side,
 {
     uint8_t piece = b->squares[sq];
     uint8_t type = PIECE_TYPE(piece);
+#ifdef BITBOARDS
+    uint8_t s64 = SQ_TO_SQ64(sq);
+    bb_t occ = b->bb_side[WHITE] | b->bb_side[BLACK];
+
+    switch (type) {
+        case PIECE_PAWN:
+            return gen_pawn_moves(b, sq, side, list, mode);
+        case PIECE_KNIGHT:
+            return gen_bb_moves(b, sq, side, bb_knight[s64], list, mode);
+        case PIECE_BISHOP:
+            return gen_bb_moves(b, sq, side, bb_bishop_attacks(s64, occ), list, mode);
+        case PIECE_ROOK:
+            return gen_bb_moves(b, sq, side, bb_rook_attacks(s64, occ), list, mode);
+        case PIECE_QUEEN:
+            return gen_bb_moves(b, sq, side, bb_bishop_attacks(s64, occ) |
+                                bb_rook_attacks(s64, occ), list, mode);
+        case PIECE_KING:
+            return gen_king_moves(b, sq, side, list, mode);
+        default:
+            return 0;
+    }
+#else
 
     switch (type) {
         case PIECE_PAWN:
@@ -250,6 +317,7 @@ static uint8_t gen_piece_moves(const board_t *b, uint8_t sq, uint8_t side,
         default:
             return 0;
     }
+#endif /* BITBOARDS */
 }
 
 /* ========== Public: Generate All Moves ========== */
@@ -285,8 +353,26 @@ uint8_t generate_moves_from(const board_t *b, uint8_t from_sq, move_t *list)
 
 /* ========== Public: Is Square Attacked ========== */
 
+/* MOVEGEN_ASM builds link is_square_attacked_0x88 from movegen.asm */
+#ifndef MOVEGEN_ASM
 uint8_t is_square_attacked(const board_t *b, uint8_t sq, uint8_t by_side)
 {
+#ifdef ATTACK_MAPS
+    return b->attacks[by_side][sq] != 0;
+#elif defined(BITBOARDS)
+    uint8_t s64 = SQ_TO_SQ64(sq);
+    bb_t them = b->bb_side[by_side];
+    bb_t occ = b->bb_side[WHITE] | b->bb_side[BLACK];
+    bb_t diag = them & (b->bb_type[PIECE_BISHOP] | b->bb_type[PIECE_QUEEN]);
+    bb_t orth = them & (b->bb_type[PIECE_ROOK] | b->bb_type[PIECE_QUEEN]);
+
+    /* A pawn of by_side attacks sq iff an opposing pawn on sq would hit it */
+    if (bb_pawn_atk[by_side ^ 1][s64] & them & b->bb_type[PIECE_PAWN]) return 1;
+    if (bb_knight[s64] & them & b->bb_type[PIECE_KNIGHT]) return 1;
+    if (bb_king[s64] & them & b->bb_type[PIECE_KING]) return 1;
+    if (diag && (bb_bishop_attacks(s64, occ) & diag)) return 1;
+    return orth && (bb_rook_attacks(s64, occ) & orth);
+#else
     uint8_t attacker_color = (by_side == WHITE) ? COLOR_WHITE : COLOR_BLACK;
     int i;
     uint8_t target;
@@ -357,4 +443,232 @@ uint8_t is_square_attacked(const board_t *b, uint8_t sq, uint8_t by_side)
     }
 
     return 0;
+#endif
+}
+#endif /* !MOVEGEN_ASM */
+
+/* ========== Public: Legal Move Count ========== */
+
+/* 1 if the piece on sq is pinned to the king of side: it shares a line
+   with the king, nothing stands between them, and the first piece
+   beyond it is an enemy slider that moves along that line. */
+static uint8_t is_pinned(const board_t *b, uint8_t sq, uint8_t side)
+{
+    uint8_t ksq = b->king_sq[side];
+    int8_t dr = (int8_t)(SQ_TO_ROW(sq) - SQ_TO_ROW(ksq));
+    int8_t dc = (int8_t)(SQ_TO_COL(sq) - SQ_TO_COL(ksq));
+    int8_t step;
+    uint8_t s, piece, type;
+
+    if (dr != 0 && dc != 0 && dr != dc && dr != -dc)
+        return 0;
+    step = (int8_t)(((dr > 0) - (dr < 0)) * 16 + ((dc > 0) - (dc < 0)));
+
+    for (s = ksq + step; s != sq; s += step)
+        if (b->squares[s] != PIECE_NONE)
+            return 0;
+
+    for (s = sq + step; SQ_VALID(s); s += step) {
+        piece = b->squares[s];
+        if (piece == PIECE_NONE)
+            continue;
+        if ((IS_BLACK(piece) ? BLACK : WHITE) == side)
+            return 0;
+        type = PIECE_TYPE(piece);
+        if (type == PIECE_QUEEN)
+            return 1;
+        return (dr && dc) ? type == PIECE_BISHOP : type == PIECE_ROOK;
+    }
+    return 0;
+}
+
+uint8_t count_legal_moves(board_t *b)
+{
+    move_t moves[MAX_MOVES];
+    undo_t undo;
+    uint8_t side = b->side;
+    uint8_t ksq = b->king_sq[side];
+    uint8_t n = generate_moves(b, moves, GEN_ALL);
+    uint8_t in_check = is_square_attacked(b, ksq, side ^ 1);
+    uint8_t i, count = 0;
+
+    for (i = 0; i < n; i++) {
+        if (!in_check && moves[i].from != ksq &&
+            !(moves[i].flags & FLAG_EN_PASSANT) &&
+            !is_pinned(b, moves[i].from, side)) {
+            count++;
+            continue;
+        }
+        board_make(b, moves[i], &undo);
+        count += board_is_legal(b);
+        board_unmake(b, moves[i], &undo);
+    }
+    return count;
+}
+
+/* ========== Static Exchange Evaluation ========== */
+
+/* Exchange values by piece type (index 0 unused).  King is large so a
+   king "recapture" into a defended square always unwinds as a loss. */
+const int16_t see_value[7] = { 0, 100, 325, 325, 500, 900, 20000 };
+
+/* Find the least valuable piece of `color` attacking sq.
+   Same ray walk as is_square_attacked(), but ordered by piece value.
+   Returns its square (SQ_NONE if none) and writes its type. */
+static uint8_t see_least_attacker(const board_t *b, uint8_t sq,
+                                  uint8_t color, uint8_t *type_out)
+{
+    uint8_t best_sq = SQ_NONE;
+    uint8_t best_type = PIECE_KING + 1;
+    uint8_t target, p, t;
+    int i;
+
+    /* Pawns */
+    {
+        int8_t pawn_dir = (color == COLOR_WHITE) ? 16 : -16;
+        uint8_t pawn = MAKE_PIECE(color, PIECE_PAWN);
+
+        target = sq + pawn_dir - 1;
+        if (SQ_VALID(target) && b->squares[target] == pawn) {
+            *type_out = PIECE_PAWN;
+            return target;
+        }
+        target = sq + pawn_dir + 1;
+        if (SQ_VALID(target) && b->squares[target] == pawn) {
+            *type_out = PIECE_PAWN;
+            return target;
+        }
+    }
+
+    /* Knights */
+    for (i = 0; i < 8; i++) {
+        target = sq + knight_offsets[i];
+        if (SQ_VALID(target) &&
+            b->squares[target] == MAKE_PIECE(color, PIECE_KNIGHT)) {
+            *type_out = PIECE_KNIGHT;
+            return target;
+        }
+    }
+
+    /* Diagonal sliders: a bishop is the cheapest left, so return it */
+    for (i = 0; i < 4; i++) {
+        int8_t dir = bishop_offsets[i];
+        target = sq + dir;
+        while (b->squares[target] == PIECE_NONE) target += dir;
+        if (!SQ_VALID(target)) continue;
+        p = b->squares[target];
+        if (PIECE_COLOR(p) != color) continue;
+        t = PIECE_TYPE(p);
+        if (t == PIECE_BISHOP) {
+            *type_out = PIECE_BISHOP;
+            return target;
+        }
+        if (t == PIECE_QUEEN && best_type > PIECE_QUEEN) {
+            best_sq = target;
+            best_type = PIECE_QUEEN;
+        }
+    }
+
+    /* Straight sliders: rook beats any queen found so far */
+    for (i = 0; i < 4; i++) {
+        int8_t dir = rook_offsets[i];
+        target = sq + dir;
+        while (b->squares[target] == PIECE_NONE) target += dir;
+        if (!SQ_VALID(target)) continue;
+        p = b->squares[target];
+        if (PIECE_COLOR(p) != color) continue;
+        t = PIECE_TYPE(p);
+        if (t == PIECE_ROOK) {
+            *type_out = PIECE_ROOK;
+            return target;
+        }
+        if (t == PIECE_QUEEN && best_type > PIECE_QUEEN) {
+            best_sq = target;
+            best_type = PIECE_QUEEN;
+        }
+    }
+
+    if (best_sq != SQ_NONE) {
+        *type_out = best_type;
+        return best_sq;
+    }
+
+    /* King */
+    for (i = 0; i < 8; i++) {
+        target = sq + king_offsets[i];
+        if (SQ_VALID(target) &&
+            b->squares[target] == MAKE_PIECE(color, PIECE_KING)) {
+            *type_out = PIECE_KING;
+            return target;
+        }
+    }
+
+    return SQ_NONE;
+}
+
+int see(board_t *b, move_t m)
+{
+    int16_t gain[32];
+    uint8_t removed_sq[34];
+    uint8_t removed_pc[34];
+    uint8_t n_removed = 0;
+    uint8_t sq = m.to;
+    uint8_t mover = b->squares[m.from];
+    uint8_t color = PIECE_COLOR(mover) ^ COLOR_MASK;
+    int16_t on_square;   /* value of the piece currently standing on sq */
+    uint8_t d = 0;
+    uint8_t asq, type;
+
+    if (m.flags & FLAG_EN_PASSANT) {
+        /* Captured pawn sits beside the mover; lift it so rays through
+           it are seen */
+        uint8_t cap_sq = (m.from & 0x70) | (m.to & 0x07);
+        gain[0] = see_value[PIECE_PAWN];
+        removed_sq[n_removed] = cap_sq;
+        removed_pc[n_removed++] = b->squares[cap_sq];
+        b->squares[cap_sq] = PIECE_NONE;
+    } else {
+        gain[0] = see_value[PIECE_TYPE(b->squares[sq])];
+    }
+
+    on_square = see_value[PIECE_TYPE(mover)];
+    if (m.flags & FLAG_PROMOTION) {
+        /* Only queen promotions are valued; underpromotions are rare */
+        gain[0] += see_value[PIECE_QUEEN] - see_value[PIECE_PAWN];
+        on_square = see_value[PIECE_QUEEN];
+    }
+
+    removed_sq[n_removed] = m.from;
+    removed_pc[n_removed++] = mover;
+    b->squares[m.from] = PIECE_NONE;
+
+    while (d < 31) {
+        asq = see_least_attacker(b, sq, color, &type);
+        if (asq == SQ_NONE) break;
+        d++;
+        /* Side to move captures the piece on sq */
+        gain[d] = on_square - gain[d - 1];
+        /* Neither side can gain by continuing */
+        if (-gain[d - 1] < 0 && gain[d] < 0) break;
+        on_square = see_value[type];
+        removed_sq[n_removed] = asq;
+        removed_pc[n_removed++] = b->squares[asq];
+        b->squares[asq] = PIECE_NONE;
+        color ^= COLOR_MASK;
+    }
+
+    /* Each side may decline to recapture */
+    while (d) {
+        int16_t best = (-gain[d - 1] > gain[d]) ? -gain[d - 1] : gain[d];
+        gain[d - 1] = -best;
+        d--;
+    }
+
+    /* Restore lifted pieces */
+    while (n_removed) {
+        n_removed--;
+        b->squares[removed_sq[n_removed]] = removed_pc[n_removed];
+    }
+
+    return gain[0];
 }
@@ -17,10 +17,35 @@ uint8_t generate_moves(const board_t *b, move_t *list, uint8_t mode);
    Returns the number of moves written to list[]. */
 uint8_t generate_moves_from(const board_t *b, uint8_t from_sq, move_t *list);
 
+/* Opt-in (make ASM_KERNELS=1): hand-written eZ80 versions of the 0x88
+   attack test and slider generation (movegen.asm).  The C code stays the
+   default until a chess/bench perft and cy/node run of the kernels is
+   recorded in chess/bench/RESULTS.md. */
+#if defined(__ez80__) && defined(ASM_KERNELS) && \
+    !defined(ATTACK_MAPS) && !defined(BITBOARDS)
+#define MOVEGEN_ASM
+#define is_square_attacked is_square_attacked_0x88
+#endif
+
 /* Check if sq is attacked by the given side.
    Does not require move generation — pure board query. */
 uint8_t is_square_attacked(const board_t *b, uint8_t sq, uint8_t by_side);
 
+/* Number of legal moves for the side to move.  Moves that cannot
+   expose the king (king not in check, not a king move or en passant,
+   piece not pinned) are counted without make/unmake; the rest are
+   checked by making them, so b is modified and restored. */
+uint8_t count_legal_moves(board_t *b);
+
+/* Static exchange evaluation of a capture on m.to: net material (in
+   centipawns) the side to move expects after the best sequence of
+   recaptures, least valuable attacker first.  Pieces are lifted from
+   b->squares while x-rays are resolved and restored before returning. */
+int see(board_t *b, move_t m);
+
+/* Exchange values used by see(), indexed by piece type */
+extern const int16_t see_value[7];
+
 /* Check if the current position is legal (side that just moved
    did not leave their king in check). */
 static inline uint8_t board_is_legal(const board_t *b)
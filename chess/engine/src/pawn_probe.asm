@@ -0,0 +1,49 @@
+	assume	adl=1
+	section	.text
+	public	_pawn_cache_probe
+
+; pawn_cache_entry_t *pawn_cache_probe(pawn_cache_entry_t *set_slots, zhash_t key)
+;
+; Scans the PAWN_CACHE_WAYS (4) slots of one pawn cache set for key and
+; returns the matching slot, or NULL.  Replaces the unrolled if/else
+; chain in evaluate_bounded(), which reloads b->pawn_hash and compares
+; it byte by byte per slot.  eval.c checks the entry size at compile time.
+;
+; Calling convention (eZ80 CE toolchain):
+;   Stack: [ret_addr(3)] [set_slots(3)] [key(3)]
+;   Return: HL = slot or 0
+;
+; Registers:
+;   IY = slot (key is the first field)
+;   DE = key
+;   BC = entry size
+;   A  = ways left
+
+PAWN_ENTRY_SIZE := 151
+
+_pawn_cache_probe:
+	push	ix
+	ld	ix, 0
+	add	ix, sp
+	ld	iy, (ix + 6)		; IY = set_slots
+	ld	de, (ix + 9)		; DE = key
+	pop	ix
+	ld	bc, PAWN_ENTRY_SIZE
+	ld	a, 4
+
+.slot:
+	ld	hl, (iy + 0)
+	or	a, a			; clear carry
+	sbc	hl, de
+	jr	z, .hit
+	add	iy, bc
+	dec	a
+	jr	nz, .slot
+
+	or	a, a
+	sbc	hl, hl			; not found
+	ret
+
+.hit:
+	lea	hl, iy + 0
+	ret
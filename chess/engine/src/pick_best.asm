@@ -1,106 +1,112 @@
 	assume	adl=1
 	section	.text
-	public	_pick_best_score
+	public	_pick_move
 
-; uint8_t pick_best_score(const int16_t *scores, uint8_t count, uint8_t start)
+; void pick_move(scored_move_t *list, uint8_t count, uint8_t index)
 ;
-; Scans scores[start..count-1] and returns the index of the highest value.
-; Used by pick_move() for selection sort — replaces the C inner loop
-; which the compiler generates with duplicate comparisons + __setflag calls.
+; Selection sort step: finds the highest score in list[index..count-1]
+; (the first of equals) and swaps that entry into list[index].  Replaces
+; the C scan, which the compiler generates with duplicate comparisons +
+; __setflag calls, and the separate swap of the move and score arrays.
 ;
 ; Calling convention (eZ80 CE toolchain):
-;   Stack: [ret_addr(3)] [scores(3)] [count(3)] [start(3)]
-;   Return: A = best index
+;   Stack: [ret_addr(3)] [list(3)] [count(3)] [index(3)]
+;   Entry: scored_move_t is 5 bytes: from, to, flags, score (int16_t)
 ;
 ; Register usage inside loop:
-;   IY = pointer to scores[i] (advances by 2 per iteration)
-;   DE = best_score (16-bit signed, stored as XOR 0x80 in D for unsigned cmp)
-;   B  = count (loop bound)
-;   C  = best index
-;   A  = loop counter i
+;   IY = entry being compared (advances by 5 per iteration)
+;   IX = best entry so far
+;   DE = best score (16-bit signed, stored as XOR 0x80 in D for unsigned cmp)
+;   C  = flipped high byte of the entry being compared
+;   B  = entries left to compare
 ;
 ; Signed 16-bit comparison trick: XOR high byte with 0x80 converts
 ; signed ordering to unsigned ordering. We store D already flipped,
 ; so each iteration only flips the loaded score's high byte.
 
-_pick_best_score:
+SCORED_MOVE_SIZE := 5
+
+_pick_move:
 	push	ix
 	ld	ix, 0
 	add	ix, sp
 
-	; Load arguments
-	ld	iy, (ix + 6)		; IY = scores pointer
-	ld	b, (ix + 9)		; B = count
-	ld	c, (ix + 12)		; C = start (= initial best index)
+	; Entries from index on; nothing to pick with fewer than two
+	ld	a, (ix + 9)		; count
+	sub	a, (ix + 12)		; - index
+	cp	a, 2
+	jr	c, .out
+	dec	a
+	ld	b, a			; B = entries after list[index]
 
-	; Compute IY = &scores[start]
-	ld	a, c
-	add	a, a			; A = start * 2 (int16_t stride)
-	ld	l, a
-	ld	h, 0
-	push	hl			; can't add to IY directly easily
+	; HL = &list[index]
+	or	a, a
+	sbc	hl, hl
+	ld	l, (ix + 12)
+	push	hl
 	pop	de
-	add	iy, de			; IY = scores + start*2
+	add	hl, hl
+	add	hl, hl
+	add	hl, de			; HL = index * 5
+	ld	de, (ix + 6)
+	add	hl, de
 
-	; Load initial best_score from scores[start]
-	ld	e, (iy)			; low byte
-	ld	d, (iy + 1)		; high byte
-	ld	a, d
-	xor	a, 80h			; flip sign bit for unsigned comparison
-	ld	d, a			; D = flipped high byte of best_score
+	push	iy
+	push	hl			; keep &list[index] for the swap
+	push	hl
+	pop	iy			; IY = cursor
+	push	hl
+	pop	ix			; IX = best
 
-	; Advance to scores[start+1]
-	lea	iy, iy + 2
-	ld	a, c
-	inc	a			; A = i = start + 1
+	; Initial best_score from list[index]
+	ld	e, (iy + 3)		; low byte
+	ld	a, (iy + 4)		; high byte
+	xor	a, 80h			; flip sign bit for unsigned comparison
+	ld	d, a
 
 .loop:
-	cp	a, b			; i >= count?
-	jr	nc, .done
-
-	; Load scores[i] high byte, flip sign bit
-	ld	h, (iy + 1)		; high byte of scores[i]
-	ld	l, h			; save original for potential update
-	ld	h, a			; save i temporarily
-	ld	a, l
-	xor	a, 80h			; flip sign bit
-	ld	l, a			; L = flipped high byte of scores[i]
-	ld	a, h			; restore i
+	lea	iy, iy + SCORED_MOVE_SIZE
+	ld	a, (iy + 4)
+	xor	a, 80h
+	ld	c, a			; C = flipped high byte of this score
 
-	; Compare high bytes (unsigned): D vs L
-	; if D < L: scores[i] > best_score → new best
-	; if D > L: scores[i] < best_score → skip
-	; if D == L: compare low bytes
-	push	af			; save i+flags
-	ld	a, d
-	cp	a, l			; compare flipped high bytes
-	jr	c, .new_best		; best < scores[i] (high byte)
-	jr	nz, .skip		; best > scores[i] (high byte)
+	; Compare high bytes (unsigned): D vs C
+	cp	a, d
+	jr	c, .next		; score < best (high byte)
+	jr	nz, .new_best		; score > best (high byte)
 
 	; High bytes equal — compare low bytes (unsigned)
 	ld	a, e
-	cp	a, (iy)			; compare low bytes
-	jr	nc, .skip		; best_score >= scores[i]
+	cp	a, (iy + 3)
+	jr	nc, .next		; best >= score
 
 .new_best:
-	; Update best
-	ld	e, (iy)			; E = new best_score low byte
-	ld	d, l			; D = new flipped high byte (already flipped)
-	pop	af			; restore i
-	ld	c, a			; C = best = i
+	ld	d, c
+	ld	e, (iy + 3)
+	lea	ix, iy + 0
 
-	; Advance
-	lea	iy, iy + 2
-	inc	a
-	jr	.loop
+.next:
+	djnz	.loop
 
-.skip:
-	pop	af			; restore i
-	lea	iy, iy + 2
-	inc	a
-	jr	.loop
+	; Swap list[index] and the best entry unless they are the same
+	pop	hl			; HL = &list[index]
+	lea	de, ix + 0
+	or	a, a
+	sbc	hl, de
+	jr	z, .done
+	add	hl, de
+	ld	b, SCORED_MOVE_SIZE
+.swap:
+	ld	a, (hl)
+	ld	c, (ix + 0)
+	ld	(ix + 0), a
+	ld	(hl), c
+	inc	hl
+	inc	ix
+	djnz	.swap
 
 .done:
-	ld	a, c			; return best index in A
+	pop	iy
+.out:
 	pop	ix
 	ret
@@ -4,6 +4,12 @@
 #include "tt.h"
 #include "zobrist.h"
 #include "directions.h"
+#include "timeman.h"
+#include "bitbase.h"
+#include <string.h>
+#ifdef SEARCH_THREADS
+#include <pthread.h>
+#endif
 
 /* ========== Search Profiling ========== */
 
@@ -65,20 +71,132 @@ static const uint8_t mvv_lva[6][6] = {
 #define SCORE_CAPTURE_BASE 10000
 #define SCORE_KILLER_1     9000
 #define SCORE_KILLER_2     8000
+#define SCORE_COUNTERMOVE  7500
+/* Captures that lose material by SEE: below every quiet move
+   (history is clamped to +/-4000, continuation history to +/-3000)
+   and searched last. */
+#define SCORE_LOSING_CAPTURE (-8000)
+
+/* ========== Countermove / Continuation History ========== */
+
+/* Both are keyed on the move that led to the node: its piece (colour
+   and type) and destination, see piece_to_key().  COUNTER_MOVES keeps
+   the quiet move that last refuted each such move; CONT_HISTORY keeps
+   a history score for each (previous move, current piece and
+   destination) pair.  The current mover's colour is implied by the
+   previous one, so a pair is prev_key * 384 + (type - 1) * 64 + sq64.
+
+   The full table (2^19 entries, ~1 MB) has no collisions; the
+   calculator folds the pair into CONT_HIST_SIZE entries instead. */
+#define PIECE_TO_KEYS 768       /* 12 pieces x 64 squares */
+#define PIECE_TO_NONE 0xFFFF    /* no previous move (root, null move) */
+
+#ifndef CONT_HIST_BITS
+#ifdef __ez80__
+#define CONT_HIST_BITS 12       /* 8 KB */
+#else
+#define CONT_HIST_BITS 19
+#endif
+#endif
+#define CONT_HIST_SIZE (1UL << CONT_HIST_BITS)
 
-/* ========== Search State ========== */
+#if defined(COUNTER_MOVES) || defined(CONT_HISTORY)
+static inline uint16_t piece_to_key(uint8_t piece, uint8_t to)
+{
+    uint8_t idx = PIECE_TYPE(piece) - 1;
+    if (IS_BLACK(piece)) idx += 6;
+    return (uint16_t)(idx * 64 + SQ_TO_SQ64(to));
+}
+#endif
+
+#ifdef CONT_HISTORY
+static inline uint32_t cont_index(uint16_t prev_key, uint8_t piece, uint8_t to)
+{
+    uint32_t i = (uint32_t)prev_key * 384 +
+                 (uint16_t)((PIECE_TYPE(piece) - 1) * 64 + SQ_TO_SQ64(to));
+    return (i ^ (i >> CONT_HIST_BITS)) & (CONT_HIST_SIZE - 1);
+}
+#endif
 
-/* Killer moves: 2 per ply */
-static move_t killers[MAX_PLY][2];
+/* From/to/promotion match — TT moves don't store the other flags */
+#define MOVE_KEY_EQ(a, c) ((a).from == (c).from && (a).to == (c).to && \
+    ((a).flags & (FLAG_PROMOTION | FLAG_PROMO_MASK)) == \
+    ((c).flags & (FLAG_PROMOTION | FLAG_PROMO_MASK)))
 
-/* History heuristic: history[side][to_sq88] */
-static int16_t history[2][128];
+/* ========== Search State ========== */
 
 /* Position history for repetition detection (256 half-moves = 128 full moves) */
 #define MAX_GAME_PLY 256
-static zhash_t pos_history[MAX_GAME_PLY];
-static uint16_t pos_history_count;
-static uint16_t pos_history_irreversible;
+
+/* Root move candidates for move_variance */
+#define MAX_ROOT_CANDIDATES 16
+
+/* Per-thread search state.  The eZ80 build has exactly one static
+   instance, so every access is a fixed address just like the plain
+   file statics it replaces.  Desktop Lazy SMP builds (SEARCH_THREADS)
+   make it thread-local: each helper gets its own killers, history,
+   move pool and root list while the TT is shared. */
+typedef struct {
+    /* Killer moves: 2 per ply */
+    move_t   killers[MAX_PLY][2];
+
+    /* History heuristic: history[side][to_sq88] */
+    int16_t  history[2][128];
+
+#if defined(COUNTER_MOVES) || defined(CONT_HISTORY)
+    /* piece_to_key() of the move made at each ply */
+    uint16_t ply_key[MAX_PLY];
+#endif
+#ifdef COUNTER_MOVES
+    move_t   countermove[PIECE_TO_KEYS];
+#endif
+#ifdef CONT_HISTORY
+    int16_t  cont_hist[CONT_HIST_SIZE];
+#endif
+
+    zhash_t  pos_history[MAX_GAME_PLY];
+    uint16_t pos_history_count;
+    uint16_t pos_history_irreversible;
+
+    /* Triangular PV table: pv[ply] is the best line found from ply,
+       pv_len[ply] moves long, built from pv[ply + 1] on each new best */
+    move_t   pv[SEARCH_PV_MAX][SEARCH_PV_MAX];
+    uint8_t  pv_len[SEARCH_PV_MAX];
+    uint8_t  seldepth;
+
+    uint32_t search_nodes;
+    move_t   search_best_root_move;
+    uint32_t search_rng_state;
+
+    move_t   root_moves[MAX_ROOT_CANDIDATES];
+    int16_t  root_scores[MAX_ROOT_CANDIDATES];
+    uint8_t  root_count;
+    /* Pending candidates for current (possibly incomplete) iteration */
+    move_t   root_moves_pending[MAX_ROOT_CANDIDATES];
+    int16_t  root_scores_pending[MAX_ROOT_CANDIDATES];
+    uint8_t  root_count_pending;
+
+    /* Persistent root move list: legal moves only, generated once per
+       search_go() and reordered after every iteration (best move first,
+       then by move-ordering score, ties broken by subtree size). */
+    move_t   root_list[MAX_MOVES];
+    uint32_t root_list_nodes[MAX_MOVES];
+    uint8_t  root_list_count;
+
+    /* Move pool — avoids ~2KB stack per ply.
+       Search is depth-first, so plies share this pool via a stack pointer.
+       Each entry packs a move with its ordering score (5 bytes on the
+       calculator, the same as separate move and score arrays), so
+       selection moves one entry instead of two.  Generators write a
+       plain move list at the tail of the node's MAX_MOVES window
+       (pool_scratch) and scoring packs it into the head. */
+    scored_move_t pool[MOVE_POOL_SIZE];
+    uint16_t move_sp;
+
+    uint8_t  helper;   /* Lazy SMP helper: no time/node limit checks */
+} search_thread_t;
+
+static THREAD_LOCAL search_thread_t st;
 
 /* Stack overflow guard: TI-OS only provides ~4KB of stack.
    negamax uses ~200 bytes per frame, quiescence ~100 bytes.
@@ -100,36 +218,55 @@ static inline uint8_t stack_low(void)
 static inline uint8_t stack_low(void) { return 0; }
 #endif
 
-/* Search globals */
-static uint32_t search_nodes;
+/* Search globals shared by all threads */
 static volatile uint8_t  search_stopped;
 static uint32_t search_deadline;
+static uint32_t search_start;          /* when the time budget started */
+static tm_t     search_tm;
 static uint32_t search_max_nodes;
 static uint32_t search_node_deadline; /* timer-failure fallback */
 static time_ms_fn search_time_fn;
-static move_t   search_best_root_move;
 static int      search_eval_noise;     /* max random noise added at root (0 = off) */
 static int      search_move_variance;  /* cp threshold for random root move pick */
-static uint32_t search_rng_state;
+static search_poll_fn search_poll;
+static search_info_fn search_info;
+static uint16_t search_poll_ms;
+static uint32_t search_poll_next;
+
+/* Last completed iteration of the previous search, kept so a ponder
+   hit can pick up where the ponder search left off */
+static zhash_t  search_last_hash;
+static uint16_t search_last_lock;
+static search_result_t search_last;
+static move_t   search_last_pv[SEARCH_PV_MAX];
+static uint8_t  search_last_pv_len;
+static uint8_t  search_continue_armed;
+/* Position the current TT generation was started for */
+static zhash_t  search_gen_hash;
+static uint16_t search_gen_lock;
+
+/* Nodes between poll-timer reads.  A CE node costs milliseconds, so
+   the timer is read every node there; native builds read it every
+   256 nodes like the deadline check. */
+#ifdef __ez80__
+#define POLL_CHECK_MASK 0
+#else
+#define POLL_CHECK_MASK 255
+#endif
 
-/* Root move candidates for move_variance */
-#define MAX_ROOT_CANDIDATES 16
-static move_t   root_moves[MAX_ROOT_CANDIDATES];
-static int16_t  root_scores[MAX_ROOT_CANDIDATES];
-static uint8_t  root_count;
-/* Pending candidates for current (possibly incomplete) iteration */
-static move_t   root_moves_pending[MAX_ROOT_CANDIDATES];
-static int16_t  root_scores_pending[MAX_ROOT_CANDIDATES];
-static uint8_t  root_count_pending;
+/* Aspiration window: initial half-width and the point past which a
+   failing search gives up and goes full width. */
+#define ASP_WINDOW     25
+#define ASP_MAX_WINDOW 400
 
 /* Simple xorshift PRNG — returns value in [-noise, +noise] */
 static int search_rand_noise(void)
 {
-    uint32_t x = search_rng_state;
+    uint32_t x = st.search_rng_state;
     x ^= x << 13;
     x ^= x >> 17;
     x ^= x << 5;
-    search_rng_state = x;
+    st.search_rng_state = x;
     if (search_eval_noise == 0) return 0;
     return (int)(x % (2 * (unsigned)search_eval_noise + 1)) - search_eval_noise;
 }
@@ -137,48 +274,90 @@ static int search_rand_noise(void)
 /* Quiescence search depth limit */
 #define QS_MAX_DEPTH 8
 
-/* Global move pool (SoA) — avoids ~2KB stack per ply.
-   Search is depth-first, so plies share this pool via a stack pointer.
-   SoA layout lets generate_moves write directly into pool_moves,
-   eliminating a per-node copy from a temp buffer. */
-static move_t pool_moves[MOVE_POOL_SIZE];
-static int16_t pool_scores[MOVE_POOL_SIZE];
-static uint16_t move_sp;
+/* ========== Late Move Reductions / Pruning ========== */
+
+/* Base reduction by [depth][move number], both capped at the last
+   column: r = 0.75 + ln(depth) * ln(moves) / 2.25, rounded down.
+   Kept const so the calculator build leaves it in flash. */
+#define LMR_DEPTHS 16
+#define LMR_MOVES  32
+static const uint8_t lmr_table[LMR_DEPTHS][LMR_MOVES] = {
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+    { 0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+    { 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3 },
+    { 0, 0, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3 },
+    { 0, 0, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3 },
+    { 0, 0, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3 },
+    { 0, 0, 1, 1, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4 },
+    { 0, 0, 1, 1, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 },
+    { 0, 0, 1, 1, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4 },
+    { 0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4 },
+    { 0, 0, 1, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4 },
+    { 0, 0, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4 },
+    { 0, 0, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4 }
+};
+
+/* History score past which a quiet move is reduced one ply less
+   (history is clamped to +-4000) */
+#define LMR_HISTORY_GOOD 2000
+
+/* Late move pruning: at depth <= LMP_MAX_DEPTH, quiet moves past the
+   first lmp_count[depth] searched are skipped at non-PV nodes */
+#define LMP_MAX_DEPTH 3
+static const uint8_t lmp_count[LMP_MAX_DEPTH + 1] = { 0, 4, 7, 12 };
+
+/* Reduction for a late quiet move: the table, one ply less at PV
+   nodes, for killers and for moves with good history, and never so
+   much that the reduced search drops into quiescence. */
+static int8_t lmr_reduction(int8_t depth, uint8_t move_num,
+                            uint8_t pv_node, uint8_t killer, int16_t hist)
+{
+    int8_t r = lmr_table[depth < LMR_DEPTHS ? depth : LMR_DEPTHS - 1]
+                        [move_num < LMR_MOVES ? move_num : LMR_MOVES - 1];
+    if (pv_node) r--;
+    if (killer) r--;
+    if (hist >= LMR_HISTORY_GOOD) r--;
+    if (r > depth - 2) r = depth - 2;
+    return r > 0 ? r : 0;
+}
 
 /* ========== Position History ========== */
 
 void search_history_push(zhash_t hash)
 {
-    if (pos_history_count < MAX_GAME_PLY)
-        pos_history[pos_history_count++] = hash;
+    if (st.pos_history_count < MAX_GAME_PLY)
+        st.pos_history[st.pos_history_count++] = hash;
 }
 
 void search_history_pop(void)
 {
-    if (pos_history_count > 0)
-        pos_history_count--;
+    if (st.pos_history_count > 0)
+        st.pos_history_count--;
 }
 
 void search_history_clear(void)
 {
-    pos_history_count = 0;
-    pos_history_irreversible = 0;
+    st.pos_history_count = 0;
+    st.pos_history_irreversible = 0;
 }
 
 void search_history_set_irreversible(void)
 {
-    pos_history_irreversible = pos_history_count;
+    st.pos_history_irreversible = st.pos_history_count;
 }
 
 static uint8_t repetition_count(zhash_t hash)
 {
     int i;
     uint8_t count = 0;
-    if (pos_history_count == 0) return 0;
+    if (st.pos_history_count == 0) return 0;
     /* Same side to move = positions at count-1, count-3, count-5, etc. */
-    for (i = (int)pos_history_count - 1;
-         i >= (int)pos_history_irreversible; i -= 2) {
-        if (pos_history[i] == hash)
+    for (i = (int)st.pos_history_count - 1;
+         i >= (int)st.pos_history_irreversible; i -= 2) {
+        if (st.pos_history[i] == hash)
             count++;
     }
     return count;
@@ -199,13 +378,15 @@ static uint8_t is_repetition(zhash_t hash)
 
 static void check_time(void)
 {
+    /* Helpers only follow search_stopped; limits belong to the main thread */
+    if (st.helper) return;
     if (search_time_fn && search_deadline) {
-        if ((search_nodes & 255) == 0) {
+        if ((st.search_nodes & 255) == 0) {
             if (search_time_fn() >= search_deadline)
                 search_stopped = 1;
         }
     }
-    if (search_max_nodes && search_nodes >= search_max_nodes) {
+    if (search_max_nodes && st.search_nodes >= search_max_nodes) {
         search_stopped = 1;
     }
     /* Hard fallback: if a time limit was set, stop after a generous
@@ -213,47 +394,141 @@ static void check_time(void)
        with ~160K cy/node the engine does ~300 nodes/sec, so 1 node/ms
        gives ~3x headroom.  This never fires when the timer works
        (timer stops the search well before this limit). */
-    if (search_node_deadline && search_nodes >= search_node_deadline) {
+    if (search_node_deadline && st.search_nodes >= search_node_deadline) {
         search_stopped = 1;
     }
+    if (search_poll && !search_stopped &&
+        (st.search_nodes & POLL_CHECK_MASK) == 0) {
+        uint32_t now = search_time_fn ? search_time_fn() : 0;
+        if (!search_time_fn || now >= search_poll_next) {
+            if (search_poll())
+                search_stopped = 1;
+            /* Time spent in the callback does not count toward the next interval */
+            if (search_time_fn)
+                search_poll_next = search_time_fn() + search_poll_ms;
+        }
+    }
+}
+
+void search_set_poll(search_poll_fn fn, uint16_t interval_ms)
+{
+    search_poll = fn;
+    search_poll_ms = interval_ms;
+}
+
+void search_set_info(search_info_fn fn)
+{
+    search_info = fn;
+}
+
+uint8_t search_get_pv(const board_t *b, move_t *pv, uint8_t max)
+{
+    uint8_t i;
+
+    if (!search_last.depth || search_last_hash != b->hash ||
+        search_last_lock != b->lock)
+        return 0;
+    if (max > search_last_pv_len) max = search_last_pv_len;
+    for (i = 0; i < max; i++)
+        pv[i] = search_last_pv[i];
+    return max;
+}
+
+void search_set_time_limit(uint32_t soft_time_ms, uint32_t max_time_ms)
+{
+    search_tm.soft_ms = soft_time_ms;
+    search_tm.hard_ms = max_time_ms;
+    if (search_time_fn)
+        search_start = search_time_fn();
+    if (max_time_ms && search_time_fn)
+        search_deadline = search_start + max_time_ms;
+    else
+        search_deadline = 0;
+#ifdef __ez80__
+    search_node_deadline = max_time_ms ? st.search_nodes + max_time_ms : 0;
+#endif
+}
+
+void search_continue_next(void)
+{
+    search_continue_armed = 1;
 }
 
 /* ========== Initialization ========== */
 
 void search_init(void)
 {
-    int i, j;
     tt_clear();
+    search_reset();
+}
+
+void search_reset(void)
+{
+    int i, j;
     search_history_clear();
-    move_sp = 0;
-    root_count = 0;
-    root_count_pending = 0;
-    search_best_root_move = MOVE_NONE;
+    st.move_sp = 0;
+    st.root_count = 0;
+    st.root_count_pending = 0;
+    st.search_best_root_move = MOVE_NONE;
     for (i = 0; i < MAX_PLY; i++) {
-        killers[i][0] = MOVE_NONE;
-        killers[i][1] = MOVE_NONE;
+        st.killers[i][0] = MOVE_NONE;
+        st.killers[i][1] = MOVE_NONE;
     }
     for (i = 0; i < 2; i++)
         for (j = 0; j < 128; j++)
-            history[i][j] = 0;
+            st.history[i][j] = 0;
+#ifdef COUNTER_MOVES
+    for (i = 0; i < PIECE_TO_KEYS; i++)
+        st.countermove[i] = MOVE_NONE;
+#endif
+#ifdef CONT_HISTORY
+    memset(st.cont_hist, 0, sizeof(st.cont_hist));
+#endif
+    search_last.depth = 0;
+    search_continue_armed = 0;
 }
 
 /* ========== Move Scoring ========== */
 
-static void score_moves(const board_t *b, const move_t *moves, int16_t *scores,
-                        uint8_t count, uint8_t ply, move_t tt_move)
+/* Run SEE only when the attacker outweighs the victim: equal or
+   favourable trades can't lose material, and a legal king capture
+   can't be recaptured.  Promotions are left to the promo bonus. */
+static inline uint8_t capture_may_lose(board_t *b, move_t m,
+                                       uint8_t victim_type, uint8_t attacker_type)
+{
+    if (attacker_type == PIECE_KING || (m.flags & FLAG_PROMOTION))
+        return 0;
+    if (see_value[attacker_type] <= see_value[victim_type])
+        return 0;
+    return see(b, m) < 0;
+}
+
+/* Pack moves[] into out[] with their ordering scores.  moves may be
+   the pool_scratch() of out's window: each move is read before its
+   entry is written.  prev_key is piece_to_key() of the move that led
+   here, or PIECE_TO_NONE where there is none to follow up on. */
+static void score_moves(board_t *b, const move_t *moves, scored_move_t *out,
+                        uint8_t count, uint8_t ply, move_t tt_move,
+                        uint16_t prev_key)
 {
     uint8_t i;
+#ifdef COUNTER_MOVES
+    move_t counter = (prev_key != PIECE_TO_NONE) ? st.countermove[prev_key] : MOVE_NONE;
+#endif
+#if !defined(COUNTER_MOVES) && !defined(CONT_HISTORY)
+    (void)prev_key;
+#endif
     for (i = 0; i < count; i++) {
         move_t m = moves[i];
+        int16_t score;
+
+        out[i].move = m;
 
         /* TT move gets highest priority.
            Compare from/to and promotion flags only — TT moves don't
            store capture/castle/EP/double-push flags. */
-        if (m.from == tt_move.from && m.to == tt_move.to &&
-            (m.flags & (FLAG_PROMOTION | FLAG_PROMO_MASK)) ==
-            (tt_move.flags & (FLAG_PROMOTION | FLAG_PROMO_MASK))) {
-            scores[i] = SCORE_TT_MOVE;
+        if (MOVE_KEY_EQ(m, tt_move)) {
+            out[i].score = SCORE_TT_MOVE;
             continue;
         }
 
@@ -268,33 +543,46 @@ static void score_moves(const board_t *b, const move_t *moves, int16_t *scores,
 
             if (victim_type >= PIECE_PAWN && victim_type <= PIECE_KING &&
                 attacker_type >= PIECE_PAWN && attacker_type <= PIECE_KING) {
-                scores[i] = SCORE_CAPTURE_BASE +
+                score = SCORE_CAPTURE_BASE +
                     mvv_lva[victim_type - 1][attacker_type - 1];
+                if (capture_may_lose(b, m, victim_type, attacker_type))
+                    score = SCORE_LOSING_CAPTURE +
+                        mvv_lva[victim_type - 1][attacker_type - 1];
             } else {
-                scores[i] = SCORE_CAPTURE_BASE;
+                score = SCORE_CAPTURE_BASE;
             }
-        } else if (ply < MAX_PLY && MOVE_EQ(m, killers[ply][0])) {
-            scores[i] = SCORE_KILLER_1;
-        } else if (ply < MAX_PLY && MOVE_EQ(m, killers[ply][1])) {
-            scores[i] = SCORE_KILLER_2;
+        } else if (ply < MAX_PLY && MOVE_EQ(m, st.killers[ply][0])) {
+            score = SCORE_KILLER_1;
+        } else if (ply < MAX_PLY && MOVE_EQ(m, st.killers[ply][1])) {
+            score = SCORE_KILLER_2;
+#ifdef COUNTER_MOVES
+        } else if (MOVE_EQ(m, counter)) {
+            score = SCORE_COUNTERMOVE;
+#endif
         } else {
             /* History heuristic */
-            scores[i] = history[b->side][m.to];
+            score = st.history[b->side][m.to];
+#ifdef CONT_HISTORY
+            if (prev_key != PIECE_TO_NONE)
+                score += st.cont_hist[cont_index(prev_key, b->squares[m.from], m.to)];
+#endif
         }
 
         /* Bonus for promotions */
         if (m.flags & FLAG_PROMOTION) {
             if ((m.flags & FLAG_PROMO_MASK) == FLAG_PROMO_Q)
-                scores[i] += 5000;
+                score += 5000;
             else
-                scores[i] += 1000;
+                score += 1000;
         }
+        out[i].score = score;
     }
 }
 
-/* Capture-only scoring used in quiescence (non-check nodes). */
-static void score_capture_moves(const board_t *b, const move_t *moves,
-                                int16_t *scores, uint8_t count)
+/* Capture-only scoring used in quiescence (non-check nodes).
+   Losing captures get a negative score so the caller can stop at them. */
+static void score_capture_moves(board_t *b, const move_t *moves,
+                                scored_move_t *out, uint8_t count)
 {
     uint8_t i;
     for (i = 0; i < count; i++) {
@@ -311,6 +599,9 @@ static void score_capture_moves(const board_t *b, const move_t *moves,
             if (victim_type >= PIECE_PAWN && victim_type <= PIECE_KING &&
                 attacker_type >= PIECE_PAWN && attacker_type <= PIECE_KING) {
                 score += mvv_lva[victim_type - 1][attacker_type - 1];
+                if (capture_may_lose(b, m, victim_type, attacker_type))
+                    score = SCORE_LOSING_CAPTURE +
+                        mvv_lva[victim_type - 1][attacker_type - 1];
             }
         }
 
@@ -321,43 +612,67 @@ static void score_capture_moves(const board_t *b, const move_t *moves,
                 score += 1000;
         }
 
-        scores[i] = score;
+        out[i].move = m;
+        out[i].score = score;
     }
 }
 
-/* Hand-written eZ80 asm scan: find index of highest score in scores[start..count-1].
-   Eliminates compiler's duplicate comparison + __setflag overhead (~2.8x faster). */
+/* Move list of a node's window: the tail MAX_MOVES * sizeof(move_t)
+   bytes of pool[base .. base + MAX_MOVES).  Packing entry i forward
+   never reaches move i + 1 (entries are at least as big as moves), so
+   score_moves() can read from here while it fills pool[base...]. */
+static inline move_t *pool_scratch(uint16_t base)
+{
+    return (move_t *)((uint8_t *)&st.pool[base + MAX_MOVES] -
+                      MAX_MOVES * sizeof(move_t));
+}
+
+/* Selection sort step: swap the best entry of list[index..count-1]
+   (first of equals) into list[index].  Hand-written eZ80 asm fuses the
+   scan and the 5-byte swap (pick_best.asm); the compiler's version
+   does duplicate comparisons + __setflag calls per entry. */
 #ifdef __ez80__
-extern uint8_t pick_best_score(const int16_t *scores, uint8_t count, uint8_t start);
+extern void pick_move(scored_move_t *list, uint8_t count, uint8_t index);
 #else
-static uint8_t pick_best_score(const int16_t *scores, uint8_t count, uint8_t start)
+static void pick_move(scored_move_t *list, uint8_t count, uint8_t index)
 {
-    uint8_t best = start;
-    int16_t best_score = scores[start];
+    uint8_t best = index;
+    int16_t best_score = list[index].score;
     uint8_t i;
-    for (i = start + 1; i < count; i++) {
-        if (scores[i] > best_score) {
+
+    for (i = index + 1; i < count; i++) {
+        if (list[i].score > best_score) {
             best = i;
-            best_score = scores[i];
+            best_score = list[i].score;
         }
     }
-    return best;
+    if (best != index) {
+        scored_move_t tmp = list[index];
+        list[index] = list[best];
+        list[best] = tmp;
+    }
 }
 #endif
 
-/* Selection sort: swap best move to position 'index' */
-static void pick_move(move_t *moves, int16_t *scores, uint8_t count, uint8_t index)
+/* Partial insertion sort: entries scoring >= 0 move to the front in
+   descending order (stable), the rest follow unsorted.  Returns how
+   many were sorted.  Capture lists are short and usually all searched
+   or cut on the first move, so this replaces a selection scan per
+   move; the losing captures behind them are only picked if reached. */
+static uint8_t sort_good_moves(scored_move_t *list, uint8_t count)
 {
-    uint8_t best = pick_best_score(scores, count, index);
+    uint8_t i, j, good = 0;
 
-    if (best != index) {
-        move_t tmp_m = moves[index];
-        int16_t tmp_s = scores[index];
-        moves[index] = moves[best];
-        scores[index] = scores[best];
-        moves[best] = tmp_m;
-        scores[best] = tmp_s;
+    for (i = 0; i < count; i++) {
+        scored_move_t e;
+        if (list[i].score < 0) continue;
+        e = list[i];
+        list[i] = list[good];
+        for (j = good++; j > 0 && list[j - 1].score < e.score; j--)
+            list[j] = list[j - 1];
+        list[j] = e;
     }
+    return good;
 }
 
 /* ========== Update Killer and History ========== */
@@ -365,23 +680,65 @@ static void pick_move(move_t *moves, int16_t *scores, uint8_t count, uint8_t ind
 static void update_killers(uint8_t ply, move_t m)
 {
     if (ply >= MAX_PLY) return;
-    if (!MOVE_EQ(m, killers[ply][0])) {
-        killers[ply][1] = killers[ply][0];
-        killers[ply][0] = m;
+    if (!MOVE_EQ(m, st.killers[ply][0])) {
+        st.killers[ply][1] = st.killers[ply][0];
+        st.killers[ply][0] = m;
     }
 }
 
 static void update_history(uint8_t side, move_t m, int8_t depth)
 {
     int bonus = (int)depth * depth;
-    int val = history[side][m.to];
+    int val = st.history[side][m.to];
     /* Gravity: prevent overflow, trend toward 0 */
     val += bonus - val * bonus / 16384;
     if (val > 4000) val = 4000;
     if (val < -4000) val = -4000;
-    history[side][m.to] = val;
+    st.history[side][m.to] = val;
+}
+
+/* m is the new best move at ply: the PV from ply is m followed by the
+   line the child search just left at ply + 1 */
+static inline void update_pv(uint8_t ply, move_t m)
+{
+    uint8_t n = 0;
+
+    if (ply >= SEARCH_PV_MAX) return;
+    if (ply + 1 < SEARCH_PV_MAX) {
+        n = st.pv_len[ply + 1];
+        memcpy(&st.pv[ply][1], st.pv[ply + 1], n * sizeof(move_t));
+    }
+    st.pv[ply][0] = m;
+    st.pv_len[ply] = (uint8_t)(n + 1);
 }
 
+/* Record a quiet cutoff move m against the move that led to the node */
+#if defined(COUNTER_MOVES) || defined(CONT_HISTORY)
+static void update_followup(const board_t *b, uint16_t prev_key, move_t m, int8_t depth)
+{
+#ifdef CONT_HISTORY
+    int bonus = (int)depth * depth;
+    int val;
+    int16_t *h;
+#endif
+    if (prev_key == PIECE_TO_NONE) return;
+#ifdef COUNTER_MOVES
+    st.countermove[prev_key] = m;
+#endif
+#ifdef CONT_HISTORY
+    h = &st.cont_hist[cont_index(prev_key, b->squares[m.from], m.to)];
+    val = *h;
+    val += bonus - val * bonus / 16384;
+    if (val > 3000) val = 3000;
+    if (val < -3000) val = -3000;
+    *h = (int16_t)val;
+#else
+    (void)b;
+    (void)depth;
+#endif
+}
+#endif
+
 /* ========== Legality Fast Path ========== */
 
 typedef struct {
@@ -424,41 +781,47 @@ static void compute_legal_info(const board_t *b, legal_info_t *li)
     li->num_checkers = 0;
     li->pinned_count = 0;
 
-    /* Knight checkers */
-    for (i = 0; i < 8; i++) {
-        target = king_sq + knight_offsets[i];
-        if (SQ_VALID(target)) {
-            uint8_t p = b->squares[target];
-            if (p != PIECE_NONE &&
-                PIECE_COLOR(p) == attacker_color &&
-                PIECE_TYPE(p) == PIECE_KNIGHT) {
-                add_checker(li, target);
+#ifdef ATTACK_MAPS
+    /* Attack map says nobody hits the king: skip straight to pins */
+    if (b->attacks[opp][king_sq])
+#endif
+    {
+        /* Knight checkers */
+        for (i = 0; i < 8; i++) {
+            target = king_sq + knight_offsets[i];
+            if (SQ_VALID(target)) {
+                uint8_t p = b->squares[target];
+                if (p != PIECE_NONE &&
+                    PIECE_COLOR(p) == attacker_color &&
+                    PIECE_TYPE(p) == PIECE_KNIGHT) {
+                    add_checker(li, target);
+                }
             }
         }
-    }
 
-    /* Pawn checkers */
-    {
-        int8_t pawn_dir = (opp == WHITE) ? 16 : -16;
-        uint8_t pawn = MAKE_PIECE(attacker_color, PIECE_PAWN);
-
-        target = king_sq + pawn_dir - 1;
-        if (SQ_VALID(target) && b->squares[target] == pawn)
-            add_checker(li, target);
-        target = king_sq + pawn_dir + 1;
-        if (SQ_VALID(target) && b->squares[target] == pawn)
-            add_checker(li, target);
-    }
+        /* Pawn checkers */
+        {
+            int8_t pawn_dir = (opp == WHITE) ? 16 : -16;
+            uint8_t pawn = MAKE_PIECE(attacker_color, PIECE_PAWN);
 
-    /* Adjacent king checker (illegal positions, but keep robust) */
-    for (i = 0; i < 8; i++) {
-        target = king_sq + king_offsets[i];
-        if (SQ_VALID(target)) {
-            uint8_t p = b->squares[target];
-            if (p != PIECE_NONE &&
-                PIECE_COLOR(p) == attacker_color &&
-                PIECE_TYPE(p) == PIECE_KING) {
+            target = king_sq + pawn_dir - 1;
+            if (SQ_VALID(target) && b->squares[target] == pawn)
                 add_checker(li, target);
+            target = king_sq + pawn_dir + 1;
+            if (SQ_VALID(target) && b->squares[target] == pawn)
+                add_checker(li, target);
+        }
+
+        /* Adjacent king checker (illegal positions, but keep robust) */
+        for (i = 0; i < 8; i++) {
+            target = king_sq + king_offsets[i];
+            if (SQ_VALID(target)) {
+                uint8_t p = b->squares[target];
+                if (p != PIECE_NONE &&
+                    PIECE_COLOR(p) == attacker_color &&
+                    PIECE_TYPE(p) == PIECE_KING) {
+                    add_checker(li, target);
+                }
             }
         }
     }
@@ -583,6 +946,52 @@ static uint8_t is_evasion_candidate(const board_t *b,
     return 0;
 }
 
+/* ========== Staged Move Picker ========== */
+
+#define STAGE_TT           0
+#define STAGE_CAPTURES     1
+#define STAGE_KILLERS      2
+#define STAGE_QUIETS       3
+#define STAGE_BAD_CAPTURES 4
+#define STAGE_DONE         5
+
+/* Check that m is a pseudo-legal move of the piece on m.from without a
+   full generation.  On a match *out gets the generator's flags.
+   scratch must have room for one piece's moves (27). */
+static uint8_t find_piece_move(const board_t *b, move_t m, move_t *scratch,
+                               move_t *out)
+{
+    uint8_t n, i;
+
+    if (!SQ_VALID(m.from)) return 0;
+    n = generate_moves_from(b, m.from, scratch);
+    for (i = 0; i < n; i++) {
+        if (MOVE_KEY_EQ(scratch[i], m)) {
+            *out = scratch[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Remove moves already searched by an earlier stage; returns new count */
+static uint8_t drop_tried(move_t *moves, uint8_t count,
+                          const move_t *tried, uint8_t tried_count)
+{
+    uint8_t i, j;
+
+    if (!tried_count) return count;
+    for (i = 0; i < count; ) {
+        for (j = 0; j < tried_count; j++)
+            if (MOVE_EQ(moves[i], tried[j])) break;
+        if (j < tried_count)
+            moves[i] = moves[--count];
+        else
+            i++;
+    }
+    return count;
+}
+
 /* ========== Quiescence Search ========== */
 
 static int quiescence(board_t *b, int alpha, int beta,
@@ -591,20 +1000,27 @@ static int quiescence(board_t *b, int alpha, int beta,
     int stand_pat;
     int score;
     uint8_t in_check;
-    uint8_t count, i;
+    uint8_t count, good, i;
     uint16_t base;
-    move_t *moves;
-    int16_t *scores;
+    scored_move_t *list;
+    move_t m;
     undo_t undo;
     legal_info_t linfo;
     PROF_VARS;
 
     if (search_stopped) return 0;
-    search_nodes++;
+    st.search_nodes++;
+    if (ply < SEARCH_PV_MAX) st.pv_len[ply] = 0;
+    if (ply > st.seldepth) st.seldepth = ply;
 
     check_time();
     if (search_stopped) return 0;
 
+    /* Exact result from an endgame bitbase */
+    if (b->piece_count[WHITE] + b->piece_count[BLACK] <= BITBASE_MAX_MEN &&
+        bitbase_probe(b, &score))
+        return score;
+
     if (ply >= MAX_PLY || qs_depth >= QS_MAX_DEPTH || stack_low()) {
         PROF_B(); stand_pat = evaluate(b); PROF_E(eval_cy); PROF_C(eval_cnt);
         return stand_pat;
@@ -618,34 +1034,34 @@ static int quiescence(board_t *b, int alpha, int beta,
     if (in_check) {
         /* In check: must search all moves (evasions) */
         uint8_t legal_found = 0;
-        base = move_sp;
+        base = st.move_sp;
         if (base + MAX_MOVES > MOVE_POOL_SIZE) return evaluate(b);
         PROF_B();
-        count = generate_moves(b, &pool_moves[base], GEN_ALL);
+        count = generate_moves(b, pool_scratch(base), GEN_ALL);
         PROF_E(movegen_cy); PROF_C(movegen_cnt);
 
-        moves = &pool_moves[base];
-        scores = &pool_scores[base];
-        move_sp = base + count;
+        list = &st.pool[base];
+        st.move_sp = base + count;
         PROF_B();
-        score_moves(b, moves, scores, count, ply, MOVE_NONE);
+        score_moves(b, pool_scratch(base), list, count, ply, MOVE_NONE, PIECE_TO_NONE);
         PROF_E(moveorder_cy);
 
         /* Keep caller's alpha bound (do NOT reset to -SCORE_INF) */
         for (i = 0; i < count; i++) {
             PROF_B();
-            pick_move(moves, scores, count, i);
+            pick_move(list, count, i);
             PROF_E(moveorder_cy);
-            if (!is_evasion_candidate(b, &linfo, moves[i]))
+            m = list[i].move;
+            if (!is_evasion_candidate(b, &linfo, m))
                 continue;
             PROF_B();
-            board_make(b, moves[i], &undo);
+            board_make(b, m, &undo);
             PROF_E(make_unmake_cy);
             PROF_B();
             if (!board_is_legal(b)) {
                 PROF_E(is_legal_cy); PROF_C(legal_cnt);
                 PROF_B();
-                board_unmake(b, moves[i], &undo);
+                board_unmake(b, m, &undo);
                 PROF_E(make_unmake_cy);
                 continue;
             }
@@ -654,17 +1070,17 @@ static int quiescence(board_t *b, int alpha, int beta,
             legal_found = 1;
             score = -quiescence(b, -beta, -alpha, ply + 1, qs_depth + 1);
             PROF_B();
-            board_unmake(b, moves[i], &undo);
+            board_unmake(b, m, &undo);
             PROF_E(make_unmake_cy);
 
-            if (search_stopped) { move_sp = base; return 0; }
+            if (search_stopped) { st.move_sp = base; return 0; }
             if (score > alpha) {
                 alpha = score;
-                if (alpha >= beta) { move_sp = base; return beta; }
+                if (alpha >= beta) { st.move_sp = base; return beta; }
             }
         }
 
-        move_sp = base;
+        st.move_sp = base;
 
         /* No legal moves while in check = checkmate */
         if (!legal_found) return -SCORE_MATE + ply;
@@ -672,9 +1088,10 @@ static int quiescence(board_t *b, int alpha, int beta,
         return alpha;
     }
 
-    /* Not in check: stand pat */
+    /* Not in check: stand pat.  Outside the delta-pruning band the
+       exact score doesn't matter, so let eval bail out early. */
     PROF_B();
-    stand_pat = evaluate(b);
+    stand_pat = evaluate_bounded(b, alpha - 1100, beta);
     PROF_E(eval_cy); PROF_C(eval_cnt);
     if (stand_pat >= beta) return beta;
     if (stand_pat > alpha) alpha = stand_pat;
@@ -683,34 +1100,33 @@ static int quiescence(board_t *b, int alpha, int beta,
     if (stand_pat + 1100 < alpha) return alpha;
 
     /* Generate captures only — directly into pool */
-    base = move_sp;
+    base = st.move_sp;
     if (base + MAX_MOVES > MOVE_POOL_SIZE) return alpha;
     PROF_B();
-    count = generate_moves(b, &pool_moves[base], GEN_CAPTURES);
+    count = generate_moves(b, pool_scratch(base), GEN_CAPTURES);
     PROF_E(movegen_cy); PROF_C(movegen_cnt);
 
-    moves = &pool_moves[base];
-    scores = &pool_scores[base];
-    move_sp = base + count;
+    list = &st.pool[base];
+    st.move_sp = base + count;
     PROF_B();
-    score_capture_moves(b, moves, scores, count);
+    score_capture_moves(b, pool_scratch(base), list, count);
+    /* SEE pruning: the losing captures left behind are never searched */
+    good = sort_good_moves(list, count);
     PROF_E(moveorder_cy);
 
-    for (i = 0; i < count; i++) {
+    for (i = 0; i < good; i++) {
         uint8_t need_legality_check;
+        m = list[i].move;
+        need_legality_check = move_needs_legality_check(b, &linfo, m);
         PROF_B();
-        pick_move(moves, scores, count, i);
-        PROF_E(moveorder_cy);
-        need_legality_check = move_needs_legality_check(b, &linfo, moves[i]);
-        PROF_B();
-        board_make(b, moves[i], &undo);
+        board_make(b, m, &undo);
         PROF_E(make_unmake_cy);
         if (need_legality_check) {
             PROF_B();
             if (!board_is_legal(b)) {
                 PROF_E(is_legal_cy); PROF_C(legal_cnt);
                 PROF_B();
-                board_unmake(b, moves[i], &undo);
+                board_unmake(b, m, &undo);
                 PROF_E(make_unmake_cy);
                 continue;
             }
@@ -719,17 +1135,17 @@ static int quiescence(board_t *b, int alpha, int beta,
         PROF_C(make_cnt);
         score = -quiescence(b, -beta, -alpha, ply + 1, qs_depth + 1);
         PROF_B();
-        board_unmake(b, moves[i], &undo);
+        board_unmake(b, m, &undo);
         PROF_E(make_unmake_cy);
 
-        if (search_stopped) { move_sp = base; return 0; }
+        if (search_stopped) { st.move_sp = base; return 0; }
         if (score > alpha) {
             alpha = score;
-            if (alpha >= beta) { move_sp = base; return beta; }
+            if (alpha >= beta) { st.move_sp = base; return beta; }
         }
     }
 
-    move_sp = base;
+    st.move_sp = base;
     return alpha;
 }
 
@@ -747,19 +1163,28 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
     int8_t tt_depth;
     uint8_t tt_flag;
     uint16_t base;
-    move_t *moves;
-    int16_t *scores;
-    uint8_t count, i, stage, cutoff;
+    scored_move_t *list;
+    move_t *gen;
+    uint8_t count, sorted, i, stage, cutoff;
+    uint16_t node_base, bad_base;
+    uint8_t bad_start, bad_count;
+    move_t tried[3];
+    uint8_t tried_count;
+    uint8_t at_root;
     undo_t undo;
     uint8_t best_flag;
     move_t best_move;
     int8_t new_depth;
     legal_info_t linfo;
-    uint8_t can_futility;
+    uint8_t can_futility, can_lmp;
+    int8_t reduction;
+    uint16_t prev_key = PIECE_TO_NONE;
     PROF_VARS;
 
     if (search_stopped) return 0;
-    search_nodes++;
+    st.search_nodes++;
+    if (ply < SEARCH_PV_MAX) st.pv_len[ply] = 0;
+    if (ply > st.seldepth) st.seldepth = ply;
 
     check_time();
     if (search_stopped) return 0;
@@ -768,6 +1193,13 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
     if (ply > 0 && (is_repetition(b->hash) || b->halfmove >= 100))
         return SCORE_DRAW;
 
+    /* Exact result from an endgame bitbase (the root must still pick
+       a move) */
+    if (ply > 0 &&
+        b->piece_count[WHITE] + b->piece_count[BLACK] <= BITBASE_MAX_MEN &&
+        bitbase_probe(b, &score))
+        return score;
+
     /* Quiescence at leaf */
     if (depth <= 0)
         return quiescence(b, alpha, beta, ply, 0);
@@ -775,6 +1207,10 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
     if (ply >= MAX_PLY || stack_low())
         return evaluate(b);
 
+#if defined(COUNTER_MOVES) || defined(CONT_HISTORY)
+    if (ply > 0) prev_key = st.ply_key[ply - 1];
+#endif
+
     /* Compute check info and apply check extension BEFORE TT probe,
        so the TT depth comparison uses the effective (extended) depth.
        Without this, check extensions inflate stored TT depths, causing
@@ -797,7 +1233,9 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
         else if (tt_score < -SCORE_MATE + MAX_PLY)
             tt_score += ply;
 
-        if (tt_depth >= depth) {
+        /* Never cut at the root: it must pick a move (and Lazy SMP helpers
+           may already have stored a deeper root entry) */
+        if (tt_depth >= depth && ply > 0 && beta - alpha == 1) {
             if (tt_flag == TT_EXACT) { PROF_E(tt_cy); PROF_C(tt_cnt); return tt_score; }
             if (tt_flag == TT_BETA && tt_score >= beta) { PROF_E(tt_cy); PROF_C(tt_cnt); return beta; }
             if (tt_flag == TT_ALPHA && tt_score <= alpha) { PROF_E(tt_cy); PROF_C(tt_cnt); return alpha; }
@@ -814,11 +1252,14 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
         int static_eval;
         int futility_margin = (depth == 1) ? 200 : 500;
         PROF_B();
-        static_eval = evaluate(b);
+        static_eval = evaluate_bounded(b, alpha - futility_margin,
+                                       alpha - futility_margin + 1);
         PROF_E(eval_cy); PROF_C(eval_cnt);
         if (static_eval + futility_margin <= alpha)
             can_futility = 1;
     }
+    can_lmp = !in_check && depth <= LMP_MAX_DEPTH && ply > 0 &&
+              beta - alpha == 1;
 
     /* Null move pruning */
     if (do_null && !in_check && depth >= 3 && ply > 0) {
@@ -848,6 +1289,9 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
             }
             b->ep_square = SQ_NONE;
             search_history_push(b->hash);
+#if defined(COUNTER_MOVES) || defined(CONT_HISTORY)
+            st.ply_key[ply] = PIECE_TO_NONE;
+#endif
             PROF_E(null_move_cy);
 
             score = -negamax(b, depth - 1 - 2, -beta, -beta + 1, ply + 1, 0, ext);
@@ -874,30 +1318,104 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
     legal_moves = 0;
     cutoff = 0;
 
-    /* Staged generation: captures first, then quiets. */
-    for (stage = 0; stage < 2 && !cutoff; stage++) {
-        uint8_t mode = (stage == 0) ? GEN_CAPTURES : GEN_QUIETS;
+    /* Staged move picker.  The TT move and the killers are verified
+       against the moving piece's own moves and searched before any
+       full generation; captures come next (losing ones are held back
+       in the pool), then quiets, generated only if no cutoff came
+       earlier, then the deferred losing captures. */
+    node_base = st.move_sp;
+    bad_base = 0;
+    bad_start = 0;
+    bad_count = 0;
+    tried_count = 0;
+    at_root = (ply == 0 && st.root_list_count > 0);
+    for (stage = STAGE_TT; stage < STAGE_DONE && !cutoff; stage++) {
+        base = st.move_sp;
+        if (base + MAX_MOVES > MOVE_POOL_SIZE) { st.move_sp = node_base; return evaluate(b); }
+        list = &st.pool[base];
+        gen = pool_scratch(base);
+        count = 0;
+        sorted = 0;
+        i = 0;
+
+        if (at_root) {
+            /* Root: walk the pre-ordered legal move list in place */
+            if (stage > STAGE_TT) break;
+            count = st.root_list_count;
+        } else if (stage == STAGE_TT) {
+            if (tt_move.from == SQ_NONE) continue;
+            PROF_B();
+            if (find_piece_move(b, tt_move, gen, &tried[0])) {
+                list[0].move = tried[0];
+                list[0].score = SCORE_TT_MOVE;
+                count = tried_count = 1;
+            }
+            PROF_E(movegen_cy);
+            st.move_sp = base + count;
+        } else if (stage == STAGE_KILLERS) {
+            uint8_t k;
+            if (ply >= MAX_PLY) continue;
+            PROF_B();
+            for (k = 0; k < 2; k++) {
+                move_t km = st.killers[ply][k];
+                move_t found;
+                if (km.from == SQ_NONE || (km.flags & FLAG_CAPTURE)) continue;
+                if (tried_count && MOVE_EQ(km, tried[0])) continue;
+                if (!find_piece_move(b, km, gen, &found) || !MOVE_EQ(found, km))
+                    continue;
+                list[count].move = km;
+                list[count].score = k ? SCORE_KILLER_2 : SCORE_KILLER_1;
+                count++;
+                tried[tried_count++] = km;
+            }
+            PROF_E(movegen_cy);
+            st.move_sp = base + count;
+        } else if (stage == STAGE_BAD_CAPTURES) {
+            if (bad_start >= bad_count) break;
+            base = bad_base;
+            list = &st.pool[base];
+            count = bad_count;
+            i = bad_start;
+        } else {
+            uint8_t mode = (stage == STAGE_CAPTURES) ? GEN_CAPTURES : GEN_QUIETS;
 
-        base = move_sp;
-        if (base + MAX_MOVES > MOVE_POOL_SIZE) return evaluate(b);
-        PROF_B();
-        count = generate_moves(b, &pool_moves[base], mode);
-        PROF_E(movegen_cy); PROF_C(movegen_cnt);
-        moves = &pool_moves[base];
-        scores = &pool_scores[base];
-        move_sp = base + count;
-        PROF_B();
-        score_moves(b, moves, scores, count, ply, tt_move);
-        PROF_E(moveorder_cy);
+            PROF_B();
+            count = generate_moves(b, gen, mode);
+            count = drop_tried(gen, count, tried, tried_count);
+            PROF_E(movegen_cy); PROF_C(movegen_cnt);
+            st.move_sp = base + count;
+            PROF_B();
+            score_moves(b, gen, list, count, ply, MOVE_NONE, prev_key);
+            /* Captures are searched in sorted order; quiets are picked
+               lazily since most nodes cut within the first few */
+            if (stage == STAGE_CAPTURES)
+                sorted = sort_good_moves(list, count);
+            PROF_E(moveorder_cy);
+        }
 
-        for (i = 0; i < count; i++) {
+        for (; i < count; i++) {
             move_t m;
             uint8_t need_legality_check;
+            uint32_t nodes_before = st.search_nodes;
 
-            PROF_B();
-            pick_move(moves, scores, count, i);
-            PROF_E(moveorder_cy);
-            m = moves[i];
+            if (at_root) {
+                m = st.root_list[i];
+            } else {
+                if (i >= sorted) {
+                    PROF_B();
+                    pick_move(list, count, i);
+                    PROF_E(moveorder_cy);
+                }
+                m = list[i].move;
+            }
+
+            /* Defer losing captures until after the quiets */
+            if (!at_root && stage == STAGE_CAPTURES && i >= sorted) {
+                bad_base = base;
+                bad_start = i;
+                bad_count = count;
+                break;
+            }
             if (!is_evasion_candidate(b, &linfo, m))
                 continue;
 
@@ -907,6 +1425,13 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
                 !(m.flags & (FLAG_CAPTURE | FLAG_PROMOTION)))
                 continue;
 
+            /* Late move pruning: enough quiets have been tried here,
+               unless every line so far loses to mate */
+            if (can_lmp && legal_moves >= lmp_count[depth] &&
+                best_score > -SCORE_MATE + MAX_PLY &&
+                !(m.flags & (FLAG_CAPTURE | FLAG_PROMOTION)))
+                continue;
+
             need_legality_check = move_needs_legality_check(b, &linfo, m);
 
             PROF_B();
@@ -925,12 +1450,15 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
             }
             PROF_C(make_cnt);
             legal_moves++;
+#if defined(COUNTER_MOVES) || defined(CONT_HISTORY)
+            st.ply_key[ply] = piece_to_key(b->squares[m.to], m.to);
+#endif
 
             /* Save first legal root move as fallback in case the search
                times out before any move is fully evaluated (can happen
                on slow hardware when check extensions deepen the tree) */
-            if (ply == 0 && search_best_root_move.from == SQ_NONE)
-                search_best_root_move = m;
+            if (ply == 0 && st.search_best_root_move.from == SQ_NONE)
+                st.search_best_root_move = m;
 
             /* Record position for repetition detection */
             search_history_push(b->hash);
@@ -949,12 +1477,19 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
                 /* First move: full window */
                 score = -negamax(b, new_depth, -beta, -alpha, ply + 1, 1, ext);
                 got_accurate = 1;
-            } else if (!in_check && legal_moves > 4 && depth >= 3 &&
-                       !(m.flags & FLAG_CAPTURE) && !(m.flags & FLAG_PROMOTION)) {
+            } else if ((reduction = (!in_check && legal_moves > 4 && depth >= 3 &&
+                                     !(m.flags & (FLAG_CAPTURE | FLAG_PROMOTION)))
+                        ? lmr_reduction(depth, legal_moves, beta - alpha > 1,
+                                        stage == STAGE_KILLERS,
+                                        st.history[b->side ^ 1][m.to])
+                        : 0) > 0) {
                 /* LMR: reduced search, wider window at root for variance */
-                score = -negamax(b, new_depth - 1, -alpha - 1, -pvs_floor, ply + 1, 1, ext);
-                /* Re-search at full depth + full window if it beats alpha */
-                if (score > alpha && !search_stopped) {
+                score = -negamax(b, new_depth - reduction, -alpha - 1, -pvs_floor, ply + 1, 1, ext);
+                /* Verify at full depth if it beats alpha, then with the
+                   full window if it still lands inside it */
+                if (score > alpha && !search_stopped)
+                    score = -negamax(b, new_depth, -alpha - 1, -pvs_floor, ply + 1, 1, ext);
+                if (score > alpha && score < beta && !search_stopped) {
                     score = -negamax(b, new_depth, -beta, -alpha, ply + 1, 1, ext);
                     got_accurate = 1;
                 } else if (score > pvs_floor) {
@@ -977,7 +1512,10 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
             board_unmake(b, m, &undo);
             PROF_E(make_unmake_cy);
 
-            if (search_stopped) { move_sp = base; return 0; }
+            if (at_root)
+                st.root_list_nodes[i] = st.search_nodes - nodes_before;
+
+            if (search_stopped) { st.move_sp = node_base; return 0; }
 
             /* Add random noise at root for weaker play */
             if (ply == 0 && search_eval_noise)
@@ -987,11 +1525,11 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
                Only record moves with accurate scores (first move or
                PVS/LMR re-search).  Null-window fail-lows return alpha
                for ANY worse move, making them look equal to the best. */
-            if (ply == 0 && search_move_variance && root_count_pending < MAX_ROOT_CANDIDATES
+            if (ply == 0 && search_move_variance && st.root_count_pending < MAX_ROOT_CANDIDATES
                 && got_accurate) {
-                root_moves_pending[root_count_pending] = m;
-                root_scores_pending[root_count_pending] = (int16_t)score;
-                root_count_pending++;
+                st.root_moves_pending[st.root_count_pending] = m;
+                st.root_scores_pending[st.root_count_pending] = (int16_t)score;
+                st.root_count_pending++;
             }
             }
 
@@ -1000,11 +1538,12 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
                 best_move = m;
 
                 if (ply == 0)
-                    search_best_root_move = m;
+                    st.search_best_root_move = m;
 
                 if (score > alpha) {
                     alpha = score;
                     best_flag = TT_EXACT;
+                    update_pv(ply, m);
 
                     if (alpha >= beta) {
                         best_flag = TT_BETA;
@@ -1013,6 +1552,9 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
                         if (!(m.flags & FLAG_CAPTURE)) {
                             update_killers(ply, m);
                             update_history(b->side, m, depth);
+#if defined(COUNTER_MOVES) || defined(CONT_HISTORY)
+                            update_followup(b, prev_key, m, depth);
+#endif
                         }
                         cutoff = 1;
                         break;
@@ -1021,8 +1563,11 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
             }
         }
 
-        move_sp = base;
+        /* Keep the deferred losing captures reserved for their stage */
+        if (stage != STAGE_CAPTURES || !bad_count)
+            st.move_sp = base;
     }
+    st.move_sp = node_base;
 
     /* Checkmate or stalemate */
     if (legal_moves == 0) {
@@ -1050,14 +1595,229 @@ static int negamax(board_t *b, int8_t depth, int alpha, int beta,
     return best_score;
 }
 
+/* ========== Root Move List ========== */
+
+/* Fill root_list with the legal moves of b, ordered by the usual move
+   scores (TT move, captures, st.killers, st.history) for the first iteration. */
+static void root_list_init(board_t *b)
+{
+    /* Scratch space: the pool is empty between iterations */
+    scored_move_t *list = st.pool;
+    uint8_t count, i, j;
+    undo_t undo;
+    move_t tt_move = MOVE_NONE;
+    tt_move16_t tt_packed;
+    int tt_score;
+    int8_t tt_depth;
+    uint8_t tt_flag;
+
+    if (tt_probe(b->hash, b->lock, &tt_score, &tt_packed, &tt_depth, &tt_flag) &&
+        tt_packed != TT_MOVE_NONE)
+        tt_move = tt_unpack_move(tt_packed);
+
+    count = generate_moves(b, pool_scratch(0), GEN_ALL);
+    score_moves(b, pool_scratch(0), list, count, 0, tt_move, PIECE_TO_NONE);
+
+    st.root_list_count = 0;
+    for (i = 0; i < count; i++) {
+        move_t m = list[i].move;
+        int16_t sc = list[i].score;
+        board_make(b, m, &undo);
+        if (board_is_legal(b)) {
+            /* Insertion sort, highest score first; list[0..i] is free
+               to hold the sorted scores */
+            j = st.root_list_count++;
+            while (j > 0 && list[j - 1].score < sc) {
+                st.root_list[j] = st.root_list[j - 1];
+                list[j].score = list[j - 1].score;
+                j--;
+            }
+            st.root_list[j] = m;
+            list[j].score = sc;
+        }
+        board_unmake(b, m, &undo);
+    }
+    for (i = 0; i < st.root_list_count; i++)
+        st.root_list_nodes[i] = 0;
+}
+
+/* Reorder root_list after an iteration (or an aspiration fail-high).
+   Among equally scored moves the larger subtree goes first: it came
+   closer to being best. */
+static void root_list_sort(board_t *b, move_t best)
+{
+    scored_move_t *list = st.pool;
+    uint8_t i, j;
+
+    /* Fresh ordering scores: picks up killers and history from the
+       iteration just finished; the best move outranks everything. */
+    score_moves(b, st.root_list, list, st.root_list_count, 0, best, PIECE_TO_NONE);
+
+    for (i = 1; i < st.root_list_count; i++) {
+        move_t m = st.root_list[i];
+        uint32_t n = st.root_list_nodes[i];
+        int16_t sc = list[i].score;
+        for (j = i; j > 0 && (list[j - 1].score < sc ||
+                              (list[j - 1].score == sc && st.root_list_nodes[j - 1] < n)); j--) {
+            st.root_list[j] = st.root_list[j - 1];
+            st.root_list_nodes[j] = st.root_list_nodes[j - 1];
+            list[j].score = list[j - 1].score;
+        }
+        st.root_list[j] = m;
+        st.root_list_nodes[j] = n;
+        list[j].score = sc;
+    }
+}
+
 /* ========== Iterative Deepening ========== */
 
+/* ========== Lazy SMP ========== */
+
+#ifdef SEARCH_THREADS
+
+typedef struct {
+    pthread_t tid;
+    board_t   board;       /* private copy of the root position */
+    const search_thread_t *main;
+    uint8_t   id;
+    uint8_t   max_depth;
+    volatile uint32_t nodes;  /* published after each iteration */
+} search_helper_t;
+
+static uint8_t search_threads = 1;
+static search_helper_t helpers[SEARCH_MAX_THREADS - 1];
+static uint8_t helper_count;   /* helpers running in this search */
+
+/* Helper thread: plain iterative deepening on its own board with
+   full-width windows, sharing only the TT and search_stopped with the
+   main thread.  Odd helpers start one ply deeper so the threads spread
+   over different depths instead of duplicating work. */
+static void *helper_main(void *arg)
+{
+    search_helper_t *h = (search_helper_t *)arg;
+    int8_t d;
+
+    st.helper = 1;
+    st.search_nodes = 0;
+    st.move_sp = 0;
+    memcpy(st.pos_history, h->main->pos_history, sizeof(st.pos_history));
+    st.pos_history_count = h->main->pos_history_count;
+    st.pos_history_irreversible = h->main->pos_history_irreversible;
+    st.search_rng_state = h->board.hash ^ (0x9E37u * (h->id + 1));
+
+    root_list_init(&h->board);
+    for (d = 1 + (h->id & 1); d <= (int8_t)h->max_depth && !search_stopped; d++) {
+        negamax(&h->board, d, -SCORE_INF, SCORE_INF, 0, 1, 0);
+        h->nodes = st.search_nodes;
+    }
+
+    h->nodes = st.search_nodes;
+    return 0;
+}
+
+uint8_t search_set_threads(uint8_t n)
+{
+    if (n < 1) n = 1;
+    if (n > SEARCH_MAX_THREADS) n = SEARCH_MAX_THREADS;
+    search_threads = n;
+    return n;
+}
+
+#else
+
+uint8_t search_set_threads(uint8_t n)
+{
+    (void)n;
+    return 1;
+}
+
+#endif /* SEARCH_THREADS */
+
+/* Scratch copy of the root for extend_pv(): make/unmake would reorder
+   the root's piece lists, and with them the next iteration's moves */
+static board_t pv_board;
+
+/* TT cutoffs at PV nodes leave the line short: walk it from root, then
+   follow the TT's best moves while they are legal and the line does
+   not repeat.  Returns the new length. */
+static uint8_t extend_pv(const board_t *root, move_t *pv, uint8_t n)
+{
+    board_t *b = &pv_board;
+    move_t *scratch = (move_t *)&st.pool[st.move_sp];
+    undo_t undo;
+    uint8_t made = 0;
+    int score;
+    tt_move16_t packed;
+    int8_t depth;
+    uint8_t flag;
+
+    *b = *root;
+    for (;;) {
+        move_t m;
+        if (made == n) {
+            if (n >= SEARCH_PV_MAX || is_repetition(b->hash) ||
+                !tt_probe(b->hash, b->lock, &score, &packed, &depth, &flag) ||
+                packed == TT_MOVE_NONE ||
+                !find_piece_move(b, tt_unpack_move(packed), scratch, &m))
+                break;
+            board_make(b, m, &undo);
+            if (!board_is_legal(b))
+                break;
+            pv[n++] = m;
+        } else {
+            board_make(b, pv[made], &undo);
+        }
+        search_history_push(b->hash);
+        made++;
+    }
+    while (made--)
+        search_history_pop();
+    return n;
+}
+
+/* Keep the PV of a completed iteration and hand it to the info callback */
+static void report_iteration(const board_t *b, const search_result_t *r,
+                             uint32_t go_start)
+{
+    search_info_t info;
+    uint8_t n = 0;
+
+    n = st.pv_len[0];
+    if (n && MOVE_EQ(st.pv[0][0], r->best_move)) {
+        memcpy(search_last_pv, st.pv[0], n * sizeof(move_t));
+    } else {
+        /* No root PV (the best move never raised alpha): the move alone */
+        search_last_pv[0] = r->best_move;
+        n = 1;
+    }
+    search_last_pv_len = extend_pv(b, search_last_pv, n);
+
+    if (!search_info) return;
+    info.depth = r->depth;
+    info.seldepth = st.seldepth;
+    info.score = r->score;
+    info.nodes = st.search_nodes;
+#ifdef SEARCH_THREADS
+    {
+        uint8_t h;
+        for (h = 0; h < helper_count; h++)
+            info.nodes += helpers[h].nodes;
+    }
+#endif
+    info.time_ms = search_time_fn ? search_time_fn() - go_start : 0;
+    info.hashfull = tt_hashfull();
+    info.pv = search_last_pv;
+    info.pv_len = search_last_pv_len;
+    search_info(&info);
+}
+
 search_result_t search_go(board_t *b, const search_limits_t *limits)
 {
     search_result_t result;
     uint8_t max_depth;
     int8_t d;
     int score;
+    uint32_t go_start;
 
     /* Set stack floor from OS stack limit register (eZ80 only) */
 #ifdef __ez80__
@@ -1068,22 +1828,37 @@ search_result_t search_go(board_t *b, const search_limits_t *limits)
 #endif
 
     /* Reset search state */
-    search_nodes = 0;
+    st.search_nodes = 0;
     search_stopped = 0;
-    search_best_root_move = MOVE_NONE;
+    st.search_best_root_move = MOVE_NONE;
     /* Root candidates are position-specific: never carry across searches. */
-    root_count = 0;
-    root_count_pending = 0;
-    move_sp = 0;
+    st.root_count = 0;
+    st.root_count_pending = 0;
+    st.move_sp = 0;
+    /* A resumed ponder slice (or its ponder hit) is the same search:
+       keep its generation so the entries it stored are not aged */
+    if (!search_continue_armed || search_gen_hash != b->hash ||
+        search_gen_lock != b->lock) {
+        tt_new_search();
+        search_gen_hash = b->hash;
+        search_gen_lock = b->lock;
+    }
 
     /* Time management */
     search_time_fn = limits->time_fn;
+    search_start = search_time_fn ? search_time_fn() : 0;
+    go_start = search_start;
     if (limits->max_time_ms && search_time_fn) {
-        search_deadline = search_time_fn() + limits->max_time_ms;
+        search_deadline = search_start + limits->max_time_ms;
     } else {
         search_deadline = 0;
     }
+    search_tm.soft_ms = limits->soft_time_ms;
+    search_tm.hard_ms = limits->max_time_ms;
+    search_tm.last_iter_ms = 0;
+    search_tm.stable = 0;
     search_max_nodes = limits->max_nodes;
+    search_poll_next = search_time_fn ? search_time_fn() + search_poll_ms : 0;
 
     /* Node-based timer fallback (eZ80 only): if the hardware timer fails
        (returns 0 forever), this hard cap stops the search at roughly the
@@ -1097,40 +1872,92 @@ search_result_t search_go(board_t *b, const search_limits_t *limits)
 #endif
     search_eval_noise = limits->eval_noise;
     search_move_variance = limits->move_variance;
-    search_rng_state = b->hash ^ 0xDEAD;
+    st.search_rng_state = b->hash ^ 0xDEAD;
     if (search_time_fn)
-        search_rng_state ^= search_time_fn();
+        st.search_rng_state ^= search_time_fn();
 
     max_depth = limits->max_depth;
     if (max_depth == 0 && limits->max_time_ms == 0 && limits->max_nodes == 0) max_depth = 1;
-    if (max_depth == 0) max_depth = MAX_PLY - 1;
+    if (max_depth == 0 || max_depth > MAX_PLY - 1) max_depth = MAX_PLY - 1;
 
     result.best_move = MOVE_NONE;
     result.score = 0;
     result.depth = 0;
     result.nodes = 0;
 
-    for (d = 1; d <= (int8_t)max_depth; d++) {
-        int asp_alpha, asp_beta;
-        search_best_root_move = MOVE_NONE;
-        root_count_pending = 0;
+    root_list_init(b);
+
+    /* Ponder hit: resume after the last iteration the earlier search
+       of this position completed, instead of starting over at depth 1 */
+    d = 1;
+    if (search_continue_armed && search_last.depth &&
+        search_last_hash == b->hash && search_last_lock == b->lock) {
+        result = search_last;
+        result.nodes = 0;
+        root_list_sort(b, result.best_move);
+        d = (int8_t)(result.depth + 1);
+    }
+    search_continue_armed = 0;
 
-        /* Aspiration windows: narrow search around previous score */
-        if (d > 1 && result.best_move.from != SQ_NONE) {
-            asp_alpha = result.score - 25;
-            asp_beta  = result.score + 25;
+#ifdef SEARCH_THREADS
+    {
+        uint8_t h;
+        for (h = 0; h + 1 < search_threads; h++) {
+            helpers[h].board = *b;
+            helpers[h].main = &st;
+            helpers[h].id = h;
+            helpers[h].max_depth = max_depth;
+            helpers[h].nodes = 0;
+            if (pthread_create(&helpers[h].tid, 0, helper_main, &helpers[h]) != 0)
+                break;
+        }
+        helper_count = h;
+    }
+#endif
+
+    for (; d <= (int8_t)max_depth; d++) {
+        int asp_alpha, asp_beta;
+        int delta = ASP_WINDOW;
+        uint32_t iter_start = search_time_fn ? search_time_fn() : 0;
+        st.search_best_root_move = MOVE_NONE;
+        st.root_count_pending = 0;
+        st.seldepth = 0;
+
+        /* Aspiration windows: narrow search around previous score.
+           With move_variance the lower edge also covers the candidate
+           band, so near-best root moves still get accurate scores. */
+        if (d > 1 && result.best_move.from != SQ_NONE &&
+            result.score > -SCORE_MATE + MAX_PLY &&
+            result.score < SCORE_MATE - MAX_PLY) {
+            asp_alpha = result.score - delta - search_move_variance;
+            asp_beta  = result.score + delta;
         } else {
             asp_alpha = -SCORE_INF;
             asp_beta  =  SCORE_INF;
         }
 
-        score = negamax(b, d, asp_alpha, asp_beta, 0, 1, 0);
+        /* Widen the failing side and re-search until the score lands
+           inside the window (or the window has gone full width). */
+        for (;;) {
+            score = negamax(b, d, asp_alpha, asp_beta, 0, 1, 0);
+            if (search_stopped) break;
+
+            if (score <= asp_alpha && asp_alpha > -SCORE_INF) {
+                delta += delta;
+                asp_alpha = score - delta - search_move_variance;
+            } else if (score >= asp_beta && asp_beta < SCORE_INF) {
+                delta += delta;
+                asp_beta = score + delta;
+                /* Search the move that failed high first */
+                root_list_sort(b, st.search_best_root_move);
+            } else {
+                break;
+            }
+            if (delta > ASP_MAX_WINDOW || asp_alpha < -SCORE_INF) asp_alpha = -SCORE_INF;
+            if (delta > ASP_MAX_WINDOW || asp_beta > SCORE_INF) asp_beta = SCORE_INF;
 
-        /* Re-search with full window on fail */
-        if (!search_stopped && (score <= asp_alpha || score >= asp_beta)) {
-            search_best_root_move = MOVE_NONE;
-            root_count_pending = 0;
-            score = negamax(b, d, -SCORE_INF, SCORE_INF, 0, 1, 0);
+            st.search_best_root_move = MOVE_NONE;
+            st.root_count_pending = 0;
         }
 
         if (search_stopped) {
@@ -1138,7 +1965,7 @@ search_result_t search_go(board_t *b, const search_limits_t *limits)
                when check extensions deepen the tree on slow hardware),
                extend the deadline and continue the current iteration. */
             if (result.best_move.from == SQ_NONE &&
-                search_best_root_move.from == SQ_NONE &&
+                st.search_best_root_move.from == SQ_NONE &&
                 search_deadline && search_time_fn) {
                 search_deadline = search_time_fn() + 5000;
                 search_stopped = 0;
@@ -1149,56 +1976,86 @@ search_result_t search_go(board_t *b, const search_limits_t *limits)
         }
 
         /* Completed iteration — save result and commit root candidates */
-        if (search_best_root_move.from != SQ_NONE) {
+        if (st.search_best_root_move.from != SQ_NONE) {
             uint8_t ci;
-            result.best_move = search_best_root_move;
+            uint8_t changed = !MOVE_EQ(st.search_best_root_move, result.best_move);
+            result.best_move = st.search_best_root_move;
             result.score = score;
             result.depth = (uint8_t)d;
-            result.nodes = search_nodes;
-            root_count = root_count_pending;
-            for (ci = 0; ci < root_count; ci++) {
-                root_moves[ci] = root_moves_pending[ci];
-                root_scores[ci] = root_scores_pending[ci];
+            result.nodes = st.search_nodes;
+            root_list_sort(b, st.search_best_root_move);
+            st.root_count = st.root_count_pending;
+            for (ci = 0; ci < st.root_count; ci++) {
+                st.root_moves[ci] = st.root_moves_pending[ci];
+                st.root_scores[ci] = st.root_scores_pending[ci];
+            }
+            report_iteration(b, &result, go_start);
+
+            /* Time manager: stop on a spent soft limit or before an
+               iteration that can't finish in time */
+            if (search_time_fn) {
+                uint32_t now = search_time_fn();
+                if (!tm_next_iteration(&search_tm, now - search_start,
+                                       now - iter_start, changed))
+                    break;
             }
         }
     }
 
     /* If no completed iteration, try to return any move found */
-    if (result.best_move.from == SQ_NONE && search_best_root_move.from != SQ_NONE) {
-        result.best_move = search_best_root_move;
+    if (result.best_move.from == SQ_NONE && st.search_best_root_move.from != SQ_NONE) {
+        result.best_move = st.search_best_root_move;
         result.score = 0;
         result.depth = 0;
-        result.nodes = search_nodes;
+        result.nodes = st.search_nodes;
+    }
+
+#ifdef SEARCH_THREADS
+    /* Stop and collect the helpers; their nodes count toward the total */
+    {
+        uint8_t h;
+        search_stopped = 1;
+        for (h = 0; h < helper_count; h++) {
+            pthread_join(helpers[h].tid, 0);
+            result.nodes += helpers[h].nodes;
+        }
+    }
+#endif
+
+    if (result.depth) {
+        search_last = result;
+        search_last_hash = b->hash;
+        search_last_lock = b->lock;
     }
 
     /* Move variance: pick randomly among root moves within threshold of best */
-    if (search_move_variance && root_count > 1) {
+    if (search_move_variance && st.root_count > 1) {
         int16_t best = -30000;
         uint8_t i, n_candidates = 0;
         int16_t threshold;
 
-        for (i = 0; i < root_count; i++)
-            if (root_scores[i] > best) best = root_scores[i];
+        for (i = 0; i < st.root_count; i++)
+            if (st.root_scores[i] > best) best = st.root_scores[i];
 
         threshold = best - (int16_t)search_move_variance;
 
         /* Count candidates within threshold */
-        for (i = 0; i < root_count; i++)
-            if (root_scores[i] >= threshold) n_candidates++;
+        for (i = 0; i < st.root_count; i++)
+            if (st.root_scores[i] >= threshold) n_candidates++;
 
         if (n_candidates > 1) {
-            uint32_t x = search_rng_state;
+            uint32_t x = st.search_rng_state;
             uint8_t pick;
             x ^= x << 13; x ^= x >> 17; x ^= x << 5;
-            search_rng_state = x;
+            st.search_rng_state = x;
             pick = (uint8_t)(x % n_candidates);
 
             n_candidates = 0;
-            for (i = 0; i < root_count; i++) {
-                if (root_scores[i] >= threshold) {
+            for (i = 0; i < st.root_count; i++) {
+                if (st.root_scores[i] >= threshold) {
                     if (n_candidates == pick) {
-                        result.best_move = root_moves[i];
-                        result.score = root_scores[i];
+                        result.best_move = st.root_moves[i];
+                        result.score = st.root_scores[i];
                         break;
                     }
                     n_candidates++;
@@ -1213,9 +2070,9 @@ search_result_t search_go(board_t *b, const search_limits_t *limits)
 void search_get_root_candidates(move_t *moves, int16_t *scores, uint8_t *count)
 {
     uint8_t i;
-    *count = root_count;
-    for (i = 0; i < root_count; i++) {
-        moves[i] = root_moves[i];
-        scores[i] = root_scores[i];
+    *count = st.root_count;
+    for (i = 0; i < st.root_count; i++) {
+        moves[i] = st.root_moves[i];
+        scores[i] = st.root_scores[i];
     }
 }
@@ -6,6 +6,9 @@
 /* Time management callback */
 typedef uint32_t (*time_ms_fn)(void);
 
+/* In-search poll callback: return nonzero to stop ("move now") */
+typedef uint8_t (*search_poll_fn)(void);
+
 /* Search result */
 typedef struct {
     move_t best_move;
@@ -17,21 +20,88 @@ typedef struct {
 /* Search limits */
 typedef struct {
     uint8_t  max_depth;   /* 0 = no limit */
-    uint32_t max_time_ms; /* 0 = no limit */
+    uint32_t max_time_ms; /* hard limit, 0 = none */
+    uint32_t soft_time_ms;/* no new iteration past this, 0 = none (timeman.h) */
     uint32_t max_nodes;   /* 0 = no limit */
     time_ms_fn time_fn;   /* NULL = no time checks */
     int      eval_noise;  /* random noise +-N added to root scores (0 = off) */
     int      move_variance; /* pick randomly among root moves within N cp of best (0 = off) */
 } search_limits_t;
 
+/* Longest principal variation kept.  The calculator keeps a short one
+   to save RAM: the PV table is SEARCH_PV_MAX^2 moves. */
+#ifndef SEARCH_PV_MAX
+#ifdef __ez80__
+#define SEARCH_PV_MAX 16
+#else
+#define SEARCH_PV_MAX MAX_PLY
+#endif
+#endif
+
+/* Progress of a running search, reported after each completed
+   iteration */
+typedef struct {
+    uint8_t  depth;
+    uint8_t  seldepth;   /* deepest ply reached, quiescence included */
+    int      score;      /* side to move, SCORE_MATE - plies for mates */
+    uint32_t nodes;      /* all threads */
+    uint32_t time_ms;    /* since search_go() started */
+    uint16_t hashfull;   /* permille of the TT written by this search */
+    const move_t *pv;    /* principal variation, pv[0] = best move */
+    uint8_t  pv_len;
+} search_info_t;
+
+typedef void (*search_info_fn)(const search_info_t *info);
+
+/* Lazy SMP thread cap (desktop SEARCH_THREADS builds) */
+#ifndef SEARCH_MAX_THREADS
+#define SEARCH_MAX_THREADS 64
+#endif
+
 /* Initialize search state (call once at startup or new game) */
 void search_init(void);
 
+/* search_init() without clearing the transposition table: history,
+   killers and the position history only */
+void search_reset(void);
+
 /* Run iterative deepening search.
    Returns the best move and associated info.
    The board position is restored after search. */
 search_result_t search_go(board_t *b, const search_limits_t *limits);
 
+/* Number of search threads for later search_go() calls (main thread
+   included).  Helpers share the TT and stop with the main thread.
+   Returns the count in effect: always 1 without SEARCH_THREADS. */
+uint8_t search_set_threads(uint8_t n);
+
+/* Call fn about every interval_ms while search_go() runs (NULL = off),
+   so a single-threaded UI can draw frames and read keys during a long
+   think.  A nonzero return stops the search; search_go() then returns
+   the best move of the last completed iteration.  The board is in use
+   by the search and must not be touched from the callback. */
+void search_set_poll(search_poll_fn fn, uint16_t interval_ms);
+
+/* Call fn after every completed iteration of search_go() (NULL = off),
+   e.g. for UCI "info" lines.  Runs on the searching thread; the board
+   is in use and must not be touched. */
+void search_set_info(search_info_fn fn);
+
+/* Principal variation of the deepest completed iteration of the last
+   search, if that search was of position b.  Copies up to max moves
+   and returns how many (0 if b was not searched last). */
+uint8_t search_get_pv(const board_t *b, move_t *pv, uint8_t max);
+
+/* Re-arm the soft and hard time limits of the running search, counted
+   from now (0 = none).  Meant for the poll callback, e.g. on a UCI
+   ponderhit. */
+void search_set_time_limit(uint32_t soft_time_ms, uint32_t max_time_ms);
+
+/* Have the next search_go() continue from the last completed iteration
+   of the previous search if it is of the same position (ponder hit);
+   otherwise it starts from depth 1 as usual. */
+void search_continue_next(void);
+
 /* Position history for repetition detection.
    Must be maintained by the caller across moves. */
 void search_history_push(zhash_t hash);
@@ -0,0 +1,90 @@
+#include "timeman.h"
+
+/* Moves assumed left when the clock has no moves_to_go, and the most
+   a long control is spread over */
+#define TM_DEFAULT_MOVES 30
+#define TM_MAX_MOVES     50
+
+/* Never plan less thinking time than this */
+#define TM_MIN_MS 10
+
+/* Hard limit as a multiple of the soft one, before the clock cap */
+#define TM_HARD_FACTOR 3
+
+/* Without a clock, the soft limit is this share of the nominal time */
+#define TM_TARGET_SOFT_PCT 70
+
+/* Soft limit scaling by how many iterations the best move has held:
+   a fresh change buys extra time, a settled move gives it back */
+static const uint8_t tm_stability_pct[] = { 120, 100, 85, 70, 55 };
+#define TM_STABLE_MAX (sizeof(tm_stability_pct) - 1)
+
+/* Bounds on the predicted growth of the next iteration's time */
+#define TM_GROWTH_MIN     2
+#define TM_GROWTH_MAX     6
+#define TM_GROWTH_DEFAULT 3
+
+void tm_allocate(tm_t *tm, uint32_t time_left, uint32_t increment,
+                 uint16_t moves_to_go, uint32_t move_time,
+                 uint32_t target_time)
+{
+    tm->soft_ms = 0;
+    tm->hard_ms = 0;
+    tm->last_iter_ms = 0;
+    tm->stable = 0;
+
+    if (move_time) {
+        tm->hard_ms = move_time;
+    } else if (time_left) {
+        uint32_t moves = moves_to_go ? moves_to_go : TM_DEFAULT_MOVES;
+        uint32_t reserve, cap;
+
+        if (moves > TM_MAX_MOVES) moves = TM_MAX_MOVES;
+        reserve = (time_left > 2 * TM_OVERHEAD_MS)
+            ? time_left - TM_OVERHEAD_MS : time_left / 2;
+
+        /* Last move before the control may use nearly all of it;
+           otherwise keep two thirds of the clock in hand */
+        cap = (moves == 1) ? reserve - reserve / 10 : reserve / 3;
+
+        tm->soft_ms = reserve / moves + increment / 4 * 3;
+        tm->hard_ms = tm->soft_ms * TM_HARD_FACTOR;
+        if (tm->hard_ms > cap) tm->hard_ms = cap;
+        if (tm->hard_ms < TM_MIN_MS) tm->hard_ms = TM_MIN_MS;
+        if (tm->soft_ms > tm->hard_ms) tm->soft_ms = tm->hard_ms;
+    } else if (target_time) {
+        tm->hard_ms = target_time;
+        tm->soft_ms = target_time * TM_TARGET_SOFT_PCT / 100;
+        if (!tm->soft_ms) tm->soft_ms = 1;
+    }
+}
+
+uint8_t tm_next_iteration(tm_t *tm, uint32_t elapsed_ms, uint32_t iter_ms,
+                          uint8_t best_changed)
+{
+    uint32_t growth = TM_GROWTH_DEFAULT;
+    uint32_t last = tm->last_iter_ms;
+
+    if (best_changed)
+        tm->stable = 0;
+    else if (tm->stable < TM_STABLE_MAX)
+        tm->stable++;
+    tm->last_iter_ms = iter_ms;
+
+    if (tm->soft_ms &&
+        elapsed_ms >= tm->soft_ms * tm_stability_pct[tm->stable] / 100)
+        return 0;
+
+    /* Skip an iteration that would be cut off unfinished: the search
+       only keeps results of completed ones */
+    if (tm->hard_ms) {
+        if (last >= TM_MIN_MS) {
+            growth = iter_ms / last;
+            if (growth < TM_GROWTH_MIN) growth = TM_GROWTH_MIN;
+            if (growth > TM_GROWTH_MAX) growth = TM_GROWTH_MAX;
+        }
+        if (elapsed_ms + iter_ms * growth > tm->hard_ms)
+            return 0;
+    }
+    return 1;
+}
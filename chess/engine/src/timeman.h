@@ -0,0 +1,37 @@
+#ifndef TIMEMAN_H
+#define TIMEMAN_H
+
+#include "types.h"
+
+/* Time budget for one search.  The hard limit is the deadline the
+   search polls for; the soft limit only decides, between iterations,
+   whether to start another one.  Both in ms, 0 = none. */
+typedef struct {
+    uint32_t soft_ms;
+    uint32_t hard_ms;
+    uint32_t last_iter_ms;  /* duration of the previous iteration */
+    uint8_t  stable;        /* iterations the root best move has held */
+} tm_t;
+
+/* Safety margin kept off the clock for move transmission */
+#define TM_OVERHEAD_MS 50
+
+/* Fill in the budget for one move, first match wins:
+     move_time    fixed think time, no soft limit (UCI movetime)
+     time_left    clock with increment and moves_to_go (0 = 30 moves)
+     target_time  no clock: nominal time, may stop sooner when the
+                  best move is settled (calculator difficulty levels)
+   All zero leaves both limits off. */
+void tm_allocate(tm_t *tm, uint32_t time_left, uint32_t increment,
+                 uint16_t moves_to_go, uint32_t move_time,
+                 uint32_t target_time);
+
+/* Call after each completed iteration with the time since the budget
+   started, the iteration's own duration and whether the root best
+   move changed.  Returns 0 when no further iteration should start:
+   the stability-scaled soft limit is spent, or the next iteration is
+   predicted to run past the hard limit. */
+uint8_t tm_next_iteration(tm_t *tm, uint32_t elapsed_ms, uint32_t iter_ms,
+                          uint8_t best_changed);
+
+#endif /* TIMEMAN_H */
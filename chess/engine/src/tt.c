@@ -1,28 +1,178 @@
 #include "tt.h"
 #include <string.h>
+#ifdef __ez80__
+#include <ti/vars.h>
+#else
+#include <stdlib.h>
+#endif
+
+/* ========== TT Sub-Profiling ========== */
+
+#ifdef SEARCH_PROFILE
+
+static tt_profile_t _tp;
+
+void tt_profile_reset(void) {
+    memset(&_tp, 0, sizeof(_tp));
+}
+
+const tt_profile_t *tt_profile_get(void) {
+    return &_tp;
+}
+
+#define TP_C(f)  (_tp.f++)
+
+#else
+
+#define TP_C(f)
+
+#endif /* SEARCH_PROFILE */
 
 /* ========== Transposition Table ========== */
 
-static tt_entry_t tt[TT_SIZE];
+static tt_entry_t tt_static[TT_SIZE];
+static tt_entry_t *tt = tt_static;
+static zhash_t tt_mask = TT_MASK;   /* bucket count - 1 */
+static uint8_t tt_generation;       /* pre-shifted into TT_GEN_MASK bits */
+#ifndef __ez80__
+static uint8_t tt_isolated;         /* other generations probe as misses */
+#endif
 
 void tt_clear(void)
 {
-    memset(tt, 0, sizeof(tt));
+    memset(tt, 0, ((size_t)tt_mask + 1) * TT_BUCKET_BYTES);
+    tt_generation = 0;
+}
+
+/* ========== Runtime Sizing ========== */
+
+#ifdef __ez80__
+/* Free RAM left untouched for the OS when carving out a table */
+#define TT_RAM_RESERVE 4096
+#else
+/* Cap so the bucket count fits zhash_t and the byte size fits uint32_t */
+#define TT_MAX_BYTES 0x80000000UL
+#endif
+
+/* Try to obtain `bytes` of table storage.  Returns NULL if unavailable. */
+static tt_entry_t *tt_alloc(uint32_t bytes)
+{
+#ifdef __ez80__
+    /* AppVars top out just under 64 KB, which is no larger than the
+       power-of-two tables we already have, so borrow the free RAM gap
+       between the VAT and user variables directly.  It stays valid as
+       long as nothing allocates a RAM variable while we run. */
+    void *base;
+    size_t avail = os_MemChk(&base);
+    if (avail < TT_RAM_RESERVE || bytes > avail - TT_RAM_RESERVE)
+        return NULL;
+    return (tt_entry_t *)base;
+#else
+    return (tt_entry_t *)malloc(bytes);
+#endif
+}
+
+static void tt_release(void)
+{
+#ifndef __ez80__
+    if (tt != tt_static)
+        free(tt);
+#endif
+    tt = tt_static;
+    tt_mask = TT_MASK;
+}
+
+uint32_t tt_resize(uint32_t bytes)
+{
+    uint32_t buckets = 1;
+    uint32_t want;
+    tt_entry_t *mem = NULL;
+
+#ifndef __ez80__
+    if (bytes > TT_MAX_BYTES) bytes = TT_MAX_BYTES;
+#endif
+    want = bytes / TT_BUCKET_BYTES;
+    while (buckets * 2 <= want) buckets <<= 1;
+
+    tt_release();
+    while (buckets > TT_BUCKETS) {
+        mem = tt_alloc(buckets * TT_BUCKET_BYTES);
+        if (mem) break;
+        buckets >>= 1;
+    }
+    if (mem) {
+        tt = mem;
+        tt_mask = (zhash_t)(buckets - 1);
+    }
+
+    tt_clear();
+    return tt_size_bytes();
+}
+
+uint32_t tt_size_bytes(void)
+{
+    return ((uint32_t)tt_mask + 1) * TT_BUCKET_BYTES;
+}
+
+void tt_set_isolated(uint8_t on)
+{
+#ifndef __ez80__
+    tt_isolated = on;
+#else
+    (void)on;
+#endif
+}
+
+void tt_new_search(void)
+{
+    tt_generation = (uint8_t)(tt_generation + TT_GEN_STEP) & TT_GEN_MASK;
+#ifndef __ez80__
+    if (tt_isolated && tt_generation == 0)
+        tt_clear();
+#endif
+}
+
+#define TT_HASHFULL_SAMPLE 1000
+
+uint16_t tt_hashfull(void)
+{
+    uint32_t entries = ((uint32_t)tt_mask + 1) * TT_BUCKET_WAYS;
+    uint16_t n = (entries < TT_HASHFULL_SAMPLE)
+        ? (uint16_t)entries : TT_HASHFULL_SAMPLE;
+    uint16_t i, used = 0;
+
+    for (i = 0; i < n; i++)
+        if ((tt[i].flag & TT_FLAG_MASK) != TT_NONE &&
+            (tt[i].flag & TT_GEN_MASK) == tt_generation)
+            used++;
+    return (uint16_t)((uint32_t)used * 1000 / n);
 }
 
 uint8_t tt_probe(zhash_t hash, uint16_t lock,
                  int *score, tt_move16_t *best_move,
                  int8_t *depth, uint8_t *flag)
 {
-    tt_entry_t *e = &tt[hash & TT_MASK];
-
-    if (e->flag == TT_NONE) return 0;
-    if (e->lock16 != lock) return 0;
+    tt_entry_t *bucket = &tt[(hash & tt_mask) * TT_BUCKET_WAYS];
+    tt_entry_t *e = 0;
+    uint8_t i;
+
+    TP_C(probes);
+    for (i = 0; i < TT_BUCKET_WAYS; i++) {
+        tt_entry_t *c = &bucket[i];
+        if ((c->flag & TT_FLAG_MASK) == TT_NONE) continue;
+        if (c->lock16 != lock) continue;
+#ifndef __ez80__
+        if (tt_isolated && (c->flag & TT_GEN_MASK) != tt_generation) continue;
+#endif
+        if (!e || c->depth > e->depth) e = c;
+    }
+    if (!e) return 0;
+    TP_C(hits);
 
     *score = e->score;
     *best_move = e->best_move;
     *depth = e->depth;
-    *flag = e->flag;
+    *flag = e->flag & TT_FLAG_MASK;
     return 1;
 }
 
@@ -30,13 +180,35 @@ void tt_store(zhash_t hash, uint16_t lock,
               int score, tt_move16_t best_move,
               int8_t depth, uint8_t flag)
 {
-    tt_entry_t *e = &tt[hash & TT_MASK];
+    tt_entry_t *bucket = &tt[(hash & tt_mask) * TT_BUCKET_WAYS];
+    tt_entry_t *deep = &bucket[0];
+    tt_entry_t *e;
+
+    /* Depth-preferred slot takes the store when it is empty, left over
+       from an earlier search, or no deeper than the new result.
+       Otherwise fall through to the always-replace slot. */
+    if ((deep->flag & TT_FLAG_MASK) == TT_NONE ||
+        (deep->flag & TT_GEN_MASK) != tt_generation ||
+        depth >= deep->depth) {
+        e = deep;
+    } else {
+        e = &bucket[1];
+    }
+
+    TP_C(stores);
+#ifdef SEARCH_PROFILE
+    if ((e->flag & TT_FLAG_MASK) != TT_NONE && e->lock16 != lock) {
+        TP_C(replaces);
+        if ((e->flag & TT_GEN_MASK) != tt_generation)
+            TP_C(stale_replaces);
+    }
+#endif
 
     e->lock16 = lock;
     e->score = score;
     e->best_move = best_move;
     e->depth = depth;
-    e->flag = flag;
+    e->flag = flag | tt_generation;
 }
 
 /* ========== Move Packing ========== */
@@ -19,24 +19,67 @@ typedef uint16_t tt_move16_t;
 
 #define TT_MOVE_NONE 0
 
+/* Flag byte layout: bits 0-1 hold the bound (TT_EXACT/ALPHA/BETA),
+   bits 2-7 hold the search generation the entry was written in. */
+#define TT_FLAG_MASK 0x03
+#define TT_GEN_STEP  0x04
+#define TT_GEN_MASK  0xFC
+
 /* TT entry: 8 bytes */
 typedef struct {
     uint16_t lock16;      /* independent 16-bit verification key */
     int16_t  score;       /* evaluation score */
     tt_move16_t best_move;/* packed move */
     int8_t   depth;       /* search depth */
-    uint8_t  flag;        /* TT_EXACT, TT_ALPHA, TT_BETA */
+    uint8_t  flag;        /* bound | generation (see TT_FLAG_MASK) */
 } tt_entry_t;
 
-/* Table size (power of 2) */
+/* Built-in table size in entries (power of 2).  Entries are grouped into
+   buckets of TT_BUCKET_WAYS: slot 0 is depth-preferred, slot 1 is
+   always-replace.  Stale-generation entries are evicted first.
+   tt_resize() can swap in a larger runtime-allocated table. */
 #ifndef TT_SIZE
 #define TT_SIZE  4096
 #endif
-#define TT_MASK  (TT_SIZE - 1)
+#define TT_BUCKET_WAYS 2
+#define TT_BUCKETS     (TT_SIZE / TT_BUCKET_WAYS)
+#define TT_MASK        (TT_BUCKETS - 1)
+#define TT_BUCKET_BYTES (TT_BUCKET_WAYS * sizeof(tt_entry_t))
+
+#if (TT_SIZE & (TT_SIZE - 1)) != 0 || TT_SIZE < TT_BUCKET_WAYS
+#error "TT_SIZE must be a power of 2 and at least TT_BUCKET_WAYS"
+#endif
 
 /* Initialize (clear) the transposition table */
 void tt_clear(void);
 
+/* Resize the table to the largest power-of-two bucket count that fits
+   in `bytes`, then clear it.  0 (or anything no larger than the built-in
+   table) reverts to the static TT_SIZE table.  Larger tables come from
+   malloc on desktop and from free user RAM on the CE; if the request
+   cannot be met it is halved until it fits.  Returns the size in bytes
+   actually in use.  On the CE the caller must not create or grow RAM
+   variables while a free-RAM table is active. */
+uint32_t tt_resize(uint32_t bytes);
+
+/* Current table size in bytes */
+uint32_t tt_size_bytes(void);
+
+/* Isolated mode (desktop tools only): when on, a probe only matches
+   entries of the current generation, so each search sees an empty table
+   without paying for a tt_clear().  The table is still cleared when the
+   generation counter wraps, so entries never alias a later search. */
+void tt_set_isolated(uint8_t on);
+
+/* Advance the generation counter.  Called once per search_go() (but not
+   for a resumed ponder of the same position) so that entries left over
+   from earlier game moves are replaced first. */
+void tt_new_search(void);
+
+/* Share of the table written by the current search, in permille,
+   sampled from the first 1000 entries (UCI "hashfull") */
+uint16_t tt_hashfull(void);
+
 /* Probe the TT. Returns non-zero if entry found and valid.
    On hit, *score, *best_move, *depth, *flag are filled in.
    The caller must adjust mate scores by ply. */
@@ -44,7 +87,9 @@ uint8_t tt_probe(zhash_t hash, uint16_t lock,
                  int *score, tt_move16_t *best_move,
                  int8_t *depth, uint8_t *flag);
 
-/* Store an entry in the TT (always-replace). */
+/* Store an entry in the TT.  Deeper (or current-generation) results
+   take the depth-preferred slot; everything else goes to the
+   always-replace slot. */
 void tt_store(zhash_t hash, uint16_t lock,
               int score, tt_move16_t best_move,
               int8_t depth, uint8_t flag);
@@ -56,4 +101,19 @@ tt_move16_t tt_pack_move(move_t m);
    The caller must verify legality before using the unpacked move. */
 move_t tt_unpack_move(tt_move16_t packed);
 
+#ifdef SEARCH_PROFILE
+
+typedef struct {
+    uint32_t probes;        /* tt_probe calls */
+    uint32_t hits;          /* probes that matched an entry */
+    uint32_t stores;        /* tt_store calls */
+    uint32_t replaces;      /* stores that evicted a different position */
+    uint32_t stale_replaces;/* ...of which the victim was from an older search */
+} tt_profile_t;
+
+void tt_profile_reset(void);
+const tt_profile_t *tt_profile_get(void);
+
+#endif /* SEARCH_PROFILE */
+
 #endif /* TT_H */
@@ -109,4 +109,14 @@ typedef struct {
 #define MOVE_POOL_SIZE  2048
 #endif
 
+/* ========== Threading ========== */
+
+/* Per-thread engine state (search context, eval caches).  Only the
+   desktop SEARCH_THREADS build has more than one search thread. */
+#ifdef SEARCH_THREADS
+#define THREAD_LOCAL _Thread_local
+#else
+#define THREAD_LOCAL
+#endif
+
 #endif /* TYPES_H */
@@ -0,0 +1,486 @@
+/*
+ * batch_search.c — Batch search labeler
+ *
+ * Streams a FEN or EPD file (one position per line; EPD opcodes and a
+ * build_texel_dataset.py ",label" column are ignored) and runs a
+ * fixed-depth and/or fixed-node search on every position, writing the
+ * score, best move, depth and nodes as CSV or binary records in input
+ * order.  A throughput line (positions/sec, nodes/sec) goes to stderr.
+ *
+ * The engine keeps one search context per process: the TT, the limits
+ * and the stop flag its Lazy SMP helpers share are file globals.  So the
+ * worker pool is forked processes, each with its own engine, pulling
+ * positions from a shared batch.  Every position starts from an empty
+ * TT and fresh search state, so the labels don't depend on the worker
+ * count or on which worker searched what.  The TT runs isolated
+ * (tt_set_isolated): emptying it costs a generation bump per position,
+ * not a clear of the whole --hash-mb table.
+ *
+ * Build: make batch-search  (from chess/engine/)
+ * Run:   ./build/batch_search --input <fen|epd|csv> [--out <file>]
+ *            [--depth N] [--nodes N] [--workers N] [--hash-mb N]
+ *            [--format csv|bin] [--bitbase <CHEGTB.bin>]
+ *
+ * CSV: fen,score,bestmove,depth,nodes (score from the side to move,
+ * SCORE_MATE - plies for mates; bestmove 0000 when there is none).
+ *
+ * Binary: "BSR\x01", then one 14-byte little-endian record per labeled
+ * position: uint32 line, uint32 nodes, int16 score, uint8 from and to
+ * (a1 = 0 .. h8 = 63), uint8 promotion (0 none, 1 n, 2 b, 3 r, 4 q),
+ * uint8 depth.
+ */
+
+#define _DEFAULT_SOURCE    /* MAP_ANONYMOUS, clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "../src/board.h"
+#include "../src/movegen.h"
+#include "../src/search.h"
+#include "../src/tt.h"
+#include "../src/bitbase.h"
+
+#define BATCH_SIZE 4096     /* positions per fork of the worker pool */
+#define FEN_MAX    100      /* longest legal FEN is 92 characters */
+
+typedef struct {
+    char     fen[FEN_MAX];
+    uint32_t line;
+    /* written by the worker */
+    uint8_t  valid;
+    uint8_t  depth;
+    int16_t  score;
+    move_t   best;
+    uint32_t nodes;
+} item_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t next;          /* next item to claim, shared by the workers */
+    item_t   items[BATCH_SIZE];
+} batch_t;
+
+/* ========== Time ========== */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ========== FEN Parsing ========== */
+
+/* Copy the FEN fields of an input line into out: placement, side,
+   castling and en passant, plus the clocks when they are numbers (EPD
+   puts opcodes there).  Returns 0 for lines with fewer than 4 fields. */
+static int extract_fen(const char *line, char *out)
+{
+    const char *p = line;
+    size_t len = 0;
+    int field;
+
+    for (field = 0; field < 6; field++) {
+        const char *start, *q;
+        size_t n;
+
+        while (*p == ' ' || *p == '\t') p++;
+        start = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != ',' && *p != ';' &&
+               *p != '\r' && *p != '\n')
+            p++;
+        n = (size_t)(p - start);
+        if (n == 0) break;
+        if (field >= 4) {
+            for (q = start; q < p; q++)
+                if (*q < '0' || *q > '9') break;
+            if (q < p) break;
+        }
+        if (len + n + 1 >= FEN_MAX) return 0;
+        if (field) out[len++] = ' ';
+        memcpy(out + len, start, n);
+        len += n;
+        if (*p != ' ' && *p != '\t') { field++; break; }
+    }
+    out[len] = '\0';
+    return field >= 4;
+}
+
+/* Set b from fen.  Returns 0 for positions the search can't take: bad
+   placement, not one king per side, more than 16 pieces a side, pawns
+   on the back ranks, or the side not to move in check.  Castling
+   rights without the king and rook at home are dropped. */
+static int board_set_fen(board_t *b, const char *fen)
+{
+    int8_t ui[8][8];
+    int r = 0, c = 0;
+    int kings[2] = { 0, 0 }, count[2] = { 0, 0 };
+    int8_t turn;
+    uint8_t castling = 0;
+    uint8_t ep_row = 0xFF, ep_col = 0xFF;
+    unsigned long halfmove = 0, fullmove = 1;
+    const char *p = fen;
+
+    memset(ui, 0, sizeof(ui));
+    for (; *p && *p != ' '; p++) {
+        if (*p == '/') {
+            if (c != 8 || ++r > 7) return 0;
+            c = 0;
+        } else if (*p >= '1' && *p <= '8') {
+            c += *p - '0';
+            if (c > 8) return 0;
+        } else {
+            const char *types = "PNBRQK";
+            const char *t = strchr(types, *p >= 'a' ? *p - 32 : *p);
+            int black = *p >= 'a';
+            int8_t piece;
+
+            if (!t || c >= 8) return 0;
+            piece = (int8_t)(t - types + 1);
+            if (piece == UI_W_PAWN && (r == 0 || r == 7)) return 0;
+            if (piece == UI_W_KING) kings[black]++;
+            count[black]++;
+            ui[r][c++] = black ? (int8_t)-piece : piece;
+        }
+    }
+    if (r != 7 || c != 8 || kings[0] != 1 || kings[1] != 1 ||
+        count[0] > 16 || count[1] > 16)
+        return 0;
+
+    if (*p == ' ') p++;
+    if (*p != 'w' && *p != 'b') return 0;
+    turn = (*p == 'b') ? -1 : 1;
+    p++;
+
+    if (*p == ' ') p++;
+    for (; *p && *p != ' '; p++) {
+        switch (*p) {
+            case 'K': castling |= CASTLE_WK; break;
+            case 'Q': castling |= CASTLE_WQ; break;
+            case 'k': castling |= CASTLE_BK; break;
+            case 'q': castling |= CASTLE_BQ; break;
+        }
+    }
+    if (ui[7][4] != UI_W_KING) castling &= ~(CASTLE_WK | CASTLE_WQ);
+    if (ui[7][7] != UI_W_ROOK) castling &= ~CASTLE_WK;
+    if (ui[7][0] != UI_W_ROOK) castling &= ~CASTLE_WQ;
+    if (ui[0][4] != -UI_W_KING) castling &= ~(CASTLE_BK | CASTLE_BQ);
+    if (ui[0][7] != -UI_W_ROOK) castling &= ~CASTLE_BK;
+    if (ui[0][0] != -UI_W_ROOK) castling &= ~CASTLE_BQ;
+
+    if (*p == ' ') p++;
+    if (p[0] >= 'a' && p[0] <= 'h' && (p[1] == '3' || p[1] == '6')) {
+        ep_col = (uint8_t)(p[0] - 'a');
+        ep_row = (uint8_t)(8 - (p[1] - '0'));
+    }
+    while (*p && *p != ' ') p++;
+
+    if (*p == ' ') halfmove = strtoul(p + 1, (char **)&p, 10);
+    if (*p == ' ') fullmove = strtoul(p + 1, (char **)&p, 10);
+    if (halfmove > 255) halfmove = 255;
+    if (fullmove < 1 || fullmove > 65535) fullmove = 1;
+
+    board_set_from_ui(b, (const int8_t (*)[8])ui, turn, castling, ep_row, ep_col,
+                      (uint8_t)halfmove, (uint16_t)fullmove);
+    return board_is_legal(b);
+}
+
+/* ========== Moves ========== */
+
+static uint8_t sq88_to_sq64(uint8_t sq)
+{
+    return (uint8_t)((7 - SQ_TO_ROW(sq)) * 8 + SQ_TO_COL(sq));
+}
+
+static uint8_t move_promo(move_t m)
+{
+    if (!(m.flags & FLAG_PROMOTION)) return 0;
+    switch (m.flags & FLAG_PROMO_MASK) {
+        case FLAG_PROMO_N: return 1;
+        case FLAG_PROMO_B: return 2;
+        case FLAG_PROMO_R: return 3;
+        default:           return 4;
+    }
+}
+
+static void move_str(move_t m, char *out)
+{
+    if (m.from == SQ_NONE) {
+        strcpy(out, "0000");
+        return;
+    }
+    out[0] = (char)('a' + SQ_TO_COL(m.from));
+    out[1] = (char)('8' - SQ_TO_ROW(m.from));
+    out[2] = (char)('a' + SQ_TO_COL(m.to));
+    out[3] = (char)('8' - SQ_TO_ROW(m.to));
+    out[4] = " nbrq"[move_promo(m)];
+    out[move_promo(m) ? 5 : 4] = '\0';
+}
+
+/* ========== Workers ========== */
+
+static void label_item(item_t *it, const search_limits_t *limits)
+{
+    board_t b;
+    search_result_t r;
+
+    if (!board_set_fen(&b, it->fen)) {
+        it->valid = 0;
+        return;
+    }
+    search_reset();     /* search_go() starts a new, isolated TT generation */
+    r = search_go(&b, limits);
+    it->valid = 1;
+    it->score = (int16_t)r.score;
+    it->best = r.best_move;
+    it->depth = r.depth;
+    it->nodes = r.nodes;
+}
+
+static void run_worker(batch_t *batch, const search_limits_t *limits)
+{
+    uint32_t i;
+    while ((i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->count)
+        label_item(&batch->items[i], limits);
+}
+
+/* Label every item of the batch with up to workers processes */
+static void run_batch(batch_t *batch, const search_limits_t *limits, int workers)
+{
+    pid_t pids[256];
+    int w, started = 0;
+
+    batch->next = 0;
+    for (w = 0; w < workers; w++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_worker(batch, limits);
+            _exit(0);
+        }
+        if (pid < 0) break;
+        pids[started++] = pid;
+    }
+    if (!started)
+        run_worker(batch, limits);    /* no fork: label it here instead */
+    for (w = 0; w < started; w++)
+        waitpid(pids[w], NULL, 0);
+    /* a worker that died leaves its claimed item unlabeled */
+}
+
+/* ========== Output ========== */
+
+static void put_le(FILE *f, uint32_t v, int bytes)
+{
+    while (bytes--) {
+        fputc((int)(v & 0xFF), f);
+        v >>= 8;
+    }
+}
+
+static void write_item(FILE *f, const item_t *it, int binary)
+{
+    if (binary) {
+        put_le(f, it->line, 4);
+        put_le(f, it->nodes, 4);
+        put_le(f, (uint16_t)it->score, 2);
+        if (it->best.from == SQ_NONE) {
+            put_le(f, 0, 3);
+        } else {
+            put_le(f, sq88_to_sq64(it->best.from), 1);
+            put_le(f, sq88_to_sq64(it->best.to), 1);
+            put_le(f, move_promo(it->best), 1);
+        }
+        put_le(f, it->depth, 1);
+    } else {
+        char mbuf[6];
+        move_str(it->best, mbuf);
+        fprintf(f, "%s,%d,%s,%u,%lu\n", it->fen, it->score, mbuf,
+                it->depth, (unsigned long)it->nodes);
+    }
+}
+
+/* ========== Endgame Bitbase ========== */
+
+static uint8_t *bitbase_data;
+
+/* Load a tools/gen_bitbase_appvar.py --bin payload (copied from uci.c).
+   Returns the number of tables in use. */
+static int bitbase_file_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long size;
+    int used;
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) { fclose(f); return 0; }
+    bitbase_data = malloc((size_t)size);
+    if (!bitbase_data) { fclose(f); return 0; }
+    if (fread(bitbase_data, 1, (size_t)size, f) != (size_t)size) {
+        free(bitbase_data); bitbase_data = NULL; fclose(f); return 0;
+    }
+    fclose(f);
+    used = bitbase_load(bitbase_data, (uint32_t)size);
+    if (!used) { free(bitbase_data); bitbase_data = NULL; }
+    return used;
+}
+
+/* ========== Main ========== */
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: batch_search --input <file> [--out <file>]"
+            " [--depth N] [--nodes N] [--workers N] [--hash-mb N]"
+            " [--format csv|bin] [--bitbase <file>]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL, *output = NULL, *bitbase = NULL;
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long depth = 0, nodes = 0, hash_mb = 0;
+    int binary = 0;
+    search_limits_t limits;
+    batch_t *batch;
+    FILE *in, *out;
+    char line[512];
+    uint32_t line_no = 0;
+    unsigned long labeled = 0, skipped = 0;
+    uint64_t total_nodes = 0, t0;
+    double secs;
+    int i, eof = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            input = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            depth = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) {
+            nodes = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--hash-mb") == 0 && i + 1 < argc) {
+            hash_mb = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "bin") == 0) binary = 1;
+            else if (strcmp(argv[i], "csv") != 0) { usage(); return 2; }
+        } else if (strcmp(argv[i], "--bitbase") == 0 && i + 1 < argc) {
+            bitbase = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!input) {
+        usage();
+        return 2;
+    }
+    if (workers < 1) workers = 1;
+    if (workers > 256) workers = 256;
+    if (!depth && !nodes) depth = 6;
+    if (depth > MAX_PLY - 1) depth = MAX_PLY - 1;
+
+    in = strcmp(input, "-") == 0 ? stdin : fopen(input, "r");
+    if (!in) {
+        fprintf(stderr, "Error: cannot read %s\n", input);
+        return 1;
+    }
+    out = output && strcmp(output, "-") != 0 ? fopen(output, binary ? "wb" : "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: cannot write %s\n", output);
+        return 1;
+    }
+
+    /* Engine setup before the fork, so every worker inherits it */
+    {
+        board_t scratch;
+        board_init(&scratch);   /* Zobrist tables */
+    }
+    if (hash_mb && !tt_resize((uint32_t)(hash_mb << 20))) {
+        fprintf(stderr, "Error: cannot allocate a %lu MB hash\n", hash_mb);
+        return 1;
+    }
+    tt_set_isolated(1);
+    if (bitbase && !bitbase_file_load(bitbase))
+        fprintf(stderr, "Warning: no bitbase tables in %s\n", bitbase);
+
+    memset(&limits, 0, sizeof(limits));
+    limits.max_depth = (uint8_t)depth;
+    limits.max_nodes = (uint32_t)nodes;
+
+    batch = mmap(NULL, sizeof(*batch), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (batch == MAP_FAILED) {
+        fprintf(stderr, "Error: cannot map the batch buffer\n");
+        return 1;
+    }
+
+    if (binary)
+        fwrite("BSR\x01", 1, 4, out);
+    else
+        fprintf(out, "fen,score,bestmove,depth,nodes\n");
+
+    t0 = now_ns();
+    while (!eof) {
+        uint32_t n = 0, k;
+
+        while (n < BATCH_SIZE) {
+            item_t *it = &batch->items[n];
+            if (!fgets(line, sizeof(line), in)) {
+                eof = 1;
+                break;
+            }
+            line_no++;
+            if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' ||
+                (line_no == 1 && strncmp(line, "fen,", 4) == 0))
+                continue;       /* comments, blanks, a CSV header */
+            if (!extract_fen(line, it->fen)) {
+                skipped++;
+                continue;
+            }
+            it->line = line_no;
+            it->valid = 0;
+            n++;
+        }
+        if (!n) break;
+
+        batch->count = n;
+        run_batch(batch, &limits, (int)workers);
+
+        for (k = 0; k < n; k++) {
+            const item_t *it = &batch->items[k];
+            if (!it->valid) {
+                skipped++;
+                continue;
+            }
+            write_item(out, it, binary);
+            labeled++;
+            total_nodes += it->nodes;
+        }
+        fflush(out);
+    }
+    secs = (double)(now_ns() - t0) / 1e9;
+
+    if (in != stdin) fclose(in);
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr,
+            "batch_search labeled=%lu skipped=%lu workers=%ld depth=%lu nodes=%lu"
+            " seconds=%.2f pos_per_sec=%.1f nodes_per_sec=%.0f\n",
+            labeled, skipped, workers, depth, nodes, secs,
+            secs > 0 ? (double)labeled / secs : 0.0,
+            secs > 0 ? (double)total_nodes / secs : 0.0);
+    return labeled ? 0 : 1;
+}
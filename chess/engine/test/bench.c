@@ -9,8 +9,14 @@
  *   5. Perft depths 1-5
  *   6. Search depths 1-5
  *
+ * With --json it instead runs the standard bench and prints one JSON
+ * record: a signature (total nodes of a fixed-depth search over every
+ * position, which changes only when search behaviour does), search
+ * NPS, perft NPS and ns/call for each component.  Compare two records
+ * with tools/bench_compare.py.
+ *
  * Build: make bench  (from chess/engine/)
- * Run:   ./build/bench
+ * Run:   ./build/bench [--json]
  */
 
 #include <stdio.h>
@@ -24,6 +30,7 @@
 #include "../src/zobrist.h"
 #include "../src/tt.h"
 #include "../src/engine.h"
+#include "bench_positions.h"
 
 /* ========== High-Resolution Timer ========== */
 
@@ -178,6 +185,12 @@ static void board_set_fen(board_t *b, const char *fen)
             b->phase += phase_weight[idx];
         }
     }
+#ifdef ATTACK_MAPS
+    board_compute_attacks(b);
+#endif
+#ifdef BITBOARDS
+    board_compute_bitboards(b);
+#endif
 }
 
 /* ========== Perft ========== */
@@ -203,234 +216,135 @@ static uint64_t perft(board_t *b, int depth)
 
 /* ========== Benchmark Positions ========== */
 
-/*
- * 50 benchmark positions from well-known chess engine test suites:
- *   - Chessprogramming Wiki Perft Results (positions 0-5)
- *   - TalkChess / Martin Sedlak edge cases (positions 6-18)
- *   - Peterellisjones perft collection (positions 19-24)
- *   - Stockfish benchmark.cpp (positions 25-37)
- *   - Additional TalkChess movegen test positions (positions 38-49)
- */
-static const char *fens[] = {
-    /* 0: Starting position */
-    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
-    /* 1: Kiwipete (Peter McKenzie) */
-    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
-    /* 2: Sparse endgame */
-    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
-    /* 3: Promotion-heavy */
-    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
-    /* 4: Pawn on d7 promotes */
-    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
-    /* 5: Steven Edwards symmetrical */
-    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
-    /* 6: Illegal EP — bishop pins pawn (W) */
-    "8/5bk1/8/2Pp4/8/1K6/8/8 w - d6 0 1",
-    /* 7: Illegal EP — bishop pins pawn (B) */
-    "8/8/1k6/8/2pP4/8/5BK1/8 b - d3 0 1",
-    /* 8: EP gives discovered check */
-    "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
-    /* 9: Short castling gives check */
-    "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
-    /* 10: Long castling gives check */
-    "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1",
-    /* 11: Castling rights lost by rook capture */
-    "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",
-    /* 12: Castling prevented by attack */
-    "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",
-    /* 13: Promote out of check */
-    "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",
-    /* 14: Discovered check */
-    "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1",
-    /* 15: Promote to give check */
-    "4k3/1P6/8/8/8/8/K7/8 w - - 0 1",
-    /* 16: Under-promote to avoid stalemate */
-    "8/P1k5/K7/8/8/8/8/8 w - - 0 1",
-    /* 17: Self stalemate */
-    "K1k5/8/P7/8/8/8/8/8 w - - 0 1",
-    /* 18: Stalemate vs checkmate */
-    "8/k1P5/8/1K6/8/8/8/8 w - - 0 1",
-    /* 19: Rook vs bishop endgame */
-    "r6r/1b2k1bq/8/8/7B/8/8/R3K2R b KQ - 3 2",
-    /* 20: EP discovered check (bishop a2) */
-    "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 3",
-    /* 21: Kiwipete variant — Qe6+ */
-    "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 3 2",
-    /* 22: Simple rook vs pawn */
-    "2r5/3pk3/8/2P5/8/2K5/8/8 w - - 5 4",
-    /* 23: Illegal EP — king exposed to rook */
-    "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",
-    /* 24: Bishop pin prevents EP */
-    "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",
-    /* 25: Stockfish — tactical middlegame */
-    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
-    /* 26: Stockfish — open game */
-    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
-    /* 27: Stockfish — Sicilian-type */
-    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
-    /* 28: Stockfish — attacking position */
-    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
-    /* 29: Stockfish — active rook */
-    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
-    /* 30: Stockfish — closed pawns */
-    "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
-    /* 31: Stockfish — pawn endgame */
-    "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
-    /* 32: Stockfish — rook + pawn endgame */
-    "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
-    /* 33: Stockfish — bishop + pawn endgame */
-    "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
-    /* 34: Stockfish — rook endgame passed pawn */
-    "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
-    /* 35: Stockfish — minor piece endgame */
-    "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
-    /* 36: Stockfish — queen middlegame */
-    "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
-    /* 37: Stockfish — opposite colored bishops */
-    "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
-    /* 38: Promotion bug catcher */
-    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
-    /* 39: Mirrored position 4 */
-    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
-    /* 40: EP after double push (real game) */
-    "rnbqkb1r/ppppp1pp/7n/4Pp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
-    /* 41: Complex castling + EP + extra rook */
-    "r3k2r/8/8/8/3pPp2/8/8/R3K1RR b KQkq e3 0 1",
-    /* 42: Real game endgame with EP */
-    "8/7p/p5pb/4k3/P1pPn3/8/P5PP/1rB2RK1 b - d3 0 28",
-    /* 43: Deep endgame — Q+R+B */
-    "8/3K4/2p5/p2b2r1/5k2/8/8/1q6 b - - 1 67",
-    /* 44: Castling with rook threat */
-    "1k6/1b6/8/8/7R/8/8/4K2R b K - 0 1",
-    /* 45: Castling + pawn structure + pins */
-    "r3k2r/p6p/8/B7/1pp1p3/3b4/P6P/R3K2R w KQkq - 0 1",
-    /* 46: Pure pawn race */
-    "8/p7/8/1P6/K1k3p1/6P1/7P/8 w - - 0 1",
-    /* 47: K+P endgame — distant pawns */
-    "8/5p2/8/2k3P1/p3K3/8/1P6/8 b - - 0 1",
-    /* 48: Realistic middlegame — both castle */
-    "r3k2r/pb3p2/5npp/n2p4/1p1PPB2/6P1/P2N1PBP/R3K2R w KQkq - 0 1",
-    /* 49: Double check position */
-    "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",
-
-    /* ===== Tactical middlegames (positions 50-69) ===== */
-    /* WAC (Win At Chess), Nolot, Bratko-Kopec, ERET */
-
-    /* 50: WAC.001 — Qg6, knight sacrifice + queen attack */
-    "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
-    /* 51: WAC.003 — Rg3, tactical middlegame */
-    "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1",
-    /* 52: WAC.004 — Qxh7+, Greek gift sacrifice */
-    "r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PPR/2KR4 w - - 0 1",
-    /* 53: WAC.008 — Rf7, rook penetration */
-    "r4q1k/p2bR1rp/2p2Q1N/5p2/5p2/2P5/PP3PPP/R5K1 w - - 0 1",
-    /* 54: WAC.010 — Rxh7, rook sac to expose king */
-    "2br2k1/2q3rn/p2NppQ1/2p1P3/Pp5R/4P3/1P3PPP/3R2K1 w - - 0 1",
-    /* 55: WAC.014 — Qxh7+, attack with bishop pair */
-    "r2rb1k1/pp1q1p1p/2n1p1p1/2bp4/5P2/PP1BPR1Q/1BPN2PP/R5K1 w - - 0 1",
-    /* 56: WAC.021 — Nxf7, knight fork */
-    "r1bqk2r/ppp1nppp/4p3/n5N1/2BPp3/P1P5/2P2PPP/R1BQK2R w KQkq - 0 1",
-    /* 57: WAC.022 — g4, pawn thrust trapping queen */
-    "r3nrk1/2p2p1p/p1p1b1p1/2NpPq2/3R4/P1N1Q3/1PP2PPP/4R1K1 w - - 0 1",
-    /* 58: WAC.029 — Nxd6, knight fork winning material */
-    "1r3r2/4q1kp/b1pp2p1/5p2/pPn1N3/6P1/P3PPBP/2QRR1K1 w - - 0 1",
-    /* 59: Nolot 1 (Kasparov-Karpov 1990) — Nxh6!! */
-    "r3qb1k/1b4p1/p2pr2p/3n4/Pnp1N1N1/6RP/1B3PP1/1B1QR1K1 w - - 0 1",
-    /* 60: Nolot 2 (Bronstein-Ljubojevic 1973) — Rxc5!! */
-    "r4rk1/pp1n1p1p/1nqP2p1/2b1P1B1/4NQ2/1B3P2/PP2K2P/2R5 w - - 0 1",
-    /* 61: Nolot 4 (Keres-Kotov 1950) — Nxe6!! */
-    "r1b1kb1r/1p1n1ppp/p2ppn2/6BB/2qNP3/2N5/PPP2PPP/R2Q1RK1 w kq - 0 1",
-    /* 62: Nolot 5 (Spassky-Petrosian 1969) — e5!! */
-    "r2qrb1k/1p1b2p1/p2ppn1p/8/3NP3/1BN5/PPP3QP/1K3RR1 w - - 0 1",
-    /* 63: Nolot 9 — Ng5!! piece sac for attack */
-    "r4r1k/4bppb/2n1p2p/p1n1P3/1p1p1BNP/3P1NP1/qP2QPB1/2RR2K1 w - - 0 1",
-    /* 64: Nolot 10 (Van der Wiel-Ribli 1980) — Rxf7!! */
-    "r1b2rk1/1p1nbppp/pq1p4/3B4/P2NP3/2N1p3/1PP3PP/R2Q1R1K w - - 0 15",
-    /* 65: BK.03 — closed KID, f5 pawn break */
-    "2q1rr1k/3bbnnp/p2p1pp1/2pPp3/PpP1P1P1/1P2BNNP/2BQ1PRK/7R b - - 0 1",
-    /* 66: BK.05 — central knight outpost Nd5 */
-    "r1b2rk1/2q1b1pp/p2ppn2/1p6/3QP3/1BN1B3/PPP3PP/R4RK1 w - - 0 1",
-    /* 67: BK.09 — opposite-side castling, f5 attack */
-    "2kr1bnr/pbpq4/2n1pp2/3p3p/3P1P1B/2N2N1Q/PPP3PP/2KR1B1R w - - 0 1",
-    /* 68: ERET 1 — tactical relief, piece tension */
-    "r1bqk1r1/1p1p1n2/p1n2pN1/2p1b2Q/2P1Pp2/1PN5/PB4PP/R4RK1 w q - 0 1",
-    /* 69: ERET 3 — open line attack, queen + rook battery */
-    "r1b1r1k1/1pqn1pbp/p2pp1p1/P7/1n1NPP1Q/2NBBR2/1PP3PP/R6K w - - 0 1",
-
-    /* ===== Positional middlegames (positions 70-89) ===== */
-    /* SBD (Silent but Deadly), LCT II, Bratko-Kopec, Kaufman, STS */
-
-    /* 70: SBD.039 — QGD structure */
-    "r1b2rk1/1pqn1pp1/p2bpn1p/8/3P4/2NB1N2/PPQB1PPP/3R1RK1 w - - 0 1",
-    /* 71: LCTII.POS.08 — KID pawn chain, bishop maneuver */
-    "r2qrnk1/pp3ppb/3b1n1p/1Pp1p3/2P1P2N/P5P1/1B1NQPBP/R4RK1 w - - 0 1",
-    /* 72: SBD.078 — Sicilian middlegame */
-    "r1r3k1/1bq2pbp/pp1pp1p1/2n5/P3PP2/R2B4/1PPBQ1PP/3N1R1K w - - 0 1",
-    /* 73: SBD.083 — Catalan structure, e4 break */
-    "r2q1rk1/pb2bppp/npp1pn2/3pN3/2PP4/1PB3P1/P2NPPBP/R2Q1RK1 w - - 0 1",
-    /* 74: SBD.014 — piece pressure, Nd4 */
-    "3q1rk1/3rbppp/ppbppn2/1N6/2P1P3/BP6/P1B1QPPP/R3R1K1 w - - 0 1",
-    /* 75: SBD.106 — central bind */
-    "r3r1k1/1pqn1pbp/p2p2p1/2nP2B1/P1P1P3/2NB3P/5PP1/R2QR1K1 w - - 0 1",
-    /* 76: SBD.008 — piece redeployment */
-    "2r1r1k1/pbpp1npp/1p1b3q/3P4/4RN1P/1P4P1/PB1Q1PB1/2R3K1 w - - 0 1",
-    /* 77: SBD.111 — maneuvering */
-    "r4rk1/1bqp1ppp/pp2pn2/4b3/P1P1P3/2N2BP1/1PQB1P1P/2R2RK1 w - - 0 1",
-    /* 78: SBD.079 — French structure */
-    "r1rn2k1/pp1qppbp/6p1/3pP3/3P4/1P3N1P/PB1Q1PP1/R3R1K1 w - - 0 1",
-    /* 79: SBD.095 — IQP position */
-    "r2r2k1/p1pnqpp1/4p2p/3b4/3P4/3BPN2/PP3PPP/2RQR1K1 b - - 0 1",
-    /* 80: SBD.017 — piece coordination */
-    "3r2k1/p1q1npp1/3r1n1p/2p1p3/4P2B/P1P2Q1P/B4PP1/1R2R1K1 w - - 0 1",
-    /* 81: SBD.005 — Sicilian middlegame, prophylactic */
-    "2brr1k1/ppq2ppp/2pb1n2/8/3NP3/2P2P2/P1Q2BPP/1R1R1BK1 w - - 0 1",
-    /* 82: SF bench — minor piece battle */
-    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
-    /* 83: LCTII.POS.05 — pawn structure play */
-    "2r2rk1/1p1bq3/p3p2p/3pPpp1/1P1Q4/P7/2P2PPP/2R1RBK1 b - - 0 1",
-    /* 84: BK.11 — KID maneuvering, f4 prep */
-    "2r1nrk1/p2q1ppp/bp1p4/n1pPp3/P1P1P3/2PBB1N1/4QPPP/R4RK1 w - - 0 1",
-    /* 85: BK.17 — KID structure, h5 expansion */
-    "r2q1rk1/1ppnbppp/p2p1nb1/3Pp3/2P1P1P1/2N2N1P/PPB1QP2/R1B2RK1 b - - 0 1",
-    /* 86: KAU.23 — French structure */
-    "rn1q1rk1/1b2bppp/1pn1p3/p2pP3/3P4/P2BBN1P/1P1N1PP1/R2Q1RK1 b - - 0 1",
-    /* 87: STS 3.003 — knight outpost */
-    "1r1q1rk1/1b1n1p1p/p2b1np1/3pN3/3P1P2/P1N5/3BB1PP/1R1Q1RK1 b - - 0 1",
-    /* 88: SBD.015 — prophylactic Bh6 */
-    "3r1rk1/p1q44p/1pP1ppp1/2n1b1B1/2P5/6P1/P1Q2PBP/1R3RK1 w - - 0 1",
-    /* 89: SBD.042 — knight redeployment */
-    "r1b2rk1/pp4pp/1q1Nppn1/2n4B/1P3P2/2B2RP1/P6P/R2Q3K b - - 0 1",
-
-    /* ===== Complex endgames (positions 90-99) ===== */
-    /* EET (Eigenmann Endgame Test), PET (Peter's Endgame Test) */
-
-    /* 90: EET 075 — R+B vs R+B, minority attack */
-    "6k1/p6p/1p1p2p1/2bP4/P1P5/2B3P1/4r2P/1R5K w - - 0 1",
-    /* 91: EET 098 — 2R+B vs 2R+B, central pawns */
-    "3r2k1/p1R2ppp/1p6/P1b1PP2/3p4/3R2B1/5PKP/1r6 w - - 0 1",
-    /* 92: EET 017 — Q+R+B vs Q+2B, positional */
-    "6k1/1p2p1bp/p5p1/4pb2/1q6/4Q3/1P2BPPP/2R3K1 w - - 0 1",
-    /* 93: PET 044 — 2R+N vs 2R+N, locked center */
-    "1r6/Rp2rp2/1Pp2kp1/N1Pp3p/3Pp1nP/4P1P1/R4P2/6K1 w - - 0 1",
-    /* 94: PET 028 — R vs R, outside passed pawn */
-    "8/4kp2/4p1p1/2p1r3/PpP5/3R4/1P1K1PP1/8 w - - 0 1",
-    /* 95: EET 083 — R+B+N vs R+B+N, tactical */
-    "8/1B4k1/5pn1/6N1/1P3rb1/P1K4p/3R4/8 w - - 0 1",
-    /* 96: EET 062 — R vs R, passed pawn race */
-    "2r3k1/6pp/3pp1P1/1pP5/1P6/P4R2/5K2/8 w - - 0 1",
-    /* 97: EET 051 — R vs B, pawn structure */
-    "8/5p2/3pp2p/p5p1/4Pk2/2p2P1P/P1Kb2P1/1R6 w - - 0 1",
-    /* 98: EET 074 — R+B vs R+pawns, advanced pawns */
-    "5k2/1p6/1P1p4/1K1p2p1/PB1P2P1/3pR2p/1P2p1pr/8 w - - 0 1",
-    /* 99: PET 038 — RB vs RB endgame */
-    "4k3/2p1b3/4p1p1/1pp1P3/5PP1/1PBK4/r1P2R2/8 b - - 0 1",
-};
-#define NUM_POS 100
+#define NUM_POS BENCH_NUM_POS
 #define ITERS   1000
 
+/* ========== Standard Bench ========== */
+
+#define BENCH_PERFT_DEPTH 5   /* startpos perft depth */
+#define BENCH_ITERS       1000 /* component calls per position */
+#define BENCH_REPEATS     3    /* component passes; the fastest counts */
+
+/* One iterated component: total ns for BENCH_ITERS calls on every
+   position.  Make/unmake times each position's first move. */
+enum { COMP_MOVEGEN, COMP_ATTACKED, COMP_EVAL, COMP_MAKE, NUM_COMPS };
+
+static uint64_t time_component(int comp)
+{
+    board_t b;
+    move_t moves[MAX_MOVES];
+    undo_t undo;
+    uint64_t t0, total = 0;
+    volatile int sink = 0;
+    int i, j;
+
+    for (i = 0; i < NUM_POS; i++) {
+        board_set_fen(&b, bench_fens[i]);
+        if (comp == COMP_MAKE && generate_moves(&b, moves, GEN_ALL) == 0)
+            continue;
+        t0 = timer_ns();
+        for (j = 0; j < BENCH_ITERS; j++) {
+            switch (comp) {
+            case COMP_MOVEGEN:
+                sink += generate_moves(&b, moves, GEN_ALL);
+                break;
+            case COMP_ATTACKED:
+                sink += is_square_attacked(&b, b.king_sq[b.side], b.side ^ 1);
+                break;
+            case COMP_EVAL:
+                sink += evaluate(&b);
+                break;
+            default:
+                board_make(&b, moves[0], &undo);
+                board_unmake(&b, moves[0], &undo);
+                break;
+            }
+        }
+        total += timer_ns() - t0;
+    }
+    (void)sink;
+    return total;
+}
+
+/* Fixed-depth search over the whole set.  Each position starts from
+   cleared TT, killers and history so the node total is independent of
+   position order and of anything searched before. */
+static uint32_t search_signature(uint64_t *elapsed_ns)
+{
+    board_t b;
+    search_limits_t limits;
+    search_result_t sr;
+    uint32_t total = 0;
+    uint64_t t0;
+    int i;
+
+    *elapsed_ns = 0;
+    for (i = 0; i < NUM_POS; i++) {
+        board_set_fen(&b, bench_fens[i]);
+        search_init();
+        search_history_push(b.hash);
+        memset(&limits, 0, sizeof(limits));
+        limits.max_depth = BENCH_DEPTH;
+        t0 = timer_ns();
+        sr = search_go(&b, &limits);
+        *elapsed_ns += timer_ns() - t0;
+        total += sr.nodes;
+    }
+    return total;
+}
+
+static uint64_t per_sec(uint64_t count, uint64_t ns)
+{
+    return ns ? count * 1000000000ULL / ns : 0;
+}
+
+static int run_standard_bench(void)
+{
+    static const char *const comp_names[NUM_COMPS] = {
+        "movegen_ns", "attacked_ns", "eval_ns", "make_unmake_ns"
+    };
+    uint64_t search_ns, perft_ns, perft_nodes, t0;
+    uint32_t signature;
+    board_t b;
+    int c;
+
+    signature = search_signature(&search_ns);
+
+    board_set_fen(&b, bench_fens[0]);
+    t0 = timer_ns();
+    perft_nodes = perft(&b, BENCH_PERFT_DEPTH);
+    perft_ns = timer_ns() - t0;
+
+#ifdef BITBOARDS
+    printf("{\"harness\": \"desktop\", \"backend\": \"bitboard\"");
+#else
+    printf("{\"harness\": \"desktop\", \"backend\": \"0x88\"");
+#endif
+    printf(", \"positions\": %d, \"depth\": %d", NUM_POS, BENCH_DEPTH);
+    printf(", \"signature\": %lu", (unsigned long)signature);
+    printf(", \"search_ms\": %llu, \"nps\": %llu",
+           (unsigned long long)(search_ns / 1000000ULL),
+           (unsigned long long)per_sec(signature, search_ns));
+    printf(", \"perft_nodes\": %llu, \"perft_nps\": %llu",
+           (unsigned long long)perft_nodes,
+           (unsigned long long)per_sec(perft_nodes, perft_ns));
+    for (c = 0; c < NUM_COMPS; c++) {
+        uint64_t ns = time_component(c);
+        int r;
+        for (r = 1; r < BENCH_REPEATS; r++) {
+            uint64_t again = time_component(c);
+            if (again < ns) ns = again;
+        }
+        printf(", \"%s\": %.1f", comp_names[c],
+               (double)ns / ((double)NUM_POS * BENCH_ITERS));
+    }
+    printf("}\n");
+    return 0;
+}
+
 /* ========== Main ========== */
 
-int main(void)
+int main(int argc, char **argv)
 {
     board_t b;
     move_t moves[MAX_MOVES];
@@ -445,8 +359,6 @@ int main(void)
 
     timer_init();
 
-    printf("=== Chess Engine Desktop Benchmark ===\n\n");
-
     /* Init engine internals */
     zobrist_init(0x12345678);
     search_init();
@@ -454,6 +366,11 @@ int main(void)
     hooks.time_ms = bench_time_ms;
     engine_init(&hooks);
 
+    if (argc > 1 && strcmp(argv[1], "--json") == 0)
+        return run_standard_bench();
+
+    printf("=== Chess Engine Desktop Benchmark ===\n\n");
+
     /* ======== 1. Memory Sizes ======== */
     printf("-- Memory --\n");
     printf("  board_t: %zu bytes\n", sizeof(board_t));
@@ -463,7 +380,7 @@ int main(void)
 
     /* ======== 2. Single-Call Ops (startpos) ======== */
     printf("-- Single Ops (startpos) --\n");
-    board_set_fen(&b, fens[0]);
+    board_set_fen(&b, bench_fens[0]);
 
     t0 = timer_ns();
     nmoves = generate_moves(&b, moves, GEN_ALL);
@@ -497,7 +414,7 @@ int main(void)
     printf("-- Movegen x%d (%d positions) --\n", ITERS, NUM_POS);
     total_ns = 0;
     for (i = 0; i < NUM_POS; i++) {
-        board_set_fen(&b, fens[i]);
+        board_set_fen(&b, bench_fens[i]);
         t0 = timer_ns();
         for (j = 0; j < ITERS; j++)
             nmoves = generate_moves(&b, moves, GEN_ALL);
@@ -512,7 +429,7 @@ int main(void)
     printf("-- is_square_attacked x%d --\n", ITERS);
     total_ns = 0;
     for (i = 0; i < NUM_POS; i++) {
-        board_set_fen(&b, fens[i]);
+        board_set_fen(&b, bench_fens[i]);
         t0 = timer_ns();
         for (j = 0; j < ITERS; j++)
             (void)is_square_attacked(&b, b.king_sq[b.side], b.side ^ 1);
@@ -527,7 +444,7 @@ int main(void)
     printf("-- Eval x%d --\n", ITERS);
     total_ns = 0;
     for (i = 0; i < NUM_POS; i++) {
-        board_set_fen(&b, fens[i]);
+        board_set_fen(&b, bench_fens[i]);
         t0 = timer_ns();
         for (j = 0; j < ITERS; j++)
             eval_result = evaluate(&b);
@@ -543,7 +460,7 @@ int main(void)
     printf("-- Make/Unmake x%d --\n", ITERS);
     total_ns = 0;
     for (i = 0; i < NUM_POS; i++) {
-        board_set_fen(&b, fens[i]);
+        board_set_fen(&b, bench_fens[i]);
         nmoves = generate_moves(&b, moves, GEN_ALL);
         if (nmoves == 0) continue;
         t0 = timer_ns();
@@ -562,7 +479,7 @@ int main(void)
     /* ======== 4. Perft ======== */
     printf("-- Perft (startpos) --\n");
     for (d = 1; d <= 5; d++) {
-        board_set_fen(&b, fens[0]);
+        board_set_fen(&b, bench_fens[0]);
         t0 = timer_ns();
         nodes = perft(&b, d);
         t1 = timer_ns();
@@ -577,7 +494,7 @@ int main(void)
     /* ======== 5. Search ======== */
     printf("-- Search (startpos, depths 1-5) --\n");
     for (d = 1; d <= 5; d++) {
-        board_set_fen(&b, fens[0]);
+        board_set_fen(&b, bench_fens[0]);
         search_history_clear();
         tt_clear();
         memset(&limits, 0, sizeof(limits));
@@ -600,7 +517,7 @@ int main(void)
         uint32_t total_nodes = 0;
         printf("  depth %d:", d);
         for (i = 0; i < NUM_POS; i++) {
-            board_set_fen(&b, fens[i]);
+            board_set_fen(&b, bench_fens[i]);
             search_history_clear();
             tt_clear();
             memset(&limits, 0, sizeof(limits));
@@ -634,7 +551,7 @@ int main(void)
 
         for (i = 0; i < NUM_POS; i++) {
             for (t = 0; t < NUM_TLIMITS; t++) {
-                board_set_fen(&b, fens[i]);
+                board_set_fen(&b, bench_fens[i]);
                 search_history_clear();
                 tt_clear();
                 memset(&limits, 0, sizeof(limits));
@@ -101,6 +101,7 @@ static void board_set_fen(board_t *b, const char *fen)
 
     {
         uint32_t h = 0;
+        uint32_t ph = 0;    /* pawn-only hash: keys the pawn cache */
         uint16_t l = 0;
         int sq;
         for (sq = 0; sq < 128; sq++) {
@@ -113,6 +114,8 @@ static void board_set_fen(board_t *b, const char *fen)
             pidx = zobrist_piece_index(piece);
             sq64 = SQ_TO_SQ64((uint8_t)sq);
             h ^= zobrist_piece[pidx][sq64];
+            if (PIECE_TYPE(piece) == PIECE_PAWN)
+                ph ^= zobrist_piece[pidx][sq64];
             l ^= lock_piece[pidx][sq64];
         }
         h ^= zobrist_castle[b->castling];
@@ -126,6 +129,7 @@ static void board_set_fen(board_t *b, const char *fen)
             l ^= lock_side;
         }
         b->hash = h;
+        b->pawn_hash = ph;
         b->lock = l;
     }
 
@@ -160,6 +164,12 @@ static void board_set_fen(board_t *b, const char *fen)
             b->phase += phase_weight[idx];
         }
     }
+#ifdef ATTACK_MAPS
+    board_compute_attacks(b);
+#endif
+#ifdef BITBOARDS
+    board_compute_bitboards(b);
+#endif
 }
 
 static void trim_line(char *s)
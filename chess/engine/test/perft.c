@@ -6,6 +6,16 @@
 #include "../src/movegen.h"
 #include "../src/zobrist.h"
 
+#ifdef SEARCH_THREADS
+#include <pthread.h>
+#endif
+
+/* Perft modes (all keep the expected-count checks):
+ *   --bulk       count depth-1 leaves with count_legal_moves()
+ *   --hash <MB>  cache subtree counts keyed on board hash + lock
+ *   --threads N  split the root moves across N threads
+ *                (desktop SEARCH_THREADS builds) */
+
 /* ========== FEN Parser ========== */
 
 static void board_set_fen(board_t *b, const char *fen)
@@ -133,6 +143,45 @@ static void board_set_fen(board_t *b, const char *fen)
         b->hash = h;
         b->lock = l;
     }
+#ifdef ATTACK_MAPS
+    board_compute_attacks(b);
+#endif
+#ifdef BITBOARDS
+    board_compute_bitboards(b);
+#endif
+}
+
+/* ========== Perft Hash ========== */
+
+/* One entry per slot, always replaced.  check holds the position key
+   (hash, lock and depth) XORed with count, so an entry torn by two
+   threads writing at once fails the check instead of returning a
+   wrong count. */
+typedef struct {
+    uint64_t check;
+    uint64_t count;
+} perft_hash_entry_t;
+
+static perft_hash_entry_t *perft_hash;
+static uint64_t perft_hash_mask;
+static int perft_bulk;
+
+static int perft_hash_alloc(unsigned mb)
+{
+    uint64_t n = 1;
+
+    while ((n * 2) * sizeof(perft_hash_entry_t) <= (uint64_t)mb << 20)
+        n *= 2;
+    perft_hash = calloc(n, sizeof(perft_hash_entry_t));
+    if (!perft_hash) return 0;
+    perft_hash_mask = n - 1;
+    return 1;
+}
+
+static uint64_t perft_hash_key(const board_t *b, int depth)
+{
+    return (uint64_t)b->hash | ((uint64_t)b->lock << 32) |
+           ((uint64_t)depth << 48);
 }
 
 /* ========== Perft ========== */
@@ -143,8 +192,18 @@ static uint64_t perft(board_t *b, int depth)
     undo_t undo;
     uint8_t nmoves, i;
     uint64_t nodes = 0;
+    uint64_t key = 0;
+    perft_hash_entry_t *e = NULL;
 
     if (depth == 0) return 1;
+    if (perft_bulk && depth == 1) return count_legal_moves(b);
+
+    if (perft_hash && depth >= 2) {
+        key = perft_hash_key(b, depth);
+        e = &perft_hash[b->hash & perft_hash_mask];
+        if ((e->check ^ e->count) == key)
+            return e->count;
+    }
 
     nmoves = generate_moves(b, moves, GEN_ALL);
 
@@ -161,9 +220,92 @@ static uint64_t perft(board_t *b, int depth)
         board_unmake(b, moves[i], &undo);
     }
 
+    if (e) {
+        e->count = nodes;
+        e->check = key ^ nodes;
+    }
     return nodes;
 }
 
+/* ========== Threaded Root Split ========== */
+
+#ifdef SEARCH_THREADS
+
+#define PERFT_MAX_THREADS 64
+
+typedef struct {
+    pthread_t tid;
+    board_t   board;      /* private copy of the root position */
+    const move_t *moves;
+    uint8_t   nmoves;
+    uint8_t   first;      /* takes moves first, first + stride, ... */
+    uint8_t   stride;
+    int       depth;
+    uint64_t  nodes;
+} perft_worker_t;
+
+static void *perft_worker(void *arg)
+{
+    perft_worker_t *w = (perft_worker_t *)arg;
+    undo_t undo;
+    uint8_t i;
+
+    w->nodes = 0;
+    for (i = w->first; i < w->nmoves; i += w->stride) {
+        board_make(&w->board, w->moves[i], &undo);
+        if (board_is_legal(&w->board))
+            w->nodes += perft(&w->board, w->depth - 1);
+        board_unmake(&w->board, w->moves[i], &undo);
+    }
+    return NULL;
+}
+
+/* perft() with the root moves dealt round-robin to nthreads workers,
+   which share the hash table */
+static uint64_t perft_threaded(board_t *b, int depth, int nthreads)
+{
+    static perft_worker_t workers[PERFT_MAX_THREADS];
+    move_t moves[MAX_MOVES];
+    uint8_t nmoves;
+    uint64_t total = 0;
+    int t;
+
+    if (depth < 2 || nthreads < 2)
+        return perft(b, depth);
+    if (nthreads > PERFT_MAX_THREADS)
+        nthreads = PERFT_MAX_THREADS;
+
+    nmoves = generate_moves(b, moves, GEN_ALL);
+    for (t = 0; t < nthreads; t++) {
+        workers[t].board = *b;
+        workers[t].moves = moves;
+        workers[t].nmoves = nmoves;
+        workers[t].first = (uint8_t)t;
+        workers[t].stride = (uint8_t)nthreads;
+        workers[t].depth = depth;
+        if (pthread_create(&workers[t].tid, NULL, perft_worker, &workers[t]) != 0) {
+            perft_worker(&workers[t]);  /* run it here instead */
+            workers[t].tid = 0;
+        }
+    }
+    for (t = 0; t < nthreads; t++) {
+        if (workers[t].tid)
+            pthread_join(workers[t].tid, NULL);
+        total += workers[t].nodes;
+    }
+    return total;
+}
+
+#else
+
+static uint64_t perft_threaded(board_t *b, int depth, int nthreads)
+{
+    (void)nthreads;
+    return perft(b, depth);
+}
+
+#endif /* SEARCH_THREADS */
+
 /* ========== Divide (perft with per-move breakdown) ========== */
 
 static uint64_t divide(board_t *b, int depth)
@@ -359,8 +501,15 @@ static const perft_test_t edge_tests[] = {
 
 /* ========== Test Runner ========== */
 
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
 static int run_suite(const char *suite_name, const perft_test_t *tests,
-                     unsigned count, board_t *board, int verbose,
+                     unsigned count, board_t *board, int verbose, int threads,
                      int *passed, int *failed)
 {
     unsigned i;
@@ -370,7 +519,7 @@ static int run_suite(const char *suite_name, const perft_test_t *tests,
     for (i = 0; i < count; i++) {
         clock_t start, end;
         uint64_t result;
-        double elapsed;
+        double elapsed, wall_start;
 
         printf("[%u/%u] %s (depth %d)...\n", i + 1, count,
                tests[i].name, tests[i].depth);
@@ -378,16 +527,19 @@ static int run_suite(const char *suite_name, const perft_test_t *tests,
         board_set_fen(board, tests[i].fen);
 
         start = clock();
+        wall_start = wall_seconds();
 
         if (verbose) {
             printf("  Divide:\n");
             result = divide(board, tests[i].depth);
         } else {
-            result = perft(board, tests[i].depth);
+            result = perft_threaded(board, tests[i].depth, threads);
         }
 
         end = clock();
-        elapsed = (double)(end - start) / CLOCKS_PER_SEC;
+        /* clock() is CPU time, summed over threads */
+        elapsed = threads > 1 ? wall_seconds() - wall_start
+                              : (double)(end - start) / CLOCKS_PER_SEC;
 
         if (result == tests[i].expected) {
             printf("  PASS: %llu nodes (%.3fs)\n", (unsigned long long)result, elapsed);
@@ -413,6 +565,8 @@ int main(int argc, char **argv)
     int passed = 0, failed = 0;
     int verbose = 0;
     int skip_edge = 0;
+    int threads = 1;
+    unsigned hash_mb = 0;
     unsigned total;
 
     /* Parse args */
@@ -421,9 +575,19 @@ int main(int argc, char **argv)
             verbose = 1;
         else if (strcmp(argv[a], "--standard") == 0)
             skip_edge = 1;
+        else if (strcmp(argv[a], "--bulk") == 0)
+            perft_bulk = 1;
+        else if (strcmp(argv[a], "--hash") == 0 && a + 1 < argc)
+            hash_mb = (unsigned)atoi(argv[++a]);
+        else if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc)
+            threads = atoi(argv[++a]);
         else if (strcmp(argv[a], "--divide") == 0 && a + 2 < argc) {
             const char *fen = argv[a + 1];
             int depth = atoi(argv[a + 2]);
+            if (hash_mb && !perft_hash_alloc(hash_mb)) {
+                fprintf(stderr, "perft: cannot allocate %u MB hash\n", hash_mb);
+                return 1;
+            }
             zobrist_init(0x12345678u);
             board_set_fen(&board, fen);
             printf("Divide depth %d:\n", depth);
@@ -433,14 +597,28 @@ int main(int argc, char **argv)
         }
     }
 
+#ifndef SEARCH_THREADS
+    if (threads > 1) {
+        printf("Note: built without SEARCH_THREADS, using 1 thread\n");
+        threads = 1;
+    }
+#endif
+    if (hash_mb && !perft_hash_alloc(hash_mb)) {
+        fprintf(stderr, "perft: cannot allocate %u MB hash\n", hash_mb);
+        return 1;
+    }
+    if (perft_bulk || perft_hash || threads > 1)
+        printf("Mode:%s%s threads=%d\n\n", perft_bulk ? " bulk" : "",
+               perft_hash ? " hash" : "", threads);
+
     zobrist_init(0x12345678u);
 
     run_suite("Standard CPW Perft", standard_tests, NUM_STANDARD, &board, verbose,
-              &passed, &failed);
+              threads, &passed, &failed);
 
     if (!skip_edge) {
         run_suite("Edge Cases (Stockfish/PEJ)", edge_tests, NUM_EDGE, &board, verbose,
-                  &passed, &failed);
+                  threads, &passed, &failed);
     }
 
     total = skip_edge ? NUM_STANDARD : (unsigned)(NUM_STANDARD + NUM_EDGE);
@@ -13,6 +13,11 @@
  *   9. Checkmate, stalemate, and draw detection
  *  10. Position get/set roundtrip
  *  11. Full game simulation through public API
+ *  12. Runtime transposition table resize
+ *  13. Multi-threaded (Lazy SMP) search
+ *  14. Think poll callback and "move now"
+ *  15. Pondering on the opponent's move
+ *  16. Cached legal moves and status through a game
  */
 
 #include <stdio.h>
@@ -460,6 +465,183 @@ static void test_ai_think(void)
     }
 }
 
+/* ========== Test: Hash Resize ========== */
+
+static void test_hash_resize(void)
+{
+    engine_move_t m;
+    uint32_t kb;
+
+    printf("\n=== Hash Resize Tests ===\n");
+
+    kb = engine_set_hash_kb(1024);
+    if (kb == 1024)
+        PASS("Resize hash to 1 MB");
+    else
+        FAIL("Resize hash to 1 MB", "got %u KB", (unsigned)kb);
+
+    engine_new_game();
+    m = engine_think(4, 5000);
+    if (m.from_row != ENGINE_SQ_NONE && engine_is_legal_move(m))
+        PASS("Search with resized hash");
+    else
+        FAIL("Search with resized hash", "no legal move returned");
+
+    kb = engine_set_hash_kb(0);
+    if (kb == 32)
+        PASS("Hash 0 reverts to built-in table");
+    else
+        FAIL("Hash 0 reverts to built-in table", "got %u KB", (unsigned)kb);
+}
+
+/* ========== Test: Threaded Search ========== */
+
+static void test_threads(void)
+{
+    int8_t board[8][8];
+    engine_move_t m;
+    uint8_t n;
+
+    printf("\n=== Threaded Search Tests ===\n");
+
+    n = engine_set_threads(4);
+    if (n == (ENGINE_MAX_THREADS < 4 ? ENGINE_MAX_THREADS : 4))
+        PASS("Set 4 search threads");
+    else
+        FAIL("Set 4 search threads", "got %u", (unsigned)n);
+
+    engine_new_game();
+    m = engine_think(6, 5000);
+    if (m.from_row != ENGINE_SQ_NONE && engine_is_legal_move(m))
+        PASS("Threaded search returns a legal move");
+    else
+        FAIL("Threaded search returns a legal move", "no legal move returned");
+
+    /* Back-rank mate in one: Ra1-a8# */
+    memset(board, 0, sizeof(board));
+    board[0][7] = -6;  /* B_KING h8 */
+    board[1][5] = -1;  /* B_PAWN f7 */
+    board[1][6] = -1;  /* B_PAWN g7 */
+    board[1][7] = -1;  /* B_PAWN h7 */
+    board[7][0] = 4;   /* W_ROOK a1 */
+    board[7][4] = 6;   /* W_KING e1 */
+    set_position(board, 1, 0, ENGINE_EP_NONE, ENGINE_EP_NONE);
+    m = engine_think(5, 5000);
+    if (m.from_row == 7 && m.from_col == 0 && m.to_row == 0 && m.to_col == 0)
+        PASS("Threaded search finds mate in one");
+    else
+        FAIL("Threaded search finds mate in one", "got %d%d-%d%d",
+             m.from_row, m.from_col, m.to_row, m.to_col);
+
+    engine_set_threads(1);
+}
+
+/* ========== Test: Think Poll ========== */
+
+static int poll_calls;
+static int poll_stop_after;
+
+static uint8_t test_poll(void)
+{
+    poll_calls++;
+    return poll_calls >= poll_stop_after;
+}
+
+static void test_think_poll(void)
+{
+    engine_move_t m;
+    uint32_t t0, elapsed;
+
+    printf("\n=== Think Poll Tests ===\n");
+
+    /* Poll every ms, never stop: the search runs to its depth limit */
+    engine_new_game();
+    engine_set_use_book(0);
+    poll_calls = 0;
+    poll_stop_after = 1 << 30;
+    engine_set_think_poll(test_poll, 1);
+    m = engine_think(7, 0);
+    if (poll_calls > 0)
+        PASS("Poll called during search");
+    else
+        FAIL("Poll called during search", "no calls");
+    if (m.from_row != ENGINE_SQ_NONE && engine_is_legal_move(m))
+        PASS("Polled search returns a legal move");
+    else
+        FAIL("Polled search returns a legal move", "no legal move returned");
+
+    /* "Move now": stop on the third poll of a 60s think */
+    engine_new_game();
+    poll_calls = 0;
+    poll_stop_after = 3;
+    t0 = test_time_ms();
+    m = engine_think(0, 60000);
+    elapsed = test_time_ms() - t0;
+    if (elapsed < 5000 && m.from_row != ENGINE_SQ_NONE && engine_is_legal_move(m))
+        PASS("Poll stop returns a legal move early");
+    else
+        FAIL("Poll stop returns a legal move early", "%u ms, from_row=%u",
+             (unsigned)elapsed, (unsigned)m.from_row);
+
+    engine_set_think_poll(0, 0);
+    engine_set_use_book(1);
+}
+
+/* ========== Test: Ponder ========== */
+
+static void test_ponder(void)
+{
+    engine_move_t e4 = { 6, 4, 4, 4, 0 };
+    engine_move_t bad = { 7, 0, 0, 0, 0 };  /* Ra1-a8 through pawns */
+    engine_move_t reply, predicted, m;
+    engine_position_t before, after;
+
+    printf("\n=== Ponder Tests ===\n");
+
+    engine_new_game();
+    engine_set_use_book(0);
+    engine_make_move(e4);
+    reply = engine_think(4, 0);
+    engine_make_move(reply);
+
+    predicted = engine_get_ponder_move(NULL);
+    if (predicted.from_row != ENGINE_SQ_NONE && engine_is_legal_move(predicted))
+        PASS("Expected reply comes from the TT");
+    else
+        FAIL("Expected reply comes from the TT", "no legal prediction");
+
+    if (!engine_ponder(bad, 1000))
+        PASS("Illegal ponder move is rejected");
+    else
+        FAIL("Illegal ponder move is rejected", "pondered anyway");
+
+    /* Ponder leaves the real position alone */
+    memset(&before, 0, sizeof(before));
+    memset(&after, 0, sizeof(after));
+    engine_get_position(&before);
+    engine_set_max_nodes(20000);
+    if (engine_ponder(predicted, 0))
+        PASS("Ponder searches the predicted move");
+    else
+        FAIL("Ponder searches the predicted move", "returned 0");
+    engine_get_position(&after);
+    if (memcmp(&before, &after, sizeof(before)) == 0)
+        PASS("Ponder does not touch the game position");
+    else
+        FAIL("Ponder does not touch the game position", "position changed");
+
+    /* Ponder hit: the think continues and plays a legal reply */
+    engine_make_move(predicted);
+    m = engine_think(3, 0);
+    if (m.from_row != ENGINE_SQ_NONE && engine_is_legal_move(m))
+        PASS("Think after ponder hit returns a legal move");
+    else
+        FAIL("Think after ponder hit returns a legal move", "no legal move returned");
+
+    engine_set_max_nodes(0);
+    engine_set_use_book(1);
+}
+
 /* ========== Test: Game End Detection ========== */
 
 static void test_game_end(void)
@@ -661,6 +843,84 @@ static void test_full_game(void)
     PASS("Full game simulation (no crash)");
 }
 
+/* ========== Test: Legal Move Cache ========== */
+
+/* The per-square lists must partition the full list, hold only legal
+   moves from their own square, and agree with the status */
+static void test_move_cache(void)
+{
+    engine_hooks_t hooks;
+    engine_move_t all[256], from[64], m;
+    uint8_t count, n, status = ENGINE_STATUS_NORMAL;
+    int r, c, i, ply, bad = 0;
+
+    printf("\n=== Legal Move Cache Tests ===\n");
+
+    hooks.time_ms = test_time_ms;
+    engine_init(&hooks);
+    engine_new_game();
+
+    count = engine_get_all_moves(all, 255);
+    if (count == 20 && engine_get_status() == ENGINE_STATUS_NORMAL &&
+        !engine_in_check())
+        PASS("20 cached moves from the start position");
+    else
+        FAIL("Start position cache", "%d moves, status %d", count, engine_get_status());
+
+    for (ply = 0; ply < 60; ply++) {
+        count = engine_get_all_moves(all, 255);
+        n = 0;
+        for (r = 0; r < 8; r++) {
+            for (c = 0; c < 8; c++) {
+                uint8_t k = engine_get_moves_from((uint8_t)r, (uint8_t)c, from, 64);
+                for (i = 0; i < k; i++)
+                    if (from[i].from_row != r || from[i].from_col != c ||
+                        !engine_is_legal_move(from[i]))
+                        bad++;
+                n += k;
+            }
+        }
+        if (n != count || (count == 0) != (status == ENGINE_STATUS_CHECKMATE ||
+                                           status == ENGINE_STATUS_STALEMATE))
+            bad++;
+        if (engine_in_check() != (status == ENGINE_STATUS_CHECK ||
+                                  status == ENGINE_STATUS_CHECKMATE) &&
+            status < ENGINE_STATUS_STALEMATE)
+            bad++;
+        if (count == 0 || status >= ENGINE_STATUS_STALEMATE)
+            break;
+
+        m = engine_think(1, 2000);
+        status = engine_make_move(m);
+        if (status != engine_get_status())
+            bad++;
+    }
+    if (!bad)
+        PASS("Cache consistent through a game");
+    else
+        FAIL("Cache consistent through a game", "%d mismatches by ply %d", bad, ply);
+
+    /* Back rank mate: no moves, checkmate */
+    {
+        static const int8_t mated[8][8] = {
+            { 0, 0, 0, 4, 0, 0,-6, 0 },
+            { 0, 0, 0, 0, 0,-1,-1,-1 },
+            { 0, 0, 0, 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0, 0, 6, 0 },
+        };
+        set_position(mated, -1, 0, ENGINE_EP_NONE, ENGINE_EP_NONE);
+        if (engine_get_all_moves(all, 255) == 0 &&
+            engine_get_status() == ENGINE_STATUS_CHECKMATE && engine_in_check())
+            PASS("New position rebuilds the cache");
+        else
+            FAIL("New position rebuilds the cache", "status %d", engine_get_status());
+    }
+}
+
 /* ========== Test: Move Effects for Non-Special Moves ========== */
 
 static void test_normal_move_effects(void)
@@ -701,9 +961,14 @@ int main(void)
     test_ep_effects();
     test_promotion();
     test_ai_think();
+    test_hash_resize();
+    test_threads();
+    test_think_poll();
+    test_ponder();
     test_game_end();
     test_position_roundtrip();
     test_normal_move_effects();
+    test_move_cache();
     test_full_game();
 
     printf("\n========================================\n");
@@ -10,6 +10,16 @@
  *   6. Eval sanity (starting position ~0, material advantage > 0)
  *   7. Incremental eval consistency (eval matches recomputation)
  *   8. Full game simulation (play a short game, verify no crashes)
+ *   9. Transposition table bucket replacement and aging
+ *  10. Static exchange evaluation
+ *  11. Incremental attack maps / bitboards match recomputation
+ *      (ATTACK_MAPS and BITBOARDS builds)
+ *  12. Bounded (lazy) evaluation
+ *  13. Runtime eval feature mask
+ *  14. Time manager budgets and iteration stopping
+ *  15. Continuing a search of the same position (ponder hit)
+ *  16. Principal variation and per-iteration search info
+ *  17. KPK bitbase probes and search (needs `make bitbase`)
  */
 
 #include <stdio.h>
@@ -22,6 +32,9 @@
 #include "../src/eval.h"
 #include "../src/search.h"
 #include "../src/zobrist.h"
+#include "../src/tt.h"
+#include "../src/timeman.h"
+#include "../src/bitbase.h"
 
 static int tests_passed = 0;
 static int tests_failed = 0;
@@ -561,6 +574,502 @@ static void test_full_game(void)
 
 /* ========== Main ========== */
 
+/* ========== Test: Static Exchange Evaluation ========== */
+
+static void test_see(void)
+{
+    move_t m;
+    int v;
+
+    printf("\n=== SEE Tests ===\n");
+
+    /* QxP defended by a pawn loses the queen */
+    set_fen("4k3/8/3p4/4p3/8/8/8/4Q1K1 w - - 0 1");
+    m.from = RC_TO_SQ(7, 4); m.to = RC_TO_SQ(3, 4); m.flags = FLAG_CAPTURE;
+    v = see(&engine_board, m);
+    if (v == -800) PASS("SEE QxP defended by pawn");
+    else FAIL("SEE QxP defended by pawn", "expected -800, got %d", v);
+
+    /* PxP undefended wins a pawn */
+    set_fen("4k3/8/8/4p3/3P4/8/8/6K1 w - - 0 1");
+    m.from = RC_TO_SQ(4, 3); m.to = RC_TO_SQ(3, 4); m.flags = FLAG_CAPTURE;
+    v = see(&engine_board, m);
+    if (v == 100) PASS("SEE PxP undefended");
+    else FAIL("SEE PxP undefended", "expected 100, got %d", v);
+
+    /* RxP with a rook x-raying behind: recapture doesn't pay */
+    set_fen("4k3/4r3/8/4p3/8/8/4R3/4R1K1 w - - 0 1");
+    m.from = RC_TO_SQ(6, 4); m.to = RC_TO_SQ(3, 4); m.flags = FLAG_CAPTURE;
+    v = see(&engine_board, m);
+    if (v == 100) PASS("SEE RxP with x-ray support");
+    else FAIL("SEE RxP with x-ray support", "expected 100, got %d", v);
+
+    /* Board is untouched afterwards */
+    if (engine_board.squares[RC_TO_SQ(6, 4)] == MAKE_PIECE(COLOR_WHITE, PIECE_ROOK) &&
+        engine_board.squares[RC_TO_SQ(7, 4)] == MAKE_PIECE(COLOR_WHITE, PIECE_ROOK) &&
+        engine_board.squares[RC_TO_SQ(1, 4)] == MAKE_PIECE(COLOR_BLACK, PIECE_ROOK))
+        PASS("SEE restores the board");
+    else
+        FAIL("SEE restores the board", "pieces missing after see()");
+}
+
+/* ========== Test: Incremental Attack Maps / Bitboards ========== */
+
+#if defined(ATTACK_MAPS) || defined(BITBOARDS)
+static int incremental_state_match(const board_t *b)
+{
+    static board_t fresh;
+    fresh = *b;
+#ifdef ATTACK_MAPS
+    board_compute_attacks(&fresh);
+    if (memcmp(fresh.attacks, b->attacks, sizeof(fresh.attacks)) != 0)
+        return 0;
+#endif
+#ifdef BITBOARDS
+    board_compute_bitboards(&fresh);
+    if (memcmp(fresh.bb_side, b->bb_side, sizeof(fresh.bb_side)) != 0 ||
+        memcmp(fresh.bb_type, b->bb_type, sizeof(fresh.bb_type)) != 0)
+        return 0;
+#endif
+    return 1;
+}
+
+/* Walk every move to the given depth; returns number of mismatching nodes */
+static int incremental_state_walk(board_t *b, int depth)
+{
+    move_t list[MAX_MOVES];
+    undo_t u;
+    uint8_t i, count;
+    int bad = 0;
+
+    if (depth == 0) return 0;
+    count = generate_moves(b, list, GEN_ALL);
+    for (i = 0; i < count; i++) {
+        board_make(b, list[i], &u);
+        if (!incremental_state_match(b)) bad++;
+        bad += incremental_state_walk(b, depth - 1);
+        board_unmake(b, list[i], &u);
+        if (!incremental_state_match(b)) bad++;
+    }
+    return bad;
+}
+
+static void test_incremental_state(void)
+{
+    static const char *fens[] = {
+        /* castling both sides, pins, discovered attacks */
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        /* en passant available */
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        /* promotions with and without capture */
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1"
+    };
+    int i, bad;
+
+    printf("\n=== Incremental Board State Tests ===\n");
+
+    for (i = 0; i < 3; i++) {
+        set_fen(fens[i]);
+        if (!incremental_state_match(&engine_board)) {
+            FAIL("Incremental state after FEN setup", "position %d", i);
+            continue;
+        }
+        bad = incremental_state_walk(&engine_board, 3);
+        if (bad == 0 && incremental_state_match(&engine_board))
+            PASS("Incremental state consistent through make/unmake");
+        else
+            FAIL("Incremental state consistent through make/unmake",
+                 "position %d: %d mismatches", i, bad);
+    }
+}
+#endif
+
+/* ========== Test: Bounded Evaluation ========== */
+
+static void test_eval_bounded(void)
+{
+    int full, lazy;
+
+    printf("\n=== Bounded Eval Tests ===\n");
+
+    /* Window around the score: must match the full eval */
+    set_fen("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4");
+    full = evaluate(&engine_board);
+    lazy = evaluate_bounded(&engine_board, full - 50, full + 50);
+    if (lazy == full) PASS("Bounded eval inside window matches evaluate()");
+    else FAIL("Bounded eval inside window", "expected %d, got %d", full, lazy);
+
+    /* White is a queen and rook up: both far windows stay valid bounds */
+    set_fen("4k3/pppppppp/8/8/8/8/PPPPPPPP/RQ2K2R w K - 0 1");
+    full = evaluate(&engine_board);
+    lazy = evaluate_bounded(&engine_board, -100, 100);
+    if (lazy >= 100 && lazy <= full + 350)
+        PASS("Bounded eval fails high far above beta");
+    else
+        FAIL("Bounded eval fails high", "full=%d lazy=%d beta=100", full, lazy);
+    lazy = evaluate_bounded(&engine_board, 3000, 3100);
+    if (lazy <= 3000 && lazy >= full - 350)
+        PASS("Bounded eval fails low far below alpha");
+    else
+        FAIL("Bounded eval fails low", "full=%d lazy=%d alpha=3000", full, lazy);
+}
+
+/* ========== Test: Eval Feature Mask ========== */
+
+static void test_eval_features(void)
+{
+    int full, no_pawns, restored;
+    uint8_t used;
+
+    printf("\n=== Eval Feature Mask Tests ===\n");
+
+    /* Doubled, isolated c-pawns for white: the pawn terms matter */
+    set_fen("4k3/pp3ppp/8/8/2P5/2P5/5PPP/4K3 w - - 0 1");
+    full = evaluate(&engine_board);
+
+    used = engine_set_eval_features(ENGINE_EVAL_ALL & ~ENGINE_EVAL_PAWNS);
+    no_pawns = evaluate(&engine_board);
+    if (used == (ENGINE_EVAL_ALL & ~ENGINE_EVAL_PAWNS) && no_pawns > full)
+        PASS("Masking pawn structure drops the cached doubled/isolated penalty");
+    else
+        FAIL("Pawn structure mask", "mask=%u full=%d masked=%d",
+             (unsigned)used, full, no_pawns);
+
+    used = engine_set_eval_features(ENGINE_EVAL_ALL);
+    restored = evaluate(&engine_board);
+    if (used == ENGINE_EVAL_ALL && restored == full)
+        PASS("Restoring the full mask restores the eval");
+    else
+        FAIL("Full mask restore", "mask=%u expected %d, got %d",
+             (unsigned)used, full, restored);
+}
+
+/* ========== Test: Time Manager ========== */
+
+static void test_time_manager(void)
+{
+    tm_t tm;
+    engine_clock_t clock;
+    engine_move_t m;
+    uint32_t t0, elapsed;
+
+    printf("\n=== Time Manager Tests ===\n");
+
+    /* Sudden death: a slice of the clock, hard limit a few times that */
+    tm_allocate(&tm, 60000, 0, 0, 0, 0);
+    if (tm.soft_ms > 1000 && tm.soft_ms < 3000 &&
+        tm.hard_ms > tm.soft_ms && tm.hard_ms <= 20000)
+        PASS("Clock budget: soft slice, hard limit above it");
+    else
+        FAIL("Clock budget", "soft=%u hard=%u",
+             (unsigned)tm.soft_ms, (unsigned)tm.hard_ms);
+
+    /* Increment adds to the slice; the last move before the control
+       may spend most, but never all, of what is left */
+    {
+        uint32_t plain = tm.soft_ms;
+        tm_allocate(&tm, 60000, 2000, 0, 0, 0);
+        if (tm.soft_ms > plain)
+            PASS("Increment raises the soft budget");
+        else
+            FAIL("Increment budget", "soft %u -> %u",
+                 (unsigned)plain, (unsigned)tm.soft_ms);
+    }
+    tm_allocate(&tm, 1000, 0, 1, 0, 0);
+    if (tm.hard_ms > 500 && tm.hard_ms < 1000 - TM_OVERHEAD_MS)
+        PASS("movestogo 1 keeps a margin on the clock");
+    else
+        FAIL("movestogo 1 budget", "hard=%u", (unsigned)tm.hard_ms);
+
+    /* Fixed movetime: hard limit only */
+    tm_allocate(&tm, 60000, 0, 0, 700, 0);
+    if (tm.soft_ms == 0 && tm.hard_ms == 700)
+        PASS("movetime is a plain hard limit");
+    else
+        FAIL("movetime budget", "soft=%u hard=%u",
+             (unsigned)tm.soft_ms, (unsigned)tm.hard_ms);
+
+    /* A settled best move stops before an unsettled one would */
+    tm_allocate(&tm, 0, 0, 0, 0, 10000);
+    if (tm_next_iteration(&tm, 50, 20, 1) && tm_next_iteration(&tm, 100, 50, 0) &&
+        tm_next_iteration(&tm, 200, 100, 0) && tm_next_iteration(&tm, 400, 200, 0) &&
+        !tm_next_iteration(&tm, 4000, 1000, 0))
+        PASS("Stable best move stops at the scaled soft limit");
+    else
+        FAIL("Stable best move stop", "stable=%u", (unsigned)tm.stable);
+    tm_allocate(&tm, 0, 0, 0, 0, 10000);
+    if (tm_next_iteration(&tm, 4000, 1000, 1))
+        PASS("Changed best move keeps searching at the same point");
+    else
+        FAIL("Changed best move", "stopped at 4000 ms");
+
+    /* Iteration predicted to overrun the hard limit is not started */
+    tm_allocate(&tm, 0, 0, 0, 1000, 0);
+    tm_next_iteration(&tm, 100, 100, 1);
+    if (!tm_next_iteration(&tm, 500, 400, 1))
+        PASS("Iteration predicted to overrun is skipped");
+    else
+        FAIL("Overrun prediction", "would start at 500 ms with a 400 ms iteration");
+
+    /* Through the engine: a long nominal time on a one-reply position
+       ends early once the only move is settled */
+    set_fen("7k/8/8/8/8/8/6r1/7K w - - 0 1");
+    memset(&clock, 0, sizeof(clock));
+    clock.target_time = 3000;
+    t0 = test_time_ms();
+    m = engine_think_clock(0, &clock);
+    elapsed = test_time_ms() - t0;
+    if (m.from_row != ENGINE_SQ_NONE && elapsed < 3000)
+        PASS("Nominal think time stops early on a forced move");
+    else
+        FAIL("Nominal think time", "%u ms, from_row=%u",
+             (unsigned)elapsed, (unsigned)m.from_row);
+}
+
+/* ========== Test: Search Continuation ========== */
+
+static void test_search_continue(void)
+{
+    search_limits_t limits;
+    search_result_t first, again;
+
+    printf("\n=== Search Continuation Tests ===\n");
+
+    set_fen("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4");
+    memset(&limits, 0, sizeof(limits));
+    limits.max_depth = 5;
+    first = search_go(&engine_board, &limits);
+
+    /* Same position, same depth: nothing left to search */
+    search_continue_next();
+    again = search_go(&engine_board, &limits);
+    if (again.nodes == 0 && again.depth == 5 &&
+        MOVE_EQ(again.best_move, first.best_move))
+        PASS("Continued search reuses completed iterations");
+    else
+        FAIL("Continued search reuses completed iterations",
+             "depth %u, %u nodes", (unsigned)again.depth, (unsigned)again.nodes);
+
+    /* One ply deeper: only the new iteration runs */
+    search_continue_next();
+    limits.max_depth = 6;
+    again = search_go(&engine_board, &limits);
+    if (again.depth == 6 && again.nodes > 0)
+        PASS("Continued search goes one ply deeper");
+    else
+        FAIL("Continued search goes one ply deeper", "depth %u", (unsigned)again.depth);
+
+    /* Different position: starts from scratch */
+    set_fen("6k1/5ppp/8/8/8/8/8/3R2K1 w - - 0 1");
+    search_continue_next();
+    limits.max_depth = 3;
+    again = search_go(&engine_board, &limits);
+    if (again.depth == 3 && again.nodes > 0)
+        PASS("Continuation ignored for another position");
+    else
+        FAIL("Continuation ignored for another position", "depth %u, %u nodes",
+             (unsigned)again.depth, (unsigned)again.nodes);
+}
+
+/* ========== Test: PV and Search Info ========== */
+
+static board_t pv_root;
+static uint8_t info_calls, info_last_depth, info_bad;
+
+/* Every reported PV must be a legal line from the root */
+static void collect_info(const search_info_t *info)
+{
+    board_t b = pv_root;
+    move_t moves[MAX_MOVES];
+    undo_t undo;
+    uint8_t i, j, count;
+
+    info_calls++;
+    if (info->depth != info_last_depth + 1 || info->pv_len == 0 ||
+        info->seldepth < info->depth || info->hashfull > 1000)
+        info_bad++;
+    info_last_depth = info->depth;
+
+    for (i = 0; i < info->pv_len; i++) {
+        count = generate_moves(&b, moves, GEN_ALL);
+        for (j = 0; j < count; j++)
+            if (MOVE_EQ(moves[j], info->pv[i])) break;
+        if (j == count) { info_bad++; return; }
+        board_make(&b, moves[j], &undo);
+        if (!board_is_legal(&b)) { info_bad++; return; }
+    }
+}
+
+static void test_pv(void)
+{
+    search_limits_t limits;
+    search_result_t r;
+    move_t pv[SEARCH_PV_MAX];
+    uint8_t n;
+    engine_move_t best, reply;
+
+    printf("\n=== PV / Search Info Tests ===\n");
+
+    set_fen("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4");
+    pv_root = engine_board;
+    info_calls = info_last_depth = info_bad = 0;
+    memset(&limits, 0, sizeof(limits));
+    limits.max_depth = 6;
+    search_set_info(collect_info);
+    r = search_go(&engine_board, &limits);
+    search_set_info(NULL);
+
+    if (info_calls == 6 && !info_bad)
+        PASS("One legal PV reported per iteration");
+    else
+        FAIL("One legal PV reported per iteration", "%u calls, %u bad",
+             (unsigned)info_calls, (unsigned)info_bad);
+
+    n = search_get_pv(&engine_board, pv, SEARCH_PV_MAX);
+    if (n >= 2 && MOVE_EQ(pv[0], r.best_move))
+        PASS("PV starts with the best move");
+    else
+        FAIL("PV starts with the best move", "PV length %u", (unsigned)n);
+
+    /* The ponder move is the PV's second move */
+    best.from_row = SQ_TO_ROW(pv[0].from); best.from_col = SQ_TO_COL(pv[0].from);
+    best.to_row = SQ_TO_ROW(pv[0].to);     best.to_col = SQ_TO_COL(pv[0].to);
+    best.flags = pv[0].flags;
+    reply = engine_get_ponder_move(&best);
+    if (n >= 2 && reply.from_row == SQ_TO_ROW(pv[1].from) &&
+        reply.from_col == SQ_TO_COL(pv[1].from) &&
+        reply.to_row == SQ_TO_ROW(pv[1].to) && reply.to_col == SQ_TO_COL(pv[1].to))
+        PASS("Ponder move follows the PV");
+    else
+        FAIL("Ponder move follows the PV", "reply differs from pv[1]");
+
+    set_fen("6k1/5ppp/8/8/8/8/8/3R2K1 w - - 0 1");
+    if (search_get_pv(&engine_board, pv, SEARCH_PV_MAX) == 0)
+        PASS("No PV for a position not searched");
+    else
+        FAIL("No PV for a position not searched", "stale PV returned");
+}
+
+/* ========== Test: Endgame Bitbase ========== */
+
+/* Payload written by `make bitbase`, relative to the engine directory */
+#ifndef BITBASE_FILE
+#define BITBASE_FILE "build/CHEGTB.bin"
+#endif
+
+static void check_bitbase(const char *name, const char *fen, int expect)
+{
+    int score = 0;
+    set_fen(fen);
+    if (bitbase_probe(&engine_board, &score) &&
+        (expect ? score * expect > 0 : score == 0))
+        PASS(name);
+    else
+        FAIL(name, "score %d", score);
+}
+
+static void test_bitbase(void)
+{
+    static uint8_t data[32768];
+    FILE *f;
+    size_t size = 0;
+    int score;
+    search_limits_t limits;
+    search_result_t r;
+
+    printf("\n=== Bitbase Tests ===\n");
+
+    f = fopen(BITBASE_FILE, "rb");
+    if (f) {
+        size = fread(data, 1, sizeof(data), f);
+        fclose(f);
+    }
+    if (engine_set_bitbase(data, (uint32_t)size) == 1) {
+        PASS("KPK table loaded");
+    } else {
+        FAIL("KPK table loaded", "no table in %s", BITBASE_FILE);
+        return;
+    }
+
+    check_bitbase("King on the sixth wins", "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", 1);
+    check_bitbase("...whoever moves", "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", -1);
+    check_bitbase("Black pawn side wins", "8/8/8/8/4p3/4k3/8/4K3 b - - 0 1", 1);
+    check_bitbase("Mirrored g-pawn wins", "6k1/8/6K1/6P1/8/8/8/8 w - - 0 1", 1);
+    check_bitbase("Pawn on seventh, stalemate", "3k4/3P4/3K4/8/8/8/8/8 b - - 0 1", 0);
+    check_bitbase("Pawn on seventh, white to move wins", "3k4/3P4/3K4/8/8/8/8/8 w - - 0 1", 1);
+    check_bitbase("Rook pawn vs cornered king", "k7/8/8/8/8/8/P7/K7 w - - 0 1", 0);
+
+    set_fen("4k3/8/4K3/4N3/8/8/8/8 w - - 0 1");
+    if (!bitbase_probe(&engine_board, &score))
+        PASS("No table for KNK");
+    else
+        FAIL("No table for KNK", "probe answered %d", score);
+
+    /* The search sees the win at once and still prefers promoting */
+    set_fen("8/8/8/8/8/1k6/6P1/6K1 w - - 0 1");
+    memset(&limits, 0, sizeof(limits));
+    limits.max_depth = 3;
+    r = search_go(&engine_board, &limits);
+    if (r.score >= BITBASE_WIN)
+        PASS("Search scores a won KPK");
+    else
+        FAIL("Search scores a won KPK", "score %d", r.score);
+
+    set_fen("8/6P1/8/8/8/1k6/8/6K1 w - - 0 1");
+    r = search_go(&engine_board, &limits);
+    if (r.best_move.to == RC_TO_SQ(0, 6))
+        PASS("Search promotes out of the bitbase");
+    else
+        FAIL("Search promotes out of the bitbase", "score %d", r.score);
+
+    engine_set_bitbase(0, 0);
+}
+
+/* ========== Test: TT Bucket Replacement ========== */
+
+static void test_tt_buckets(void)
+{
+    zhash_t h = 0x1234;
+    int score;
+    tt_move16_t mv;
+    int8_t depth;
+    uint8_t flag;
+
+    printf("\n=== TT Bucket Tests ===\n");
+
+    tt_clear();
+    tt_new_search();
+
+    /* Deep entry, then two shallow stores to the same bucket */
+    tt_store(h, 0x1111, 50, TT_MOVE_NONE, 8, TT_EXACT);
+    tt_store(h, 0x2222, 10, TT_MOVE_NONE, 1, TT_BETA);
+    tt_store(h, 0x3333, 20, TT_MOVE_NONE, 1, TT_ALPHA);
+
+    if (tt_probe(h, 0x1111, &score, &mv, &depth, &flag) &&
+        score == 50 && depth == 8 && flag == TT_EXACT)
+        PASS("Deep entry survives shallow stores");
+    else
+        FAIL("Deep entry survives shallow stores", "deep entry was evicted");
+
+    if (tt_probe(h, 0x3333, &score, &mv, &depth, &flag) &&
+        score == 20 && flag == TT_ALPHA)
+        PASS("Shallow entry lands in always-replace slot");
+    else
+        FAIL("Shallow entry lands in always-replace slot", "latest shallow entry missing");
+
+    /* Next search: the old deep entry is stale and yields to a shallow one */
+    tt_new_search();
+    tt_store(h, 0x4444, 30, TT_MOVE_NONE, 1, TT_EXACT);
+    if (tt_probe(h, 0x4444, &score, &mv, &depth, &flag) &&
+        !tt_probe(h, 0x1111, &score, &mv, &depth, &flag) &&
+        tt_probe(h, 0x3333, &score, &mv, &depth, &flag))
+        PASS("Stale deep entry replaced first");
+    else
+        FAIL("Stale deep entry replaced first", "aging did not evict the old entry");
+
+    tt_clear();
+}
+
 int main(void)
 {
     engine_hooks_t hooks;
@@ -575,6 +1084,17 @@ int main(void)
     test_eval_sanity();
     test_eval_incremental();
     test_full_game();
+    test_tt_buckets();
+    test_see();
+    test_eval_bounded();
+    test_eval_features();
+    test_time_manager();
+    test_search_continue();
+    test_pv();
+    test_bitbase();
+#if defined(ATTACK_MAPS) || defined(BITBOARDS)
+    test_incremental_state();
+#endif
 
     printf("\n========================================\n");
     printf("Results: %d passed, %d failed (of %d)\n",
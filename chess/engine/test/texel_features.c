@@ -0,0 +1,723 @@
+/*
+ * texel_features.c — Native Texel feature extractor
+ *
+ * Streams a fen,label CSV (build_texel_dataset.py output) through the
+ * EVAL_TRACE build of evaluate() and writes the .npz feature cache that
+ * texel_tune.py's load_feature_cache() reads: per position the untuned
+ * mg/eg base, phase, side sign and label, plus one mg and one eg column
+ * per tuner parameter.  Positions are split across worker threads.
+ *
+ * The cache records --dataset as the tuner will see it, so run the tuner
+ * with the same --dataset path or it will not accept the cache.
+ *
+ * Build: make texel-features  (from chess/engine/)
+ * Run:   ./build/texel_features --dataset <csv> --out <npz>
+ *            [--max-positions N] [--threads N]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "../src/board.h"
+#include "../src/eval.h"
+#include "../src/zobrist.h"
+
+#ifndef EVAL_TRACE
+#error "texel_features needs the EVAL_TRACE eval build (make texel-features)"
+#endif
+
+/* ========== FEN Parser (copied from eval_fen.c) ========== */
+
+/* Returns 0 for placements the tuner would reject: bad characters,
+   ranks that are not 8 squares, or not exactly one king per side. */
+static int board_set_fen(board_t *b, const char *fen)
+{
+    int r = 0, c = 0;
+    uint8_t castling = 0;
+    uint8_t ep_sq = SQ_NONE;
+    uint8_t kings[2] = { 0, 0 };
+    uint8_t side;
+    const char *p = fen;
+
+    board_init(b);
+
+    while (*p && *p != ' ') {
+        if (*p == '/') {
+            if (c != 8) return 0;
+            r++;
+            c = 0;
+        } else if (*p >= '1' && *p <= '8') {
+            c += *p - '0';
+        } else {
+            uint8_t piece = PIECE_NONE;
+            uint8_t color = (*p >= 'a') ? COLOR_BLACK : COLOR_WHITE;
+            char ch = (*p >= 'a') ? (char)(*p - 32) : *p;
+
+            switch (ch) {
+                case 'P': piece = MAKE_PIECE(color, PIECE_PAWN); break;
+                case 'N': piece = MAKE_PIECE(color, PIECE_KNIGHT); break;
+                case 'B': piece = MAKE_PIECE(color, PIECE_BISHOP); break;
+                case 'R': piece = MAKE_PIECE(color, PIECE_ROOK); break;
+                case 'Q': piece = MAKE_PIECE(color, PIECE_QUEEN); break;
+                case 'K': piece = MAKE_PIECE(color, PIECE_KING); break;
+            }
+            if (piece == PIECE_NONE || r >= 8 || c >= 8) return 0;
+
+            {
+                uint8_t sq = RC_TO_SQ(r, c);
+                uint8_t s = IS_BLACK(piece) ? BLACK : WHITE;
+                uint8_t idx = b->piece_count[s];
+
+                if (idx >= 16) return 0;
+                b->squares[sq] = piece;
+                b->piece_list[s][idx] = sq;
+                b->piece_index[sq] = idx;
+                b->piece_count[s] = idx + 1;
+
+                if (PIECE_TYPE(piece) == PIECE_KING) {
+                    b->king_sq[s] = sq;
+                    kings[s]++;
+                } else if (PIECE_TYPE(piece) == PIECE_BISHOP) {
+                    b->bishop_count[s]++;
+                }
+            }
+            c++;
+        }
+        if (c > 8) return 0;
+        p++;
+    }
+    if (r != 7 || c != 8 || kings[WHITE] != 1 || kings[BLACK] != 1)
+        return 0;
+
+    if (*p == ' ') p++;
+    if (*p != 'w' && *p != 'b') return 0;
+    side = (*p == 'b') ? BLACK : WHITE;
+    b->side = side;
+    p++;
+
+    if (*p == ' ') p++;
+    while (*p && *p != ' ') {
+        switch (*p) {
+            case 'K': castling |= CASTLE_WK; break;
+            case 'Q': castling |= CASTLE_WQ; break;
+            case 'k': castling |= CASTLE_BK; break;
+            case 'q': castling |= CASTLE_BQ; break;
+        }
+        p++;
+    }
+    b->castling = castling;
+
+    if (*p == ' ') p++;
+    if (*p != '-' && *p) {
+        uint8_t file = (uint8_t)(*p - 'a');
+        p++;
+        if (file < 8 && *p >= '1' && *p <= '8') {
+            uint8_t rank = (uint8_t)(*p - '1');
+            ep_sq = RC_TO_SQ(7 - rank, file);
+            p++;
+        }
+    }
+    b->ep_square = ep_sq;
+
+    /* Material + PST and phase; the trace build probes no hashed cache */
+    {
+        int sq;
+        for (sq = 0; sq < 128; sq++) {
+            uint8_t piece, s, idx, sq64;
+
+            if (!SQ_VALID(sq)) continue;
+            piece = b->squares[sq];
+            if (piece == PIECE_NONE) continue;
+
+            s = IS_BLACK(piece) ? BLACK : WHITE;
+            idx = EVAL_INDEX(PIECE_TYPE(piece));
+            sq64 = SQ_TO_SQ64((uint8_t)sq);
+            if (s == BLACK) sq64 = PST_FLIP(sq64);
+            b->mg[s] += mg_table[idx][sq64];
+            b->eg[s] += eg_table[idx][sq64];
+            b->phase += phase_weight[idx];
+        }
+    }
+#ifdef ATTACK_MAPS
+    board_compute_attacks(b);
+#endif
+#ifdef BITBOARDS
+    board_compute_bitboards(b);
+#endif
+    return 1;
+}
+
+/* ========== Tuner Parameters ========== */
+
+/* texel_tune.py build_param_specs() order: each parameter is one phase
+   of one traced term. */
+#define NUM_PARAMS (2 * ET_COUNT)
+
+typedef struct {
+    char name[32];
+    uint8_t term;
+    uint8_t eg;               /* 0 = mg column, 1 = eg column */
+} param_t;
+
+static param_t params[NUM_PARAMS];
+
+/* A run of terms named fmt(phase, first_label + i), mg before eg */
+static int add_run(int n, const char *fmt, uint8_t first, int count,
+                   int first_label)
+{
+    int i, phase;
+    for (i = 0; i < count; i++) {
+        for (phase = 0; phase < 2; phase++) {
+            snprintf(params[n].name, sizeof(params[n].name), fmt,
+                     phase ? "eg" : "mg", first_label + i);
+            params[n].term = (uint8_t)(first + i);
+            params[n].eg = (uint8_t)phase;
+            n++;
+        }
+    }
+    return n;
+}
+
+static void build_params(void)
+{
+    static const char *const pieces[6] = {
+        "pawn", "knight", "bishop", "rook", "queen", "king"
+    };
+    static const struct { const char *name; uint8_t term; } scalars[] = {
+        { "bishop_pair",   ET_BISHOP_PAIR },
+        { "tempo",         ET_TEMPO },
+        { "doubled",       ET_DOUBLED },
+        { "isolated",      ET_ISOLATED },
+        { "rook_open",     ET_ROOK_OPEN },
+        { "rook_semiopen", ET_ROOK_SEMIOPEN },
+        { "shield",        ET_SHIELD },
+    };
+    int n = 0, i, phase;
+
+    for (i = 0; i < 6; i++) {
+        for (phase = 0; phase < 2; phase++) {
+            snprintf(params[n].name, sizeof(params[n].name), "table_%s_%s",
+                     pieces[i], phase ? "eg" : "mg");
+            params[n].term = (uint8_t)(ET_TABLE + i);
+            params[n].eg = (uint8_t)phase;
+            n++;
+        }
+    }
+    /* Scalars come mg then eg per term, like SCALAR_PARAMS */
+    for (i = 0; i < (int)(sizeof(scalars) / sizeof(scalars[0])); i++) {
+        for (phase = 0; phase < 2; phase++) {
+            snprintf(params[n].name, sizeof(params[n].name), "%s_%s",
+                     scalars[i].name, phase ? "eg" : "mg");
+            params[n].term = scalars[i].term;
+            params[n].eg = (uint8_t)phase;
+            n++;
+        }
+    }
+    /* Rank runs are labelled by relative rank (r2..r7) */
+    n = add_run(n, "connected_%s_r%d", ET_CONNECTED, ET_PASSED - ET_CONNECTED, 2);
+    n = add_run(n, "passed_%s_r%d", ET_PASSED, ET_ROOK_OPEN - ET_PASSED, 2);
+    n = add_run(n, "knight_mob_%s_%d", ET_KNIGHT_MOB, ET_BISHOP_MOB - ET_KNIGHT_MOB, 0);
+    n = add_run(n, "bishop_mob_%s_%d", ET_BISHOP_MOB, ET_SHIELD - ET_BISHOP_MOB, 0);
+    (void)n;
+}
+
+/* ========== Dataset ========== */
+
+typedef struct {
+    char **fens;
+    double *labels;
+    size_t count;
+} dataset_t;
+
+/* Read the CSV into memory.  Columns are found by header name, as
+   csv.DictReader does; the FEN field never contains a comma. */
+static int load_dataset(const char *path, size_t max_positions, dataset_t *ds)
+{
+    FILE *f = fopen(path, "r");
+    char line[1024];
+    int fen_col = -1, label_col = -1, col;
+    size_t cap = 0;
+    char *tok, *save;
+
+    memset(ds, 0, sizeof(*ds));
+    if (!f) return 0;
+
+    if (!fgets(line, sizeof(line), f)) { fclose(f); return 0; }
+    line[strcspn(line, "\r\n")] = '\0';
+    for (col = 0, tok = strtok_r(line, ",", &save); tok;
+         col++, tok = strtok_r(NULL, ",", &save)) {
+        if (strcmp(tok, "fen") == 0) fen_col = col;
+        else if (strcmp(tok, "label") == 0) label_col = col;
+    }
+    if (fen_col < 0 || label_col < 0) {
+        fprintf(stderr, "Error: %s has no fen,label header\n", path);
+        fclose(f);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        char *fen = NULL, *label = NULL;
+
+        if (max_positions && ds->count >= max_positions) break;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') continue;
+        for (col = 0, tok = strtok_r(line, ",", &save); tok;
+             col++, tok = strtok_r(NULL, ",", &save)) {
+            if (col == fen_col) fen = tok;
+            else if (col == label_col) label = tok;
+        }
+        if (!fen || !label) continue;
+
+        if (ds->count == cap) {
+            cap = cap ? cap * 2 : 65536;
+            ds->fens = realloc(ds->fens, cap * sizeof(*ds->fens));
+            ds->labels = realloc(ds->labels, cap * sizeof(*ds->labels));
+            if (!ds->fens || !ds->labels) { fclose(f); return 0; }
+        }
+        ds->fens[ds->count] = strdup(fen);
+        ds->labels[ds->count] = strtod(label, NULL);
+        ds->count++;
+    }
+    fclose(f);
+    return 1;
+}
+
+/* ========== Extraction ========== */
+
+typedef struct {
+    double *mg_base, *eg_base, *phase, *side_sign, *labels;
+    double *mg_terms, *eg_terms;      /* [row * NUM_PARAMS + param] */
+    uint8_t *valid;
+} features_t;
+
+typedef struct {
+    pthread_t tid;
+    uint8_t started;
+    const dataset_t *ds;
+    features_t *ft;
+    size_t lo, hi;
+} worker_t;
+
+static void *extract_worker(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
+    features_t *ft = w->ft;
+    board_t b;
+    size_t i;
+    int j;
+
+    for (i = w->lo; i < w->hi; i++) {
+        const eval_trace_t *t;
+        double *mg_row = ft->mg_terms + i * NUM_PARAMS;
+        double *eg_row = ft->eg_terms + i * NUM_PARAMS;
+
+        if (!board_set_fen(&b, w->ds->fens[i])) {
+            ft->valid[i] = 0;
+            continue;
+        }
+        (void)evaluate(&b);
+        t = eval_trace_get();
+
+        ft->valid[i] = 1;
+        ft->mg_base[i] = t->mg_base;
+        ft->eg_base[i] = t->eg_base;
+        ft->phase[i] = t->phase;
+        ft->side_sign[i] = (b.side == WHITE) ? 1.0 : -1.0;
+        ft->labels[i] = w->ds->labels[i];
+        for (j = 0; j < NUM_PARAMS; j++) {
+            mg_row[j] = params[j].eg ? 0.0 : t->mg[params[j].term];
+            eg_row[j] = params[j].eg ? t->eg[params[j].term] : 0.0;
+        }
+    }
+    return NULL;
+}
+
+/* Drop rejected rows in place, keeping dataset order */
+static size_t compact_rows(features_t *ft, size_t n)
+{
+    size_t i, kept = 0;
+
+    for (i = 0; i < n; i++) {
+        if (!ft->valid[i]) continue;
+        if (kept != i) {
+            ft->mg_base[kept] = ft->mg_base[i];
+            ft->eg_base[kept] = ft->eg_base[i];
+            ft->phase[kept] = ft->phase[i];
+            ft->side_sign[kept] = ft->side_sign[i];
+            ft->labels[kept] = ft->labels[i];
+            memmove(ft->mg_terms + kept * NUM_PARAMS,
+                    ft->mg_terms + i * NUM_PARAMS, NUM_PARAMS * sizeof(double));
+            memmove(ft->eg_terms + kept * NUM_PARAMS,
+                    ft->eg_terms + i * NUM_PARAMS, NUM_PARAMS * sizeof(double));
+        }
+        kept++;
+    }
+    return kept;
+}
+
+/* ========== NPZ Writer ========== */
+
+/* An .npz is a zip of .npy files.  Members are stored uncompressed
+   with zip64 sizes so multi-gigabyte feature matrices fit. */
+
+#define NPZ_MAX_MEMBERS 16
+
+typedef struct {
+    FILE *f;
+    uint64_t offset;
+    int count;
+    struct {
+        char name[32];
+        uint64_t offset, size;
+        uint32_t crc;
+    } m[NPZ_MAX_MEMBERS];
+} npz_t;
+
+static uint32_t crc_table[256];
+
+static void crc_init(void)
+{
+    uint32_t i, k, c;
+    for (i = 0; i < 256; i++) {
+        c = i;
+        for (k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    while (len--)
+        crc = crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_le(FILE *f, uint64_t v, int bytes)
+{
+    while (bytes--) {
+        fputc((int)(v & 0xFF), f);
+        v >>= 8;
+    }
+}
+
+/* Build an .npy v1.0 header padded to 64 bytes; returns its length */
+static size_t npy_header(char *out, const char *descr, const char *shape)
+{
+    char dict[192];
+    size_t len = (size_t)snprintf(dict, sizeof(dict),
+        "{'descr': '%s', 'fortran_order': False, 'shape': %s, }", descr, shape);
+    size_t total = 10 + len + 1;
+    size_t pad = (64 - total % 64) % 64;
+
+    memcpy(out, "\x93NUMPY\x01\x00", 8);
+    out[8] = (char)((len + pad + 1) & 0xFF);
+    out[9] = (char)((len + pad + 1) >> 8);
+    memcpy(out + 10, dict, len);
+    memset(out + 10 + len, ' ', pad);
+    out[10 + len + pad] = '\n';
+    return total + pad;
+}
+
+static void npz_member(npz_t *z, const char *key, const char *descr,
+                       const char *shape, const void *data, uint64_t bytes)
+{
+    char header[256];
+    size_t hlen = npy_header(header, descr, shape);
+    uint64_t size = hlen + bytes;
+    uint32_t crc = crc_update(0, header, hlen);
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t left = bytes;
+    int i = z->count++;
+    size_t name_len;
+
+    /* crc_update takes size_t; feed big arrays in chunks */
+    while (left) {
+        size_t chunk = left > (1u << 30) ? (1u << 30) : (size_t)left;
+        crc = crc_update(crc, p, chunk);
+        p += chunk;
+        left -= chunk;
+    }
+
+    snprintf(z->m[i].name, sizeof(z->m[i].name), "%s.npy", key);
+    name_len = strlen(z->m[i].name);
+    z->m[i].offset = z->offset;
+    z->m[i].size = size;
+    z->m[i].crc = crc;
+
+    /* Local file header + zip64 extra (sizes) */
+    put_le(z->f, 0x04034b50, 4);
+    put_le(z->f, 45, 2);                    /* version needed: zip64 */
+    put_le(z->f, 0, 2);                     /* flags */
+    put_le(z->f, 0, 2);                     /* stored */
+    put_le(z->f, 0, 2);                     /* time */
+    put_le(z->f, 0x21, 2);                  /* date: 1980-01-01 */
+    put_le(z->f, crc, 4);
+    put_le(z->f, 0xFFFFFFFFu, 4);
+    put_le(z->f, 0xFFFFFFFFu, 4);
+    put_le(z->f, name_len, 2);
+    put_le(z->f, 20, 2);
+    fwrite(z->m[i].name, 1, name_len, z->f);
+    put_le(z->f, 0x0001, 2);
+    put_le(z->f, 16, 2);
+    put_le(z->f, size, 8);
+    put_le(z->f, size, 8);
+
+    fwrite(header, 1, hlen, z->f);
+    fwrite(data, 1, (size_t)bytes, z->f);
+    z->offset += 30 + name_len + 20 + size;
+}
+
+static int npz_close(npz_t *z)
+{
+    uint64_t cd_start = z->offset, cd_size = 0;
+    int i;
+
+    for (i = 0; i < z->count; i++) {
+        size_t name_len = strlen(z->m[i].name);
+        put_le(z->f, 0x02014b50, 4);
+        put_le(z->f, 45, 2);                /* made by */
+        put_le(z->f, 45, 2);                /* needed */
+        put_le(z->f, 0, 2);
+        put_le(z->f, 0, 2);
+        put_le(z->f, 0, 2);
+        put_le(z->f, 0x21, 2);
+        put_le(z->f, z->m[i].crc, 4);
+        put_le(z->f, 0xFFFFFFFFu, 4);
+        put_le(z->f, 0xFFFFFFFFu, 4);
+        put_le(z->f, name_len, 2);
+        put_le(z->f, 28, 2);                /* extra */
+        put_le(z->f, 0, 2);                 /* comment */
+        put_le(z->f, 0, 2);                 /* disk */
+        put_le(z->f, 0, 2);                 /* internal attrs */
+        put_le(z->f, 0, 4);                 /* external attrs */
+        put_le(z->f, 0xFFFFFFFFu, 4);       /* offset: in zip64 extra */
+        fwrite(z->m[i].name, 1, name_len, z->f);
+        put_le(z->f, 0x0001, 2);
+        put_le(z->f, 24, 2);
+        put_le(z->f, z->m[i].size, 8);
+        put_le(z->f, z->m[i].size, 8);
+        put_le(z->f, z->m[i].offset, 8);
+        cd_size += 46 + name_len + 28;
+    }
+
+    /* Zip64 end of central directory record + locator */
+    put_le(z->f, 0x06064b50, 4);
+    put_le(z->f, 44, 8);
+    put_le(z->f, 45, 2);
+    put_le(z->f, 45, 2);
+    put_le(z->f, 0, 4);
+    put_le(z->f, 0, 4);
+    put_le(z->f, (uint64_t)z->count, 8);
+    put_le(z->f, (uint64_t)z->count, 8);
+    put_le(z->f, cd_size, 8);
+    put_le(z->f, cd_start, 8);
+
+    put_le(z->f, 0x07064b50, 4);
+    put_le(z->f, 0, 4);
+    put_le(z->f, cd_start + cd_size, 8);
+    put_le(z->f, 1, 4);
+
+    /* Classic end record, pointing at the zip64 one */
+    put_le(z->f, 0x06054b50, 4);
+    put_le(z->f, 0, 2);
+    put_le(z->f, 0, 2);
+    put_le(z->f, (uint64_t)z->count, 2);
+    put_le(z->f, (uint64_t)z->count, 2);
+    put_le(z->f, 0xFFFFFFFFu, 4);
+    put_le(z->f, 0xFFFFFFFFu, 4);
+    put_le(z->f, 0, 2);
+
+    return fclose(z->f) == 0;
+}
+
+/* numpy unicode scalars are UCS-4; decode the UTF-8 path */
+static size_t utf8_to_ucs4(const char *s, uint32_t *out)
+{
+    const uint8_t *p = (const uint8_t *)s;
+    size_t n = 0;
+
+    while (*p) {
+        uint32_t c = *p++;
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : 0;
+        if (extra) c &= 0x3Fu >> extra;
+        while (extra-- && (*p & 0xC0) == 0x80)
+            c = (c << 6) | (*p++ & 0x3F);
+        out[n++] = c;
+    }
+    return n;
+}
+
+/* pathlib.Path(x) form of the dataset path: no "./" prefix, no
+   repeated or trailing slashes */
+static void normalise_path(const char *in, char *out, size_t size)
+{
+    size_t n = 0;
+
+    while (in[0] == '.' && in[1] == '/') {
+        in += 2;
+        while (*in == '/') in++;
+    }
+    for (; *in && n + 1 < size; in++) {
+        if (*in == '/' && n > 0 && out[n - 1] == '/') continue;
+        out[n++] = *in;
+    }
+    while (n > 1 && out[n - 1] == '/') n--;
+    out[n] = '\0';
+}
+
+static int write_cache(const char *path, const char *dataset,
+                       const features_t *ft, size_t n)
+{
+    npz_t z;
+    char shape[64];
+    char descr[32];
+    char norm[1024];
+    uint32_t *text;
+    uint32_t *names;
+    size_t len;
+    int j;
+
+    memset(&z, 0, sizeof(z));
+    z.f = fopen(path, "wb");
+    if (!z.f) return 0;
+
+    normalise_path(dataset, norm, sizeof(norm));
+    text = calloc(strlen(norm) + 1, sizeof(uint32_t));
+    names = calloc((size_t)NUM_PARAMS * 64, sizeof(uint32_t));
+    if (!text || !names) { fclose(z.f); return 0; }
+
+    len = utf8_to_ucs4(norm, text);
+    snprintf(descr, sizeof(descr), "<U%u", (unsigned)(len ? len : 1));
+    npz_member(&z, "dataset_csv", descr, "()", text,
+               (uint64_t)(len ? len : 1) * 4);
+
+    for (j = 0; j < NUM_PARAMS; j++)
+        utf8_to_ucs4(params[j].name, names + (size_t)j * 64);
+    snprintf(shape, sizeof(shape), "(%d,)", NUM_PARAMS);
+    npz_member(&z, "param_names", "<U64", shape, names,
+               (uint64_t)NUM_PARAMS * 64 * 4);
+
+    snprintf(shape, sizeof(shape), "(%lu,)", (unsigned long)n);
+    npz_member(&z, "mg_base", "<f8", shape, ft->mg_base, n * 8ull);
+    npz_member(&z, "eg_base", "<f8", shape, ft->eg_base, n * 8ull);
+    npz_member(&z, "phase", "<f8", shape, ft->phase, n * 8ull);
+    npz_member(&z, "side_sign", "<f8", shape, ft->side_sign, n * 8ull);
+    snprintf(shape, sizeof(shape), "(%lu, %d)", (unsigned long)n, NUM_PARAMS);
+    npz_member(&z, "mg_terms", "<f8", shape, ft->mg_terms, n * NUM_PARAMS * 8ull);
+    npz_member(&z, "eg_terms", "<f8", shape, ft->eg_terms, n * NUM_PARAMS * 8ull);
+    snprintf(shape, sizeof(shape), "(%lu,)", (unsigned long)n);
+    npz_member(&z, "labels", "<f8", shape, ft->labels, n * 8ull);
+
+    free(text);
+    free(names);
+    return npz_close(&z);
+}
+
+/* ========== Main ========== */
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: texel_features --dataset <csv> --out <npz>"
+            " [--max-positions N] [--threads N]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *dataset = NULL, *out = NULL;
+    size_t max_positions = 0, n, kept, per;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    dataset_t ds;
+    features_t ft;
+    worker_t *workers;
+    board_t scratch;
+    long t;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dataset") == 0 && i + 1 < argc) {
+            dataset = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else if (strcmp(argv[i], "--max-positions") == 0 && i + 1 < argc) {
+            max_positions = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atol(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!dataset || !out) {
+        usage();
+        return 2;
+    }
+    if (threads < 1) threads = 1;
+
+    if (!load_dataset(dataset, max_positions, &ds)) {
+        fprintf(stderr, "Error: cannot read dataset %s\n", dataset);
+        return 1;
+    }
+    n = ds.count;
+    printf("Loaded dataset rows: %lu\n", (unsigned long)n);
+    if (n == 0) return 1;
+
+    build_params();
+    crc_init();
+    board_init(&scratch);   /* Zobrist tables, before the workers start */
+
+    ft.mg_base = malloc(n * sizeof(double));
+    ft.eg_base = malloc(n * sizeof(double));
+    ft.phase = malloc(n * sizeof(double));
+    ft.side_sign = malloc(n * sizeof(double));
+    ft.labels = malloc(n * sizeof(double));
+    ft.mg_terms = malloc(n * NUM_PARAMS * sizeof(double));
+    ft.eg_terms = malloc(n * NUM_PARAMS * sizeof(double));
+    ft.valid = malloc(n);
+    workers = calloc((size_t)threads, sizeof(*workers));
+    if (!ft.mg_base || !ft.eg_base || !ft.phase || !ft.side_sign ||
+        !ft.labels || !ft.mg_terms || !ft.eg_terms || !ft.valid || !workers) {
+        fprintf(stderr, "Error: out of memory for %lu positions\n",
+                (unsigned long)n);
+        return 1;
+    }
+
+    per = (n + (size_t)threads - 1) / (size_t)threads;
+    for (t = 0; t < threads; t++) {
+        workers[t].ds = &ds;
+        workers[t].ft = &ft;
+        workers[t].lo = (size_t)t * per < n ? (size_t)t * per : n;
+        workers[t].hi = workers[t].lo + per < n ? workers[t].lo + per : n;
+        workers[t].started =
+            pthread_create(&workers[t].tid, NULL, extract_worker, &workers[t]) == 0;
+        if (!workers[t].started)
+            extract_worker(&workers[t]);    /* run the slice here instead */
+    }
+    for (t = 0; t < threads; t++) {
+        if (workers[t].started)
+            pthread_join(workers[t].tid, NULL);
+    }
+
+    kept = compact_rows(&ft, n);
+    printf("feature_extract processed=%lu kept=%lu threads=%ld\n",
+           (unsigned long)n, (unsigned long)kept, threads);
+    if (kept == 0) {
+        fprintf(stderr, "Error: no valid positions extracted\n");
+        return 1;
+    }
+
+    if (!write_cache(out, dataset, &ft, kept)) {
+        fprintf(stderr, "Error: cannot write %s\n", out);
+        return 1;
+    }
+    printf("Saved feature cache: %s\n", out);
+    return 0;
+}
@@ -2,20 +2,22 @@
 """Texel tuning for chess/engine/src/eval.c feature groups.
 
 This tuner keeps the search code fixed and tunes evaluation-term scales.
+Per-position features come from the native EVAL_TRACE extractor
+(chess/engine/test/texel_features.c), so they always match eval.c.
 """
 
 from __future__ import annotations
 
 import argparse
-import csv
 import json
 import math
 import re
+import subprocess
+import tempfile
 from dataclasses import dataclass
 from pathlib import Path
 from typing import Any
 
-import chess
 import numpy as np
 
 
@@ -106,6 +108,14 @@ def parse_named_array_1d(text: str, name: str, expected_count: int | None = None
     return parse_array_block(m.group(1), expected_count)
 
 
+def parse_connected_bonus(text: str, phase: str) -> np.ndarray:
+    # eval.c may share one connected_bonus table between mg and eg.
+    try:
+        return parse_named_array_1d(text, f"connected_bonus_{phase}")
+    except ValueError:
+        return parse_named_array_1d(text, "connected_bonus")
+
+
 def parse_eval_constants(eval_c_path: Path) -> EvalConstants:
     raw = eval_c_path.read_text(encoding="utf-8")
     text = strip_c_comments(raw)
@@ -134,8 +144,8 @@ def parse_eval_constants(eval_c_path: Path) -> EvalConstants:
         doubled_eg=parse_define(text, "DOUBLED_EG"),
         isolated_mg=parse_define(text, "ISOLATED_MG"),
         isolated_eg=parse_define(text, "ISOLATED_EG"),
-        connected_bonus_mg=parse_named_array_1d(text, "connected_bonus_mg"),
-        connected_bonus_eg=parse_named_array_1d(text, "connected_bonus_eg"),
+        connected_bonus_mg=parse_connected_bonus(text, "mg"),
+        connected_bonus_eg=parse_connected_bonus(text, "eg"),
         passed_mg=parse_named_array_1d(text, "passed_mg"),
         passed_eg=parse_named_array_1d(text, "passed_eg"),
         rook_open_mg=parse_define(text, "ROOK_OPEN_MG"),
@@ -240,404 +250,27 @@ def build_base_values(c: EvalConstants, param_specs: list[ParamSpec]) -> dict[st
     return out
 
 
-def raw_keys_from_specs(param_specs: list[ParamSpec]) -> set[str]:
-    keys: set[str] = set()
-    for spec in param_specs:
-        if spec.mg_key is not None:
-            keys.add(spec.mg_key)
-        if spec.eg_key is not None:
-            keys.add(spec.eg_key)
-    return keys
-
-
-def square_row_col(square: chess.Square) -> tuple[int, int]:
-    rank = chess.square_rank(square)
-    file = chess.square_file(square)
-    row = 7 - rank
-    col = file
-    return row, col
-
-
-def square_to_sq64(square: chess.Square) -> int:
-    rank = chess.square_rank(square)
-    file = chess.square_file(square)
-    return (7 - rank) * 8 + file
-
-
-def piece_sign(color: chess.Color) -> int:
-    return 1 if color == chess.WHITE else -1
-
-
-def build_pawn_masks(board: chess.Board, color: chess.Color) -> list[int]:
-    masks = [0] * 8
-    for sq in board.pieces(chess.PAWN, color):
-        row, col = square_row_col(sq)
-        masks[col] |= 1 << row
-    return masks
-
-
-def pawn_attacks_square(board: chess.Board, square: chess.Square, by_color: chess.Color) -> bool:
-    rank = chess.square_rank(square)
-    file = chess.square_file(square)
-
-    attacker_rank = rank - 1 if by_color == chess.WHITE else rank + 1
-    if attacker_rank < 0 or attacker_rank > 7:
-        return False
-
-    for attacker_file in (file - 1, file + 1):
-        if attacker_file < 0 or attacker_file > 7:
-            continue
-        sq = chess.square(attacker_file, attacker_rank)
-        p = board.piece_at(sq)
-        if p is not None and p.piece_type == chess.PAWN and p.color == by_color:
-            return True
-
-    return False
-
-
-def extract_position_terms(board: chess.Board, c: EvalConstants, raw_keys: set[str]) -> dict[str, Any]:
-    mg_base = 0.0
-    eg_base = 0.0
-    phase = 0
-
-    raw = {k: 0 for k in raw_keys}
-
-    # Piece-table contributions are fully tunable; keep them out of mg_base/eg_base.
-    for square, piece in board.piece_map().items():
-        idx = piece.piece_type - 1
-        sq64 = square_to_sq64(square)
-        pst_sq = sq64 if piece.color == chess.WHITE else (sq64 ^ 56)
-        sgn = piece_sign(piece.color)
-
-        piece_name = PIECE_NAMES[idx]
-        raw[f"table_{piece_name}_mg"] += sgn * int(c.mg_table[idx, pst_sq])
-        raw[f"table_{piece_name}_eg"] += sgn * int(c.eg_table[idx, pst_sq])
-        phase += int(c.phase_weight[idx])
-
-    if phase < 0:
-        phase = 0
-    elif phase > 24:
-        phase = 24
-
-    w_bishops = len(board.pieces(chess.BISHOP, chess.WHITE))
-    b_bishops = len(board.pieces(chess.BISHOP, chess.BLACK))
-    if w_bishops >= 2:
-        raw["bishop_pair_mg"] += c.bishop_pair_mg
-        raw["bishop_pair_eg"] += c.bishop_pair_eg
-    if b_bishops >= 2:
-        raw["bishop_pair_mg"] -= c.bishop_pair_mg
-        raw["bishop_pair_eg"] -= c.bishop_pair_eg
-
-    if board.turn == chess.WHITE:
-        raw["tempo_mg"] += c.tempo_mg
-        raw["tempo_eg"] += c.tempo_eg
-    else:
-        raw["tempo_mg"] -= c.tempo_mg
-        raw["tempo_eg"] -= c.tempo_eg
-
-    w_pawns = build_pawn_masks(board, chess.WHITE)
-    b_pawns = build_pawn_masks(board, chess.BLACK)
-
-    for sq in board.pieces(chess.PAWN, chess.WHITE):
-        row, col = square_row_col(sq)
-        rel_rank = chess.square_rank(sq)
-
-        if w_pawns[col] & ~(1 << row):
-            raw["doubled_mg"] -= c.doubled_mg
-            raw["doubled_eg"] -= c.doubled_eg
-
-        adj = 0
-        if col > 0:
-            adj |= w_pawns[col - 1]
-        if col < 7:
-            adj |= w_pawns[col + 1]
-        if adj == 0:
-            raw["isolated_mg"] -= c.isolated_mg
-            raw["isolated_eg"] -= c.isolated_eg
-
-        supported = False
-        for df in (-1, 1):
-            f = chess.square_file(sq) + df
-            r = chess.square_rank(sq) - 1
-            if 0 <= f <= 7 and 0 <= r <= 7:
-                p = board.piece_at(chess.square(f, r))
-                if p is not None and p.piece_type == chess.PAWN and p.color == chess.WHITE:
-                    supported = True
-                    break
-        if supported and 2 <= rel_rank <= 7:
-            ri = rel_rank - 2
-            if ri < len(c.connected_bonus_mg):
-                rank = ri + 2
-                raw[f"connected_mg_r{rank}"] += int(c.connected_bonus_mg[ri])
-                raw[f"connected_eg_r{rank}"] += int(c.connected_bonus_eg[ri])
-
-        passed = True
-        for f in range(col - 1, col + 2):
-            if not (0 <= f <= 7):
-                continue
-            mask = b_pawns[f]
-            for rr in range(0, row):
-                if mask & (1 << rr):
-                    passed = False
-                    break
-            if not passed:
-                break
-
-        if passed and rel_rank >= 2:
-            ri = rel_rank - 2
-            if ri < len(c.passed_mg):
-                rank = ri + 2
-                raw[f"passed_mg_r{rank}"] += int(c.passed_mg[ri])
-                raw[f"passed_eg_r{rank}"] += int(c.passed_eg[ri])
-
-    for sq in board.pieces(chess.PAWN, chess.BLACK):
-        row, col = square_row_col(sq)
-        rel_rank = row
-
-        if b_pawns[col] & ~(1 << row):
-            raw["doubled_mg"] += c.doubled_mg
-            raw["doubled_eg"] += c.doubled_eg
-
-        adj = 0
-        if col > 0:
-            adj |= b_pawns[col - 1]
-        if col < 7:
-            adj |= b_pawns[col + 1]
-        if adj == 0:
-            raw["isolated_mg"] += c.isolated_mg
-            raw["isolated_eg"] += c.isolated_eg
-
-        supported = False
-        for df in (-1, 1):
-            f = chess.square_file(sq) + df
-            r = chess.square_rank(sq) + 1
-            if 0 <= f <= 7 and 0 <= r <= 7:
-                p = board.piece_at(chess.square(f, r))
-                if p is not None and p.piece_type == chess.PAWN and p.color == chess.BLACK:
-                    supported = True
-                    break
-        if supported and 2 <= rel_rank <= 7:
-            ri = rel_rank - 2
-            if ri < len(c.connected_bonus_mg):
-                rank = ri + 2
-                raw[f"connected_mg_r{rank}"] -= int(c.connected_bonus_mg[ri])
-                raw[f"connected_eg_r{rank}"] -= int(c.connected_bonus_eg[ri])
-
-        passed = True
-        for f in range(col - 1, col + 2):
-            if not (0 <= f <= 7):
-                continue
-            mask = w_pawns[f]
-            for rr in range(row + 1, 8):
-                if mask & (1 << rr):
-                    passed = False
-                    break
-            if not passed:
-                break
-
-        if passed and rel_rank >= 2:
-            ri = rel_rank - 2
-            if ri < len(c.passed_mg):
-                rank = ri + 2
-                raw[f"passed_mg_r{rank}"] -= int(c.passed_mg[ri])
-                raw[f"passed_eg_r{rank}"] -= int(c.passed_eg[ri])
-
-    for sq in board.pieces(chess.ROOK, chess.WHITE):
-        col = chess.square_file(sq)
-        if w_pawns[col] == 0 and b_pawns[col] == 0:
-            raw["rook_open_mg"] += c.rook_open_mg
-            raw["rook_open_eg"] += c.rook_open_eg
-        elif w_pawns[col] == 0 and b_pawns[col] != 0:
-            raw["rook_semiopen_mg"] += c.rook_semiopen_mg
-            raw["rook_semiopen_eg"] += c.rook_semiopen_eg
-
-    for sq in board.pieces(chess.ROOK, chess.BLACK):
-        col = chess.square_file(sq)
-        if b_pawns[col] == 0 and w_pawns[col] == 0:
-            raw["rook_open_mg"] -= c.rook_open_mg
-            raw["rook_open_eg"] -= c.rook_open_eg
-        elif b_pawns[col] == 0 and w_pawns[col] != 0:
-            raw["rook_semiopen_mg"] -= c.rook_semiopen_mg
-            raw["rook_semiopen_eg"] -= c.rook_semiopen_eg
-
-    knight_offsets = [
-        (-2, -1),
-        (-2, 1),
-        (-1, -2),
-        (-1, 2),
-        (1, -2),
-        (1, 2),
-        (2, -1),
-        (2, 1),
-    ]
-
-    bishop_dirs = [(-1, -1), (-1, 1), (1, -1), (1, 1)]
-
-    for color, enemy in ((chess.WHITE, chess.BLACK), (chess.BLACK, chess.WHITE)):
-        sgn = 1 if color == chess.WHITE else -1
-        for sq in board.pieces(chess.KNIGHT, color):
-            mob = 0
-            r0 = chess.square_rank(sq)
-            f0 = chess.square_file(sq)
-            for dr, df in knight_offsets:
-                r = r0 + dr
-                f = f0 + df
-                if not (0 <= r <= 7 and 0 <= f <= 7):
-                    continue
-                dst = chess.square(f, r)
-                occ = board.piece_at(dst)
-                if occ is not None and occ.color == color:
-                    continue
-                if pawn_attacks_square(board, dst, enemy):
-                    continue
-                mob += 1
-            mob = min(mob, len(c.knight_mob_mg) - 1)
-            raw[f"knight_mob_mg_{mob}"] += sgn * int(c.knight_mob_mg[mob])
-            raw[f"knight_mob_eg_{mob}"] += sgn * int(c.knight_mob_eg[mob])
-
-        for sq in board.pieces(chess.BISHOP, color):
-            mob = 0
-            r0 = chess.square_rank(sq)
-            f0 = chess.square_file(sq)
-            for dr, df in bishop_dirs:
-                r = r0 + dr
-                f = f0 + df
-                while 0 <= r <= 7 and 0 <= f <= 7:
-                    dst = chess.square(f, r)
-                    occ = board.piece_at(dst)
-                    if occ is not None and occ.color == color:
-                        break
-                    if not pawn_attacks_square(board, dst, enemy):
-                        mob += 1
-                    if occ is not None:
-                        break
-                    r += dr
-                    f += df
-            mob = min(mob, len(c.bishop_mob_mg) - 1)
-            raw[f"bishop_mob_mg_{mob}"] += sgn * int(c.bishop_mob_mg[mob])
-            raw[f"bishop_mob_eg_{mob}"] += sgn * int(c.bishop_mob_eg[mob])
-
-    w_king = board.king(chess.WHITE)
-    if w_king is not None:
-        r = chess.square_rank(w_king)
-        f = chess.square_file(w_king)
-        shield = 0
-        if r < 7:
-            for ff in range(f - 1, f + 2):
-                if 0 <= ff <= 7:
-                    p = board.piece_at(chess.square(ff, r + 1))
-                    if p is not None and p.piece_type == chess.PAWN and p.color == chess.WHITE:
-                        shield += 1
-        raw["shield_mg"] += shield * c.shield_mg
-        raw["shield_eg"] += shield * c.shield_eg
-
-    b_king = board.king(chess.BLACK)
-    if b_king is not None:
-        r = chess.square_rank(b_king)
-        f = chess.square_file(b_king)
-        shield = 0
-        if r > 0:
-            for ff in range(f - 1, f + 2):
-                if 0 <= ff <= 7:
-                    p = board.piece_at(chess.square(ff, r - 1))
-                    if p is not None and p.piece_type == chess.PAWN and p.color == chess.BLACK:
-                        shield += 1
-        raw["shield_mg"] -= shield * c.shield_mg
-        raw["shield_eg"] -= shield * c.shield_eg
-
-    return {
-        "mg_base": float(mg_base),
-        "eg_base": float(eg_base),
-        "phase": float(phase),
-        "side_sign": 1.0 if board.turn == chess.WHITE else -1.0,
-        "raw": raw,
-    }
-
-
-def load_dataset_rows(path: Path, max_positions: int | None) -> tuple[list[str], np.ndarray]:
-    fens: list[str] = []
-    labels: list[float] = []
-
-    with path.open("r", encoding="utf-8", newline="") as f:
-        reader = csv.DictReader(f)
-        for row in reader:
-            fens.append(row["fen"])
-            labels.append(float(row["label"]))
-            if max_positions is not None and len(fens) >= max_positions:
-                break
-
-    return fens, np.array(labels, dtype=np.float64)
-
-
-def build_features(
-    fens: list[str],
-    labels: np.ndarray,
-    constants: EvalConstants,
-    param_specs: list[ParamSpec],
-) -> dict[str, np.ndarray]:
-    n = len(fens)
-    p = len(param_specs)
-
-    mg_base = np.zeros(n, dtype=np.float64)
-    eg_base = np.zeros(n, dtype=np.float64)
-    phase = np.zeros(n, dtype=np.float64)
-    side_sign = np.zeros(n, dtype=np.float64)
-    mg_terms = np.zeros((n, p), dtype=np.float64)
-    eg_terms = np.zeros((n, p), dtype=np.float64)
-
-    raw_keys = raw_keys_from_specs(param_specs)
-
-    kept = 0
-    for i, fen in enumerate(fens):
-        try:
-            board = chess.Board(fen)
-        except ValueError:
-            continue
-
-        terms = extract_position_terms(board, constants, raw_keys)
-        mg_base[kept] = terms["mg_base"]
-        eg_base[kept] = terms["eg_base"]
-        phase[kept] = terms["phase"]
-        side_sign[kept] = terms["side_sign"]
-
-        raw = terms["raw"]
-        for j, spec in enumerate(param_specs):
-            if spec.mg_key is not None:
-                mg_terms[kept, j] = float(raw[spec.mg_key])
-            if spec.eg_key is not None:
-                eg_terms[kept, j] = float(raw[spec.eg_key])
-
-        kept += 1
-        if (i + 1) % 5000 == 0:
-            print(f"feature_extract processed={i+1} kept={kept}", flush=True)
-
-    if kept == 0:
-        raise RuntimeError("no valid positions extracted")
-
-    return {
-        "mg_base": mg_base[:kept],
-        "eg_base": eg_base[:kept],
-        "phase": phase[:kept],
-        "side_sign": side_sign[:kept],
-        "mg_terms": mg_terms[:kept],
-        "eg_terms": eg_terms[:kept],
-        "labels": labels[:kept],
-    }
-
-
-def save_feature_cache(
-    cache_path: Path,
-    arrays: dict[str, np.ndarray],
+def run_native_extractor(
+    extractor: Path,
     dataset_csv: Path,
-    param_specs: list[ParamSpec],
+    cache_path: Path,
+    max_positions: int | None,
+    threads: int | None,
 ) -> None:
+    """Build the feature cache with the EVAL_TRACE extractor
+    (`make -C chess/engine texel-features`), which reads the terms
+    straight out of evaluate() instead of re-implementing it."""
+    if not extractor.exists():
+        raise FileNotFoundError(
+            f"{extractor} not found; build it with `make -C chess/engine texel-features`"
+        )
     cache_path.parent.mkdir(parents=True, exist_ok=True)
-    np.savez_compressed(
-        cache_path,
-        dataset_csv=str(dataset_csv),
-        param_names=np.array([spec.name for spec in param_specs], dtype="U64"),
-        **arrays,
-    )
+    cmd = [str(extractor), "--dataset", str(dataset_csv), "--out", str(cache_path)]
+    if max_positions is not None:
+        cmd += ["--max-positions", str(max_positions)]
+    if threads is not None:
+        cmd += ["--threads", str(threads)]
+    subprocess.run(cmd, check=True)
 
 
 def load_feature_cache(
@@ -891,6 +524,12 @@ def main() -> None:
     parser.add_argument("--eval-c", default="chess/engine/src/eval.c")
     parser.add_argument("--out", required=True, help="Output JSON path")
     parser.add_argument("--feature-cache", default=None, help="Optional .npz cache path")
+    parser.add_argument(
+        "--extractor",
+        default="chess/engine/build/texel_features",
+        help="Native feature extractor binary (make -C chess/engine texel-features)",
+    )
+    parser.add_argument("--threads", type=int, default=None, help="Extractor threads (default: all cores)")
     parser.add_argument("--max-positions", type=int, default=None)
     parser.add_argument("--iters", type=int, default=400)
     parser.add_argument("--lr", type=float, default=0.02)
@@ -921,12 +560,17 @@ def main() -> None:
             print(f"Loaded feature cache: {cache_path}")
 
     if arrays is None:
-        fens, labels = load_dataset_rows(dataset, args.max_positions)
-        print(f"Loaded dataset rows: {len(fens)}")
-        arrays = build_features(fens, labels, constants, param_specs)
+        extractor = Path(args.extractor)
         if cache_path is not None:
-            save_feature_cache(cache_path, arrays, dataset, param_specs)
-            print(f"Saved feature cache: {cache_path}")
+            run_native_extractor(extractor, dataset, cache_path, args.max_positions, args.threads)
+            arrays = load_feature_cache(cache_path, dataset, param_specs)
+        else:
+            with tempfile.TemporaryDirectory() as tmp:
+                tmp_cache = Path(tmp) / "features.npz"
+                run_native_extractor(extractor, dataset, tmp_cache, args.max_positions, args.threads)
+                arrays = load_feature_cache(tmp_cache, dataset, param_specs)
+        if arrays is None:
+            raise RuntimeError("extractor output does not match the tuner's parameter list")
 
     result = train_texel(
         arrays,
@@ -2,7 +2,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <sys/select.h>
+#include <unistd.h>
 #include "../src/engine.h"
+#include "../test/bench_positions.h"
 
 /* ========== Polyglot Opening Book ========== */
 
@@ -200,6 +203,33 @@ static int book_probe(const engine_position_t *pos, char *out)
     return 1;
 }
 
+/* ========== Endgame Bitbase ========== */
+
+static uint8_t *bitbase_data;
+
+/* Load a tools/gen_bitbase_appvar.py --bin payload.  Returns the number
+   of tables in use. */
+static int bitbase_file_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long size;
+    int used;
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) { fclose(f); return 0; }
+    bitbase_data = malloc((size_t)size);
+    if (!bitbase_data) { fclose(f); return 0; }
+    if (fread(bitbase_data, 1, (size_t)size, f) != (size_t)size) {
+        free(bitbase_data); bitbase_data = NULL; fclose(f); return 0;
+    }
+    fclose(f);
+    used = engine_set_bitbase(bitbase_data, (uint32_t)size);
+    if (!used) { free(bitbase_data); bitbase_data = NULL; }
+    return used;
+}
+
 /* ========== Time Function ========== */
 
 static uint32_t uci_time_ms(void)
@@ -349,6 +379,35 @@ static void move_to_uci(engine_move_t em, char *out)
     }
 }
 
+/* ========== Search Info ========== */
+
+/* One "info" line per completed iteration */
+static void uci_info(const engine_info_t *info)
+{
+    char mv[6];
+    uint8_t i;
+
+    printf("info depth %u seldepth %u", (unsigned)info->depth,
+           (unsigned)info->seldepth);
+    if (info->mate)
+        printf(" score mate %d", info->mate);
+    else
+        printf(" score cp %d", info->score);
+    printf(" nodes %u nps %u hashfull %u time %u", (unsigned)info->nodes,
+           (unsigned)(info->time_ms
+                      ? (uint64_t)info->nodes * 1000 / info->time_ms : 0),
+           (unsigned)info->hashfull, (unsigned)info->time_ms);
+    if (info->pv_len) {
+        printf(" pv");
+        for (i = 0; i < info->pv_len; i++) {
+            move_to_uci(info->pv[i], mv);
+            printf(" %s", mv);
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
 /* ========== UCI Protocol ========== */
 
 static int move_count = 0;
@@ -359,7 +418,9 @@ static void handle_position(char *line)
     char *moves;
 
     if (strncmp(p, "startpos", 8) == 0) {
-        engine_new_game();
+        /* Board and move list only: the TT and history survive until
+           "ucinewgame", since GUIs resend the position every move */
+        parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
         current_side = 1; /* white */
         move_count = 0;
         p += 8;
@@ -395,53 +456,196 @@ static void handle_position(char *line)
     }
 }
 
+/* ========== Commands During Search ========== */
+
+/* "go ponder" / "go infinite" search with no depth limit (the engine
+   clamps it to its ply limit) */
+#define UCI_DEPTH_INFINITE 255
+
+static char pending_line[4096];   /* command read mid-search, run after it */
+static uint8_t has_pending;
+static uint8_t uci_stopped;
+static uint8_t uci_pondering;     /* between "go ponder" and "ponderhit" */
+static engine_clock_t ponder_clock; /* time control once the ponder move is played */
+
+static int stdin_ready(void)
+{
+    fd_set fds;
+    struct timeval tv;
+
+    FD_ZERO(&fds);
+    FD_SET(STDIN_FILENO, &fds);
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    return select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) > 0;
+}
+
+/* Read one command that arrives while a search is running.  "stop"
+   and "ponderhit" act on the search, "isready" is answered at once,
+   anything else is kept for the main loop once the search is done. */
+static void read_search_command(void)
+{
+    if (!fgets(pending_line, sizeof(pending_line), stdin)) {
+        strcpy(pending_line, "quit");
+        has_pending = 1;
+        uci_stopped = 1;
+        return;
+    }
+    pending_line[strcspn(pending_line, "\n")] = '\0';
+
+    if (strcmp(pending_line, "stop") == 0) {
+        uci_stopped = 1;
+    } else if (strcmp(pending_line, "ponderhit") == 0) {
+        if (uci_pondering) {
+            uci_pondering = 0;
+            engine_ponderhit(&ponder_clock);
+        }
+    } else if (strcmp(pending_line, "isready") == 0) {
+        printf("readyok\n");
+        fflush(stdout);
+    } else {
+        has_pending = 1;
+    }
+}
+
+/* Think poll: picks up commands without blocking the search */
+static uint8_t uci_poll(void)
+{
+    while (!has_pending && !uci_stopped && stdin_ready())
+        read_search_command();
+    return uci_stopped;
+}
+
+/* Value of "<key> <n>" in a go command, 0 if absent */
+static uint32_t go_param(const char *line, const char *key)
+{
+    const char *p = strstr(line, key);
+    return p ? (uint32_t)atol(p + strlen(key)) : 0;
+}
+
 static void handle_go(char *line)
 {
     uint8_t depth = 0;
-    uint32_t movetime = 0;
+    engine_clock_t clock;
+    uint8_t ponder = strstr(line, "ponder") != NULL;
+    uint8_t infinite = strstr(line, "infinite") != NULL;
     char *p;
     char move_str[6];
+    char ponder_str[6];
     engine_move_t em;
+    engine_position_t pos;
 
-    /* Try opening book first */
-    {
-        engine_position_t pos;
-        char book_move_str[6];
-        engine_get_position(&pos);
-        if (book_probe(&pos, book_move_str)) {
-            printf("bestmove %s\n", book_move_str);
-            fflush(stdout);
-            return;
-        }
-    }
+    uci_stopped = 0;
+    ponder_str[0] = '\0';
 
     p = strstr(line, "depth ");
     if (p) depth = (uint8_t)atoi(p + 6);
 
-    p = strstr(line, "movetime ");
-    if (p) movetime = (uint32_t)atoi(p + 9);
+    /* The time manager turns the clock into soft and hard budgets */
+    memset(&clock, 0, sizeof(clock));
+    clock.move_time = go_param(line, "movetime ");
+    if (!depth) {
+        clock.time_left = go_param(line, current_side == 1 ? "wtime " : "btime ");
+        clock.increment = go_param(line, current_side == 1 ? "winc " : "binc ");
+        clock.moves_to_go = (uint16_t)go_param(line, "movestogo ");
+    }
 
-    /* If wtime/btime are specified, use simple time allocation */
-    if (!movetime && !depth) {
-        p = strstr(line, current_side == 1 ? "wtime " : "btime ");
-        if (p) {
-            uint32_t time_left = (uint32_t)atoi(p + 6);
-            movetime = time_left / 30;
-            if (movetime < 100) movetime = 100;
-        }
+    /* Pondering searches untimed until ponderhit; the clock starts then */
+    uci_pondering = ponder;
+    ponder_clock = clock;
+    if (ponder || infinite) {
+        memset(&clock, 0, sizeof(clock));
+        if (!depth) depth = UCI_DEPTH_INFINITE;
     }
 
-    if (depth == 0 && movetime == 0)
+    if (depth == 0 && !clock.move_time && !clock.time_left)
         depth = 6;
 
-    em = engine_think(depth, movetime);
+    /* Try opening book first */
+    engine_get_position(&pos);
+    if (!book_probe(&pos, move_str)) {
+        em = engine_think_clock(depth, &clock);
+
+        if (em.from_row != ENGINE_SQ_NONE) {
+            engine_move_t pm = engine_get_ponder_move(&em);
+            move_to_uci(em, move_str);
+            if (pm.from_row != ENGINE_SQ_NONE)
+                move_to_uci(pm, ponder_str);
+        } else {
+            strcpy(move_str, "0000");
+        }
+    }
 
-    if (em.from_row != ENGINE_SQ_NONE) {
-        move_to_uci(em, move_str);
+    /* bestmove must wait for "stop" (or "ponderhit" when pondering) */
+    while ((uci_pondering || infinite) && !uci_stopped && !has_pending)
+        read_search_command();
+    uci_pondering = 0;
+
+    if (ponder_str[0])
+        printf("bestmove %s ponder %s\n", move_str, ponder_str);
+    else
         printf("bestmove %s\n", move_str);
-    } else {
-        printf("bestmove 0000\n");
+    fflush(stdout);
+}
+
+/* "setoption name <id> [value <x>]" */
+static void handle_setoption(char *line)
+{
+    char *name = strstr(line, "name ");
+    char *value = strstr(line, " value ");
+
+    if (!name) return;
+    name += 5;
+    if (value) {
+        *value = '\0';
+        value += 7;
+    }
+
+    if (strcmp(name, "Hash") == 0 && value) {
+        uint32_t mb = (uint32_t)atoi(value);
+        uint32_t kb = engine_set_hash_kb(mb * 1024);
+        fprintf(stderr, "info string Hash %u KB\n", (unsigned)kb);
+    } else if (strcmp(name, "Threads") == 0 && value) {
+        int n = atoi(value);
+        uint8_t used = engine_set_threads((uint8_t)(n > 255 ? 255 : (n < 1 ? 1 : n)));
+        fprintf(stderr, "info string Threads %u\n", (unsigned)used);
+    } else if (strcmp(name, "EvalFeatures") == 0 && value) {
+        int mask = atoi(value);
+        uint8_t used = engine_set_eval_features((uint8_t)(mask & ENGINE_EVAL_ALL));
+        fprintf(stderr, "info string EvalFeatures %u\n", (unsigned)used);
     }
+}
+
+/* ========== Bench ========== */
+
+/* "bench [depth]": fixed-depth search of the shared bench positions,
+   each from a new game.  Prints the node total (the bench signature)
+   and NPS; the node total changes only when search behaviour does.
+   "stop" (or end of input) cuts the run short. */
+static void handle_bench(const char *args)
+{
+    int depth = atoi(args);
+    uint32_t nodes = 0, t0, ms;
+    int i;
+
+    if (depth <= 0) depth = BENCH_DEPTH;
+    uci_stopped = 0;
+    engine_set_info(NULL);   /* keep the report readable */
+    t0 = uci_time_ms();
+    for (i = 0; i < BENCH_NUM_POS && !uci_stopped; i++) {
+        engine_new_game();
+        parse_fen(bench_fens[i]);
+        nodes += engine_bench((uint8_t)depth, 0).nodes;
+    }
+    ms = uci_time_ms() - t0;
+    engine_new_game();
+    engine_set_info(uci_info);
+
+    printf("Positions       : %d\n", i);
+    printf("Depth           : %d\n", depth);
+    printf("Nodes searched  : %u\n", (unsigned)nodes);
+    printf("Nodes/second    : %u\n",
+           (unsigned)(ms ? (uint64_t)nodes * 1000 / ms : 0));
     fflush(stdout);
 }
 
@@ -459,6 +663,8 @@ int main(int argc, char *argv[])
 
     hooks.time_ms = uci_time_ms;
     engine_init(&hooks);
+    engine_set_think_poll(uci_poll, 5);
+    engine_set_info(uci_info);
 
     /* Node limit: 0 = unlimited (time-based), or set via -DNODE_LIMIT=N */
 #ifdef NODE_LIMIT
@@ -468,11 +674,15 @@ int main(int argc, char *argv[])
     /* Parse command-line flags */
     {
         const char *book_path = NULL;
-        int i;
+        int i, tables;
         for (i = 1; i < argc - 1; i++) {
             if (strcmp(argv[i], "-book") == 0) {
                 book_path = argv[i + 1];
                 i++;
+            } else if (strcmp(argv[i], "-bitbase") == 0) {
+                tables = bitbase_file_load(argv[i + 1]);
+                fprintf(stderr, "info string Bitbase tables: %d\n", tables);
+                i++;
             } else if (strcmp(argv[i], "-variance") == 0) {
                 engine_set_move_variance(atoi(argv[i + 1]));
                 i++;
@@ -483,12 +693,26 @@ int main(int argc, char *argv[])
         }
     }
 
-    while (fgets(line, sizeof(line), stdin)) {
+    for (;;) {
+        if (has_pending) {
+            /* Command that arrived during the last search */
+            strcpy(line, pending_line);
+            has_pending = 0;
+        } else if (!fgets(line, sizeof(line), stdin)) {
+            break;
+        }
         line[strcspn(line, "\n")] = '\0';
 
         if (strcmp(line, "uci") == 0) {
             printf("id name TI84Chess\n");
             printf("id author hunterchen\n");
+            /* Hash 0 keeps the built-in calculator-sized table */
+            printf("option name Hash type spin default 0 min 0 max 4096\n");
+            printf("option name Threads type spin default 1 min 1 max %d\n",
+                   ENGINE_MAX_THREADS);
+            /* Bit mask of ENGINE_EVAL_* terms, for ablation runs */
+            printf("option name EvalFeatures type spin default %d min 0 max %d\n",
+                   ENGINE_EVAL_ALL, ENGINE_EVAL_ALL);
             printf("uciok\n");
             fflush(stdout);
         } else if (strcmp(line, "isready") == 0) {
@@ -498,8 +722,12 @@ int main(int argc, char *argv[])
             engine_new_game();
         } else if (strncmp(line, "position ", 9) == 0) {
             handle_position(line + 9);
+        } else if (strncmp(line, "setoption ", 10) == 0) {
+            handle_setoption(line + 10);
         } else if (strncmp(line, "go", 2) == 0) {
             handle_go(line + 2);
+        } else if (strncmp(line, "bench", 5) == 0) {
+            handle_bench(line + 5);
         } else if (strcmp(line, "quit") == 0) {
             break;
         }
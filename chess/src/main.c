@@ -6,6 +6,7 @@
 #include <string.h>
 #include <fileioc.h>
 #include "engine.h"
+#include "frame.h"
 #include "book.h"
 #include "chdata.h"
 #include "piece_sprites.h"
@@ -27,7 +28,12 @@
 /* ========== Framerate ========== */
 
 #define TARGET_FPS 60
-#define FRAME_TIME (CLOCKS_PER_SEC / TARGET_FPS)
+#define THINK_POLL_MS (1000 / TARGET_FPS)
+
+/* Transposition table target: borrows free RAM, halving until it fits
+   (the built-in 32 KB table is the floor).  Nothing in the game creates
+   RAM variables, so the borrowed region stays ours while we run. */
+#define HASH_KB 128
 
 /* ========== Palette Indices ========== */
 
@@ -133,6 +139,7 @@ static int anim_to_r, anim_to_c;
 static int8_t anim_captured;   /* piece captured at destination */
 static clock_t anim_start;
 static clock_t anim_duration;  /* precomputed ticks for this move */
+static int anim_px, anim_py;   /* where the sliding piece was last drawn */
 
 /* game over */
 static int winner; /* WHITE_TURN, BLACK_TURN, or 0 for draw */
@@ -148,10 +155,20 @@ static int color_cursor;       /* 0=White, 1=Black, 2=Random */
 static uint8_t cur_g1, cur_g6, cur_g7;
 static uint8_t prev_g1, prev_g6, prev_g7;
 
-/* dirty flag — skip redraw when nothing changed */
+/* dirty flag — full redraw of the playing screen on the next frame */
 static int screen_dirty;
 
-/* sprite data pointer (from CHSPR appvar or embedded fallback) */
+/* dirty-square tracking for partial redraws (bit c of [r] = square r,c
+   in board[] coordinates).  A partial frame redraws what changed since
+   the frame on screen plus what the back buffer is missing: the squares
+   the frame before changed. */
+static uint8_t dirty_rows[8];
+static uint8_t stale_rows[8];
+static uint8_t sidebar_dirty;
+static uint8_t sidebar_stale;
+static uint8_t back_stale;     /* back buffer predates the last full redraw */
+
+/* sprite data pointer (CHDATA appvar or embedded fallback) */
 static const uint8_t *sprite_data;
 
 /* legal move targets (engine integration) */
@@ -165,6 +182,16 @@ static engine_move_effects_t pending_effects;
 /* AI state: 0=idle, 1=draw thinking screen, 2=compute */
 static int ai_thinking;
 
+/* Pondering on the player's turn (Hard and up): the engine searches
+   its reply to ponder_move until a key other than the arrows comes in.
+   An interrupted ponder resumes on a later frame, up to ponder_until. */
+#define PONDER_MIN_DIFFICULTY 2
+static uint8_t ponder_active;
+static uint8_t pondering;            /* inside engine_ponder() */
+static uint8_t ponder_interrupted;   /* think_poll() stopped it for a key */
+static engine_move_t ponder_move;
+static uint32_t ponder_until;
+
 /* ========== Engine Time Function ========== */
 
 static uint32_t ce_time_ms(void)
@@ -228,72 +255,83 @@ static void init_board(void)
 
 /* ========== Piece Drawing ========== */
 
-/* Pre-rendered piece sprites: 6 types x 2 colors (white, black) = 12 */
+/* Pre-rendered piece sprites: 6 types x 2 colors (white, black) = 12.
+   A type is rendered the first time one of its pieces is drawn, so
+   startup doesn't pay for decoding and expanding all of them. */
 static uint8_t piece_spr_data[12][2 + PIECE_SPR_W * PIECE_SPR_H];
+static uint8_t piece_spr_ready;    /* bit per type */
 
-static void prerender_pieces(void)
+static void prerender_type(int type)
 {
-    int type, color, row, col, idx;
+    int color, row, col, idx;
     uint8_t fill;
     gfx_sprite_t *spr;
+    const uint8_t *src;
+#ifdef SPRITES_EXTERNAL
+    static uint8_t unpacked[PIECE_SPR_W * PIECE_SPR_H];
+    src = chdata_sprite(sprite_data, (uint8_t)type, unpacked);
+#else
+    src = sprite_data + type * (PIECE_SPR_W * PIECE_SPR_H);
+#endif
 
-    for (type = 0; type < 6; type++)
+    for (color = 0; color < 2; color++)
     {
-        for (color = 0; color < 2; color++)
+        idx = type * 2 + color;
+        fill = color ? PAL_BLACK_PC : PAL_WHITE_PC;
+        spr = (gfx_sprite_t *)piece_spr_data[idx];
+        spr->width = PIECE_SPR_W;
+        spr->height = PIECE_SPR_H;
+
+        /* base pass: fill + outline */
+        for (row = 0; row < PIECE_SPR_H; row++)
         {
-            idx = type * 2 + color;
-            fill = color ? PAL_BLACK_PC : PAL_WHITE_PC;
-            spr = (gfx_sprite_t *)piece_spr_data[idx];
-            spr->width = PIECE_SPR_W;
-            spr->height = PIECE_SPR_H;
-
-            /* base pass: fill + outline */
-            for (row = 0; row < PIECE_SPR_H; row++)
+            for (col = 0; col < PIECE_SPR_W; col++)
             {
-                for (col = 0; col < PIECE_SPR_W; col++)
-                {
-                    uint8_t v = sprite_data[type * (PIECE_SPR_W * PIECE_SPR_H) + row * PIECE_SPR_W + col];
-                    uint8_t *px = &spr->data[row * PIECE_SPR_W + col];
-                    if (v == 1)       *px = fill;
-                    else if (v == 2)  *px = PAL_PIECE_OL;
-                    else              *px = 0; /* transparent */
-                }
+                uint8_t v = src[row * PIECE_SPR_W + col];
+                uint8_t *px = &spr->data[row * PIECE_SPR_W + col];
+                if (v == 1)       *px = fill;
+                else if (v == 2)  *px = PAL_PIECE_OL;
+                else              *px = 0; /* transparent */
             }
+        }
 
-            /* contour reinforcement for crisp edges */
-            for (row = 0; row < PIECE_SPR_H; row++)
+        /* contour reinforcement for crisp edges */
+        for (row = 0; row < PIECE_SPR_H; row++)
+        {
+            for (col = 0; col < PIECE_SPR_W; col++)
             {
-                for (col = 0; col < PIECE_SPR_W; col++)
-                {
-                    int up_open, down_open;
-                    uint8_t v = sprite_data[type * (PIECE_SPR_W * PIECE_SPR_H) + row * PIECE_SPR_W + col];
-                    if (v != 1) continue;
+                int up_open, down_open;
+                uint8_t v = src[row * PIECE_SPR_W + col];
+                if (v != 1) continue;
 
-                    up_open = (row == 0) ||
-                              (sprite_data[type * (PIECE_SPR_W * PIECE_SPR_H) + (row - 1) * PIECE_SPR_W + col] == 0);
-                    down_open = (row + 1 >= PIECE_SPR_H) ||
-                                (sprite_data[type * (PIECE_SPR_W * PIECE_SPR_H) + (row + 1) * PIECE_SPR_W + col] == 0);
+                up_open = (row == 0) ||
+                          (src[(row - 1) * PIECE_SPR_W + col] == 0);
+                down_open = (row + 1 >= PIECE_SPR_H) ||
+                            (src[(row + 1) * PIECE_SPR_W + col] == 0);
 
-                    if (up_open || down_open)
-                    {
-                        spr->data[row * PIECE_SPR_W + col] = PAL_PIECE_OL;
-                        if (up_open && row > 0)
-                            spr->data[(row - 1) * PIECE_SPR_W + col] = PAL_PIECE_OL;
-                        if (down_open && row + 1 < PIECE_SPR_H)
-                            spr->data[(row + 1) * PIECE_SPR_W + col] = PAL_PIECE_OL;
-                    }
+                if (up_open || down_open)
+                {
+                    spr->data[row * PIECE_SPR_W + col] = PAL_PIECE_OL;
+                    if (up_open && row > 0)
+                        spr->data[(row - 1) * PIECE_SPR_W + col] = PAL_PIECE_OL;
+                    if (down_open && row + 1 < PIECE_SPR_H)
+                        spr->data[(row + 1) * PIECE_SPR_W + col] = PAL_PIECE_OL;
                 }
             }
         }
     }
+    piece_spr_ready |= 1 << type;
 }
 
 static void draw_piece(int8_t piece, int sx, int sy)
 {
-    int idx;
+    int type, idx;
     if (piece == EMPTY) return;
 
-    idx = (PIECE_TYPE(piece) - 1) * 2 + (PIECE_IS_WHITE(piece) ? 0 : 1);
+    type = PIECE_TYPE(piece) - 1;
+    if (!(piece_spr_ready & (1 << type)))
+        prerender_type(type);
+    idx = type * 2 + (PIECE_IS_WHITE(piece) ? 0 : 1);
     gfx_TransparentSprite_NoClip((gfx_sprite_t *)piece_spr_data[idx],
                                   sx + PIECE_SPR_XOFF, sy + PIECE_SPR_YOFF);
 }
@@ -427,24 +465,6 @@ static void draw_board(void)
     }
 }
 
-/* Partial redraw: only update old and new cursor squares */
-static void draw_cursor_move(int old_r, int old_c)
-{
-    /* copy front buffer to back buffer so we have the current display */
-    gfx_Blit(gfx_screen);
-
-    /* redraw old cursor square (removes cursor border) */
-    draw_square(old_r, old_c);
-
-    /* redraw new cursor square */
-    draw_square(cur_r, cur_c);
-
-    /* draw cursor at new position */
-    draw_cursor_border();
-
-    gfx_SwapDraw();
-}
-
 static void draw_sidebar(void)
 {
     gfx_SetColor(PAL_SIDEBAR);
@@ -526,10 +546,98 @@ static void render_playing(void)
     draw_sidebar();
 }
 
-static void draw_playing(void)
+/* ========== Dirty Tracking ========== */
+
+static void mark_square(int r, int c)
 {
-    render_playing();
-    gfx_SwapDraw();
+    dirty_rows[r] |= (uint8_t)(1 << c);
+}
+
+/* legal-move indicators of the current selection */
+static void mark_targets(void)
+{
+    uint8_t i;
+    for (i = 0; i < legal_target_count; i++)
+        mark_square(legal_targets[i].to_row, legal_targets[i].to_col);
+}
+
+/* squares under a piece drawn at screen position (sx, sy) */
+static void mark_piece_rect(int sx, int sy)
+{
+    int dr0 = (sy - BOARD_Y) / SQ_SIZE, dr1 = (sy - BOARD_Y + SQ_SIZE - 1) / SQ_SIZE;
+    int dc0 = (sx - BOARD_X) / SQ_SIZE, dc1 = (sx - BOARD_X + SQ_SIZE - 1) / SQ_SIZE;
+    int dr, dc;
+    if (dr1 > 7) dr1 = 7;
+    if (dc1 > 7) dc1 = 7;
+    for (dr = dr0; dr <= dr1; dr++)
+        for (dc = dc0; dc <= dc1; dc++)
+            mark_square(board_flipped ? 7 - dr : dr, board_flipped ? 7 - dc : dc);
+}
+
+static uint8_t view_dirty(void)
+{
+    uint8_t r;
+    if (screen_dirty || sidebar_dirty) return 1;
+    for (r = 0; r < 8; r++)
+        if (dirty_rows[r]) return 1;
+    return 0;
+}
+
+/* Bring the back buffer up to date with what changed.  Returns 1 if
+   anything was drawn: the caller must then swap. */
+static uint8_t render_dirty(void)
+{
+    int r, c;
+    uint8_t bits;
+
+    if (screen_dirty)
+    {
+        render_playing();
+        memset(dirty_rows, 0, sizeof(dirty_rows));
+        memset(stale_rows, 0, sizeof(stale_rows));
+        sidebar_dirty = sidebar_stale = 0;
+        screen_dirty = 0;
+        back_stale = 1;
+        return 1;
+    }
+    if (!view_dirty())
+        return 0;
+
+    if (back_stale)
+    {
+        /* copy the front buffer so we have the current display */
+        gfx_Blit(gfx_screen);
+        memset(stale_rows, 0, sizeof(stale_rows));
+        sidebar_stale = 0;
+        back_stale = 0;
+    }
+
+    for (r = 0; r < 8; r++)
+    {
+        bits = dirty_rows[r] | stale_rows[r];
+        for (c = 0; bits; c++, bits >>= 1)
+            if (bits & 1)
+                draw_square(r, c);
+    }
+    if ((dirty_rows[cur_r] | stale_rows[cur_r]) & (1 << cur_c))
+        draw_cursor_border();
+    if (sidebar_dirty || sidebar_stale)
+        draw_sidebar();
+
+    /* after the swap the back buffer is the frame on screen now */
+    memcpy(stale_rows, dirty_rows, sizeof(stale_rows));
+    memset(dirty_rows, 0, sizeof(dirty_rows));
+    sidebar_stale = sidebar_dirty;
+    sidebar_dirty = 0;
+    return 1;
+}
+
+static void draw_dirty(void)
+{
+    FRAME_SCOPE_BEGIN(FRAME_SCOPE_DRAW);
+    if (render_dirty())
+        gfx_SwapDraw();
+    FRAME_SCOPE_END(FRAME_SCOPE_DRAW);
 }
 
 /* ========== Promotion Popup ========== */
@@ -712,19 +820,25 @@ static void draw_menu(void)
         }
     }
 
-    /* version + detected book tier (probe once and cache) */
+    /* version + detected book tier: one tier's first AppVar is probed
+       per frame, largest first, so the menu shows up without waiting
+       on the lookups */
     {
-        static char ver_buf[20] = {0};
-        if (!ver_buf[0]) {
-            const char *tag = "";
-            uint8_t h;
-            h = ti_Open("CHBY01", "r"); if (h) { ti_Close(h); tag = " XXL"; }
-            if (!tag[0]) { h = ti_Open("CHBX01", "r"); if (h) { ti_Close(h); tag = " XL"; } }
-            if (!tag[0]) { h = ti_Open("CHBL01", "r"); if (h) { ti_Close(h); tag = " L"; } }
-            if (!tag[0]) { h = ti_Open("CHBM01", "r"); if (h) { ti_Close(h); tag = " M"; } }
-            if (!tag[0]) { h = ti_Open("CHBS01", "r"); if (h) { ti_Close(h); tag = " S"; } }
-            strcpy(ver_buf, "v" VERSION);
-            strcat(ver_buf, tag);
+        static const char tier_appvars[5][7] = {
+            "CHBY01", "CHBX01", "CHBL01", "CHBM01", "CHBS01"
+        };
+        static const char *const tier_tags[5] = { " XXL", " XL", " L", " M", " S" };
+        static char ver_buf[20] = "v" VERSION;
+        static uint8_t tier_probe;
+        if (tier_probe < 5) {
+            uint8_t h = ti_Open(tier_appvars[tier_probe], "r");
+            if (h) {
+                ti_Close(h);
+                strcat(ver_buf, tier_tags[tier_probe]);
+                tier_probe = 5;
+            } else {
+                tier_probe++;
+            }
         }
         gfx_SetTextScale(1, 1);
         gfx_SetTextFGColor(PAL_PIECE_OL);
@@ -743,9 +857,37 @@ static void draw_menu(void)
 static void sync_ui_from_engine(void)
 {
     engine_position_t pos;
+    int r, c;
     engine_get_position(&pos);
+    for (r = 0; r < 8; r++)
+        for (c = 0; c < 8; c++)
+            if (board[r][c] != pos.board[r][c])
+                mark_square(r, c);
     memcpy(board, pos.board, sizeof(board));
     current_turn = pos.turn;
+    sidebar_dirty = 1;
+}
+
+/* Select the piece on (r, c) and its legal targets, or nothing when
+   r < 0 */
+static void set_selection(int r, int c)
+{
+    if (sel_r >= 0)
+    {
+        mark_square(sel_r, sel_c);
+        mark_targets();
+    }
+    sel_r = r; sel_c = c;
+    legal_target_count = (r >= 0)
+        ? engine_get_moves_from((uint8_t)r, (uint8_t)c, legal_targets, 64)
+        : 0;
+    if (r >= 0)
+    {
+        mark_square(r, c);
+        mark_targets();
+    }
+    mark_square(cur_r, cur_c);  /* cursor colour follows the selection */
+    sidebar_dirty = 1;
 }
 
 /* Apply a completed move to the engine and check game status.
@@ -768,10 +910,9 @@ static uint8_t apply_engine_move(engine_move_t move)
     }
 
     uint8_t status = engine_make_move(move);
+    ponder_active = 0;
     sync_ui_from_engine();
-    screen_dirty = 1;
-    sel_r = -1; sel_c = -1;
-    legal_target_count = 0;
+    set_selection(-1, -1);
 
     if (status == ENGINE_STATUS_CHECKMATE)
     {
@@ -798,9 +939,81 @@ static uint8_t apply_engine_move(engine_move_t move)
     else
         ai_thinking = 0;
 
+    /* the AI just moved: think on the player's time */
+    if (game_mode == MODE_COMPUTER && current_turn == player_color &&
+        difficulty_cursor >= PONDER_MIN_DIFFICULTY)
+    {
+        ponder_move = engine_get_ponder_move(NULL);
+        if (ponder_move.from_row != ENGINE_SQ_NONE)
+        {
+            ponder_until = ce_time_ms() + think_time_ms;
+            ponder_active = 1;
+        }
+    }
+
     return 0;
 }
 
+/* Arrow keys move the cursor (mirrored when the board is flipped).
+   Returns 1 if it moved, with both squares marked for redraw. */
+static uint8_t move_cursor(uint8_t new7)
+{
+    int old_r = cur_r, old_c = cur_c;
+
+    if (board_flipped)
+    {
+        if (new7 & kb_Up)    cur_r = (cur_r < 7) ? cur_r + 1 : 7;
+        if (new7 & kb_Down)  cur_r = (cur_r > 0) ? cur_r - 1 : 0;
+        if (new7 & kb_Left)  cur_c = (cur_c < 7) ? cur_c + 1 : 7;
+        if (new7 & kb_Right) cur_c = (cur_c > 0) ? cur_c - 1 : 0;
+    }
+    else
+    {
+        if (new7 & kb_Up)    cur_r = (cur_r > 0) ? cur_r - 1 : 0;
+        if (new7 & kb_Down)  cur_r = (cur_r < 7) ? cur_r + 1 : 7;
+        if (new7 & kb_Left)  cur_c = (cur_c > 0) ? cur_c - 1 : 0;
+        if (new7 & kb_Right) cur_c = (cur_c < 7) ? cur_c + 1 : 7;
+    }
+    if (cur_r == old_r && cur_c == old_c)
+        return 0;
+    mark_square(old_r, old_c);
+    mark_square(cur_r, cur_c);
+    return 1;
+}
+
+/* Engine poll hook, called every THINK_POLL_MS while the AI thinks:
+   keeps the cursor live and lets CLEAR cut the search short (the
+   engine then plays its best move so far).  While pondering, any
+   other key stops the search so update_playing() can handle it.
+   Scans step the main loop's key state so a key handled here is not
+   seen again as a new press on the next frame. */
+static uint8_t think_poll(void)
+{
+    uint8_t new1, new6, new7;
+
+    kb_Scan();
+    prev_g1 = cur_g1;
+    prev_g6 = cur_g6;
+    prev_g7 = cur_g7;
+    cur_g1 = kb_Data[1];
+    cur_g6 = kb_Data[6];
+    cur_g7 = kb_Data[7];
+    new1 = cur_g1 & ~prev_g1;
+    new6 = cur_g6 & ~prev_g6;
+    new7 = cur_g7 & ~prev_g7;
+
+    if (move_cursor(new7) && !screen_dirty)
+        draw_dirty();
+
+    if (pondering)
+    {
+        if (new1 || new6)
+            ponder_interrupted = 1;
+        return ponder_interrupted;
+    }
+    return (new6 & kb_Clear) ? 1 : 0;
+}
+
 static void start_game(void)
 {
     engine_hooks_t hooks;
@@ -811,6 +1024,8 @@ static void start_game(void)
 
     hooks.time_ms = ce_time_ms;
     engine_init(&hooks);
+    engine_set_hash_kb(HASH_KB);
+    engine_set_think_poll(think_poll, THINK_POLL_MS);
     engine_new_game();
 
     init_board();
@@ -820,6 +1035,7 @@ static void start_game(void)
     has_last_move = 0;
     legal_target_count = 0;
     ai_thinking = 0;
+    ponder_active = 0;
     anim_active = 0;
     game_over_reason = 0;
 
@@ -1103,15 +1319,22 @@ static void start_move_anim(int from_r, int from_c, int to_r, int to_c)
     anim_duration = (clock_t)(CLOCKS_PER_SEC * ms / 1000);
     anim_start = clock();
     anim_active = 1;
+    anim_px = BOARD_X + (board_flipped ? 7 - from_c : from_c) * SQ_SIZE;
+    anim_py = BOARD_Y + (board_flipped ? 7 - from_r : from_r) * SQ_SIZE;
 
     /* remove piece from origin during animation */
     board[from_r][from_c] = EMPTY;
+    mark_square(from_r, from_c);
     /* remove captured piece so it doesn't draw under the sliding piece */
     board[to_r][to_c] = EMPTY;
+    mark_square(to_r, to_c);
 
     /* for EP, also remove the captured pawn */
     if (pending_effects.has_ep_capture)
+    {
         board[pending_effects.ep_capture_row][pending_effects.ep_capture_col] = EMPTY;
+        mark_square(pending_effects.ep_capture_row, pending_effects.ep_capture_col);
+    }
 
     /* for castling, move the rook immediately (so it appears in new position during king slide) */
     if (pending_effects.has_rook_move)
@@ -1119,6 +1342,8 @@ static void start_move_anim(int from_r, int from_c, int to_r, int to_c)
         int8_t rook = board[pending_effects.rook_from_row][pending_effects.rook_from_col];
         board[pending_effects.rook_from_row][pending_effects.rook_from_col] = EMPTY;
         board[pending_effects.rook_to_row][pending_effects.rook_to_col] = rook;
+        mark_square(pending_effects.rook_from_row, pending_effects.rook_from_col);
+        mark_square(pending_effects.rook_to_row, pending_effects.rook_to_col);
     }
 }
 
@@ -1132,13 +1357,19 @@ static void finish_move(void)
     int prev_to_r = last_to_r, prev_to_c = last_to_c;
 
     anim_active = 0;
-    screen_dirty = 1;
     board[to_r][to_c] = piece;
+    mark_square(to_r, to_c);
 
     /* record last move for highlighting */
+    if (prev_has_last)
+    {
+        mark_square(prev_from_r, prev_from_c);
+        mark_square(prev_to_r, prev_to_c);
+    }
     last_from_r = anim_from_r; last_from_c = anim_from_c;
     last_to_r = to_r; last_to_c = to_c;
     has_last_move = 1;
+    mark_square(last_from_r, last_from_c);
 
     /* check pawn promotion */
     is_ai_move = (game_mode == MODE_COMPUTER && current_turn != player_color);
@@ -1185,14 +1416,14 @@ static void draw_anim_frame(void)
     int from_px, from_py, to_px, to_py;
     int cur_px, cur_py;
 
+    /* the piece leaves where it was drawn last frame */
+    mark_piece_rect(anim_px, anim_py);
+
     if (elapsed >= duration)
     {
         finish_move();
-        if (state == STATE_PLAYING && screen_dirty)
-        {
-            draw_playing();
-            screen_dirty = 0;
-        }
+        if (state == STATE_PLAYING)
+            draw_dirty();
         return;
     }
 
@@ -1210,9 +1441,13 @@ static void draw_anim_frame(void)
 
     cur_px = from_px + (int)((long)(to_px - from_px) * elapsed / duration);
     cur_py = from_py + (int)((long)(to_py - from_py) * elapsed / duration);
+    mark_piece_rect(cur_px, cur_py);
+    anim_px = cur_px;
+    anim_py = cur_py;
 
-    /* draw board without the moving piece (already removed from board[]) */
-    render_playing();
+    /* redraw the squares it crosses without the moving piece (already
+       removed from board[]) */
+    render_dirty();
 
     /* draw the sliding piece on top */
     draw_piece(anim_piece, cur_px, cur_py);
@@ -1256,15 +1491,24 @@ static void update_playing(void)
         {
             /* first frame: draw "Thinking..." on sidebar and return */
             ai_thinking = 2;
-            draw_playing();
+            sidebar_dirty = 1;
+            draw_dirty();
             return;
         }
 
-        /* second frame: compute AI move (blocking) */
+        /* second frame: compute AI move (think_poll keeps input live;
+           CLEAR plays the best move found so far) */
         {
             engine_move_t ai_move;
+            engine_clock_t clock;
 
-            ai_move = engine_think(0, think_time_ms);
+            /* think_time_ms is the level's nominal time: the time
+               manager stops sooner once the best move has settled */
+            memset(&clock, 0, sizeof(clock));
+            clock.target_time = think_time_ms;
+            FRAME_SCOPE_BEGIN(1);
+            ai_move = engine_think_clock(0, &clock);
+            FRAME_SCOPE_END(1);
 
             if (ai_move.from_row == ENGINE_SQ_NONE ||
                 ai_move.from_row > 7 || ai_move.from_col > 7 ||
@@ -1285,52 +1529,43 @@ static void update_playing(void)
             /* prepare and animate the AI move */
             pending_move = ai_move;
             engine_get_move_effects(ai_move, &pending_effects);
+            ai_thinking = 0;
+            sidebar_dirty = 1;
             start_move_anim(ai_move.from_row, ai_move.from_col,
                             ai_move.to_row, ai_move.to_col);
-            ai_thinking = 0;
         }
         return;
     }
 
-    /* skip redraw if no input and screen is clean */
-    if (!new7 && !new6 && !new1 && !screen_dirty)
-        return;
-
-    /* cursor movement — save old position for partial redraw */
+    /* ponder once the board is on screen; the key that ends it is
+       handled below (the arrows already were, inside think_poll) */
+    if (ponder_active && !view_dirty())
     {
-        int old_r = cur_r, old_c = cur_c;
+        uint32_t now = ce_time_ms();
+
+        ponder_interrupted = 0;
+        pondering = 1;
+        if (now >= ponder_until ||
+            !engine_ponder(ponder_move, ponder_until - now) ||
+            !ponder_interrupted)
+            ponder_active = 0;  /* out of time, nothing to ponder, or done */
+        pondering = 0;
+
+        new1 = cur_g1 & ~prev_g1;
+        new6 = cur_g6 & ~prev_g6;
+        new7 = 0;
+    }
 
-        if (board_flipped)
-        {
-            if (new7 & kb_Up)    cur_r = (cur_r < 7) ? cur_r + 1 : 7;
-            if (new7 & kb_Down)  cur_r = (cur_r > 0) ? cur_r - 1 : 0;
-            if (new7 & kb_Left)  cur_c = (cur_c < 7) ? cur_c + 1 : 7;
-            if (new7 & kb_Right) cur_c = (cur_c > 0) ? cur_c - 1 : 0;
-        }
-        else
-        {
-            if (new7 & kb_Up)    cur_r = (cur_r > 0) ? cur_r - 1 : 0;
-            if (new7 & kb_Down)  cur_r = (cur_r < 7) ? cur_r + 1 : 7;
-            if (new7 & kb_Left)  cur_c = (cur_c > 0) ? cur_c - 1 : 0;
-            if (new7 & kb_Right) cur_c = (cur_c < 7) ? cur_c + 1 : 7;
-        }
+    /* skip redraw if no input and screen is clean */
+    if (!new7 && !new6 && !new1 && !view_dirty())
+        return;
 
-        /* if only the cursor moved (no buttons), do a fast partial redraw.
-           Never do this while the board is dirty (e.g., right after a move),
-           or the moved piece may never get a full redraw. */
-        if (!screen_dirty && new7 && !new6 && !new1 &&
-            (cur_r != old_r || cur_c != old_c))
-        {
-            draw_cursor_move(old_r, old_c);
-            return;
-        }
-    }
+    /* cursor movement marks the old and new squares */
+    move_cursor(new7);
 
-    /* enter/2nd — select or move (needs full redraw) */
+    /* enter/2nd — select or move */
     if ((new6 & kb_Enter) || (new1 & kb_2nd))
     {
-        screen_dirty = 1;
-
         if (sel_r < 0)
         {
             /* nothing selected — try to select a piece */
@@ -1341,11 +1576,8 @@ static void update_playing(void)
                 if ((current_turn == WHITE_TURN && PIECE_IS_WHITE(target)) ||
                     (current_turn == BLACK_TURN && !PIECE_IS_WHITE(target)))
                 {
-                    sel_r = cur_r;
-                    sel_c = cur_c;
-                    /* compute legal moves for this piece */
-                    legal_target_count = engine_get_moves_from(
-                        (uint8_t)cur_r, (uint8_t)cur_c, legal_targets, 64);
+                    /* select it along with its legal moves */
+                    set_selection(cur_r, cur_c);
                 }
             }
         }
@@ -1355,8 +1587,7 @@ static void update_playing(void)
             if (cur_r == sel_r && cur_c == sel_c)
             {
                 /* deselect if clicking same square */
-                sel_r = -1; sel_c = -1;
-                legal_target_count = 0;
+                set_selection(-1, -1);
             }
             else
             {
@@ -1366,11 +1597,8 @@ static void update_playing(void)
                     ((current_turn == WHITE_TURN && PIECE_IS_WHITE(target)) ||
                      (current_turn == BLACK_TURN && !PIECE_IS_WHITE(target))))
                 {
-                    sel_r = cur_r;
-                    sel_c = cur_c;
-                    /* recompute legal moves for new piece */
-                    legal_target_count = engine_get_moves_from(
-                        (uint8_t)cur_r, (uint8_t)cur_c, legal_targets, 64);
+                    /* reselect, with the new piece's legal moves */
+                    set_selection(cur_r, cur_c);
                 }
                 else
                 {
@@ -1392,11 +1620,9 @@ static void update_playing(void)
     /* clear — deselect */
     if (new6 & kb_Clear)
     {
-        screen_dirty = 1;
         if (sel_r >= 0)
         {
-            sel_r = -1; sel_c = -1;
-            legal_target_count = 0;
+            set_selection(-1, -1);
         }
         else
         {
@@ -1417,11 +1643,8 @@ static void update_playing(void)
         return;
     }
 
-    if (state == STATE_PLAYING && screen_dirty)
-    {
-        draw_playing();
-        screen_dirty = 0;
-    }
+    if (state == STATE_PLAYING)
+        draw_dirty();
 }
 
 /* ========== State: Promotion ========== */
@@ -1455,6 +1678,7 @@ static void update_promotion(void)
             return; /* game over */
 
         state = STATE_PLAYING;
+        screen_dirty = 1;  /* the popup covered the board */
         return;
     }
 
@@ -1473,6 +1697,7 @@ static void update_promotion(void)
         sel_r = -1; sel_c = -1;
         legal_target_count = 0;
         state = STATE_PLAYING;
+        screen_dirty = 1;  /* the popup covered the board */
         return;
     }
 
@@ -1501,8 +1726,6 @@ static void update_gameover(void)
 
 int main(void)
 {
-    clock_t frame_start;
-
     gfx_Begin();
     gfx_SetDrawBuffer();
     setup_palette();
@@ -1522,22 +1745,24 @@ int main(void)
             gfx_End();
             return 1;
         }
-        sprite_data = (const uint8_t *)ti_GetDataPtr(data_h) + CHDATA_SPR_OFFSET;
+        sprite_data = (const uint8_t *)ti_GetDataPtr(data_h);
         ti_Close(data_h);
     }
 #else
     sprite_data = &piece_sprites[0][0][0];
 #endif
-    prerender_pieces();
 
     srand(clock());
     state = STATE_MENU;
     menu_cursor = 0;
     running = 1;
+    frame_init(TARGET_FPS);
+    frame_hud_style(BOARD_X, SCREEN_H - 20, PAL_TEXT, PAL_BG);
+    frame_scope_name(1, "AI");
 
     do
     {
-        frame_start = clock();
+        frame_begin();
         kb_Scan();
 
         cur_g1 = kb_Data[1];
@@ -1559,8 +1784,7 @@ int main(void)
         prev_g7 = cur_g7;
         frame_count++;
 
-        while (clock() - frame_start < FRAME_TIME)
-            ;
+        frame_end();
 
     } while (running);
 
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+Compare a standard bench record against a stored baseline and flag
+regressions.
+
+Records are the single-line JSON objects printed by the desktop bench
+(`build/bench --json`) and by the calculator bench (the `BENCH_JSON`
+line in the emulator debug log).  Either file may be a whole log: the
+last line containing a JSON object is used.
+
+Rules:
+  - signature, perft_nodes  must match exactly (a new search node count
+                           means search behaviour changed: re-baseline if
+                           intended; a new perft count is a movegen bug)
+  - *_ns, *_ms, *cy_node   lower is better
+  - *nps                   higher is better
+  - anything else          informational, shown but never flagged
+
+Exit status is 1 when any metric regressed by more than the tolerance
+or an exact count changed, so `make bench-compare` can gate a change.
+
+Usage:
+  python3 bench_compare.py <baseline> <current> [--tolerance PCT]
+
+Examples:
+  python3 bench_compare.py ../engine/test/bench_baseline.json build/bench.json
+  python3 bench_compare.py ez80_base.log ez80_new.log --tolerance 1
+"""
+
+import argparse
+import json
+import sys
+
+IDENTITY_KEYS = ("harness", "backend", "positions", "depth", "node_limit")
+EXACT_KEYS = ("signature", "perft_nodes")
+
+
+def load_record(path):
+    """Return the last JSON object found in the file at path."""
+    record = None
+    with open(path) as f:
+        for line in f:
+            start = line.find("{")
+            if start < 0:
+                continue
+            try:
+                record = json.loads(line[start:])
+            except ValueError:
+                continue
+    if record is None:
+        print(f"Error: no bench record in {path}", file=sys.stderr)
+        sys.exit(2)
+    return record
+
+
+def direction(key):
+    """+1 if higher is better, -1 if lower is better, 0 if untracked."""
+    if key.endswith("nps"):
+        return 1
+    if key.endswith(("_ns", "_ms", "cy_node")):
+        return -1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare bench records")
+    parser.add_argument("baseline", help="stored baseline record")
+    parser.add_argument("current", help="record from this build")
+    parser.add_argument("--tolerance", type=float, default=5.0,
+                        help="allowed slowdown in percent (default: 5)")
+    args = parser.parse_args()
+
+    base = load_record(args.baseline)
+    cur = load_record(args.current)
+    failed = False
+
+    for key in IDENTITY_KEYS:
+        if base.get(key) != cur.get(key):
+            print(f"Error: records differ in {key} "
+                  f"({base.get(key)} vs {cur.get(key)})", file=sys.stderr)
+            sys.exit(2)
+
+    print(f"{'metric':<18} {'baseline':>14} {'current':>14} {'delta':>9}")
+    for key, old in base.items():
+        if key in IDENTITY_KEYS or key not in cur or \
+                not isinstance(old, (int, float)):
+            continue
+        new = cur[key]
+        delta = (new - old) * 100.0 / old if old else 0.0
+        flag = ""
+        if key in EXACT_KEYS:
+            if new != old:
+                flag = "CHANGED"
+        elif direction(key) * delta < -args.tolerance:
+            flag = "REGRESSION"
+        elif direction(key) * delta > args.tolerance:
+            flag = "improved"
+        if flag in ("CHANGED", "REGRESSION"):
+            failed = True
+        print(f"{key:<18} {old:>14} {new:>14} {delta:>+8.2f}% {flag}")
+
+    if failed:
+        print(f"FAIL: regression beyond {args.tolerance:g}% "
+              "or node count change")
+        sys.exit(1)
+    print("OK")
+
+
+if __name__ == "__main__":
+    main()
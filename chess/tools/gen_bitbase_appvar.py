@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+"""
+Generate the endgame bitbase AppVar (CHEGTB.8xv) for the TI-84 Plus CE.
+
+The search probes it for exact results in tiny endgames that it cannot
+see to the end of at calculator speed.  It holds one table for now,
+KPK (king and pawn vs king, 24,576 bytes), behind a small directory so
+more 3/4-man tables can be appended without changing the format.
+
+Payload layout (multi-byte fields little-endian), see bitbase.c:
+  [4]      magic "CBB\\x01"
+  [1]      table count N
+  [N * 9]  directory: table id (1), offset from payload start (4), size (4)
+  tables
+
+KPK table (id 1): one bit per position with the pawn side as white,
+pawn on files a-d (the rest mirror), 1 = white wins, 0 = draw or
+illegal.  Squares are a1=0 .. h8=63.
+  index = ((stm * 24 + pawn) * 64 + white_king) * 64 + black_king
+  pawn  = (pawn_rank - 1) * 4 + pawn_file     (ranks 2..7 -> 1..6)
+  stm   = 0 white to move, 1 black to move
+  bit   = byte[index >> 3] >> (index & 7) & 1
+
+Usage:
+  python3 gen_bitbase_appvar.py <output_dir>      CHEGTB.8xv via convbin
+  python3 gen_bitbase_appvar.py --bin <path>      raw payload (desktop builds)
+
+Example:
+  python3 tools/gen_bitbase_appvar.py assets/
+  python3 tools/gen_bitbase_appvar.py --bin engine/build/CHEGTB.bin
+
+Requires: convbin (CE C toolchain) for the .8xv only
+"""
+
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+APPVAR_NAME = "CHEGTB"
+MAGIC = b"CBB\x01"
+DIR_ENTRY = 9
+
+TABLE_KPK = 1
+KPK_PAWNS = 24
+KPK_POSITIONS = 2 * KPK_PAWNS * 64 * 64
+KPK_BYTES = KPK_POSITIONS // 8   # 24,576
+
+UNKNOWN, DRAW, WIN, ILLEGAL = 0, 1, 2, 3
+
+
+def find_convbin():
+    """Find the convbin executable."""
+    for path_dir in os.environ.get("PATH", "").split(os.pathsep):
+        candidate = os.path.join(path_dir, "convbin")
+        if os.path.isfile(candidate) and os.access(candidate, os.X_OK):
+            return candidate
+    cedev = os.environ.get("CEDEV", os.path.expanduser("~/CEdev"))
+    candidate = os.path.join(cedev, "bin", "convbin")
+    if os.path.isfile(candidate):
+        return candidate
+    return None
+
+
+# ========== KPK ==========
+
+def distance(a, b):
+    return max(abs((a >> 3) - (b >> 3)), abs((a & 7) - (b & 7)))
+
+
+KING_STEPS = [[t for t in range(64) if distance(s, t) == 1] for s in range(64)]
+
+
+def pawn_attacks(p):
+    """Squares a white pawn on p attacks."""
+    out = []
+    if p < 56:
+        if p & 7:
+            out.append(p + 7)
+        if p & 7 != 7:
+            out.append(p + 9)
+    return out
+
+
+def kpk_index(stm, pawn_sq, wk, bk):
+    pawn = ((pawn_sq >> 3) - 1) * 4 + (pawn_sq & 7)
+    return ((stm * KPK_PAWNS + pawn) * 64 + wk) * 64 + bk
+
+
+def queen_attacks(q, blockers):
+    """Squares a queen on q attacks, stopping at squares in blockers."""
+    out = set()
+    for dr, df in ((1, 0), (-1, 0), (0, 1), (0, -1),
+                   (1, 1), (1, -1), (-1, 1), (-1, -1)):
+        r, f = (q >> 3) + dr, (q & 7) + df
+        while 0 <= r < 8 and 0 <= f < 8:
+            s = r * 8 + f
+            out.add(s)
+            if s in blockers:
+                break
+            r, f = r + dr, f + df
+    return out
+
+
+def promotion_wins(wk, bk, q):
+    """White just queened on q, black to move: a win unless black can
+    take the queen or is stalemated (underpromotion is not tried)."""
+    if distance(bk, q) == 1 and distance(wk, q) > 1:
+        return False
+    attacked = queen_attacks(q, {wk})   # bk itself does not block its flight
+    if bk in attacked:
+        return True
+    for t in KING_STEPS[bk]:
+        if t not in attacked and distance(t, wk) > 1:
+            return True
+    return False                        # stalemate
+
+
+def kpk_setup():
+    """Classify legality and terminal moves, and list each position's
+    successors.  Returns (result, successors)."""
+    result = [ILLEGAL] * KPK_POSITIONS
+    succ = [None] * KPK_POSITIONS
+
+    for f in range(4):
+        for r in range(1, 7):
+            p = r * 8 + f
+            attacks = pawn_attacks(p)
+            for wk in range(64):
+                if wk == p:
+                    continue
+                for bk in range(64):
+                    if bk == p or distance(wk, bk) <= 1:
+                        continue
+
+                    # White to move (black may not be in check)
+                    if bk not in attacks:
+                        idx = kpk_index(0, p, wk, bk)
+                        moves = []
+                        win = False
+                        for t in KING_STEPS[wk]:
+                            if t != p and distance(t, bk) > 1:
+                                moves.append(kpk_index(1, p, t, bk))
+                        push = p + 8
+                        if push != wk and push != bk:
+                            if r == 6:
+                                win = promotion_wins(wk, bk, push)
+                            else:
+                                moves.append(kpk_index(1, push, wk, bk))
+                                if r == 1 and p + 16 != wk and p + 16 != bk:
+                                    moves.append(kpk_index(1, p + 16, wk, bk))
+                        if win:
+                            result[idx] = WIN
+                        elif not moves:
+                            result[idx] = DRAW    # stalemate
+                        else:
+                            result[idx] = UNKNOWN
+                            succ[idx] = moves
+
+                    # Black to move
+                    idx = kpk_index(1, p, wk, bk)
+                    moves = []
+                    draw = False
+                    for t in KING_STEPS[bk]:
+                        if distance(t, wk) <= 1 or t in attacks:
+                            continue
+                        if t == p:
+                            draw = True           # pawn taken: bare kings
+                            break
+                        moves.append(kpk_index(0, p, wk, t))
+                    if draw:
+                        result[idx] = DRAW
+                    elif not moves:
+                        result[idx] = WIN if bk in attacks else DRAW
+                    else:
+                        result[idx] = UNKNOWN
+                        succ[idx] = moves
+    return result, succ
+
+
+def kpk_solve():
+    """Retrograde iteration to a fixed point.  Returns the bit table."""
+    result, succ = kpk_setup()
+    stm_split = KPK_PAWNS * 64 * 64
+    pending = [i for i in range(KPK_POSITIONS) if result[i] == UNKNOWN]
+
+    while pending:
+        left = []
+        for idx in pending:
+            vals = [result[s] for s in succ[idx]]
+            if idx < stm_split:
+                # White picks: any winning move wins, all drawn draws
+                if WIN in vals:
+                    result[idx] = WIN
+                elif UNKNOWN not in vals:
+                    result[idx] = DRAW
+                else:
+                    left.append(idx)
+            else:
+                if DRAW in vals:
+                    result[idx] = DRAW
+                elif UNKNOWN not in vals:
+                    result[idx] = WIN
+                else:
+                    left.append(idx)
+        if len(left) == len(pending):
+            break                 # nothing resolved: the rest can't be won
+        pending = left
+
+    bits = bytearray(KPK_BYTES)
+    for idx, res in enumerate(result):
+        if res == WIN:
+            bits[idx >> 3] |= 1 << (idx & 7)
+    return bytes(bits)
+
+
+# ========== Payload ==========
+
+def build_payload():
+    tables = [(TABLE_KPK, kpk_solve())]
+    offset = len(MAGIC) + 1 + DIR_ENTRY * len(tables)
+    directory = b""
+    for table_id, data in tables:
+        directory += struct.pack("<BII", table_id, offset, len(data))
+        offset += len(data)
+    return MAGIC + bytes([len(tables)]) + directory + \
+        b"".join(data for _, data in tables)
+
+
+def main():
+    args = sys.argv[1:]
+    if len(args) == 2 and args[0] == "--bin":
+        bin_path, output_dir = args[1], None
+    elif len(args) == 1 and not args[0].startswith("-"):
+        bin_path, output_dir = None, args[0]
+    else:
+        print(__doc__)
+        sys.exit(1)
+
+    convbin = None
+    if output_dir:
+        convbin = find_convbin()
+        if not convbin:
+            print("Error: convbin not found.", file=sys.stderr)
+            sys.exit(1)
+
+    payload = build_payload()
+    print(f"KPK:   {KPK_BYTES:,} bytes")
+    print(f"Total: {len(payload):,} bytes")
+
+    if bin_path:
+        os.makedirs(os.path.dirname(bin_path) or ".", exist_ok=True)
+        with open(bin_path, "wb") as f:
+            f.write(payload)
+        print(f"Generated {bin_path}")
+        return
+
+    os.makedirs(output_dir, exist_ok=True)
+    output_path = os.path.join(output_dir, f"{APPVAR_NAME}.8xv")
+    with tempfile.NamedTemporaryFile(suffix=".bin", delete=False) as tmp:
+        tmp.write(payload)
+        tmp_path = tmp.name
+    try:
+        result = subprocess.run(
+            [convbin, "-j", "bin", "-k", "8xv",
+             "-i", tmp_path, "-o", output_path,
+             "-n", APPVAR_NAME, "-r"],
+            capture_output=True, text=True
+        )
+        if result.returncode != 0:
+            err = result.stdout.strip() or result.stderr.strip()
+            print(f"Error: convbin failed: {err}", file=sys.stderr)
+            sys.exit(1)
+    finally:
+        os.unlink(tmp_path)
+    print(f"Generated {output_path} ({os.path.getsize(output_path)} bytes)")
+
+
+if __name__ == "__main__":
+    main()
@@ -12,11 +12,18 @@ Output files:
 
 Tier prefixes: CHBS (small), CHBM (medium), CHBL (large), CHBX (xl), CHBY (xxl)
 
+With --compact the chunks use the compact block format instead of raw
+16-byte entries (see encode_compact_segments); book.c detects it per
+AppVar from the header magic, so the names and tiers are unchanged.
+The compact format is experimental: its lookup cost on the calculator has
+not been measured yet (chess/bench, make BOOK_PROBE=1).
+
 Usage:
-  python3 gen_book_appvar.py <input.bin> <output_dir> <tier>
+  python3 gen_book_appvar.py <input.bin> <output_dir> <tier> [--compact]
 
 Example:
   python3 gen_book_appvar.py books/book_medium.bin books/ medium
+  python3 gen_book_appvar.py books/book_xxl.bin books/ xxl --compact
 
 Requires: python-chess (pip install chess), convbin (CE C toolchain)
 """
@@ -49,6 +56,35 @@ TIER_PREFIXES = {
 
 RANDOMS_APPVAR = "CHBKRN"
 
+# Compact chunk layout (all multi-byte header fields little-endian):
+#   [4]          magic "CBK\x01"  (never a valid raw entry count)
+#   [4]          entry count
+#   [2]          block count B
+#   [1]          key shift S: records store key >> S
+#   [5]          key prefix of the last record (big-endian)
+#   [B * 5]      key prefix of each block's first record (big-endian)
+#   [B * 256]    blocks (the last one is not padded)
+#
+# Keys are stored as their top 64 - S bits, with S chosen so a random
+# non-book key matches a stored prefix about once in 2^23 probes (40
+# bits for XXL); the probe still rejects moves that are not legal in
+# the position.  A block holds a record count
+# byte and then records, each a LEB128 delta from the previous record's
+# prefix (the first record's delta is from the block's index prefix),
+# followed by its moves as uint16 LE Polyglot move codes.  Bit 15 of a
+# move code means another move for the same key follows; when a key has
+# more than one move, each code is followed by a weight byte scaled so
+# the key's best move is 255.  Single-move keys store no weight.  A key's
+# moves never straddle a block, and the prefixes within a block span
+# less than 2^32, so the decoder works in 32-bit offsets.
+COMPACT_MAGIC = b"CBK\x01"
+COMPACT_HEADER = 16
+COMPACT_BLOCK = 256
+COMPACT_FALSE_HIT_BITS = 23
+COMPACT_MAX_PREFIX_BITS = 40
+MAX_BLOCKS_PER_CHUNK = ((MAX_APPVAR_PAYLOAD - COMPACT_HEADER)
+                        // (COMPACT_BLOCK + 5))  # 249
+
 
 def find_convbin():
     """Find the convbin executable."""
@@ -150,6 +186,145 @@ def generate_book_appvars(convbin, input_bin, output_dir, tier):
     return appvar_paths
 
 
+def leb128(value):
+    """Unsigned LEB128 encoding of value."""
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def compact_record(delta, moves):
+    """Encode one key's record: delta, then its (move, weight) list."""
+    rec = bytearray(leb128(delta))
+    top = max(w for _, w in moves)
+    for i, (move, weight) in enumerate(moves):
+        code = move & 0x7FFF
+        if i + 1 < len(moves):
+            code |= 0x8000
+        rec += struct.pack("<H", code)
+        if len(moves) > 1:
+            # Only ratios between a key's moves matter to the probe
+            scaled = (weight * 255 + top // 2) // top if top else 0
+            rec.append(max(scaled, 1) if weight else 0)
+    return bytes(rec)
+
+
+def encode_compact_segments(book_data):
+    """Encode a sorted Polyglot book into compact chunk payloads.
+
+    Returns (payloads, dropped) where dropped counts book keys whose
+    stored prefix collided with a heavier key and were left out.
+    """
+    grouped = {}
+    for off in range(0, len(book_data) - ENTRY_SIZE + 1, ENTRY_SIZE):
+        key, move, weight = struct.unpack_from(">QHH", book_data, off)
+        grouped.setdefault(key, []).append((move, weight))
+
+    bits = min(COMPACT_MAX_PREFIX_BITS,
+               len(grouped).bit_length() + COMPACT_FALSE_HIT_BITS)
+    shift = 64 - bits
+
+    # Keep one full key per prefix: the one with the most total weight
+    by_prefix = {}
+    dropped = 0
+    for key, moves in grouped.items():
+        if not any(w for _, w in moves):
+            continue  # book_probe() never plays an all-zero position
+        prefix = key >> shift
+        if prefix in by_prefix:
+            dropped += 1
+            if sum(w for _, w in moves) <= sum(w for _, w in by_prefix[prefix]):
+                continue
+        by_prefix[prefix] = moves
+
+    payloads = []
+    blocks = []   # (first prefix, bytes)
+    entries = 0
+    last_prefix = 0
+
+    def flush_chunk():
+        body = b"".join(b.ljust(COMPACT_BLOCK, b"\0") for _, b in blocks[:-1])
+        body += blocks[-1][1]
+        index = b"".join(p.to_bytes(5, "big") for p, _ in blocks)
+        header = (COMPACT_MAGIC +
+                  struct.pack("<IHB", entries, len(blocks), shift) +
+                  last_prefix.to_bytes(5, "big"))
+        payloads.append(header + index + body)
+
+    block = None
+    block_prefix = prev = 0
+    for prefix in sorted(by_prefix):
+        moves = by_prefix[prefix]
+        rec = None
+        if block is not None and prefix - block_prefix < (1 << 32) and block[0] < 255:
+            rec = compact_record(prefix - prev, moves)
+            if len(block) + len(rec) > COMPACT_BLOCK:
+                rec = None
+        if rec is None:
+            if block is not None:
+                blocks.append((block_prefix, bytes(block)))
+            if len(blocks) == MAX_BLOCKS_PER_CHUNK:
+                flush_chunk()
+                blocks = []
+                entries = 0
+            block = bytearray(b"\0")
+            block_prefix = prefix
+            rec = compact_record(0, moves)
+        block[0] += 1
+        block += rec
+        prev = last_prefix = prefix
+        entries += len(moves)
+
+    if block is not None:
+        blocks.append((block_prefix, bytes(block)))
+    if blocks:
+        flush_chunk()
+    return payloads, dropped
+
+
+def generate_compact_appvars(convbin, input_bin, output_dir, tier):
+    """Encode a Polyglot .bin book into compact chunked AppVars."""
+    prefix = TIER_PREFIXES[tier]
+
+    with open(input_bin, "rb") as f:
+        book_data = f.read()
+
+    payloads, dropped = encode_compact_segments(book_data)
+    total = sum(len(p) for p in payloads)
+    print(f"  Book: {len(book_data) // ENTRY_SIZE:,} entries -> "
+          f"{len(payloads)} compact AppVar(s), {total:,} bytes "
+          f"({total / max(1, len(book_data) // ENTRY_SIZE):.2f} bytes/entry)")
+    if dropped:
+        print(f"  Dropped {dropped} position(s) sharing a key prefix "
+              f"with a heavier one")
+
+    appvar_paths = []
+    for chunk_idx, payload in enumerate(payloads):
+        appvar_name = f"{prefix}{chunk_idx + 1:02d}"
+        output_path = os.path.join(output_dir, f"{appvar_name}.8xv")
+
+        with tempfile.NamedTemporaryFile(suffix=".bin", delete=False) as tmp:
+            tmp.write(payload)
+            tmp_path = tmp.name
+
+        try:
+            run_convbin(convbin, tmp_path, output_path, appvar_name)
+        finally:
+            os.unlink(tmp_path)
+
+        print(f"  {appvar_name}.8xv — {struct.unpack_from('<I', payload, 4)[0]:,} "
+              f"entries ({len(payload):,} bytes)")
+        appvar_paths.append(output_path)
+
+    return appvar_paths
+
+
 def generate_group(convbin, appvar_paths, output_dir, tier):
     """Bundle all AppVars into a .8xg group for single-file transfer."""
     group_name = f"CHBOOK{tier[0].upper()}"  # e.g., CHBOOKS, CHBOOKM, ...
@@ -171,14 +346,16 @@ def generate_group(convbin, appvar_paths, output_dir, tier):
 
 
 def main():
-    if len(sys.argv) != 4:
-        print(f"Usage: {sys.argv[0]} <input.bin> <output_dir> <tier>")
+    args = [a for a in sys.argv[1:] if a != "--compact"]
+    compact = len(args) != len(sys.argv) - 1
+    if len(args) != 3:
+        print(f"Usage: {sys.argv[0]} <input.bin> <output_dir> <tier> [--compact]")
         print(f"  tier: {', '.join(TIER_PREFIXES.keys())}")
         sys.exit(1)
 
-    input_bin = sys.argv[1]
-    output_dir = sys.argv[2]
-    tier = sys.argv[3]
+    input_bin = args[0]
+    output_dir = args[1]
+    tier = args[2]
 
     if not os.path.isfile(input_bin):
         print(f"Error: Input file not found: {input_bin}", file=sys.stderr)
@@ -201,13 +378,17 @@ def main():
     num_entries = book_size // ENTRY_SIZE
     print(f"Input: {input_bin}")
     print(f"  Size: {book_size:,} bytes ({num_entries:,} entries)")
-    print(f"  Tier: {tier} (prefix: {TIER_PREFIXES[tier]})")
+    print(f"  Tier: {tier} (prefix: {TIER_PREFIXES[tier]})"
+          f"{', compact' if compact else ''}")
     print()
     print("Generating AppVars:")
 
     # Randoms are now in CHDATA.8xv (generated by gen_data_appvar.py).
     # Only generate book data AppVars here.
-    book_paths = generate_book_appvars(convbin, input_bin, output_dir, tier)
+    if compact:
+        book_paths = generate_compact_appvars(convbin, input_bin, output_dir, tier)
+    else:
+        book_paths = generate_book_appvars(convbin, input_bin, output_dir, tier)
 
     # Bundle into .8xg group
     print()
@@ -2,10 +2,15 @@
 """
 Generate CHDATA.8xv — combined chess data appvar.
 
-Layout:
-  Offset 0:     piece sprites (2,400 bytes)
-  Offset 2400:  Polyglot random numbers (6,248 bytes)
-  Total: 8,648 bytes
+Layout (version 2, see engine/src/chdata.h):
+  Offset 0:     magic "CHD\\x02"
+  Offset 4:     Polyglot random numbers (6,248 bytes)
+  Offset 6252:  sprite index, 6 x uint16 LE stream offsets
+  Offset 6264:  run-length coded piece sprites (2,400 pixels)
+
+Each sprite stream is a run of bytes value << 6 | (length - 1), with
+runs of at most 64 pixels that never cross into the next sprite.  The
+game decodes a piece's sprite the first time it draws it.
 
 Usage:
   python3 tools/gen_data_appvar.py
@@ -29,7 +34,14 @@ APPVAR_NAME = "CHDATA"
 EXPECTED_SPRITE_SIZE = 2400   # 6 × 20 × 20
 EXPECTED_RANDOM_COUNT = 781
 EXPECTED_RANDOM_SIZE = EXPECTED_RANDOM_COUNT * 8  # 6,248
-EXPECTED_TOTAL = EXPECTED_SPRITE_SIZE + EXPECTED_RANDOM_SIZE  # 8,648
+SPRITE_COUNT = 6
+SPRITE_PIXELS = EXPECTED_SPRITE_SIZE // SPRITE_COUNT  # 20 x 20
+
+MAGIC = b"CHD\x02"
+RANDOM_OFFSET = len(MAGIC)
+INDEX_OFFSET = RANDOM_OFFSET + EXPECTED_RANDOM_SIZE   # 6,252
+STREAM_OFFSET = INDEX_OFFSET + SPRITE_COUNT * 2      # 6,264
+RUN_MAX = 64
 
 
 def find_convbin():
@@ -68,6 +80,50 @@ def get_polyglot_randoms():
     return struct.pack(f"<{EXPECTED_RANDOM_COUNT}Q", *randoms)
 
 
+def pack_sprite(pixels):
+    """Run-length code one sprite: value << 6 | (length - 1) per run."""
+    out = bytearray()
+    i = 0
+    while i < len(pixels):
+        value = pixels[i]
+        run = 1
+        while i + run < len(pixels) and pixels[i + run] == value and run < RUN_MAX:
+            run += 1
+        out.append(value << 6 | (run - 1))
+        i += run
+    return bytes(out)
+
+
+def unpack_sprite(stream):
+    """Decode a sprite stream the way chdata_sprite() does."""
+    out = bytearray()
+    for byte in stream:
+        out += bytes([byte >> 6]) * ((byte & 0x3F) + 1)
+    return bytes(out)
+
+
+def build_payload(sprites, randoms):
+    """Assemble the version 2 appvar payload."""
+    streams = []
+    for i in range(SPRITE_COUNT):
+        pixels = sprites[i * SPRITE_PIXELS:(i + 1) * SPRITE_PIXELS]
+        if max(pixels) > 3:
+            raise ValueError(f"Sprite {i} has a pixel value above 3")
+        stream = pack_sprite(pixels)
+        assert unpack_sprite(stream) == pixels
+        streams.append(stream)
+
+    index = bytearray()
+    offset = STREAM_OFFSET
+    for stream in streams:
+        index += struct.pack("<H", offset)
+        offset += len(stream)
+
+    payload = MAGIC + randoms + bytes(index) + b"".join(streams)
+    assert len(payload) == offset
+    return payload
+
+
 def main():
     convbin = find_convbin()
     if not convbin:
@@ -77,10 +133,10 @@ def main():
     # Build payload
     sprites = parse_sprites(HEADER_PATH)
     randoms = get_polyglot_randoms()
-    payload = sprites + randoms
+    payload = build_payload(sprites, randoms)
 
-    assert len(payload) == EXPECTED_TOTAL, f"Payload size {len(payload)} != {EXPECTED_TOTAL}"
-    print(f"Sprites: {len(sprites)} bytes")
+    print(f"Sprites: {len(payload) - INDEX_OFFSET} bytes "
+          f"({len(sprites)} unpacked)")
     print(f"Randoms: {len(randoms)} bytes")
     print(f"Total:   {len(payload)} bytes")
 
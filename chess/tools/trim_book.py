@@ -14,6 +14,7 @@ Requires: python-chess (pip install chess)
 Usage:
   python3 trim_book.py <source.bin> [--out-dir <dir>] [--tiers small,medium,large,xl,xxl]
   python3 trim_book.py <source.bin> --stats   # just print stats
+  python3 trim_book.py <source.bin> --compact # size tiers for --compact AppVars
 
 Examples:
   python3 trim_book.py Cerebellum3Merge.bin
@@ -40,6 +41,10 @@ TIERS = {
     "xxl":    2   * 1024 * 1024,  # 2 MB   ~130,000 entries
 }
 
+# Bytes per entry of gen_book_appvar.py --compact output, measured at
+# 5.4-6.0 on the shipped tiers
+COMPACT_ENTRY_SIZE = 6
+
 
 def read_book(path):
     """Read a Polyglot book into a dict: key -> [(move_int, weight), ...]"""
@@ -310,6 +315,8 @@ def main():
                         help="Just print stats, don't generate tiers")
     parser.add_argument("--max-moves", type=int, default=None,
                         help="Max moves per position (default: auto per tier)")
+    parser.add_argument("--compact", action="store_true",
+                        help="Size tiers for the compact AppVar format")
     args = parser.parse_args()
 
     print(f"Reading {args.source}...")
@@ -338,12 +345,13 @@ def main():
             continue
 
         target = TIERS[tier_name]
-        max_entries = target // ENTRY_SIZE
+        entry_size = COMPACT_ENTRY_SIZE if args.compact else ENTRY_SIZE
+        max_entries = target // entry_size
         max_moves = args.max_moves or tier_max_moves.get(tier_name, 2)
 
         # Skip if source is already smaller than target
         source_entries = sum(len(m) for m in book.values())
-        if source_entries * ENTRY_SIZE <= target:
+        if source_entries * entry_size <= target:
             entries = [(k, m, w) for k, moves in book.items() for m, w in moves]
             out_path = os.path.join(args.out_dir, f"book_{tier_name}.bin")
             write_book(entries, out_path)
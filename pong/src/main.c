@@ -5,6 +5,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "frame.h"
+
 /* Screen dimensions */
 #define SCREEN_W 320
 #define SCREEN_H 240
@@ -18,8 +20,18 @@
 #define BALL_SIZE 4
 
 /* Framerate */
-#define TARGET_FPS 30
-#define FRAME_TIME (CLOCKS_PER_SEC / TARGET_FPS)
+#define TARGET_FPS 60
+
+/* Physics is 8.8 fixed point.  Speeds are pixels per step of the
+   original 30 Hz loop; each frame moves by its share of a step. */
+#define FP_SHIFT 8
+#define STEP_HZ 30
+#define TO_FP(px) ((px) * (1 << FP_SHIFT))
+#define STEP_FP(speed) (TO_FP(speed) * STEP_HZ / TARGET_FPS)
+#define FP_PX(fp) ((fp) >> FP_SHIFT)
+
+/* HUD band at the top: scores, level and lives */
+#define HUD_H 24
 
 /* Palette indices */
 #define PAL_BG        0
@@ -33,7 +45,7 @@
 
 /* Game constants */
 #define NUM_LEVELS 5
-#define TRANSITION_FRAMES 90
+#define TRANSITION_FRAMES (3 * TARGET_FPS)
 #define START_LIVES 3
 #define INFINITE_MAX_SCORE 30 /* difficulty maxes out at this score */
 
@@ -59,6 +71,10 @@ typedef struct {
     color_theme_t theme;
 } level_config_t;
 
+typedef struct {
+    int x, y, w, h;
+} rect_t;
+
 typedef enum {
     STATE_MENU,
     STATE_LEVEL_SELECT,
@@ -119,9 +135,9 @@ static int menu_cursor;
 static int level_select_cursor;
 static int running;
 
-/* gameplay */
-static int paddle1_y, paddle2_y;
-static int ball_x, ball_y;
+/* gameplay (positions in fixed point, velocities in pixels per step) */
+static int paddle1_fp, paddle2_fp;
+static int ball_x_fp, ball_y_fp;
 static int ball_dx, ball_dy;
 static int score1, score2;
 static int transition_timer;
@@ -135,6 +151,22 @@ static int ball_speed_fp; /* fixed-point speed (x256) for exponential growth */
 /* active config — mutable copy used by all gameplay functions */
 static level_config_t active_cfg;
 
+/* What each buffer shows, so a frame only erases and redraws the
+   objects that were drawn into it two frames ago. */
+static struct {
+    uint8_t valid;          /* holds a plain game frame */
+    rect_t ball, pad1, pad2;
+    int score1, score2, lives;
+    uint8_t show_ms;
+} drawn[2];
+static uint8_t back_buf;    /* drawn[] index of the back buffer */
+
+/* frame-time counter, toggled with [mode] during play */
+static uint8_t show_frame_ms;
+
+/* physics steps due this frame, more than 1 after an overrun */
+static uint8_t frame_steps;
+
 /* keyboard snapshot (read once per frame after kb_Scan) */
 static uint8_t cur_g1, cur_g6, cur_g7;
 static uint8_t prev_g1, prev_g6, prev_g7;
@@ -207,25 +239,32 @@ static void reset_ball(void)
     if (last_scorer == 1)
     {
         /* AI scored — AI serves from left paddle */
-        ball_x = PADDLE_MARGIN + PADDLE_W;
-        ball_y = paddle1_y + AI_PADDLE_H / 2 - BALL_SIZE / 2;
+        ball_x_fp = TO_FP(PADDLE_MARGIN + PADDLE_W);
+        ball_y_fp = TO_FP(FP_PX(paddle1_fp) + AI_PADDLE_H / 2 - BALL_SIZE / 2);
         ball_dx = active_cfg.ball_speed + 2;
     }
     else
     {
         /* player scored — player serves from right paddle */
-        ball_x = SCREEN_W - PADDLE_MARGIN - PADDLE_W - BALL_SIZE;
-        ball_y = paddle2_y + active_cfg.paddle_h / 2 - BALL_SIZE / 2;
+        ball_x_fp = TO_FP(SCREEN_W - PADDLE_MARGIN - PADDLE_W - BALL_SIZE);
+        ball_y_fp = TO_FP(FP_PX(paddle2_fp) + active_cfg.paddle_h / 2 - BALL_SIZE / 2);
         ball_dx = -(active_cfg.ball_speed + 2);
     }
 }
 
+/* Entering play: neither buffer holds a game frame yet */
+static void invalidate_game_frames(void)
+{
+    drawn[0].valid = 0;
+    drawn[1].valid = 0;
+}
+
 static void start_level(void)
 {
     memcpy(&active_cfg, &levels[current_level], sizeof(level_config_t));
     apply_theme(&active_cfg.theme);
-    paddle1_y = SCREEN_H / 2 - AI_PADDLE_H / 2;
-    paddle2_y = SCREEN_H / 2 - active_cfg.paddle_h / 2;
+    paddle1_fp = TO_FP(SCREEN_H / 2 - AI_PADDLE_H / 2);
+    paddle2_fp = TO_FP(SCREEN_H / 2 - active_cfg.paddle_h / 2);
     score1 = 0;
     score2 = 0;
     lives = START_LIVES;
@@ -233,6 +272,7 @@ static void start_level(void)
     paused = 0;
     last_scorer = 1; /* AI serves first */
     reset_ball();
+    invalidate_game_frames();
 }
 
 static void start_infinite(void)
@@ -245,9 +285,10 @@ static void start_infinite(void)
     paused = 0;
     last_scorer = 1; /* AI serves first */
     compute_infinite_cfg();
-    paddle1_y = SCREEN_H / 2 - AI_PADDLE_H / 2;
-    paddle2_y = SCREEN_H / 2 - active_cfg.paddle_h / 2;
+    paddle1_fp = TO_FP(SCREEN_H / 2 - AI_PADDLE_H / 2);
+    paddle2_fp = TO_FP(SCREEN_H / 2 - active_cfg.paddle_h / 2);
     reset_ball();
+    invalidate_game_frames();
 }
 
 /* ---------- gameplay ---------- */
@@ -262,6 +303,21 @@ static void draw_net(void)
     }
 }
 
+/* Clear a rect back to the empty court: background and net */
+static void erase_rect(const rect_t *r)
+{
+    int y;
+
+    gfx_SetColor(PAL_BG);
+    gfx_FillRectangle_NoClip(r->x, r->y, r->w, r->h);
+
+    if (r->x >= SCREEN_W / 2 + 1 || r->x + r->w <= SCREEN_W / 2 - 1)
+        return;
+    gfx_SetColor(PAL_NET);
+    for (y = r->y & ~7; y < r->y + r->h; y += 8)
+        gfx_FillRectangle_NoClip(SCREEN_W / 2 - 1, y, 2, 4);
+}
+
 /*
  * 7x6 pixel heart bitmap (1 = filled, 0 = transparent)
  *  .XX.XX.
@@ -305,51 +361,58 @@ static void draw_lives(void)
 
 static void update_ai(void)
 {
-    int target_y, delta, spd;
+    int target_fp, delta, spd;
 
-    if (ball_dx < 0 && ball_x < SCREEN_W / 2)
+    if (ball_dx < 0 && FP_PX(ball_x_fp) < SCREEN_W / 2)
     {
         /* ball heading toward AI and past midline — track it */
-        target_y = ball_y - AI_PADDLE_H / 2;
-        spd = active_cfg.ai_speed;
+        target_fp = TO_FP(FP_PX(ball_y_fp) - AI_PADDLE_H / 2);
+        spd = STEP_FP(active_cfg.ai_speed);
     }
     else
     {
         /* ball heading away or on far side — drift to center */
-        target_y = SCREEN_H / 2 - AI_PADDLE_H / 2;
-        spd = (active_cfg.ai_speed + 1) / 2;
+        target_fp = TO_FP(SCREEN_H / 2 - AI_PADDLE_H / 2);
+        spd = STEP_FP((active_cfg.ai_speed + 1) / 2);
     }
 
-    delta = target_y - paddle1_y;
+    delta = target_fp - paddle1_fp;
 
     if (delta > spd)
-        paddle1_y += spd;
+        paddle1_fp += spd;
     else if (delta < -spd)
-        paddle1_y -= spd;
+        paddle1_fp -= spd;
     else
-        paddle1_y = target_y;
+        paddle1_fp = target_fp;
 
-    if (paddle1_y < 0) paddle1_y = 0;
-    if (paddle1_y > SCREEN_H - AI_PADDLE_H) paddle1_y = SCREEN_H - AI_PADDLE_H;
+    if (paddle1_fp < 0) paddle1_fp = 0;
+    if (paddle1_fp > TO_FP(SCREEN_H - AI_PADDLE_H)) paddle1_fp = TO_FP(SCREEN_H - AI_PADDLE_H);
 }
 
 static void update_input(void)
 {
-    if (cur_g7 & kb_Up)   paddle2_y -= active_cfg.player_speed;
-    if (cur_g7 & kb_Down) paddle2_y += active_cfg.player_speed;
+    if (cur_g7 & kb_Up)   paddle2_fp -= STEP_FP(active_cfg.player_speed);
+    if (cur_g7 & kb_Down) paddle2_fp += STEP_FP(active_cfg.player_speed);
 
-    if (paddle2_y < 0) paddle2_y = 0;
-    if (paddle2_y > SCREEN_H - active_cfg.paddle_h) paddle2_y = SCREEN_H - active_cfg.paddle_h;
+    if (paddle2_fp < 0) paddle2_fp = 0;
+    if (paddle2_fp > TO_FP(SCREEN_H - active_cfg.paddle_h)) paddle2_fp = TO_FP(SCREEN_H - active_cfg.paddle_h);
 }
 
 static void update_ball(void)
 {
-    ball_x += ball_dx;
-    ball_y += ball_dy;
+    int ball_x, ball_y, paddle1_y, paddle2_y;
+
+    ball_x_fp += STEP_FP(ball_dx);
+    ball_y_fp += STEP_FP(ball_dy);
 
     /* top/bottom bounce */
-    if (ball_y <= 0) { ball_y = 0; ball_dy = -ball_dy; }
-    if (ball_y >= SCREEN_H - BALL_SIZE) { ball_y = SCREEN_H - BALL_SIZE; ball_dy = -ball_dy; }
+    if (ball_y_fp <= 0) { ball_y_fp = 0; ball_dy = -ball_dy; }
+    if (ball_y_fp >= TO_FP(SCREEN_H - BALL_SIZE)) { ball_y_fp = TO_FP(SCREEN_H - BALL_SIZE); ball_dy = -ball_dy; }
+
+    ball_x = FP_PX(ball_x_fp);
+    ball_y = FP_PX(ball_y_fp);
+    paddle1_y = FP_PX(paddle1_fp);
+    paddle2_y = FP_PX(paddle2_fp);
 
     /* left paddle (AI) collision */
     if (ball_x <= PADDLE_MARGIN + PADDLE_W &&
@@ -357,7 +420,7 @@ static void update_ball(void)
         ball_y <= paddle1_y + AI_PADDLE_H &&
         ball_dx < 0)
     {
-        ball_x = PADDLE_MARGIN + PADDLE_W;
+        ball_x_fp = TO_FP(PADDLE_MARGIN + PADDLE_W);
         ball_speed_fp = ball_speed_fp * 105 / 100;
         ball_dx = ball_speed_fp >> 8;
     }
@@ -368,13 +431,13 @@ static void update_ball(void)
         ball_y <= paddle2_y + active_cfg.paddle_h &&
         ball_dx > 0)
     {
-        ball_x = SCREEN_W - PADDLE_MARGIN - PADDLE_W - BALL_SIZE;
+        ball_x_fp = TO_FP(SCREEN_W - PADDLE_MARGIN - PADDLE_W - BALL_SIZE);
         ball_speed_fp = ball_speed_fp * 105 / 100;
         ball_dx = -(ball_speed_fp >> 8);
     }
 
     /* player scores (ball passed AI) */
-    if (ball_x < 0)
+    if (ball_x_fp < 0)
     {
         score2++;
         last_scorer = 2;
@@ -384,7 +447,7 @@ static void update_ball(void)
     }
 
     /* AI scores (ball passed player) — lose a life */
-    if (ball_x > SCREEN_W)
+    if (ball_x_fp > TO_FP(SCREEN_W))
     {
         score1++;
         last_scorer = 1;
@@ -416,21 +479,21 @@ static void update_ball(void)
     }
 }
 
-static void draw_game(void)
+static void draw_objects(void)
 {
-    gfx_FillScreen(PAL_BG);
-    draw_net();
-
     /* paddles */
     gfx_SetColor(PAL_PADDLE1);
-    gfx_FillRectangle_NoClip(PADDLE_MARGIN, paddle1_y, PADDLE_W, AI_PADDLE_H);
+    gfx_FillRectangle_NoClip(PADDLE_MARGIN, FP_PX(paddle1_fp), PADDLE_W, AI_PADDLE_H);
     gfx_SetColor(PAL_PADDLE2);
-    gfx_FillRectangle_NoClip(SCREEN_W - PADDLE_MARGIN - PADDLE_W, paddle2_y, PADDLE_W, active_cfg.paddle_h);
+    gfx_FillRectangle_NoClip(SCREEN_W - PADDLE_MARGIN - PADDLE_W, FP_PX(paddle2_fp), PADDLE_W, active_cfg.paddle_h);
 
     /* ball */
     gfx_SetColor(PAL_BALL);
-    gfx_FillRectangle_NoClip(ball_x, ball_y, BALL_SIZE, BALL_SIZE);
+    gfx_FillRectangle_NoClip(FP_PX(ball_x_fp), FP_PX(ball_y_fp), BALL_SIZE, BALL_SIZE);
+}
 
+static void draw_hud(void)
+{
     /* scores (AI left, Player right) */
     gfx_SetTextScale(2, 2);
     gfx_SetTextFGColor(PAL_TEXT);
@@ -453,14 +516,93 @@ static void draw_game(void)
 
     /* lives */
     draw_lives();
+}
+
+/* busy milliseconds of the last frame, bottom left */
+static void draw_frame_ms(void)
+{
+    gfx_SetColor(PAL_BG);
+    gfx_FillRectangle_NoClip(0, SCREEN_H - 10, 40, 10);
+    gfx_SetTextScale(1, 1);
+    gfx_SetTextFGColor(PAL_NET);
+    gfx_SetTextXY(2, SCREEN_H - 9);
+    gfx_PrintUInt(frame_ticks_ms(frame_busy()), 2);
+    gfx_PrintString("ms");
+}
+
+static void render_game(void)
+{
+    gfx_FillScreen(PAL_BG);
+    draw_net();
+    draw_objects();
+    draw_hud();
+    if (show_frame_ms)
+        draw_frame_ms();
+}
+
+/* Draw the frame into the back buffer.  If it holds a game frame with
+   the same HUD, only the objects drawn into it last time are erased
+   and everything moving is drawn again; otherwise it is redrawn. */
+static void draw_game(void)
+{
+    rect_t ball, pad1, pad2;
+    int i;
+    int touches_hud;
+
+    ball.x = FP_PX(ball_x_fp);
+    ball.y = FP_PX(ball_y_fp);
+    ball.w = BALL_SIZE;
+    ball.h = BALL_SIZE;
+    pad1.x = PADDLE_MARGIN;
+    pad1.y = FP_PX(paddle1_fp);
+    pad1.w = PADDLE_W;
+    pad1.h = AI_PADDLE_H;
+    pad2.x = SCREEN_W - PADDLE_MARGIN - PADDLE_W;
+    pad2.y = FP_PX(paddle2_fp);
+    pad2.w = PADDLE_W;
+    pad2.h = active_cfg.paddle_h;
+
+    i = back_buf;
+    if (!drawn[i].valid || drawn[i].score1 != score1 ||
+        drawn[i].score2 != score2 || drawn[i].lives != lives ||
+        drawn[i].show_ms != show_frame_ms)
+    {
+        render_game();
+    }
+    else
+    {
+        touches_hud = drawn[i].ball.y < HUD_H || drawn[i].pad1.y < HUD_H ||
+                      drawn[i].pad2.y < HUD_H || ball.y < HUD_H ||
+                      pad1.y < HUD_H || pad2.y < HUD_H;
+
+        erase_rect(&drawn[i].ball);
+        erase_rect(&drawn[i].pad1);
+        erase_rect(&drawn[i].pad2);
+        draw_objects();
+        if (touches_hud)
+            draw_hud();
+        if (show_frame_ms)
+            draw_frame_ms();
+    }
+
+    drawn[i].valid = 1;
+    drawn[i].ball = ball;
+    drawn[i].pad1 = pad1;
+    drawn[i].pad2 = pad2;
+    drawn[i].score1 = score1;
+    drawn[i].score2 = score2;
+    drawn[i].lives = lives;
+    drawn[i].show_ms = show_frame_ms;
 
     gfx_SwapDraw();
+    back_buf ^= 1;
 }
 
 static void update_playing(void)
 {
     uint8_t new6 = cur_g6 & ~prev_g6;
     uint8_t new1 = cur_g1 & ~prev_g1;
+    uint8_t i;
 
     if (cur_g6 & kb_Clear)
     {
@@ -473,26 +615,40 @@ static void update_playing(void)
     if ((new6 & kb_Enter) || (new1 & kb_2nd))
         paused = !paused;
 
+    /* toggle the frame-time counter */
+    if (new1 & kb_Mode)
+        show_frame_ms = !show_frame_ms;
+
     if (paused)
     {
-        draw_game();
-        /* draw pause overlay on the back buffer, then swap again */
+        /* game frame with the pause overlay; not reusable for dirty redraws */
+        render_game();
         gfx_SetTextScale(2, 2);
         gfx_SetTextFGColor(PAL_TEXT);
         gfx_PrintStringXY("PAUSED", 104, 110);
         gfx_SetTextScale(1, 1);
         gfx_SetTextFGColor(PAL_NET);
         gfx_PrintStringXY("enter to resume", 100, 140);
+        drawn[back_buf].valid = 0;
         gfx_SwapDraw();
+        back_buf ^= 1;
         return;
     }
 
-    update_ai();
-    update_input();
-    update_ball();
+    /* keep game speed when a long frame skipped slots */
+    for (i = 0; i < frame_steps && state == STATE_PLAYING; i++)
+    {
+        update_ai();
+        update_input();
+        update_ball();
+    }
 
     if (state == STATE_PLAYING)
+    {
+        FRAME_SCOPE_BEGIN(FRAME_SCOPE_DRAW);
         draw_game();
+        FRAME_SCOPE_END(FRAME_SCOPE_DRAW);
+    }
 }
 
 /* ---------- menu ---------- */
@@ -766,8 +922,6 @@ static void update_game_over(void)
 
 int main(void)
 {
-    clock_t frame_start;
-
     gfx_Begin();
     gfx_SetDrawBuffer();
 
@@ -776,10 +930,12 @@ int main(void)
     menu_cursor = 0;
     running = 1;
     apply_theme(&levels[0].theme);
+    frame_init(TARGET_FPS);
+    frame_hud_style(SCREEN_W / 2, SCREEN_H - 10, PAL_TEXT, PAL_BG);
 
     do
     {
-        frame_start = clock();
+        frame_steps = frame_begin();
         kb_Scan();
 
         /* snapshot key state once per frame */
@@ -801,8 +957,7 @@ int main(void)
         prev_g6 = cur_g6;
         prev_g7 = cur_g7;
 
-        while (clock() - frame_start < FRAME_TIME)
-            ;
+        frame_end();
 
     } while (running);
 
@@ -0,0 +1,187 @@
+#include "frame.h"
+
+#ifdef FRAME_HUD
+#include <graphx.h>
+#endif
+
+static clock_t period;      /* ticks per frame */
+static clock_t slot;        /* start of the current frame's slot */
+static clock_t started;     /* when frame_begin() returned */
+static clock_t busy;
+
+void frame_init(uint8_t fps)
+{
+    period = CLOCKS_PER_SEC / fps;
+    /* the first frame_begin() returns at once */
+    slot = clock() - period;
+    started = slot;
+    busy = 0;
+}
+
+clock_t frame_idle(void)
+{
+    clock_t used = clock() - slot;
+    return used < period ? period - used : 0;
+}
+
+clock_t frame_busy(void)
+{
+    return busy;
+}
+
+unsigned frame_ticks_ms(clock_t ticks)
+{
+    return (unsigned)(ticks * 1000 / CLOCKS_PER_SEC);
+}
+
+/* ========== HUD ========== */
+
+#ifdef FRAME_HUD
+
+#define HUD_WINDOW 16       /* frames averaged per HUD update */
+#define HUD_LINE_H 10
+
+static struct {
+    const char *name;
+    clock_t begin;
+    clock_t sum;            /* this window */
+} scopes[FRAME_MAX_SCOPES];
+
+static clock_t sum_frame, sum_busy;
+static uint8_t window_frames, window_skips;
+
+/* window averages in tenths of a ms */
+static unsigned avg_frame, avg_update, avg_scope[FRAME_MAX_SCOPES];
+static uint8_t shown_skips;
+
+static int hud_x, hud_y;
+static uint8_t hud_fg = 255, hud_bg = 0;
+
+void frame_scope_name(uint8_t id, const char *name)
+{
+    scopes[id].name = name;
+}
+
+void frame_scope_begin(uint8_t id)
+{
+    scopes[id].begin = clock();
+}
+
+void frame_scope_end(uint8_t id)
+{
+    scopes[id].sum += clock() - scopes[id].begin;
+}
+
+void frame_hud_style(int x, int y, uint8_t fg, uint8_t bg)
+{
+    hud_x = x;
+    hud_y = y;
+    hud_fg = fg;
+    hud_bg = bg;
+}
+
+static unsigned tenths_ms(clock_t ticks)
+{
+    return (unsigned)(ticks / HUD_WINDOW * 10000 / CLOCKS_PER_SEC);
+}
+
+static void hud_print_ms(const char *label, unsigned tenths)
+{
+    gfx_PrintString(label);
+    gfx_PrintUInt(tenths / 10, tenths >= 100 ? 2 : 1);
+    gfx_PrintChar('.');
+    gfx_PrintUInt(tenths % 10, 1);
+    gfx_PrintChar(' ');
+}
+
+static void hud_collect(clock_t frame)
+{
+    uint8_t i;
+
+    sum_frame += frame;
+    sum_busy += busy;
+    if (++window_frames < HUD_WINDOW)
+        return;
+
+    avg_frame = tenths_ms(sum_frame);
+    avg_update = tenths_ms(sum_busy > scopes[FRAME_SCOPE_DRAW].sum ?
+                           sum_busy - scopes[FRAME_SCOPE_DRAW].sum : 0);
+    for (i = 0; i < FRAME_MAX_SCOPES; i++)
+    {
+        avg_scope[i] = tenths_ms(scopes[i].sum);
+        scopes[i].sum = 0;
+    }
+    shown_skips = window_skips;
+    sum_frame = sum_busy = 0;
+    window_frames = window_skips = 0;
+}
+
+/* Drawn straight to the screen after the game's frame, so it works
+   the same for swapped and blitted buffers. */
+static void hud_draw(void)
+{
+    uint8_t i, lines = 1;
+    int y;
+
+    for (i = 1; i < FRAME_MAX_SCOPES; i++)
+        if (scopes[i].name) lines++;
+
+    gfx_SetDrawScreen();
+    gfx_SetColor(hud_bg);
+    gfx_FillRectangle_NoClip(hud_x, hud_y, 160, lines * HUD_LINE_H);
+    gfx_SetTextScale(1, 1);
+    gfx_SetTextFGColor(hud_fg);
+
+    y = hud_y + 1;
+    gfx_SetTextXY(hud_x + 1, y);
+    hud_print_ms("F", avg_frame);
+    hud_print_ms("U", avg_update);
+    hud_print_ms("D", avg_scope[FRAME_SCOPE_DRAW]);
+    gfx_PrintChar('S');
+    gfx_PrintUInt(shown_skips, 1);
+
+    for (i = 1; i < FRAME_MAX_SCOPES; i++)
+    {
+        if (!scopes[i].name) continue;
+        y += HUD_LINE_H;
+        gfx_SetTextXY(hud_x + 1, y);
+        hud_print_ms(scopes[i].name, avg_scope[i]);
+    }
+    gfx_SetDrawBuffer();
+}
+
+#endif /* FRAME_HUD */
+
+/* ========== Pacing ========== */
+
+uint8_t frame_begin(void)
+{
+    clock_t now, late;
+    uint8_t steps;
+
+    while ((now = clock()) - slot < period)
+        ;
+
+    /* move to the latest slot that has started, dropping missed ones */
+    late = now - slot;
+    steps = late / period < FRAME_MAX_STEPS ? (uint8_t)(late / period) : FRAME_MAX_STEPS;
+    if (steps < FRAME_MAX_STEPS)
+        slot += (clock_t)steps * period;
+    else
+        slot = now;         /* far behind: start over from now */
+
+#ifdef FRAME_HUD
+    window_skips += steps - 1;
+    hud_collect(now - started);
+#endif
+    started = now;
+    return steps;
+}
+
+void frame_end(void)
+{
+    busy = clock() - started;
+#ifdef FRAME_HUD
+    hud_draw();
+#endif
+}
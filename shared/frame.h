@@ -0,0 +1,67 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* Fixed-timestep frame pacing shared by the games, with timing scopes
+   and an optional on-screen HUD.  Times are clock() ticks.
+
+   Main loop:
+       frame_init(TARGET_FPS);
+       do {
+           steps = frame_begin();   waits for this frame's slot
+           ... update; FRAME_SCOPE_BEGIN/END(FRAME_SCOPE_DRAW) around drawing
+           frame_end();             records timing, draws the HUD
+           ... optional idle work while frame_idle() allows
+       } while (running);
+
+   frame_begin() returns how many slots passed since the previous
+   frame, 1 when on time.  A frame that overruns skips the slots it
+   missed instead of rushing to catch up; fixed-timestep games can run
+   that many logic steps (at most FRAME_MAX_STEPS).
+
+   Build with -DFRAME_HUD (make FRAME_HUD=1) to time the scopes and
+   overlay frame, update and draw ms on the screen.  Without it the
+   scope macros compile away. */
+
+#define FRAME_MAX_STEPS  4
+#define FRAME_MAX_SCOPES 4
+#define FRAME_SCOPE_DRAW 0  /* drawing; the rest of the busy time is update */
+
+void frame_init(uint8_t fps);
+uint8_t frame_begin(void);
+void frame_end(void);
+
+/* Ticks left before the next slot, 0 when already late */
+clock_t frame_idle(void);
+
+/* Ticks the last frame spent between frame_begin() and frame_end() */
+clock_t frame_busy(void);
+
+/* Whole milliseconds in a tick count */
+unsigned frame_ticks_ms(clock_t ticks);
+
+#ifdef FRAME_HUD
+
+/* Scopes above FRAME_SCOPE_DRAW get their own HUD line once named */
+void frame_scope_name(uint8_t id, const char *name);
+void frame_scope_begin(uint8_t id);
+void frame_scope_end(uint8_t id);
+
+/* HUD position (top left) and palette colors, default 0,0 / 255 on 0 */
+void frame_hud_style(int x, int y, uint8_t fg, uint8_t bg);
+
+#define FRAME_SCOPE_BEGIN(id) frame_scope_begin(id)
+#define FRAME_SCOPE_END(id)   frame_scope_end(id)
+
+#else
+
+#define frame_scope_name(id, name)    ((void)0)
+#define frame_hud_style(x, y, fg, bg) ((void)0)
+#define FRAME_SCOPE_BEGIN(id)         ((void)0)
+#define FRAME_SCOPE_END(id)           ((void)0)
+
+#endif /* FRAME_HUD */
+
+#endif /* FRAME_H */
@@ -3,9 +3,12 @@
 #include <fileioc.h>
 #include <sys/util.h>
 #include <time.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "frame.h"
+
 /* ========== Screen & Layout ========== */
 
 #define SCREEN_W 320
@@ -49,8 +52,9 @@
 
 #define NUM_SETTINGS    8
 #define MAX_UNDO        128
-#define SAVE_VERSION    1
+#define SAVE_VERSION    2
 #define APPVAR_NAME     "SUDKSAV"
+#define QUEUE_DEPTH     2   /* ready puzzles kept per difficulty */
 
 #define KEY_REPEAT_DELAY 12
 #define KEY_REPEAT_RATE  3
@@ -98,6 +102,11 @@ typedef struct {
     uint16_t best_time; /* seconds, 0=no record */
 } score_entry_t;
 
+typedef struct {
+    uint8_t solution[81];
+    uint8_t given_mask[11];
+} queued_puzzle_t;
+
 typedef struct {
     uint8_t version;
     settings_t settings;
@@ -109,8 +118,14 @@ typedef struct {
     uint8_t player_values[81];
     uint16_t pencil_marks[81];
     uint16_t elapsed_seconds;
+    /* version 2 */
+    uint8_t queue_count[3];
+    queued_puzzle_t queue[3][QUEUE_DEPTH];
 } save_data_t;
 
+/* version 1 saves end before the puzzle queue */
+#define SAVE_V1_SIZE offsetof(save_data_t, queue_count)
+
 typedef enum {
     STATE_MENU,
     STATE_DIFFICULTY,
@@ -197,6 +212,11 @@ static score_entry_t scores[3];
 static int new_best;
 static int has_saved_game;
 
+/* ready puzzles per difficulty, oldest first */
+static queued_puzzle_t puzzle_queue[3][QUEUE_DEPTH];
+static uint8_t queue_count[3];
+static uint8_t queue_dirty;     /* changed since the last save */
+
 /* precomputed cell pixel positions */
 static uint16_t cell_px[9];
 static uint16_t cell_py[9];
@@ -204,6 +224,13 @@ static uint16_t cell_py[9];
 /* digit counts */
 static uint8_t digit_count[10]; /* index 1-9 */
 
+/* playing screen as last drawn, for dirty-cell redraws */
+static uint8_t play_drawn;      /* gfx_buffer holds the playing screen */
+static uint32_t drawn_look[81];
+static uint16_t drawn_seconds;
+static uint8_t drawn_pencil;
+static uint8_t drawn_count[10];
+
 /* keyboard */
 static uint8_t cur_g1, cur_g2, cur_g3, cur_g4, cur_g5, cur_g6, cur_g7;
 static uint8_t prev_g1, prev_g2, prev_g3, prev_g4, prev_g5, prev_g6, prev_g7;
@@ -315,19 +342,20 @@ static int popcount16(uint16_t v)
 
 /* ========== Puzzle Generator ========== */
 
-static int fill_grid(int pos)
-{
-    int r, c, b, i, j;
-    uint16_t used, cand;
-    uint8_t order[9], tmp;
+/* temp grid used by generator, solver and difficulty checker */
+static uint8_t temp_grid[81];
 
-    if (pos == 81) return 1;
-    r = pos / 9;
-    c = pos % 9;
-    b = (r / 3) * 3 + (c / 3);
-    used = row_used[r] | col_used[c] | box_used[b];
-    cand = (~used) & 0x3FE; /* bits 1-9 */
-    if (!cand) return 0;
+/* Random solved grid by backtracking in cell order, with an explicit
+   stack so it can run in bounded slices: each cell keeps its shuffled
+   digit order and the next digit to try. */
+static uint8_t fill_order[81][9];
+static uint8_t fill_next[81];
+static int fill_pos;
+
+static void fill_shuffle(int pos)
+{
+    int i, j;
+    uint8_t tmp, *order = fill_order[pos];
 
     for (i = 0; i < 9; i++) order[i] = (uint8_t)(i + 1);
     for (i = 8; i > 0; i--)
@@ -335,109 +363,187 @@ static int fill_grid(int pos)
         j = rand() % (i + 1);
         tmp = order[i]; order[i] = order[j]; order[j] = tmp;
     }
-
-    for (i = 0; i < 9; i++)
-    {
-        uint8_t d = order[i];
-        if (!(cand & (1 << d))) continue;
-        solution[pos] = d;
-        row_used[r] |= (1 << d);
-        col_used[c] |= (1 << d);
-        box_used[b] |= (1 << d);
-        if (fill_grid(pos + 1)) return 1;
-        row_used[r] &= ~(1 << d);
-        col_used[c] &= ~(1 << d);
-        box_used[b] &= ~(1 << d);
-    }
-    solution[pos] = 0;
-    return 0;
+    fill_next[pos] = 0;
 }
 
-/* temp grid used by solver and difficulty checker */
-static uint8_t temp_grid[81];
-
-static void rebuild_used(const uint8_t *grid)
+static void fill_begin(void)
 {
-    int i, r, c, b;
+    memset(temp_grid, 0, 81);
     memset(row_used, 0, sizeof(row_used));
     memset(col_used, 0, sizeof(col_used));
     memset(box_used, 0, sizeof(box_used));
-    for (i = 0; i < 81; i++)
+    fill_pos = 0;
+    fill_shuffle(0);
+}
+
+/* Advance the fill by up to steps placements or backtracks.  Returns 1
+   once temp_grid holds a solved grid. */
+static int fill_run(int steps)
+{
+    int r, c, b;
+    uint16_t bit;
+    uint8_t d;
+
+    while (fill_pos < 81)
     {
-        if (grid[i])
+        if (steps-- == 0) return 0;
+        r = fill_pos / 9;
+        c = fill_pos % 9;
+        b = (r / 3) * 3 + (c / 3);
+
+        /* lift the digit this cell held before backtracking into it */
+        if (temp_grid[fill_pos])
+        {
+            bit = (uint16_t)~(1 << temp_grid[fill_pos]);
+            row_used[r] &= bit;
+            col_used[c] &= bit;
+            box_used[b] &= bit;
+            temp_grid[fill_pos] = 0;
+        }
+
+        d = 0;
+        while (fill_next[fill_pos] < 9)
+        {
+            uint8_t t = fill_order[fill_pos][fill_next[fill_pos]++];
+            if (!((row_used[r] | col_used[c] | box_used[b]) & (1 << t)))
+            {
+                d = t;
+                break;
+            }
+        }
+
+        if (d)
+        {
+            temp_grid[fill_pos] = d;
+            row_used[r] |= (1 << d);
+            col_used[c] |= (1 << d);
+            box_used[b] |= (1 << d);
+            if (++fill_pos < 81) fill_shuffle(fill_pos);
+        }
+        else
         {
-            r = i / 9; c = i % 9; b = (r / 3) * 3 + (c / 3);
-            row_used[r] |= (1 << grid[i]);
-            col_used[c] |= (1 << grid[i]);
-            box_used[b] |= (1 << grid[i]);
+            fill_pos--;     /* never below 0: an empty grid always fills */
         }
     }
+    return 1;
 }
 
-/* count solutions using MCV heuristic, stop at 2 */
-static void count_solutions_inner(void)
-{
-    int i, r, c, b, d;
-    int best_pos, best_count, cnt;
-    uint16_t used, cand;
+/* ========== Solver ========== */
 
-    if (solve_count >= 2) return;
+/* Candidate-bitmask solver over temp_grid and row/col/box_used.
+   Placements go on a trail so a branch undoes exactly what it (and its
+   propagation) filled in. */
+static uint8_t cell_row[81], cell_col[81], cell_box[81];
+static uint8_t house_cells[27][9];  /* rows 0-8, cols 9-17, boxes 18-26 */
+static uint8_t trail[81];
+static uint8_t trail_top;
+static uint16_t cand_mask[81];      /* empty cells, kept by propagate() */
+
+static void init_houses(void)
+{
+    int i, r, c, b;
+    uint8_t box_fill[9];
 
-    best_pos = -1;
-    best_count = 10;
+    memset(box_fill, 0, sizeof(box_fill));
     for (i = 0; i < 81; i++)
     {
-        if (temp_grid[i]) continue;
         r = i / 9; c = i % 9; b = (r / 3) * 3 + (c / 3);
-        used = row_used[r] | col_used[c] | box_used[b];
-        cand = (~used) & 0x3FE;
-        if (!cand) return; /* dead end */
-        cnt = popcount16(cand);
-        if (cnt < best_count)
+        cell_row[i] = (uint8_t)r;
+        cell_col[i] = (uint8_t)c;
+        cell_box[i] = (uint8_t)b;
+        house_cells[r][c] = (uint8_t)i;
+        house_cells[9 + c][r] = (uint8_t)i;
+        house_cells[18 + b][box_fill[b]++] = (uint8_t)i;
+    }
+}
+
+static void rebuild_used(const uint8_t *grid)
+{
+    int i;
+    memset(row_used, 0, sizeof(row_used));
+    memset(col_used, 0, sizeof(col_used));
+    memset(box_used, 0, sizeof(box_used));
+    for (i = 0; i < 81; i++)
+    {
+        if (grid[i])
         {
-            best_count = cnt;
-            best_pos = i;
-            if (cnt == 1) break;
+            row_used[cell_row[i]] |= (1 << grid[i]);
+            col_used[cell_col[i]] |= (1 << grid[i]);
+            box_used[cell_box[i]] |= (1 << grid[i]);
         }
     }
+}
+
+static uint16_t cell_cand(int i)
+{
+    return (uint16_t)(~(row_used[cell_row[i]] | col_used[cell_col[i]] |
+                        box_used[cell_box[i]]) & 0x3FE);
+}
+
+static uint16_t house_used(int h)
+{
+    if (h < 9) return row_used[h];
+    if (h < 18) return col_used[h - 9];
+    return box_used[h - 18];
+}
 
-    if (best_pos == -1) { solve_count++; return; }
+static void place_digit(int i, int d)
+{
+    uint16_t bit = (uint16_t)(1 << d);
+    temp_grid[i] = (uint8_t)d;
+    row_used[cell_row[i]] |= bit;
+    col_used[cell_col[i]] |= bit;
+    box_used[cell_box[i]] |= bit;
+    trail[trail_top++] = (uint8_t)i;
+}
 
-    r = best_pos / 9; c = best_pos % 9; b = (r / 3) * 3 + (c / 3);
-    used = row_used[r] | col_used[c] | box_used[b];
-    for (d = 1; d <= 9; d++)
+static void undo_to(uint8_t mark)
+{
+    while (trail_top > mark)
     {
-        if (used & (1 << d)) continue;
-        temp_grid[best_pos] = (uint8_t)d;
-        row_used[r] |= (1 << d);
-        col_used[c] |= (1 << d);
-        box_used[b] |= (1 << d);
-        count_solutions_inner();
-        temp_grid[best_pos] = 0;
-        row_used[r] &= ~(1 << d);
-        col_used[c] &= ~(1 << d);
-        box_used[b] &= ~(1 << d);
-        if (solve_count >= 2) return;
+        int i = trail[--trail_top];
+        uint16_t bit = (uint16_t)~(1 << temp_grid[i]);
+        row_used[cell_row[i]] &= bit;
+        col_used[cell_col[i]] &= bit;
+        box_used[cell_box[i]] &= bit;
+        temp_grid[i] = 0;
     }
 }
 
-static int has_unique_solution(const uint8_t *puzzle)
+static int lowest_digit(uint16_t cand)
 {
-    memcpy(temp_grid, puzzle, 81);
-    rebuild_used(temp_grid);
-    solve_count = 0;
-    count_solutions_inner();
-    return (solve_count == 1);
+    int d = 1;
+    while (!(cand & (1 << d))) d++;
+    return d;
 }
 
-/* difficulty check: can the puzzle be solved with singles only? */
-static int solvable_by_singles(const uint8_t *puzzle)
+/* place and strike the digit from the candidates of the cell's houses */
+static void place_single(int i, int d)
 {
-    uint8_t work[81];
-    int i, r, c, d, j, br, bc, dr, dc, progress;
-    uint16_t used, cand;
+    const uint8_t *h;
+    uint16_t keep = (uint16_t)~(1 << d);
+    int k;
+
+    place_digit(i, d);
+    h = house_cells[cell_row[i]];
+    for (k = 0; k < 9; k++) cand_mask[h[k]] &= keep;
+    h = house_cells[9 + cell_col[i]];
+    for (k = 0; k < 9; k++) cand_mask[h[k]] &= keep;
+    h = house_cells[18 + cell_box[i]];
+    for (k = 0; k < 9; k++) cand_mask[h[k]] &= keep;
+}
+
+/* Fill naked and hidden singles until none are left.  Returns 0 on a
+   contradiction: a cell with no candidate, or a digit with no place in
+   some house. */
+static int propagate(void)
+{
+    int i, h, k, progress;
+    uint16_t cand, once, twice, only;
 
-    memcpy(work, puzzle, 81);
+    for (i = 0; i < 81; i++)
+        if (!temp_grid[i])
+            cand_mask[i] = cell_cand(i);
 
     do {
         progress = 0;
@@ -445,173 +551,336 @@ static int solvable_by_singles(const uint8_t *puzzle)
         /* naked singles */
         for (i = 0; i < 81; i++)
         {
-            if (work[i]) continue;
-            r = i / 9; c = i % 9;
-            used = 0;
-            for (j = 0; j < 9; j++)
+            if (temp_grid[i]) continue;
+            cand = cand_mask[i];
+            if (!cand) return 0;
+            if (!(cand & (cand - 1)))
             {
-                if (work[r * 9 + j]) used |= (1 << work[r * 9 + j]);
-                if (work[j * 9 + c]) used |= (1 << work[j * 9 + c]);
-            }
-            br = (r / 3) * 3; bc = (c / 3) * 3;
-            for (dr = 0; dr < 3; dr++)
-                for (dc = 0; dc < 3; dc++)
-                    if (work[(br + dr) * 9 + (bc + dc)])
-                        used |= (1 << work[(br + dr) * 9 + (bc + dc)]);
-            cand = (~used) & 0x3FE;
-            if (popcount16(cand) == 1)
-            {
-                for (d = 1; d <= 9; d++)
-                    if (cand & (1 << d)) { work[i] = (uint8_t)d; break; }
+                place_single(i, lowest_digit(cand));
                 progress = 1;
             }
         }
 
-        /* hidden singles — check rows, columns, and boxes */
-        /* For each house, find digits that can only go in one cell */
-        for (j = 0; j < 27; j++)
+        /* hidden singles: digits seen in exactly one cell of a house */
+        for (h = 0; h < 27; h++)
         {
-            /* enumerate cells in house j: rows 0-8, cols 9-17, boxes 18-26 */
-            int hi, hcells[9];
-            if (j < 9)
-            {
-                for (hi = 0; hi < 9; hi++) hcells[hi] = j * 9 + hi;
-            }
-            else if (j < 18)
+            once = twice = 0;
+            for (k = 0; k < 9; k++)
             {
-                for (hi = 0; hi < 9; hi++) hcells[hi] = hi * 9 + (j - 9);
+                i = house_cells[h][k];
+                if (temp_grid[i]) continue;
+                cand = cand_mask[i];
+                twice |= once & cand;
+                once |= cand;
             }
-            else
+            if ((once | house_used(h)) != 0x3FE) return 0;
+            only = once & ~twice;
+            for (k = 0; k < 9 && only; k++)
             {
-                int bx = ((j - 18) % 3) * 3;
-                int by = ((j - 18) / 3) * 3;
-                for (dr = 0; dr < 3; dr++)
-                    for (dc = 0; dc < 3; dc++)
-                        hcells[dr * 3 + dc] = (by + dr) * 9 + (bx + dc);
+                i = house_cells[h][k];
+                if (temp_grid[i]) continue;
+                cand = cand_mask[i] & only;
+                if (cand)
+                {
+                    /* a second hidden single in this cell is a
+                       contradiction the next pass will find */
+                    place_single(i, lowest_digit(cand));
+                    only &= ~cand;
+                    progress = 1;
+                }
             }
+        }
+    } while (progress);
+
+    return 1;
+}
+
+/* Count solutions, stopping at 2: propagate, then branch on the empty
+   cell with the fewest candidates.  The branch stack is explicit so the
+   count can run in bounded slices; a frame keeps the trail marks around
+   its propagation and the digits it has yet to try. */
+static struct {
+    uint8_t  mark;          /* trail before propagate() */
+    uint8_t  base;          /* trail after it, before the branch digit */
+    uint8_t  pos;           /* branch cell */
+    uint16_t left;          /* digits not yet tried there */
+} solve_stack[81];
+static uint8_t solve_sp;
+static uint8_t solve_enter;     /* next step propagates a new node */
+
+static void solve_begin(const uint8_t *puzzle)
+{
+    memcpy(temp_grid, puzzle, 81);
+    rebuild_used(temp_grid);
+    trail_top = 0;
+    solve_count = 0;
+    solve_sp = 0;
+    solve_enter = 1;
+}
+
+/* Advance the count by up to nodes propagations.  Returns 1 once
+   solve_count is final. */
+static int solve_run(int nodes)
+{
+    int i, d, best_pos, best_count, cnt;
+
+    for (;;)
+    {
+        if (solve_enter)
+        {
+            uint8_t mark = trail_top;
 
-            for (d = 1; d <= 9; d++)
+            if (nodes-- == 0) return 0;
+            solve_enter = 0;
+            if (!propagate()) { undo_to(mark); continue; }
+
+            best_pos = -1;
+            best_count = 10;
+            for (i = 0; i < 81; i++)
             {
-                int count = 0, last_pos = -1;
-                for (hi = 0; hi < 9; hi++)
-                {
-                    int ci = hcells[hi];
-                    if (work[ci] == (uint8_t)d) { count = 2; break; } /* already placed */
-                    if (work[ci]) continue;
-                    /* check if d is a candidate for this cell */
-                    r = ci / 9; c = ci % 9;
-                    used = 0;
-                    {
-                        int k;
-                        for (k = 0; k < 9; k++)
-                        {
-                            if (work[r * 9 + k]) used |= (1 << work[r * 9 + k]);
-                            if (work[k * 9 + c]) used |= (1 << work[k * 9 + c]);
-                        }
-                        br = (r / 3) * 3; bc = (c / 3) * 3;
-                        for (dr = 0; dr < 3; dr++)
-                            for (dc = 0; dc < 3; dc++)
-                                if (work[(br + dr) * 9 + (bc + dc)])
-                                    used |= (1 << work[(br + dr) * 9 + (bc + dc)]);
-                    }
-                    if (!(used & (1 << d)))
-                    {
-                        count++;
-                        last_pos = ci;
-                    }
-                }
-                if (count == 1 && last_pos >= 0)
+                if (temp_grid[i]) continue;
+                cnt = popcount16(cand_mask[i]);
+                if (cnt < best_count)
                 {
-                    work[last_pos] = (uint8_t)d;
-                    progress = 1;
+                    best_count = cnt;
+                    best_pos = i;
+                    if (cnt == 2) break;
                 }
             }
+
+            if (best_pos == -1)
+            {
+                solve_count++;
+                undo_to(mark);
+                continue;
+            }
+
+            solve_stack[solve_sp].mark = mark;
+            solve_stack[solve_sp].base = trail_top;
+            solve_stack[solve_sp].pos = (uint8_t)best_pos;
+            solve_stack[solve_sp].left = cand_mask[best_pos];
+            solve_sp++;
+        }
+        else
+        {
+            if (!solve_sp) return 1;
+            i = solve_sp - 1;
+            if (solve_count >= 2 || !solve_stack[i].left)
+            {
+                undo_to(solve_stack[i].mark);
+                solve_sp--;
+                continue;
+            }
+            undo_to(solve_stack[i].base);
+            d = lowest_digit(solve_stack[i].left);
+            solve_stack[i].left &= (uint16_t)~(1 << d);
+            place_digit(solve_stack[i].pos, d);
+            solve_enter = 1;
         }
+    }
+}
 
-    } while (progress);
+/* difficulty check: can the puzzle be solved with singles only? */
+static int solvable_by_singles(const uint8_t *puzzle)
+{
+    int i;
 
+    memcpy(temp_grid, puzzle, 81);
+    rebuild_used(temp_grid);
+    trail_top = 0;
+    if (!propagate()) return 0;
     for (i = 0; i < 81; i++)
-        if (!work[i]) return 0;
+        if (!temp_grid[i]) return 0;
     return 1;
 }
 
-static void generate_puzzle(uint8_t diff)
-{
+/* Generation runs as a job in bounded slices, so it can use the idle
+   end of every frame: a slice advances the grid fill by GEN_FILL_STEPS
+   placements or a hole's uniqueness count by GEN_SOLVE_NODES
+   propagations.  Finished puzzles go to the queue of their difficulty. */
+#define GEN_IDLE 0
+#define GEN_FILL 1      /* slices fill a solved grid */
+#define GEN_DIG  2      /* slices dig holes, then grade the puzzle */
+
+#define GEN_FILL_STEPS  81
+#define GEN_SOLVE_NODES 1
+
+static struct {
+    uint8_t phase;
+    uint8_t diff;
+    uint8_t attempts;
+    uint8_t target_min;
+    uint8_t clue_count;
+    uint8_t next;           /* next removal in order[] */
+    uint8_t solving;        /* a hole's uniqueness count is running */
+    uint8_t hole;           /* ...for this cell */
+    uint8_t solution[81];
     uint8_t puzzle[81];
-    uint8_t order[81], tmp;
-    int i, j, clue_count;
-    int target_min;
-    int attempts;
+    uint8_t order[81];
+} gen;
+
+static void gen_fill_begin(void)
+{
+    gen.attempts++;
+    fill_begin();
+    gen.phase = GEN_FILL;
+}
 
+static void gen_begin(uint8_t diff)
+{
     switch (diff)
     {
-        case 0: target_min = 36; break; /* easy */
-        case 1: target_min = 28; break; /* medium */
-        default: target_min = 22; break; /* hard */
+        case 0: gen.target_min = 36; break; /* easy */
+        case 1: gen.target_min = 28; break; /* medium */
+        default: gen.target_min = 22; break; /* hard */
     }
 
     /* re-seed RNG with current clock for better entropy (user has been navigating menus) */
     srand(clock());
 
-    attempts = 0;
-retry:
-    attempts++;
+    gen.diff = diff;
+    gen.attempts = 0;
+    gen_fill_begin();
+}
 
-    /* generate a full solved grid */
-    memset(solution, 0, 81);
-    memset(row_used, 0, sizeof(row_used));
-    memset(col_used, 0, sizeof(col_used));
-    memset(box_used, 0, sizeof(box_used));
-    fill_grid(0);
+static void queue_push(uint8_t diff, const uint8_t *sol, const uint8_t *puzzle)
+{
+    queued_puzzle_t *q = &puzzle_queue[diff][queue_count[diff]++];
+    int i;
+
+    memcpy(q->solution, sol, 81);
+    memset(q->given_mask, 0, sizeof(q->given_mask));
+    for (i = 0; i < 81; i++)
+        if (puzzle[i])
+            q->given_mask[i / 8] |= (uint8_t)(1 << (i % 8));
+    queue_dirty = 1;
+}
 
-    memcpy(puzzle, solution, 81);
-    clue_count = 81;
+/* Start the oldest queued puzzle of this difficulty */
+static void queue_pop(uint8_t diff)
+{
+    const queued_puzzle_t *q = &puzzle_queue[diff][0];
+    int i;
 
-    /* shuffled removal order */
-    for (i = 0; i < 81; i++) order[i] = (uint8_t)i;
-    for (i = 80; i > 0; i--)
+    memcpy(solution, q->solution, 81);
+    for (i = 0; i < 81; i++)
     {
-        j = rand() % (i + 1);
-        tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+        cells[i].given = (q->given_mask[i / 8] >> (i % 8)) & 1;
+        cells[i].value = cells[i].given ? solution[i] : 0;
+        cells[i].marks = 0;
+        cells[i].error = 0;
     }
+    queue_count[diff]--;
+    memmove(&puzzle_queue[diff][0], &puzzle_queue[diff][1],
+            queue_count[diff] * sizeof(queued_puzzle_t));
+    queue_dirty = 1;
+}
+
+/* Run one slice of the job.  Returns 0 if there was nothing to do. */
+static int gen_step(void)
+{
+    int i, j;
+    uint8_t tmp;
 
-    for (i = 0; i < 81 && clue_count > target_min; i++)
+    if (gen.phase == GEN_FILL)
     {
-        int pos = order[i];
-        uint8_t saved = puzzle[pos];
-        puzzle[pos] = 0;
-        clue_count--;
+        /* generate a full solved grid */
+        if (!fill_run(GEN_FILL_STEPS))
+            return 1;
+        memcpy(gen.solution, temp_grid, 81);
+        memcpy(gen.puzzle, temp_grid, 81);
+        gen.clue_count = 81;
+
+        /* shuffled removal order */
+        for (i = 0; i < 81; i++) gen.order[i] = (uint8_t)i;
+        for (i = 80; i > 0; i--)
+        {
+            j = rand() % (i + 1);
+            tmp = gen.order[i]; gen.order[i] = gen.order[j]; gen.order[j] = tmp;
+        }
+        gen.next = 0;
+        gen.solving = 0;
+        gen.phase = GEN_DIG;
+        return 1;
+    }
+
+    if (gen.phase != GEN_DIG)
+        return 0;
 
-        if (!has_unique_solution(puzzle))
+    if (gen.solving)
+    {
+        if (!solve_run(GEN_SOLVE_NODES))
+            return 1;
+        gen.solving = 0;
+        if (solve_count != 1)
         {
-            puzzle[pos] = saved;
-            clue_count++;
+            /* not unique: put the clue back */
+            gen.puzzle[gen.hole] = gen.solution[gen.hole];
+            gen.clue_count++;
         }
+        return 1;
+    }
+
+    if (gen.next < 81 && gen.clue_count > gen.target_min)
+    {
+        gen.hole = gen.order[gen.next++];
+        gen.puzzle[gen.hole] = 0;
+        gen.clue_count--;
+        solve_begin(gen.puzzle);
+        gen.solving = 1;
+        return 1;
     }
 
     /* difficulty check */
-    if (diff == 0)
+    if (gen.diff == 0)
     {
         /* easy must be solvable by singles only */
-        if (!solvable_by_singles(puzzle) && attempts < 10)
-            goto retry;
+        if (!solvable_by_singles(gen.puzzle) && gen.attempts < 10)
+        {
+            gen_fill_begin();
+            return 1;
+        }
     }
-    else if (diff == 1)
+    else if (gen.diff == 1)
     {
         /* medium: shouldn't be too easy (solvable by singles) or keep too many clues */
-        if (solvable_by_singles(puzzle) && clue_count > 32 && attempts < 10)
-            goto retry;
+        if (solvable_by_singles(gen.puzzle) && gen.clue_count > 32 && gen.attempts < 10)
+        {
+            gen_fill_begin();
+            return 1;
+        }
     }
     /* hard: anything that has few clues and unique solution is fine */
 
-    /* populate cells */
-    for (i = 0; i < 81; i++)
+    queue_push(gen.diff, gen.solution, gen.puzzle);
+    gen.phase = GEN_IDLE;
+    return 1;
+}
+
+/* Background slice: top up the shortest queue, the current difficulty
+   first on a tie.  Returns 0 when every queue is full. */
+static int gen_background(void)
+{
+    if (gen.phase == GEN_IDLE)
     {
-        cells[i].value = puzzle[i];
-        cells[i].marks = 0;
-        cells[i].given = (puzzle[i] != 0) ? 1 : 0;
-        cells[i].error = 0;
+        uint8_t d, best = difficulty;
+        for (d = 0; d < 3; d++)
+            if (queue_count[d] < queue_count[best])
+                best = d;
+        if (queue_count[best] >= QUEUE_DEPTH)
+            return 0;
+        gen_begin(best);
     }
+    return gen_step();
+}
+
+/* Generate a puzzle of this difficulty now, to the front of its queue */
+static void generate_puzzle(uint8_t diff)
+{
+    if (gen.phase == GEN_IDLE || gen.diff != diff)
+        gen_begin(diff);
+    while (gen.phase != GEN_IDLE)
+        gen_step();
 }
 
 /* ========== Save/Load ========== */
@@ -626,15 +895,18 @@ static void gc_after(void)
 
 static void save_data(void)
 {
-    save_data_t save;
+    static save_data_t save;   /* static: keeps it off the CE stack */
     uint8_t handle;
     int i;
 
     save.version = SAVE_VERSION;
     save.settings = settings;
     memcpy(save.scores, scores, sizeof(scores));
+    memcpy(save.queue_count, queue_count, sizeof(queue_count));
+    memcpy(save.queue, puzzle_queue, sizeof(puzzle_queue));
 
-    if (state == STATE_PLAYING || state == STATE_PAUSED)
+    /* a game left from the menu is still in cells[] */
+    if (state == STATE_PLAYING || state == STATE_PAUSED || has_saved_game)
     {
         save.has_save = 1;
         save.difficulty = difficulty;
@@ -667,29 +939,34 @@ static void save_data(void)
         ti_Write(&save, sizeof(save_data_t), 1, handle);
         ti_SetArchiveStatus(1, handle);
         ti_Close(handle);
+        queue_dirty = 0;
     }
 }
 
 static int load_data(void)
 {
-    save_data_t save;
+    static save_data_t save;   /* static: keeps it off the CE stack */
     uint8_t handle;
+    size_t size;
     int i;
 
     handle = ti_Open(APPVAR_NAME, "r");
     if (!handle) return 0;
 
-    if (ti_Read(&save, sizeof(save_data_t), 1, handle) != 1)
-    {
-        ti_Close(handle);
-        return 0;
-    }
+    size = ti_Read(&save, 1, sizeof(save_data_t), handle);
     ti_Close(handle);
 
-    if (save.version != SAVE_VERSION) return 0;
+    /* version 1 saves are kept, with an empty puzzle queue */
+    if (save.version == 1 && size >= SAVE_V1_SIZE)
+        memset(save.queue_count, 0, sizeof(save.queue_count));
+    else if (save.version != SAVE_VERSION || size != sizeof(save_data_t))
+        return 0;
 
     settings = save.settings;
     memcpy(scores, save.scores, sizeof(scores));
+    for (i = 0; i < 3; i++)
+        queue_count[i] = save.queue_count[i] <= QUEUE_DEPTH ? save.queue_count[i] : 0;
+    memcpy(puzzle_queue, save.queue, sizeof(puzzle_queue));
 
     if (save.has_save)
     {
@@ -892,11 +1169,77 @@ static void jump_next_empty(void)
 
 /* ========== Drawing ========== */
 
+/* How a cell looks: background, digit and its color, or pencil marks.
+   Equal looks draw identical pixels. */
+static uint32_t cell_look(int r, int c)
+{
+    int idx = r * 9 + c;
+    uint8_t sel_val = cells[cur_row * 9 + cur_col].value;
+    uint8_t bg, fg;
+
+    if (r == (int)cur_row && c == (int)cur_col)
+        bg = PAL_SEL_BG;
+    else if (settings.hl_same && sel_val && cells[idx].value == sel_val)
+        bg = PAL_SAME_BG;
+    else if (settings.hl_house &&
+             (r == (int)cur_row || c == (int)cur_col ||
+              (r / 3 == cur_row / 3 && c / 3 == cur_col / 3)))
+        bg = PAL_HOUSE_BG;
+    else
+        bg = PAL_CELL_BG;
+
+    if (!cells[idx].value)
+        return bg | ((uint32_t)cells[idx].marks << 16);
+
+    if (cells[idx].error && !cells[idx].given)
+        fg = PAL_ERROR;
+    else if (cells[idx].given)
+        fg = PAL_GIVEN;
+    else
+        fg = PAL_PLAYER;
+    return bg | ((uint32_t)fg << 4) | ((uint32_t)cells[idx].value << 8);
+}
+
+static void draw_cell(int r, int c, uint32_t look)
+{
+    int px = cell_px[c];
+    int py = cell_py[r];
+    uint8_t value = (uint8_t)(look >> 8) & 0x0F;
+    uint16_t marks = (uint16_t)(look >> 16);
+
+    gfx_SetColor((uint8_t)(look & 0x0F));
+    gfx_FillRectangle_NoClip(px, py, CELL_SIZE, CELL_SIZE);
+
+    if (value)
+    {
+        gfx_SetTextScale(2, 2);
+        gfx_SetTextFGColor((uint8_t)(look >> 4) & 0x0F);
+        gfx_SetTextXY(px + 4, py + 4);
+        gfx_PrintChar('0' + value);
+    }
+    else if (marks)
+    {
+        int d, mc, mr;
+        gfx_SetTextScale(1, 1);
+        gfx_SetMonospaceFont(7);
+        gfx_SetTextFGColor(PAL_PENCIL);
+        for (d = 1; d <= 9; d++)
+        {
+            if (marks & (1 << d))
+            {
+                mc = (d - 1) % 3;
+                mr = (d - 1) / 3;
+                gfx_SetTextXY(px + 2 + mc * 7, py + 1 + mr * 7);
+                gfx_PrintChar('0' + d);
+            }
+        }
+        gfx_SetMonospaceFont(0);
+    }
+}
+
 static void draw_grid(void)
 {
-    int r, c, idx;
-    uint8_t sel_val;
-    int sel_box_r, sel_box_c;
+    int r, c;
 
     /* fill grid background with thick line color */
     gfx_SetColor(PAL_GRID_THICK);
@@ -919,76 +1262,12 @@ static void draw_grid(void)
         }
     }
 
-    sel_val = cells[cur_row * 9 + cur_col].value;
-    sel_box_r = cur_row / 3;
-    sel_box_c = cur_col / 3;
-
-    /* fill each cell with appropriate background */
-    for (r = 0; r < 9; r++)
-    {
-        for (c = 0; c < 9; c++)
-        {
-            uint8_t bg;
-            idx = r * 9 + c;
-
-            if (r == (int)cur_row && c == (int)cur_col)
-                bg = PAL_SEL_BG;
-            else if (settings.hl_same && sel_val && cells[idx].value == sel_val)
-                bg = PAL_SAME_BG;
-            else if (settings.hl_house &&
-                     (r == (int)cur_row || c == (int)cur_col ||
-                      (r / 3 == sel_box_r && c / 3 == sel_box_c)))
-                bg = PAL_HOUSE_BG;
-            else
-                bg = PAL_CELL_BG;
-
-            gfx_SetColor(bg);
-            gfx_FillRectangle_NoClip(cell_px[c], cell_py[r], CELL_SIZE, CELL_SIZE);
-        }
-    }
-
-    /* draw cell contents */
     for (r = 0; r < 9; r++)
     {
         for (c = 0; c < 9; c++)
         {
-            int px = cell_px[c];
-            int py = cell_py[r];
-            idx = r * 9 + c;
-
-            if (cells[idx].value)
-            {
-                uint8_t fg;
-                if (cells[idx].error && !cells[idx].given)
-                    fg = PAL_ERROR;
-                else if (cells[idx].given)
-                    fg = PAL_GIVEN;
-                else
-                    fg = PAL_PLAYER;
-
-                gfx_SetTextScale(2, 2);
-                gfx_SetTextFGColor(fg);
-                gfx_SetTextXY(px + 4, py + 4);
-                gfx_PrintChar('0' + cells[idx].value);
-            }
-            else if (cells[idx].marks)
-            {
-                int d, mc, mr;
-                gfx_SetTextScale(1, 1);
-                gfx_SetMonospaceFont(7);
-                gfx_SetTextFGColor(PAL_PENCIL);
-                for (d = 1; d <= 9; d++)
-                {
-                    if (cells[idx].marks & (1 << d))
-                    {
-                        mc = (d - 1) % 3;
-                        mr = (d - 1) / 3;
-                        gfx_SetTextXY(px + 2 + mc * 7, py + 1 + mr * 7);
-                        gfx_PrintChar('0' + d);
-                    }
-                }
-                gfx_SetMonospaceFont(0);
-            }
+            drawn_look[r * 9 + c] = cell_look(r, c);
+            draw_cell(r, c, drawn_look[r * 9 + c]);
         }
     }
 }
@@ -997,6 +1276,10 @@ static void draw_sidebar(void)
 {
     int d, dc, dr, remaining;
 
+    drawn_seconds = elapsed_seconds;
+    drawn_pencil = (uint8_t)pencil_mode;
+    memcpy(drawn_count, digit_count, sizeof(drawn_count));
+
     gfx_SetColor(PAL_SIDEBAR_BG);
     gfx_FillRectangle_NoClip(SIDEBAR_X, 0, SIDEBAR_W, SCREEN_H);
 
@@ -1076,12 +1359,47 @@ static void draw_sidebar(void)
     gfx_PrintStringXY("Clr:Pause", SIDEBAR_X + 2, 186);
 }
 
+static int sidebar_changed(void)
+{
+    return (settings.show_timer && drawn_seconds != elapsed_seconds) ||
+           drawn_pencil != (uint8_t)pencil_mode ||
+           memcmp(drawn_count, digit_count, sizeof(drawn_count));
+}
+
+/* The buffer keeps the whole playing screen.  Only cells whose look
+   changed are redrawn and blitted to the screen, which covers cursor
+   moves, digits, pencil marks, errors, highlights and undo alike. */
 static void draw_playing(void)
 {
-    gfx_FillScreen(PAL_BG);
-    draw_grid();
-    draw_sidebar();
-    gfx_SwapDraw();
+    int r, c;
+
+    if (!play_drawn)
+    {
+        gfx_FillScreen(PAL_BG);
+        draw_grid();
+        draw_sidebar();
+        gfx_BlitBuffer();
+        play_drawn = 1;
+        return;
+    }
+
+    for (r = 0; r < 9; r++)
+    {
+        for (c = 0; c < 9; c++)
+        {
+            uint32_t look = cell_look(r, c);
+            if (look == drawn_look[r * 9 + c]) continue;
+            drawn_look[r * 9 + c] = look;
+            draw_cell(r, c, look);
+            gfx_BlitRectangle(gfx_buffer, cell_px[c], cell_py[r], CELL_SIZE, CELL_SIZE);
+        }
+    }
+
+    if (sidebar_changed())
+    {
+        draw_sidebar();
+        gfx_BlitRectangle(gfx_buffer, SIDEBAR_X, 0, SIDEBAR_W, SCREEN_H);
+    }
 }
 
 /* ========== State: Playing ========== */
@@ -1106,6 +1424,7 @@ static void update_playing(void)
     if (new_g6 & kb_Clear)
     {
         state = STATE_PAUSED;
+        play_drawn = 0;
         return;
     }
 
@@ -1166,6 +1485,7 @@ static void update_playing(void)
             if (check_complete())
             {
                 state = STATE_COMPLETE;
+                play_drawn = 0;
                 new_best = 0;
                 scores[difficulty].games_played++;
                 if (scores[difficulty].best_time == 0 ||
@@ -1205,7 +1525,9 @@ static void update_playing(void)
         }
     }
 
+    FRAME_SCOPE_BEGIN(FRAME_SCOPE_DRAW);
     draw_playing();
+    FRAME_SCOPE_END(FRAME_SCOPE_DRAW);
 }
 
 /* ========== State: Paused ========== */
@@ -1300,17 +1622,22 @@ static void update_complete(void)
 
 static void update_generating(void)
 {
-    gfx_FillScreen(PAL_BG);
-    gfx_SetTextScale(2, 2);
-    gfx_SetTextFGColor(PAL_MENU_TXT);
-    gfx_PrintStringXY("Generating", 64, 90);
-    gfx_SetTextScale(1, 1);
-    gfx_SetTextFGColor(PAL_SIDEBAR_TXT);
-    gfx_PrintStringXY(diff_names[difficulty], 136, 120);
-    gfx_PrintStringXY("Please wait...", 104, 140);
-    gfx_SwapDraw();
+    /* normally a puzzle is waiting; generate one only if not */
+    if (!queue_count[difficulty])
+    {
+        gfx_FillScreen(PAL_BG);
+        gfx_SetTextScale(2, 2);
+        gfx_SetTextFGColor(PAL_MENU_TXT);
+        gfx_PrintStringXY("Generating", 64, 90);
+        gfx_SetTextScale(1, 1);
+        gfx_SetTextFGColor(PAL_SIDEBAR_TXT);
+        gfx_PrintStringXY(diff_names[difficulty], 136, 120);
+        gfx_PrintStringXY("Please wait...", 104, 140);
+        gfx_SwapDraw();
 
-    generate_puzzle(difficulty);
+        generate_puzzle(difficulty);
+    }
+    queue_pop(difficulty);
 
     cur_row = 4;
     cur_col = 4;
@@ -1490,6 +1817,8 @@ static void update_menu(void)
 
     if (new_g6 & kb_Clear)
     {
+        /* keep puzzles generated since the last save */
+        if (queue_dirty) save_data();
         running = 0;
         return;
     }
@@ -1740,8 +2069,6 @@ static void update_scores(void)
 
 int main(void)
 {
-    clock_t frame_start;
-
     gfx_Begin();
     gfx_SetDrawBuffer();
 
@@ -1761,10 +2088,14 @@ int main(void)
     running = 1;
 
     init_cell_positions();
+    init_houses();
+    frame_init(TARGET_FPS);
+    frame_hud_style(0, SCREEN_H - 20, PAL_SIDEBAR_TXT, PAL_SIDEBAR_BG);
+    frame_scope_name(1, "Gen");
 
     do
     {
-        frame_start = clock();
+        frame_begin();
         kb_Scan();
 
         cur_g1 = kb_Data[1];
@@ -1795,8 +2126,14 @@ int main(void)
         prev_g6 = cur_g6;
         prev_g7 = cur_g7;
 
-        while (clock() - frame_start < FRAME_TIME)
+        frame_end();
+
+        /* spend the idle end of the frame topping up the puzzle queue,
+           starting a (bounded) slice only while half a frame is left */
+        FRAME_SCOPE_BEGIN(1);
+        while (frame_idle() > FRAME_TIME / 2 && gen_background())
             ;
+        FRAME_SCOPE_END(1);
 
     } while (running);
 